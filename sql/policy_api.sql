@@ -44,6 +44,32 @@ CREATE OR REPLACE FUNCTION @extschema@.remove_reorder_policy(hypertable REGCLASS
 AS '@MODULE_PATHNAME@', 'ts_policy_reorder_remove'
 LANGUAGE C VOLATILE STRICT;
 
+/* merge chunks policy */
+-- Merge adjacent chunks in the columnstore that are smaller than
+-- target_size (in bytes) or whose compressed batches have fewer than
+-- min_batch_rows rows on average, keeping the merged chunks within
+-- target_size.
+--
+-- min_batch_rows defaults to half of the compressed batch size, i.e. 500
+-- rows, and must be between 0 and 1000. Setting it to 0 merges chunks by
+-- size only. The merges always combine the compressed batches of the
+-- merged chunks, as with timescaledb.enable_merge_chunks_rebatch.
+CREATE OR REPLACE FUNCTION @extschema@.add_merge_chunks_policy(
+    hypertable REGCLASS,
+    target_size BIGINT,
+    min_batch_rows INTEGER = NULL,
+    if_not_exists BOOL = false,
+    schedule_interval INTERVAL = NULL,
+    initial_start TIMESTAMPTZ = NULL,
+    timezone TEXT = NULL
+) RETURNS INTEGER
+AS '@MODULE_PATHNAME@', 'ts_policy_merge_chunks_add'
+LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE FUNCTION @extschema@.remove_merge_chunks_policy(hypertable REGCLASS, if_exists BOOL = false) RETURNS VOID
+AS '@MODULE_PATHNAME@', 'ts_policy_merge_chunks_remove'
+LANGUAGE C VOLATILE STRICT;
+
 /* compression policy */
 CREATE OR REPLACE FUNCTION @extschema@.add_compression_policy(
     hypertable REGCLASS,
@@ -18,6 +18,10 @@ CREATE OR REPLACE FUNCTION _timescaledb_functions.policy_reorder_check(config JS
 RETURNS void AS '@MODULE_PATHNAME@', 'ts_policy_reorder_check'
 LANGUAGE C;
 
+CREATE OR REPLACE FUNCTION _timescaledb_functions.policy_merge_chunks_check(config JSONB)
+RETURNS void AS '@MODULE_PATHNAME@', 'ts_policy_merge_chunks_check'
+LANGUAGE C;
+
 CREATE OR REPLACE PROCEDURE _timescaledb_functions.policy_recompression(job_id INTEGER, config JSONB)
 AS '@MODULE_PATHNAME@', 'ts_policy_recompression_proc'
 LANGUAGE C;
@@ -252,3 +256,148 @@ BEGIN
   COMMIT;
 END;
 $$ LANGUAGE PLPGSQL;
+
+-- Merge adjacent chunks in the columnstore that are smaller than the target
+-- size or have underfilled compressed batches. Chunks are merged in order
+-- of the primary dimension as long as the merged chunk stays within the
+-- target size. The chunks are merged concurrently, one merge per
+-- transaction, so that the chunks are locked for reads only during the
+-- final swap of the merged relations.
+--
+-- Each merge turns on timescaledb.enable_merge_chunks_rebatch for its
+-- transaction, so the underfilled compressed batches of the merged chunks
+-- are combined into full batches regardless of the session setting.
+CREATE OR REPLACE PROCEDURE
+_timescaledb_functions.policy_merge_chunks(job_id INTEGER, config JSONB)
+AS $$
+DECLARE
+  htid                INTEGER;
+  dimid               INTEGER;
+  target_size         BIGINT;
+  min_batch_rows      INTEGER;
+  max_merges          INTEGER;
+  verbose_log         BOOL;
+  chunk_rec           RECORD;
+  is_candidate        BOOL;
+  merge_group         REGCLASS[] := '{}';
+  merge_size          BIGINT := 0;
+  prev_partition      INTEGER[];
+  prev_range_end      BIGINT;
+  num_merges          INTEGER := 0;
+  -- fully compressed chunk status
+  status_fully_compressed int := 1;
+BEGIN
+
+  -- procedures with SET clause cannot execute transaction
+  -- control so we adjust search_path in procedure body
+  SET LOCAL search_path TO pg_catalog, pg_temp;
+
+  IF config IS NULL THEN
+    RAISE EXCEPTION 'job % has null config', job_id;
+  END IF;
+
+  htid := jsonb_object_field_text(config, 'hypertable_id')::INTEGER;
+  IF htid is NULL THEN
+    RAISE EXCEPTION 'job % config must have hypertable_id', job_id;
+  END IF;
+
+  target_size := jsonb_object_field_text(config, 'target_size')::BIGINT;
+  IF target_size IS NULL THEN
+    RAISE EXCEPTION 'job % config must have target_size', job_id;
+  END IF;
+
+  min_batch_rows := jsonb_object_field_text(config, 'min_batch_rows')::INTEGER;
+  IF min_batch_rows IS NULL THEN
+    RAISE EXCEPTION 'job % config must have min_batch_rows', job_id;
+  END IF;
+
+  max_merges          := COALESCE(jsonb_object_field_text(config, 'max_merges_per_job')::INTEGER, 10);
+  verbose_log         := COALESCE(jsonb_object_field_text(config, 'verbose_log')::BOOLEAN, FALSE);
+
+  -- find primary dimension --
+  SELECT dim.id INTO dimid
+  FROM _timescaledb_catalog.dimension dim
+  WHERE dim.hypertable_id = htid AND dim.interval_length IS NOT NULL
+  ORDER BY dim.id
+  LIMIT 1;
+
+  -- Chunks can only be merged along the primary dimension, so the chunks
+  -- are ordered by their slices in the other dimensions first.
+  FOR chunk_rec IN
+    SELECT
+      format('%I.%I', ch.schema_name, ch.table_name)::regclass AS relid,
+      ds.range_start,
+      ds.range_end,
+      ARRAY(
+        SELECT cc2.dimension_slice_id
+        FROM _timescaledb_catalog.chunk_constraint cc2
+          INNER JOIN _timescaledb_catalog.dimension_slice ds2 ON ds2.id = cc2.dimension_slice_id
+        WHERE cc2.chunk_id = ch.id AND ds2.dimension_id <> dimid
+        ORDER BY ds2.dimension_id
+      ) AS partition,
+      ccs.compressed_heap_size + ccs.compressed_toast_size + ccs.compressed_index_size AS chunk_size,
+      ccs.numrows_pre_compression / NULLIF(ccs.numrows_post_compression, 0) AS batch_rows
+    FROM
+      _timescaledb_catalog.chunk ch
+      INNER JOIN _timescaledb_catalog.chunk_constraint cc ON cc.chunk_id = ch.id
+      INNER JOIN _timescaledb_catalog.dimension_slice ds ON ds.id = cc.dimension_slice_id AND ds.dimension_id = dimid
+      INNER JOIN _timescaledb_catalog.compression_chunk_size ccs ON ccs.chunk_id = ch.id
+    WHERE ch.hypertable_id = htid
+    AND NOT ch.dropped
+    AND NOT ch.osm_chunk
+    -- Only fully compressed chunks that are not frozen
+    AND ch.status = status_fully_compressed
+    ORDER BY partition, ds.range_start
+  LOOP
+    is_candidate := chunk_rec.chunk_size < target_size OR chunk_rec.batch_rows < min_batch_rows;
+
+    -- Merge the current group if this chunk cannot be added to it
+    IF NOT is_candidate
+      OR chunk_rec.partition IS DISTINCT FROM prev_partition
+      OR chunk_rec.range_start IS DISTINCT FROM prev_range_end
+      OR merge_size + chunk_rec.chunk_size > target_size THEN
+      IF array_length(merge_group, 1) > 1 THEN
+        IF verbose_log THEN
+          RAISE LOG 'job % merging chunks %', job_id, merge_group;
+        END IF;
+        PERFORM set_config('timescaledb.enable_merge_chunks_rebatch', 'on', true);
+        CALL @extschema@.merge_chunks_concurrently(merge_group);
+        COMMIT;
+        -- SET LOCAL is only active until end of transaction.
+        SET LOCAL search_path TO pg_catalog, pg_temp;
+        num_merges := num_merges + 1;
+      END IF;
+
+      merge_group := '{}';
+      merge_size := 0;
+
+      IF max_merges > 0 AND num_merges >= max_merges THEN
+        EXIT;
+      END IF;
+    END IF;
+
+    IF is_candidate THEN
+      merge_group := merge_group || chunk_rec.relid;
+      merge_size := merge_size + chunk_rec.chunk_size;
+    END IF;
+
+    prev_partition := chunk_rec.partition;
+    prev_range_end := chunk_rec.range_end;
+  END LOOP;
+
+  IF array_length(merge_group, 1) > 1 THEN
+    IF verbose_log THEN
+      RAISE LOG 'job % merging chunks %', job_id, merge_group;
+    END IF;
+    PERFORM set_config('timescaledb.enable_merge_chunks_rebatch', 'on', true);
+    CALL @extschema@.merge_chunks_concurrently(merge_group);
+    COMMIT;
+    SET LOCAL search_path TO pg_catalog, pg_temp;
+    num_merges := num_merges + 1;
+  END IF;
+
+  IF verbose_log THEN
+    RAISE LOG 'job % completed % chunk merges', job_id, num_merges;
+  END IF;
+END;
+$$ LANGUAGE PLPGSQL;
@@ -11,5 +11,7 @@ insert into _timescaledb_catalog.compression_algorithm( id, version, name, descr
 ( 4, 1, 'COMPRESSION_ALGORITHM_DELTADELTA', 'deltadelta'),
 ( 5, 1, 'COMPRESSION_ALGORITHM_BOOL', 'bool'),
 ( 6, 1, 'COMPRESSION_ALGORITHM_NULL', 'null'),
-( 7, 1, 'COMPRESSION_ALGORITHM_UUID', 'uuid');
+( 7, 1, 'COMPRESSION_ALGORITHM_UUID', 'uuid'),
+( 8, 1, 'COMPRESSION_ALGORITHM_DECIMAL', 'decimal'),
+( 9, 1, 'COMPRESSION_ALGORITHM_JSONB', 'jsonb');
 
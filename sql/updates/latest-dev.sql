@@ -249,3 +249,9 @@ DROP FUNCTION timescaledb_experimental.time_bucket_ng(bucket_width INTERVAL, ts
 DROP FUNCTION timescaledb_experimental.time_bucket_ng(bucket_width INTERVAL, ts TIMESTAMPTZ);
 
 DROP FUNCTION timescaledb_experimental.time_bucket_ng(bucket_width INTERVAL, ts TIMESTAMPTZ, origin TIMESTAMPTZ);
+
+INSERT INTO _timescaledb_catalog.compression_algorithm( id, version, name, description) values
+( 8, 1, 'COMPRESSION_ALGORITHM_DECIMAL', 'decimal');
+
+INSERT INTO _timescaledb_catalog.compression_algorithm( id, version, name, description) values
+( 9, 1, 'COMPRESSION_ALGORITHM_JSONB', 'jsonb');
@@ -112,3 +112,64 @@ DROP FUNCTION IF EXISTS _timescaledb_functions.compressed_data_column_size(_time
 
 DROP FUNCTION IF EXISTS _timescaledb_functions.estimate_uncompressed_size;
 
+DROP VIEW IF EXISTS timescaledb_information.decompression_stats;
+DROP FUNCTION IF EXISTS _timescaledb_functions.decompression_stats();
+DROP FUNCTION IF EXISTS _timescaledb_functions.decompression_stats_reset();
+DROP VIEW IF EXISTS timescaledb_information.job_scheduler_stats;
+DROP FUNCTION IF EXISTS _timescaledb_functions.job_scheduler_stats();
+
+-- The previous version cannot read data compressed with the decimal or
+-- jsonb algorithms. The algorithm id is the first byte of the compressed
+-- data, and it is read as bytea since the type's output function comes from
+-- the library being downgraded to.
+CREATE FUNCTION _timescaledb_functions.compressed_data_bytes(_timescaledb_internal.compressed_data)
+RETURNS bytea LANGUAGE internal IMMUTABLE STRICT AS 'byteasend';
+
+DO $$
+DECLARE
+    chunk record;
+    uses_algorithm bool;
+    chunks text[] := '{}';
+BEGIN
+    FOR chunk IN
+        SELECT format('%I.%I', ch.schema_name, ch.table_name) AS chunk_name,
+               format('%I.%I', cch.schema_name, cch.table_name) AS compressed_chunk_name,
+               string_agg(format('get_byte(_timescaledb_functions.compressed_data_bytes(%I), 0) IN (8, 9)', a.attname), ' OR ') AS condition
+          FROM _timescaledb_catalog.chunk ch
+          JOIN _timescaledb_catalog.chunk cch ON cch.id = ch.compressed_chunk_id
+          JOIN pg_attribute a ON a.attrelid = format('%I.%I', cch.schema_name, cch.table_name)::regclass
+          JOIN pg_attribute ua ON ua.attrelid = format('%I.%I', ch.schema_name, ch.table_name)::regclass
+                              AND ua.attname = a.attname
+         WHERE NOT ch.dropped
+           AND a.atttypid = '_timescaledb_internal.compressed_data'::regtype
+           AND NOT a.attisdropped
+           AND ua.atttypid IN ('numeric'::regtype, 'float4'::regtype, 'float8'::regtype, 'jsonb'::regtype)
+         GROUP BY 1, 2
+    LOOP
+        EXECUTE format('SELECT EXISTS (SELECT FROM %s WHERE %s)', chunk.compressed_chunk_name, chunk.condition)
+           INTO uses_algorithm;
+        IF uses_algorithm THEN
+            chunks := chunks || chunk.chunk_name;
+        END IF;
+    END LOOP;
+
+    IF array_length(chunks, 1) > 0 THEN
+        RAISE EXCEPTION 'cannot downgrade because there are chunks compressed with the decimal or jsonb algorithms'
+            USING
+                ERRCODE = 'object_not_in_prerequisite_state',
+                DETAIL = format('Decompress and compress these chunks with timescaledb.enable_decimal_compression and timescaledb.enable_jsonb_compression turned off before downgrade: %s.', array_to_string(chunks, ', '));
+    END IF;
+END
+$$;
+
+DROP FUNCTION _timescaledb_functions.compressed_data_bytes(_timescaledb_internal.compressed_data);
+
+DELETE FROM _timescaledb_catalog.compression_algorithm WHERE id = 8 AND version = 1 AND name = 'COMPRESSION_ALGORITHM_DECIMAL';
+
+DELETE FROM _timescaledb_catalog.compression_algorithm WHERE id = 9 AND version = 1 AND name = 'COMPRESSION_ALGORITHM_JSONB';
+
+DELETE FROM _timescaledb_config.bgw_job WHERE proc_schema = '_timescaledb_functions' AND proc_name = 'policy_merge_chunks';
+DROP FUNCTION IF EXISTS @extschema@.add_merge_chunks_policy(REGCLASS, BIGINT, INTEGER, BOOL, INTERVAL, TIMESTAMPTZ, TEXT);
+DROP FUNCTION IF EXISTS @extschema@.remove_merge_chunks_policy(REGCLASS, BOOL);
+DROP PROCEDURE IF EXISTS _timescaledb_functions.policy_merge_chunks(INTEGER, JSONB);
+DROP FUNCTION IF EXISTS _timescaledb_functions.policy_merge_chunks_check(JSONB);
@@ -428,6 +428,85 @@ AS SELECT * FROM timescaledb_information.hypertable_compression_settings;
 CREATE OR REPLACE VIEW timescaledb_information.chunk_columnstore_settings AS
 SELECT * FROM timescaledb_information.chunk_compression_settings;
 
+-- Cumulative decompression and vectorization statistics, per chunk
+-- (attnum = 0) and per chunk column
+CREATE OR REPLACE FUNCTION _timescaledb_functions.decompression_stats()
+RETURNS TABLE (
+    relid oid,
+    attnum smallint,
+    batches_decompressed bigint,
+    rows_decompressed bigint,
+    bytes_detoasted bigint,
+    dml_batches_decompressed bigint,
+    dml_rows_decompressed bigint,
+    vectorized_aggregations bigint,
+    fallback_aggregations bigint,
+    fallback_unsupported_aggregate bigint,
+    fallback_aggregate_argument bigint,
+    fallback_reverse_order bigint,
+    fallback_grouping bigint,
+    fallback_filter bigint)
+AS '@MODULE_PATHNAME@', 'ts_decompression_stats' LANGUAGE C STRICT VOLATILE;
+
+CREATE OR REPLACE FUNCTION _timescaledb_functions.decompression_stats_reset() RETURNS VOID
+AS '@MODULE_PATHNAME@', 'ts_decompression_stats_reset' LANGUAGE C STRICT VOLATILE;
+
+CREATE OR REPLACE VIEW timescaledb_information.decompression_stats AS
+SELECT
+  ht.schema_name AS hypertable_schema,
+  ht.table_name AS hypertable_name,
+  ch.schema_name AS chunk_schema,
+  ch.table_name AS chunk_name,
+  att.attname AS column_name,
+  s.batches_decompressed,
+  s.rows_decompressed,
+  s.bytes_detoasted,
+  s.dml_batches_decompressed,
+  s.dml_rows_decompressed,
+  s.vectorized_aggregations,
+  s.fallback_aggregations,
+  s.fallback_unsupported_aggregate,
+  s.fallback_aggregate_argument,
+  s.fallback_reverse_order,
+  s.fallback_grouping,
+  s.fallback_filter
+FROM _timescaledb_functions.decompression_stats() s
+JOIN pg_class cl ON cl.oid = s.relid
+JOIN pg_namespace ns ON ns.oid = cl.relnamespace
+JOIN _timescaledb_catalog.chunk ch ON ch.schema_name = ns.nspname AND ch.table_name = cl.relname
+JOIN _timescaledb_catalog.hypertable ht ON ht.id = ch.hypertable_id
+LEFT JOIN pg_attribute att ON att.attrelid = s.relid AND att.attnum = s.attnum AND s.attnum > 0;
+
+-- Main loop statistics of the job scheduler of the current database. The pid
+-- is NULL when the scheduler is no longer running.
+CREATE OR REPLACE FUNCTION _timescaledb_functions.job_scheduler_stats()
+RETURNS TABLE (
+    pid integer,
+    iterations bigint,
+    jobs_started bigint,
+    total_work_us bigint,
+    max_work_us bigint,
+    total_lag_us bigint,
+    max_lag_us bigint,
+    scheduled_jobs bigint,
+    running_jobs bigint,
+    next_wakeup timestamptz)
+AS '@MODULE_PATHNAME@', 'ts_bgw_scheduler_stats' LANGUAGE C STRICT VOLATILE;
+
+CREATE OR REPLACE VIEW timescaledb_information.job_scheduler_stats AS
+SELECT
+  s.pid,
+  s.iterations,
+  s.jobs_started,
+  s.scheduled_jobs,
+  s.running_jobs,
+  s.next_wakeup,
+  (s.total_work_us / NULLIF(s.iterations, 0)) * INTERVAL '1 microsecond' AS avg_work_time,
+  s.max_work_us * INTERVAL '1 microsecond' AS max_work_time,
+  (s.total_lag_us / NULLIF(s.iterations, 0)) * INTERVAL '1 microsecond' AS avg_wakeup_lag,
+  s.max_lag_us * INTERVAL '1 microsecond' AS max_wakeup_lag
+FROM _timescaledb_functions.job_scheduler_stats() s;
+
 --temporary alias for bgw_job
 CREATE OR REPLACE VIEW _timescaledb_config.bgw_job AS
 SELECT * from _timescaledb_catalog.bgw_job;
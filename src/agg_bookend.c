@@ -12,6 +12,9 @@
 #include <libpq/pqformat.h>
 #include <nodes/value.h>
 #include <utils/datum.h>
+#include <utils/expandeddatum.h>
+#include <utils/float.h>
+#include <utils/fmgroids.h>
 #include <utils/lsyscache.h>
 #include <utils/syscache.h>
 
@@ -47,7 +50,7 @@ typedef struct TypeInfoCache
 	bool typbyval;
 } TypeInfoCache;
 
-/* PolyDatumIOState is internal state used by  polydatum_serialize and	polydatum_deserialize  */
+/* PolyDatumIOState is internal state used by the deserialization of the partial state */
 typedef struct PolyDatumIOState
 {
 	TypeInfoCache type;
@@ -92,27 +95,6 @@ polydatum_serialize_type(StringInfo buf, Oid type_oid)
 	ReleaseSysCache(tup);
 }
 
-/* serializes the polydatum pd unto buf */
-static void
-polydatum_serialize(PolyDatum *pd, StringInfo buf, PolyDatumIOState *state, FunctionCallInfo fcinfo)
-{
-	bytea *outputbytes;
-
-	Assert(OidIsValid(state->type.typoid));
-	polydatum_serialize_type(buf, state->type.typoid);
-
-	if (pd->is_null)
-	{
-		/* emit -1 data length to signify a NULL */
-		pq_sendint32(buf, -1);
-		return;
-	}
-
-	outputbytes = SendFunctionCall(&state->proc, pd->datum);
-	pq_sendint32(buf, VARSIZE(outputbytes) - VARHDRSZ);
-	pq_sendbytes(buf, VARDATA(outputbytes), VARSIZE(outputbytes) - VARHDRSZ);
-}
-
 static Oid
 polydatum_deserialize_type(StringInfo buf)
 {
@@ -133,10 +115,12 @@ polydatum_deserialize_type(StringInfo buf)
  * Deserialize the PolyDatum where the binary representation is in buf.
  * If a not-null PolyDatum is passed in, fill in it's fields, otherwise palloc.
  *
+ * This reads the legacy serialization format, where the types are stored as
+ * qualified names and the values in their binary send format.
  */
 static PolyDatum *
-polydatum_deserialize(MemoryContext mem_ctx, PolyDatum *result, StringInfo buf,
-					  PolyDatumIOState *state, FunctionCallInfo fcinfo)
+polydatum_deserialize_legacy(MemoryContext mem_ctx, PolyDatum *result, StringInfo buf,
+							 PolyDatumIOState *state, FunctionCallInfo fcinfo)
 {
 	int itemlen;
 	StringInfoData item_buf;
@@ -217,19 +201,46 @@ polydatum_deserialize(MemoryContext mem_ctx, PolyDatum *result, StringInfo buf,
 	return result;
 }
 
+/*
+ * The comparison operators that we evaluate inline instead of calling the
+ * comparison procedure through fmgr.
+ */
+typedef enum BookendCmpKind
+{
+	BOOKEND_CMP_GENERIC = 0,
+	BOOKEND_CMP_INT16,
+	BOOKEND_CMP_INT32,
+	BOOKEND_CMP_INT64,
+	BOOKEND_CMP_FLOAT8,
+} BookendCmpKind;
+
 typedef struct TransCache
 {
 	TypeInfoCache value_type_cache;
 	TypeInfoCache cmp_type_cache;
 	FmgrInfo cmp_proc;
+	BookendCmpKind cmp_kind;
+	bool cmp_greater;
 } TransCache;
 
+/*
+ * Memory for a by-reference PolyDatum, which is reused when the datum is
+ * replaced, and only grows when the new datum doesn't fit.
+ */
+typedef struct PolyDatumBuffer
+{
+	void *data;
+	Size size;
+} PolyDatumBuffer;
+
 /* Internal state for bookend aggregates */
 typedef struct InternalCmpAggStore
 {
 	TransCache aggstate_type_cache;
 	PolyDatum value;
 	PolyDatum cmp; /* the comparison element. e.g. time */
+	PolyDatumBuffer value_buffer;
+	PolyDatumBuffer cmp_buffer;
 } InternalCmpAggStore;
 
 inline static InternalCmpAggStore *
@@ -250,33 +261,102 @@ typedef struct InternalCmpAggStoreIOState
 	PolyDatumIOState cmp; /* the comparison element. e.g. time */
 } InternalCmpAggStoreIOState;
 
+/*
+ * Copy the input datum into the output PolyDatum. The by-reference values are
+ * copied into the buffer, which is reused for the subsequent values, so that we
+ * don't have to allocate memory for each new value. Must be called in the
+ * aggregate memory context.
+ */
 inline static void
-typeinfocache_polydatumcopy(TypeInfoCache *tic, PolyDatum input, PolyDatum *output)
+typeinfocache_polydatumcopy(TypeInfoCache *tic, PolyDatum input, PolyDatum *output,
+							PolyDatumBuffer *buffer)
 {
 	Assert(OidIsValid(tic->typoid));
 
-	if (!tic->typbyval && !output->is_null)
+	if (input.is_null)
+	{
+		output->datum = PointerGetDatum(NULL);
+		output->is_null = true;
+		return;
+	}
+
+	output->is_null = false;
+
+	if (tic->typbyval)
 	{
-		pfree(DatumGetPointer(output->datum));
+		output->datum = input.datum;
+		return;
 	}
 
-	*output = input;
+	const bool is_expanded =
+		tic->typlen == -1 && VARATT_IS_EXTERNAL_EXPANDED(DatumGetPointer(input.datum));
+	const Size size = is_expanded ? EOH_get_flat_size(DatumGetEOHP(input.datum)) :
+									datumGetSize(input.datum, tic->typbyval, tic->typlen);
+	if (size > buffer->size)
+	{
+		if (buffer->data != NULL)
+		{
+			pfree(buffer->data);
+		}
+		buffer->size = Max(size, 2 * buffer->size);
+		buffer->data = palloc(buffer->size);
+	}
 
-	if (!input.is_null)
+	if (is_expanded)
 	{
-		output->datum = datumCopy(input.datum, tic->typbyval, tic->typlen);
-		output->is_null = false;
+		EOH_flatten_into(DatumGetEOHP(input.datum), buffer->data, size);
 	}
 	else
 	{
-		output->datum = PointerGetDatum(NULL);
-		output->is_null = true;
+		memcpy(buffer->data, DatumGetPointer(input.datum), size);
+	}
+
+	output->datum = PointerGetDatum(buffer->data);
+}
+
+/*
+ * Determine whether the comparison procedure is one of the builtin ones that
+ * we can evaluate inline. The timestamps are int64 on all supported Postgres
+ * versions.
+ */
+static void
+cmpproc_set_kind(TransCache *cache)
+{
+	cache->cmp_kind = BOOKEND_CMP_GENERIC;
+	switch (cache->cmp_proc.fn_oid)
+	{
+		case F_INT2LT:
+		case F_INT2GT:
+			cache->cmp_kind = BOOKEND_CMP_INT16;
+			break;
+		case F_INT4LT:
+		case F_INT4GT:
+		case F_DATE_LT:
+		case F_DATE_GT:
+			cache->cmp_kind = BOOKEND_CMP_INT32;
+			break;
+		case F_INT8LT:
+		case F_INT8GT:
+		case F_TIMESTAMP_LT:
+		case F_TIMESTAMP_GT:
+		case F_TIMESTAMPTZ_LT:
+		case F_TIMESTAMPTZ_GT:
+			cache->cmp_kind = BOOKEND_CMP_INT64;
+			break;
+		case F_FLOAT8LT:
+		case F_FLOAT8GT:
+			cache->cmp_kind = BOOKEND_CMP_FLOAT8;
+			break;
+		default:
+			break;
 	}
 }
 
 inline static void
-cmpproc_init(FunctionCallInfo fcinfo, FmgrInfo *cmp_proc, Oid type_oid, char *opname)
+cmpproc_init(FunctionCallInfo fcinfo, TransCache *cache, char *opname)
 {
+	FmgrInfo *cmp_proc = &cache->cmp_proc;
+	const Oid type_oid = cache->cmp_type_cache.typoid;
 	Oid cmp_op, cmp_regproc;
 
 	if (!OidIsValid(type_oid))
@@ -292,14 +372,40 @@ cmpproc_init(FunctionCallInfo fcinfo, FmgrInfo *cmp_proc, Oid type_oid, char *op
 			 opname,
 			 type_oid);
 	fmgr_info_cxt(cmp_regproc, cmp_proc, fcinfo->flinfo->fn_mcxt);
+
+	cache->cmp_greater = strcmp(opname, ">") == 0;
+	cmpproc_set_kind(cache);
 }
 
+#define BOOKEND_CMP(cache, left, right)                                                            \
+	((cache)->cmp_greater ? (left) > (right) : (left) < (right))
+
 inline static bool
-cmpproc_cmp(FmgrInfo *cmp_proc, FunctionCallInfo fcinfo, PolyDatum left, PolyDatum right)
+cmpproc_cmp(TransCache *cache, FunctionCallInfo fcinfo, PolyDatum left, PolyDatum right)
 {
-	return DatumGetBool(FunctionCall2Coll(cmp_proc, fcinfo->fncollation, left.datum, right.datum));
+	switch (cache->cmp_kind)
+	{
+		case BOOKEND_CMP_INT16:
+			return BOOKEND_CMP(cache, DatumGetInt16(left.datum), DatumGetInt16(right.datum));
+		case BOOKEND_CMP_INT32:
+			return BOOKEND_CMP(cache, DatumGetInt32(left.datum), DatumGetInt32(right.datum));
+		case BOOKEND_CMP_INT64:
+			return BOOKEND_CMP(cache, DatumGetInt64(left.datum), DatumGetInt64(right.datum));
+		case BOOKEND_CMP_FLOAT8:
+			/* Use the Postgres functions for the correct NaN ordering. */
+			return cache->cmp_greater ?
+					   float8_gt(DatumGetFloat8(left.datum), DatumGetFloat8(right.datum)) :
+					   float8_lt(DatumGetFloat8(left.datum), DatumGetFloat8(right.datum));
+		case BOOKEND_CMP_GENERIC:
+			break;
+	}
+
+	return DatumGetBool(
+		FunctionCall2Coll(&cache->cmp_proc, fcinfo->fncollation, left.datum, right.datum));
 }
 
+#undef BOOKEND_CMP
+
 /*
  * bookend_sfunc - internal function called by ts_last_sfunc and ts_first_sfunc;
  */
@@ -327,8 +433,11 @@ bookend_sfunc(MemoryContext aggcontext, InternalCmpAggStore *state, char *opname
 		c->typoid = get_fn_expr_argtype(fcinfo->flinfo, 2);
 		get_typlenbyval(c->typoid, &c->typlen, &c->typbyval);
 
-		typeinfocache_polydatumcopy(&cache->value_type_cache, value, &state->value);
-		typeinfocache_polydatumcopy(&cache->cmp_type_cache, cmp, &state->cmp);
+		typeinfocache_polydatumcopy(&cache->value_type_cache,
+									value,
+									&state->value,
+									&state->value_buffer);
+		typeinfocache_polydatumcopy(&cache->cmp_type_cache, cmp, &state->cmp, &state->cmp_buffer);
 	}
 	else if (!cmp.is_null)
 	{
@@ -336,14 +445,20 @@ bookend_sfunc(MemoryContext aggcontext, InternalCmpAggStore *state, char *opname
 
 		if (cache->cmp_proc.fn_addr == NULL)
 		{
-			cmpproc_init(fcinfo, &cache->cmp_proc, cache->cmp_type_cache.typoid, opname);
+			cmpproc_init(fcinfo, cache, opname);
 		}
 
 		/* only do comparison if cmp is not NULL */
-		if (state->cmp.is_null || cmpproc_cmp(&cache->cmp_proc, fcinfo, cmp, state->cmp))
+		if (state->cmp.is_null || cmpproc_cmp(cache, fcinfo, cmp, state->cmp))
 		{
-			typeinfocache_polydatumcopy(&cache->value_type_cache, value, &state->value);
-			typeinfocache_polydatumcopy(&cache->cmp_type_cache, cmp, &state->cmp);
+			typeinfocache_polydatumcopy(&cache->value_type_cache,
+										value,
+										&state->value,
+										&state->value_buffer);
+			typeinfocache_polydatumcopy(&cache->cmp_type_cache,
+										cmp,
+										&state->cmp,
+										&state->cmp_buffer);
 		}
 	}
 	MemoryContextSwitchTo(old_context);
@@ -385,8 +500,14 @@ bookend_combinefunc(MemoryContext aggcontext, InternalCmpAggStore *state1,
 		cache1->value_type_cache = cache2->value_type_cache;
 		cache1->cmp_type_cache = cache2->cmp_type_cache;
 
-		typeinfocache_polydatumcopy(&cache1->value_type_cache, state2->value, &state1->value);
-		typeinfocache_polydatumcopy(&cache1->cmp_type_cache, state2->cmp, &state1->cmp);
+		typeinfocache_polydatumcopy(&cache1->value_type_cache,
+									state2->value,
+									&state1->value,
+									&state1->value_buffer);
+		typeinfocache_polydatumcopy(&cache1->cmp_type_cache,
+									state2->cmp,
+									&state1->cmp,
+									&state1->cmp_buffer);
 
 		MemoryContextSwitchTo(old_context);
 		PG_RETURN_POINTER(state1);
@@ -407,13 +528,19 @@ bookend_combinefunc(MemoryContext aggcontext, InternalCmpAggStore *state1,
 	TransCache *cache1 = &state1->aggstate_type_cache;
 	if (cache1->cmp_proc.fn_addr == NULL)
 	{
-		cmpproc_init(fcinfo, &cache1->cmp_proc, cache1->cmp_type_cache.typoid, opname);
+		cmpproc_init(fcinfo, cache1, opname);
 	}
-	if (cmpproc_cmp(&cache1->cmp_proc, fcinfo, state2->cmp, state1->cmp))
+	if (cmpproc_cmp(cache1, fcinfo, state2->cmp, state1->cmp))
 	{
 		old_context = MemoryContextSwitchTo(aggcontext);
-		typeinfocache_polydatumcopy(&cache1->value_type_cache, state2->value, &state1->value);
-		typeinfocache_polydatumcopy(&cache1->cmp_type_cache, state2->cmp, &state1->cmp);
+		typeinfocache_polydatumcopy(&cache1->value_type_cache,
+									state2->value,
+									&state1->value,
+									&state1->value_buffer);
+		typeinfocache_polydatumcopy(&cache1->cmp_type_cache,
+									state2->cmp,
+									&state1->cmp,
+									&state1->cmp_buffer);
 		MemoryContextSwitchTo(old_context);
 	}
 
@@ -490,42 +617,117 @@ ts_last_combinefunc(PG_FUNCTION_ARGS)
 	return bookend_combinefunc(aggcontext, state1, state2, ">", fcinfo);
 }
 
+/*
+ * The partial aggregation state is serialized as the qualified type names and
+ * the values in the datumSerialize() format, which avoids calling the send and
+ * receive functions of the types. The serialized state is only passed between
+ * the parallel workers and the leader, or between the partial and the final
+ * aggregation of the same query, and is not stored. The type names are kept
+ * as in the legacy format. The format starts with a zero byte and a version
+ * number, so that it can be told apart from the legacy format that starts
+ * with a nonempty schema name of the value type.
+ */
+#define BOOKEND_SERIALIZATION_VERSION 1
+
+static void
+polydatum_serialize(const PolyDatum *pd, const TypeInfoCache *tic, StringInfo buf)
+{
+	Size size;
+	char *start_address;
+
+	Assert(OidIsValid(tic->typoid));
+
+	polydatum_serialize_type(buf, tic->typoid);
+
+	size = datumEstimateSpace(pd->datum, pd->is_null, tic->typbyval, tic->typlen);
+	enlargeStringInfo(buf, size);
+	start_address = &buf->data[buf->len];
+	datumSerialize(pd->datum, pd->is_null, tic->typbyval, tic->typlen, &start_address);
+	buf->len += size;
+	buf->data[buf->len] = '\0';
+}
+
+/*
+ * Restore the PolyDatum serialized by polydatum_serialize(). The by-reference
+ * values are allocated in the current memory context.
+ */
+static void
+polydatum_deserialize(PolyDatum *result, StringInfo buf, TypeInfoCache *tic)
+{
+	Oid typoid = polydatum_deserialize_type(buf);
+	int header;
+	int datum_len;
+
+	if (tic->typoid != typoid)
+	{
+		Assert(!OidIsValid(tic->typoid));
+		tic->typoid = typoid;
+		get_typlenbyval(typoid, &tic->typlen, &tic->typbyval);
+	}
+
+	/*
+	 * The header of the serialized datum is its length, -1 for null, or -2
+	 * for a by-value datum. Check that the entire datum is in the buffer
+	 * before restoring it.
+	 */
+	if (buf->len - buf->cursor < (int) sizeof(int))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+				 errmsg("insufficient data left in message")));
+
+	memcpy(&header, &buf->data[buf->cursor], sizeof(int));
+	if (header == -1)
+		datum_len = 0;
+	else if (header == -2 && tic->typbyval)
+		datum_len = sizeof(Datum);
+	else if (header > 0 && !tic->typbyval)
+		datum_len = header;
+	else
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+				 errmsg("improper binary format in polydata")));
+
+	if (datum_len > buf->len - buf->cursor - (int) sizeof(int))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+				 errmsg("insufficient data left in message")));
+
+	char *start_address = &buf->data[buf->cursor];
+	result->datum = datumRestore(&start_address, &result->is_null);
+	buf->cursor = start_address - buf->data;
+	Assert(buf->cursor <= buf->len);
+}
+
+/*
+ * The deserialized by-reference values are allocated separately, so they can
+ * be used as the buffer for the subsequent values.
+ */
+static void
+polydatum_buffer_from_datum(const PolyDatum *pd, const TypeInfoCache *tic,
+							PolyDatumBuffer *buffer)
+{
+	if (pd->is_null || tic->typbyval)
+		return;
+
+	buffer->data = DatumGetPointer(pd->datum);
+	buffer->size = datumGetSize(pd->datum, tic->typbyval, tic->typlen);
+}
+
 /* ts_bookend_serializefunc(internal) => bytea */
 Datum
 ts_bookend_serializefunc(PG_FUNCTION_ARGS)
 {
 	StringInfoData buf;
-	InternalCmpAggStoreIOState *my_extra;
 	InternalCmpAggStore *state;
 
 	Assert(!PG_ARGISNULL(0));
 	state = (InternalCmpAggStore *) PG_GETARG_POINTER(0);
 
-	my_extra = (InternalCmpAggStoreIOState *) fcinfo->flinfo->fn_extra;
-	if (my_extra == NULL)
-	{
-		fcinfo->flinfo->fn_extra =
-			MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt, sizeof(InternalCmpAggStoreIOState));
-		my_extra = (InternalCmpAggStoreIOState *) fcinfo->flinfo->fn_extra;
-
-		Oid func;
-		bool is_varlena;
-
-		my_extra->value.type = state->aggstate_type_cache.value_type_cache;
-		Assert(OidIsValid(my_extra->value.type.typoid));
-
-		getTypeBinaryOutputInfo(my_extra->value.type.typoid, &func, &is_varlena);
-		fmgr_info_cxt(func, &my_extra->value.proc, fcinfo->flinfo->fn_mcxt);
-
-		my_extra->cmp.type = state->aggstate_type_cache.cmp_type_cache;
-		Assert(OidIsValid(my_extra->cmp.type.typoid));
-
-		getTypeBinaryOutputInfo(my_extra->cmp.type.typoid, &func, &is_varlena);
-		fmgr_info_cxt(func, &my_extra->cmp.proc, fcinfo->flinfo->fn_mcxt);
-	}
 	pq_begintypsend(&buf);
-	polydatum_serialize(&state->value, &buf, &my_extra->value, fcinfo);
-	polydatum_serialize(&state->cmp, &buf, &my_extra->cmp, fcinfo);
+	pq_sendbyte(&buf, 0);
+	pq_sendbyte(&buf, BOOKEND_SERIALIZATION_VERSION);
+	polydatum_serialize(&state->value, &state->aggstate_type_cache.value_type_cache, &buf);
+	polydatum_serialize(&state->cmp, &state->aggstate_type_cache.cmp_type_cache, &buf);
 	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
 }
 
@@ -560,12 +762,36 @@ ts_bookend_deserializefunc(PG_FUNCTION_ARGS)
 	}
 
 	result = MemoryContextAllocZero(aggcontext, sizeof(InternalCmpAggStore));
-	polydatum_deserialize(aggcontext, &result->value, &buf, &my_extra->value, fcinfo);
-	polydatum_deserialize(aggcontext, &result->cmp, &buf, &my_extra->cmp, fcinfo);
+
+	if (buf.len >= 2 && buf.data[0] == '\0')
+	{
+		MemoryContext old_context;
+		int version;
+
+		buf.cursor = 1;
+		version = pq_getmsgbyte(&buf);
+		if (version != BOOKEND_SERIALIZATION_VERSION)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+					 errmsg("unsupported bookend aggregate state version %d", version)));
+
+		old_context = MemoryContextSwitchTo(aggcontext);
+		polydatum_deserialize(&result->value, &buf, &my_extra->value.type);
+		polydatum_deserialize(&result->cmp, &buf, &my_extra->cmp.type);
+		MemoryContextSwitchTo(old_context);
+	}
+	else
+	{
+		polydatum_deserialize_legacy(aggcontext, &result->value, &buf, &my_extra->value, fcinfo);
+		polydatum_deserialize_legacy(aggcontext, &result->cmp, &buf, &my_extra->cmp, fcinfo);
+	}
 
 	result->aggstate_type_cache.value_type_cache = my_extra->value.type;
 	result->aggstate_type_cache.cmp_type_cache = my_extra->cmp.type;
 
+	polydatum_buffer_from_datum(&result->value, &my_extra->value.type, &result->value_buffer);
+	polydatum_buffer_from_datum(&result->cmp, &my_extra->cmp.type, &result->cmp_buffer);
+
 	PG_RETURN_POINTER(result);
 }
 
@@ -1153,23 +1153,15 @@ ts_bgw_job_function_call_string(BgwJob *job)
 	return stmt.data;
 }
 
-extern Datum
-ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
+/*
+ * Set up a background worker for running jobs.
+ *
+ * This connects to the database as the given user, so all jobs run by the
+ * worker need to be owned by that user.
+ */
+void
+ts_bgw_job_worker_init(Oid db_oid, Oid user_oid)
 {
-	Oid db_oid = DatumGetObjectId(MyBgworkerEntry->bgw_main_arg);
-	BgwParams params;
-	BgwJob *job;
-	JobResult volatile res = JOB_FAILURE_IN_EXECUTION;
-	bool got_lock;
-	instr_time start;
-	instr_time duration;
-
-	memcpy(&params, MyBgworkerEntry->bgw_extra, sizeof(BgwParams));
-	Ensure(OidIsValid(params.user_oid) && params.job_id != 0,
-		   "job id or user oid was zero - job_id: %d, user_oid: %d",
-		   params.job_id,
-		   params.user_oid);
-
 	BackgroundWorkerBlockSignals();
 	/* Setup any signal handlers here */
 
@@ -1190,13 +1182,32 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 		callbacks->toggle_allocation_blocking && !callbacks->enabled)
 		callbacks->toggle_allocation_blocking(/*enable=*/true);
 
-	BackgroundWorkerInitializeConnectionByOid(db_oid, params.user_oid, 0);
+	BackgroundWorkerInitializeConnectionByOid(db_oid, user_oid, 0);
 
 	log_min_messages = ts_guc_bgw_log_level;
 
-	elog(DEBUG2, "job %d started execution", params.job_id);
-
 	ts_license_enable_module_loading();
+}
+
+/*
+ * Run a single job in a background worker set up with
+ * ts_bgw_job_worker_init().
+ *
+ * Errors are re-thrown after the job end has been recorded, which terminates
+ * the worker.
+ */
+void
+ts_bgw_job_run(const BgwParams *bgw_params)
+{
+	BgwParams params = *bgw_params;
+	BgwJob *job;
+	JobResult volatile res = JOB_FAILURE_IN_EXECUTION;
+	bool got_lock;
+	LOCKTAG tag;
+	instr_time start;
+	instr_time duration;
+
+	elog(DEBUG2, "job %d started execution", params.job_id);
 
 	INSTR_TIME_SET_CURRENT(start);
 
@@ -1354,6 +1365,29 @@ ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
 		job = NULL;
 	}
 
+	/*
+	 * Release the session lock on the job. It would be released when the
+	 * worker exits, but pooled workers continue to run other jobs.
+	 */
+	TS_SET_LOCKTAG_ADVISORY(tag, MyDatabaseId, params.job_id, 0);
+	LockRelease(&tag, RowShareLock, true);
+}
+
+extern Datum
+ts_bgw_job_entrypoint(PG_FUNCTION_ARGS)
+{
+	Oid db_oid = DatumGetObjectId(MyBgworkerEntry->bgw_main_arg);
+	BgwParams params;
+
+	memcpy(&params, MyBgworkerEntry->bgw_extra, sizeof(BgwParams));
+	Ensure(OidIsValid(params.user_oid) && params.job_id != 0,
+		   "job id or user oid was zero - job_id: %d, user_oid: %d",
+		   params.job_id,
+		   params.user_oid);
+
+	ts_bgw_job_worker_init(db_oid, params.user_oid);
+	ts_bgw_job_run(&params);
+
 	PG_RETURN_VOID();
 }
 
@@ -11,6 +11,7 @@
 
 #include "export.h"
 #include "ts_catalog/catalog.h"
+#include "worker.h"
 
 #define TELEMETRY_INITIAL_NUM_RUNS 12
 #define SCHEDULER_APPNAME "TimescaleDB Background Worker Scheduler"
@@ -96,6 +97,8 @@ extern JobResult ts_bgw_job_execute(BgwJob *job);
 extern TSDLLEXPORT void ts_bgw_job_run_config_check(Oid check, int32 job_id, Jsonb *config);
 
 extern TSDLLEXPORT Datum ts_bgw_job_entrypoint(PG_FUNCTION_ARGS);
+extern void ts_bgw_job_worker_init(Oid db_oid, Oid user_oid);
+extern void ts_bgw_job_run(const BgwParams *bgw_params);
 extern void ts_bgw_job_set_scheduler_test_hook(scheduler_test_hook_type hook);
 extern void ts_bgw_job_set_job_entrypoint_function_name(char *func_name);
 extern TSDLLEXPORT bool ts_bgw_job_run_and_set_next_start(BgwJob *job, job_main_func func,
@@ -0,0 +1,240 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+/*
+ * Cost estimates for maintenance jobs.
+ *
+ * The scheduler uses these estimates to avoid running too many expensive
+ * jobs at the same time. The cost of a job is the estimated number of bytes
+ * of chunk data that it needs to process. The estimates use the parts of the
+ * job configuration that can be evaluated without running user code, and are
+ * upper bounds otherwise. They need to be cheap, so they never wait for locks.
+ *
+ * These functions need to be called in a transaction.
+ */
+#include <postgres.h>
+
+#include <access/htup_details.h>
+#include <access/relation.h>
+#include <catalog/pg_class.h>
+#include <storage/bufmgr.h>
+#include <storage/lmgr.h>
+#include <utils/fmgroids.h>
+#include <utils/rel.h>
+#include <utils/syscache.h>
+
+#include "chunk.h"
+#include "hypertable.h"
+#include "job.h"
+#include "job_cost.h"
+#include "jsonb_utils.h"
+#include "scan_iterator.h"
+#include "time_utils.h"
+#include "ts_catalog/catalog.h"
+#include "ts_catalog/continuous_agg.h"
+
+/*
+ * Get the size of the main fork of a relation. If the relation is locked by
+ * a concurrent operation, the size from the last vacuum or analyze is used
+ * instead of waiting for the lock.
+ */
+static int64
+relation_size_nowait(Oid relid)
+{
+	int64 size = 0;
+
+	if (ConditionalLockRelationOid(relid, AccessShareLock))
+	{
+		Relation rel = try_relation_open(relid, NoLock);
+
+		if (rel != NULL)
+		{
+			if (RELKIND_HAS_STORAGE(rel->rd_rel->relkind))
+				size = (int64) RelationGetNumberOfBlocks(rel) * BLCKSZ;
+			relation_close(rel, NoLock);
+		}
+
+		UnlockRelationOid(relid, AccessShareLock);
+	}
+	else
+	{
+		HeapTuple tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(relid));
+
+		if (HeapTupleIsValid(tuple))
+		{
+			Form_pg_class form = (Form_pg_class) GETSTRUCT(tuple);
+
+			size = (int64) Max(form->relpages, 0) * BLCKSZ;
+			ReleaseSysCache(tuple);
+		}
+	}
+
+	return size;
+}
+
+/*
+ * Sum the sizes of the chunks of a hypertable in a range of the primary
+ * dimension that were created before the given time. If only_uncompressed is
+ * set, only chunks that have data that is not compressed are included.
+ */
+static int64
+hypertable_chunks_size(Hypertable *ht, int64 start, int64 end, TimestampTz created_before,
+					   bool only_uncompressed)
+{
+	Chunk *chunks;
+	uint64 num_chunks = 0;
+	int64 size = 0;
+
+	if (ht == NULL || start >= end)
+		return 0;
+
+	chunks = ts_chunk_get_chunks_in_time_range(ht, end, start, &num_chunks);
+
+	for (uint64 i = 0; i < num_chunks; i++)
+	{
+		const Chunk *chunk = &chunks[i];
+
+		if (IS_OSM_CHUNK(chunk))
+			continue;
+
+		if (chunk->fd.creation_time >= created_before)
+			continue;
+
+		if (only_uncompressed && ts_chunk_is_compressed(chunk) && !ts_chunk_is_partial(chunk))
+			continue;
+
+		size += relation_size_nowait(chunk->table_id);
+	}
+
+	return size;
+}
+
+/*
+ * Estimate the cost of a compression policy as the size of the chunks that
+ * are not yet fully compressed and that the policy would pick, that is the
+ * chunks older than "compress_after" or created before
+ * "compress_created_before".
+ *
+ * The integer now function of an integer dimension is user code that we
+ * don't want to run in the scheduler, so "compress_after" is ignored for
+ * these hypertables and all chunks are counted.
+ */
+int64
+ts_bgw_job_estimate_compression_cost(int32 job_id)
+{
+	BgwJob *job = ts_bgw_job_find(job_id, CurrentMemoryContext, false);
+	Hypertable *ht;
+	const Dimension *dim;
+	int64 end = PG_INT64_MAX;
+	TimestampTz created_before = DT_NOEND;
+
+	if (job == NULL || job->fd.config == NULL)
+		return 0;
+
+	ht = ts_hypertable_get_by_id(job->fd.hypertable_id);
+	if (ht == NULL)
+		return 0;
+
+	dim = hyperspace_get_open_dimension(ht->space, 0);
+
+	if (ts_jsonb_get_str_field(job->fd.config, "compress_after") != NULL)
+	{
+		Oid partitioning_type = dim != NULL ? ts_dimension_get_partition_type(dim) : InvalidOid;
+
+		if (IS_UUID_TYPE(partitioning_type))
+			partitioning_type = TIMESTAMPTZOID;
+
+		if (IS_TIMESTAMP_TYPE(partitioning_type))
+		{
+			Interval *lag = ts_jsonb_get_interval_field(job->fd.config, "compress_after");
+
+			if (lag != NULL)
+			{
+				Datum boundary = ts_subtract_interval_from_now(lag, partitioning_type);
+				end = ts_time_value_to_internal(boundary, partitioning_type);
+			}
+		}
+	}
+	else
+	{
+		Interval *lag = ts_jsonb_get_interval_field(job->fd.config, "compress_created_before");
+
+		if (lag != NULL)
+			created_before =
+				DatumGetTimestampTz(ts_subtract_interval_from_now(lag, TIMESTAMPTZOID));
+	}
+
+	return hypertable_chunks_size(ht, PG_INT64_MIN, end, created_before, true);
+}
+
+/*
+ * Extend the range with the invalidations for the given id in one of the
+ * invalidation logs. Both logs have the same layout: the id followed by the
+ * lowest and greatest modified values, with an index on the id and the
+ * lowest modified value.
+ */
+static void
+invalidation_log_range(CatalogTable table, int index, int32 id, int64 *start, int64 *end)
+{
+	ScanIterator iterator = ts_scan_iterator_create(table, AccessShareLock, CurrentMemoryContext);
+
+	iterator.ctx.index = catalog_get_index(ts_catalog_get(), table, index);
+	ts_scan_iterator_scan_key_init(&iterator,
+								   Anum_continuous_aggs_hypertable_invalidation_log_idx_hypertable_id,
+								   BTEqualStrategyNumber,
+								   F_INT4EQ,
+								   Int32GetDatum(id));
+
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		bool should_free;
+		HeapTuple tuple = ts_scanner_fetch_heap_tuple(ti, false, &should_free);
+		Form_continuous_aggs_hypertable_invalidation_log form =
+			(Form_continuous_aggs_hypertable_invalidation_log) GETSTRUCT(tuple);
+
+		*start = Min(*start, form->lowest_modified_value);
+		*end = Max(*end, form->greatest_modified_value);
+
+		if (should_free)
+			heap_freetuple(tuple);
+	}
+}
+
+/*
+ * Estimate the cost of a continuous aggregate refresh as the size of the
+ * chunks of the source hypertable that overlap the invalidated range.
+ */
+int64
+ts_bgw_job_estimate_refresh_cost(int32 mat_hypertable_id)
+{
+	ContinuousAgg *cagg = ts_continuous_agg_find_by_mat_hypertable_id(mat_hypertable_id, true);
+	int64 start = PG_INT64_MAX;
+	int64 end = PG_INT64_MIN;
+
+	if (cagg == NULL)
+		return 0;
+
+	invalidation_log_range(CONTINUOUS_AGGS_HYPERTABLE_INVALIDATION_LOG,
+						   CONTINUOUS_AGGS_HYPERTABLE_INVALIDATION_LOG_IDX,
+						   cagg->data.raw_hypertable_id,
+						   &start,
+						   &end);
+	invalidation_log_range(CONTINUOUS_AGGS_MATERIALIZATION_INVALIDATION_LOG,
+						   CONTINUOUS_AGGS_MATERIALIZATION_INVALIDATION_LOG_IDX,
+						   mat_hypertable_id,
+						   &start,
+						   &end);
+
+	/* The greatest modified value is inclusive */
+	if (end < PG_INT64_MAX)
+		end++;
+
+	return hypertable_chunks_size(ts_hypertable_get_by_id(cagg->data.raw_hypertable_id),
+								  start,
+								  end,
+								  DT_NOEND,
+								  false);
+}
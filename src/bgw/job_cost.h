@@ -0,0 +1,11 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#pragma once
+
+#include <postgres.h>
+
+extern int64 ts_bgw_job_estimate_compression_cost(int32 job_id);
+extern int64 ts_bgw_job_estimate_refresh_cost(int32 mat_hypertable_id);
@@ -0,0 +1,704 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+/*
+ * Pool of long-lived job workers.
+ *
+ * Starting a new background worker for every job run means connecting to
+ * the database and loading the catalog caches each time, which dominates the
+ * run time of short jobs. Pooled workers instead wait for jobs to be handed
+ * to them by the scheduler and run them back to back.
+ *
+ * The scheduler creates a dynamic shared memory segment with one slot per
+ * pooled worker. Each worker is bound to a slot and to the user it connected
+ * as, so it only runs jobs owned by that user. A job is handed over by
+ * filling in the slot and setting the latch of the worker, and the worker
+ * sets the latch of the scheduler when the job has finished.
+ *
+ * Each pooled worker holds a worker reservation for as long as it runs.
+ * Workers exit when they have been idle for
+ * timescaledb.bgw_job_pool_idle_timeout, after running
+ * timescaledb.bgw_job_pool_max_jobs jobs, or when their memory usage has
+ * grown by more than timescaledb.bgw_job_pool_max_memory. Idle workers are
+ * also asked to exit when the scheduler runs out of worker reservations for
+ * other jobs.
+ *
+ * The session state is reset after every job, the same way as DISCARD ALL
+ * does, so settings changed by one job do not leak into the next
+ * one. Errors in a job terminate the worker, so a failed job never leaves
+ * state behind for the next job.
+ */
+#include <postgres.h>
+
+#include <access/xact.h>
+#include <commands/discard.h>
+#include <miscadmin.h>
+#include <nodes/parsenodes.h>
+#include <pgstat.h>
+#include <postmaster/bgworker.h>
+#include <storage/dsm.h>
+#include <storage/latch.h>
+#include <storage/spin.h>
+#include <utils/memutils.h>
+
+#include "compat/compat.h"
+#include "debug_assert.h"
+#include "guc.h"
+#include "job_pool.h"
+#include "launcher_interface.h"
+#include "scheduler.h"
+
+/*
+ * Interval at which the scheduler checks if pooled jobs have finished when
+ * waiting for them in tests.
+ */
+#define JOB_POOL_WAIT_INTERVAL_MS 10L
+
+typedef enum JobPoolSlotState
+{
+	/* No worker */
+	JOB_POOL_SLOT_FREE = 0,
+	/* Worker is waiting for a job */
+	JOB_POOL_SLOT_IDLE,
+	/* The scheduler is about to hand a job to the worker */
+	JOB_POOL_SLOT_RESERVED,
+	/* A job has been handed to the worker but it has not picked it up yet */
+	JOB_POOL_SLOT_ASSIGNED,
+	/* Worker is running the job */
+	JOB_POOL_SLOT_RUNNING,
+	/* Worker is exiting and will not take any more jobs */
+	JOB_POOL_SLOT_EXITING,
+} JobPoolSlotState;
+
+typedef struct JobPoolSlot
+{
+	slock_t mutex; /* protects all fields below */
+	JobPoolSlotState state;
+	Oid user_oid;
+	pid_t pid; /* zero until the worker has attached */
+	Latch *latch;
+	bool exit_requested;
+	int32 job_id;
+	int64 job_history_id;
+	TimestampTz job_history_execution_start;
+	int64 jobs_run;
+} JobPoolSlot;
+
+typedef struct JobPool
+{
+	Latch *scheduler_latch;
+	int num_slots;
+	JobPoolSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} JobPool;
+
+/*
+ * Scheduler-local state. The handles are owned by the pool and shared with
+ * the scheduled jobs running on them. A slot is busy while a scheduled job
+ * refers to it, and is not reaped until the job has released it.
+ */
+static MemoryContext pool_mctx = NULL;
+static dsm_segment *pool_segment = NULL;
+static JobPool *pool = NULL;
+static BackgroundWorkerHandle **pool_handles = NULL;
+static bool *pool_slot_busy = NULL;
+
+/* Function that pooled workers run, can be changed for tests */
+static char *pool_entrypoint_function_name = "ts_bgw_job_pool_entrypoint";
+
+void
+ts_bgw_job_pool_init(MemoryContext mctx)
+{
+	if (pool_segment != NULL)
+		dsm_detach(pool_segment);
+
+	pool_mctx = mctx;
+	pool_segment = NULL;
+	pool = NULL;
+	pool_handles = NULL;
+	pool_slot_busy = NULL;
+}
+
+/*
+ * Create the pool on first use. The size is fixed for the lifetime of the
+ * scheduler.
+ */
+static bool
+job_pool_create(void)
+{
+	int num_slots = ts_guc_bgw_job_pool_size;
+	Size size;
+
+	if (pool != NULL)
+		return true;
+
+	if (num_slots <= 0)
+		return false;
+
+	size = add_size(offsetof(JobPool, slots), mul_size(num_slots, sizeof(JobPoolSlot)));
+	pool_segment = dsm_create(size, 0);
+	dsm_pin_mapping(pool_segment);
+	pool = dsm_segment_address(pool_segment);
+	pool->scheduler_latch = MyLatch;
+	pool->num_slots = num_slots;
+
+	for (int i = 0; i < num_slots; i++)
+	{
+		JobPoolSlot *slot = &pool->slots[i];
+
+		SpinLockInit(&slot->mutex);
+		slot->state = JOB_POOL_SLOT_FREE;
+		slot->user_oid = InvalidOid;
+		slot->pid = 0;
+		slot->latch = NULL;
+		slot->exit_requested = false;
+		slot->job_id = 0;
+		slot->jobs_run = 0;
+	}
+
+	pool_handles = MemoryContextAllocZero(pool_mctx, num_slots * sizeof(BackgroundWorkerHandle *));
+	pool_slot_busy = MemoryContextAllocZero(pool_mctx, num_slots * sizeof(bool));
+
+	elog(DEBUG1, "created job pool with %d slots", num_slots);
+
+	return true;
+}
+
+/*
+ * Reserve an idle pooled worker connected as the given user.
+ *
+ * Returns the slot of the worker, or -1 if there is no such worker.
+ */
+int
+ts_bgw_job_pool_reserve_idle(Oid user_oid)
+{
+	if (pool == NULL)
+		return -1;
+
+	for (int i = 0; i < pool->num_slots; i++)
+	{
+		JobPoolSlot *slot = &pool->slots[i];
+		bool reserved = false;
+
+		if (pool_slot_busy[i])
+			continue;
+
+		SpinLockAcquire(&slot->mutex);
+		if (slot->state == JOB_POOL_SLOT_IDLE && slot->user_oid == user_oid &&
+			!slot->exit_requested)
+		{
+			slot->state = JOB_POOL_SLOT_RESERVED;
+			reserved = true;
+		}
+		SpinLockRelease(&slot->mutex);
+
+		if (reserved)
+		{
+			pool_slot_busy[i] = true;
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void
+job_pool_slot_set_job(JobPoolSlot *slot, BgwJob *job)
+{
+	slot->job_id = job->fd.id;
+	slot->job_history_id = job->job_history.id;
+	slot->job_history_execution_start = job->job_history.execution_start;
+	slot->state = JOB_POOL_SLOT_ASSIGNED;
+}
+
+/*
+ * Hand a job to a pooled worker.
+ *
+ * If slotno refers to a slot reserved with ts_bgw_job_pool_reserve_idle(),
+ * the job is handed to the worker in that slot. Otherwise, a new pooled
+ * worker is started in a free slot, which takes over the worker reservation
+ * of the caller.
+ *
+ * Returns the handle of the pooled worker, or NULL if the pool is disabled,
+ * full, or the worker could not be started.
+ */
+BackgroundWorkerHandle *
+ts_bgw_job_pool_start_job(BgwJob *job, Oid user_oid, int *slotno)
+{
+	BackgroundWorkerHandle *handle;
+	BgwParams params = {
+		.user_oid = user_oid,
+	};
+	JobPoolSlot *slot;
+	Latch *latch;
+	int free_slot = -1;
+
+	if (*slotno >= 0)
+	{
+		Assert(pool != NULL && pool_slot_busy[*slotno]);
+		slot = &pool->slots[*slotno];
+
+		SpinLockAcquire(&slot->mutex);
+		Assert(slot->state == JOB_POOL_SLOT_RESERVED);
+		job_pool_slot_set_job(slot, job);
+		latch = slot->latch;
+		SpinLockRelease(&slot->mutex);
+
+		SetLatch(latch);
+		elog(DEBUG1, "handed job %d to pooled worker in slot %d", job->fd.id, *slotno);
+
+		return pool_handles[*slotno];
+	}
+
+	if (!job_pool_create())
+		return NULL;
+
+	for (int i = 0; i < pool->num_slots; i++)
+	{
+		if (pool_handles[i] == NULL)
+		{
+			free_slot = i;
+			break;
+		}
+	}
+
+	if (free_slot < 0)
+		return NULL;
+
+	slot = &pool->slots[free_slot];
+	SpinLockAcquire(&slot->mutex);
+	slot->user_oid = user_oid;
+	slot->pid = 0;
+	slot->latch = NULL;
+	slot->exit_requested = false;
+	slot->jobs_run = 0;
+	job_pool_slot_set_job(slot, job);
+	SpinLockRelease(&slot->mutex);
+
+	params.pool_segment = dsm_segment_handle(pool_segment);
+	params.pool_slot = free_slot;
+	strlcpy(params.bgw_main, pool_entrypoint_function_name, sizeof(params.bgw_main));
+
+	handle = ts_bgw_start_worker(JOB_POOL_APPNAME, &params);
+	if (handle == NULL)
+	{
+		SpinLockAcquire(&slot->mutex);
+		slot->state = JOB_POOL_SLOT_FREE;
+		SpinLockRelease(&slot->mutex);
+		return NULL;
+	}
+
+	pool_handles[free_slot] = handle;
+	pool_slot_busy[free_slot] = true;
+	*slotno = free_slot;
+
+	elog(DEBUG1, "started pooled worker in slot %d for job %d", free_slot, job->fd.id);
+
+	return handle;
+}
+
+/*
+ * Check if the pooled worker in the slot has finished running the job.
+ */
+bool
+ts_bgw_job_pool_job_done(int slotno, int32 job_id)
+{
+	JobPoolSlot *slot;
+	bool done;
+
+	Assert(pool != NULL && slotno >= 0 && slotno < pool->num_slots);
+	slot = &pool->slots[slotno];
+
+	SpinLockAcquire(&slot->mutex);
+	done = slot->job_id != job_id ||
+		   (slot->state != JOB_POOL_SLOT_ASSIGNED && slot->state != JOB_POOL_SLOT_RUNNING);
+	SpinLockRelease(&slot->mutex);
+
+	return done;
+}
+
+/*
+ * Release a slot used by a scheduled job, making it available for other jobs
+ * or for reaping if the worker has stopped.
+ */
+void
+ts_bgw_job_pool_release(int slotno)
+{
+	JobPoolSlot *slot;
+
+	Assert(pool != NULL && slotno >= 0 && slotno < pool->num_slots);
+	slot = &pool->slots[slotno];
+
+	/* The job might never have been handed over */
+	SpinLockAcquire(&slot->mutex);
+	if (slot->state == JOB_POOL_SLOT_RESERVED)
+		slot->state = JOB_POOL_SLOT_IDLE;
+	SpinLockRelease(&slot->mutex);
+
+	pool_slot_busy[slotno] = false;
+}
+
+/*
+ * Free the slots of pooled workers that have stopped and release their
+ * worker reservations.
+ */
+void
+ts_bgw_job_pool_reap(void)
+{
+	if (pool == NULL)
+		return;
+
+	for (int i = 0; i < pool->num_slots; i++)
+	{
+		JobPoolSlot *slot = &pool->slots[i];
+		int64 jobs_run;
+		pid_t pid;
+
+		if (pool_handles[i] == NULL || pool_slot_busy[i])
+			continue;
+
+		if (GetBackgroundWorkerPid(pool_handles[i], &pid) != BGWH_STOPPED)
+			continue;
+
+		pfree(pool_handles[i]);
+		pool_handles[i] = NULL;
+		ts_bgw_worker_release();
+
+		SpinLockAcquire(&slot->mutex);
+		jobs_run = slot->jobs_run;
+		slot->state = JOB_POOL_SLOT_FREE;
+		slot->pid = 0;
+		slot->latch = NULL;
+		SpinLockRelease(&slot->mutex);
+
+		elog(DEBUG1, "pooled worker in slot %d exited after " INT64_FORMAT " jobs", i, jobs_run);
+	}
+}
+
+/*
+ * Ask the idle pooled workers to exit so that their worker reservations are
+ * released for other jobs. The reservations are released when the workers
+ * have exited and are reaped.
+ *
+ * Returns the number of workers asked to exit.
+ */
+int
+ts_bgw_job_pool_release_idle(void)
+{
+	int released = 0;
+
+	if (pool == NULL)
+		return 0;
+
+	for (int i = 0; i < pool->num_slots; i++)
+	{
+		JobPoolSlot *slot = &pool->slots[i];
+		Latch *latch = NULL;
+
+		if (pool_handles[i] == NULL || pool_slot_busy[i])
+			continue;
+
+		SpinLockAcquire(&slot->mutex);
+		if (slot->state == JOB_POOL_SLOT_IDLE && !slot->exit_requested)
+		{
+			slot->exit_requested = true;
+			latch = slot->latch;
+		}
+		SpinLockRelease(&slot->mutex);
+
+		if (latch != NULL)
+		{
+			SetLatch(latch);
+			released++;
+		}
+	}
+
+	if (released > 0)
+		elog(DEBUG1, "asked %d idle pooled workers to exit", released);
+
+	return released;
+}
+
+/*
+ * Wait until no pooled worker is running a job. Only used by the mock timer
+ * in tests to make the job runs deterministic.
+ */
+void
+ts_bgw_job_pool_wait_for_jobs(void)
+{
+	if (pool == NULL)
+		return;
+
+	for (;;)
+	{
+		bool running = false;
+
+		for (int i = 0; i < pool->num_slots && !running; i++)
+		{
+			JobPoolSlot *slot = &pool->slots[i];
+
+			if (pool_handles[i] == NULL)
+				continue;
+
+			SpinLockAcquire(&slot->mutex);
+			running = slot->state == JOB_POOL_SLOT_ASSIGNED || slot->state == JOB_POOL_SLOT_RUNNING;
+			SpinLockRelease(&slot->mutex);
+		}
+
+		if (!running)
+			return;
+
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 JOB_POOL_WAIT_INTERVAL_MS,
+						 PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+		CHECK_FOR_INTERRUPTS();
+	}
+}
+
+void
+ts_bgw_job_pool_set_entrypoint_function_name(char *func_name)
+{
+	pool_entrypoint_function_name = func_name;
+}
+
+/*
+ * Ask all pooled workers to exit once they have finished their current job.
+ */
+void
+ts_bgw_job_pool_request_shutdown(void)
+{
+	if (pool == NULL)
+		return;
+
+	for (int i = 0; i < pool->num_slots; i++)
+	{
+		JobPoolSlot *slot = &pool->slots[i];
+		Latch *latch;
+
+		if (pool_handles[i] == NULL)
+			continue;
+
+		SpinLockAcquire(&slot->mutex);
+		slot->exit_requested = true;
+		latch = slot->latch;
+		SpinLockRelease(&slot->mutex);
+
+		if (latch != NULL)
+			SetLatch(latch);
+	}
+}
+
+/*
+ * Wait for all pooled workers to exit and release their reservations.
+ */
+void
+ts_bgw_job_pool_shutdown(void)
+{
+	if (pool == NULL)
+		return;
+
+	ts_bgw_job_pool_request_shutdown();
+
+	for (int i = 0; i < pool->num_slots; i++)
+	{
+		if (pool_handles[i] != NULL)
+			WaitForBackgroundWorkerShutdown(pool_handles[i]);
+	}
+
+	ts_bgw_job_pool_reap();
+}
+
+/*
+ * Terminate all pooled workers. Only used on scheduler exit, so it must not
+ * access the database.
+ */
+void
+ts_bgw_job_pool_terminate_all(void)
+{
+	if (pool == NULL)
+		return;
+
+	for (int i = 0; i < pool->num_slots; i++)
+	{
+		if (pool_handles[i] == NULL)
+			continue;
+
+		TerminateBackgroundWorker(pool_handles[i]);
+		ts_bgw_worker_release();
+		pool_handles[i] = NULL;
+	}
+}
+
+static bool
+job_pool_worker_should_recycle(int64 jobs_run, Size start_memory)
+{
+	Size memory;
+
+	if (jobs_run >= ts_guc_bgw_job_pool_max_jobs)
+		return true;
+
+	if (ts_guc_bgw_job_pool_max_memory == 0)
+		return false;
+
+	memory = MemoryContextMemAllocated(TopMemoryContext, true);
+	return memory > start_memory &&
+		   (memory - start_memory) / 1024 > (Size) ts_guc_bgw_job_pool_max_memory;
+}
+
+/*
+ * Reset the session state left behind by a job, like DISCARD ALL does. This
+ * resets all settings changed in the session, e.g., work_mem set by a policy
+ * or the parallel worker settings changed by ts_bgw_job_run(), restores the
+ * session user, and releases advisory locks, prepared statements, and
+ * temporary tables.
+ */
+static void
+job_pool_worker_reset_session(Oid user_oid)
+{
+	DiscardStmt stmt = {
+		.type = T_DiscardStmt,
+		.target = DISCARD_ALL,
+	};
+
+	StartTransactionCommand();
+	SetUserIdAndSecContext(user_oid, 0);
+	DiscardCommand(&stmt, true);
+	CommitTransactionCommand();
+
+	Ensure(GetUserId() == user_oid && GetSessionUserId() == user_oid,
+		   "unexpected user %u after resetting pooled job worker for user %u",
+		   GetUserId(),
+		   user_oid);
+
+	/* Not a GUC setting, so it is not reset by DISCARD ALL */
+	log_min_messages = ts_guc_bgw_log_level;
+}
+
+TS_FUNCTION_INFO_V1(ts_bgw_job_pool_entrypoint);
+
+/*
+ * Main function of a pooled job worker.
+ */
+Datum
+ts_bgw_job_pool_entrypoint(PG_FUNCTION_ARGS)
+{
+	Oid db_oid = DatumGetObjectId(MyBgworkerEntry->bgw_main_arg);
+	BgwParams params;
+	dsm_segment *seg;
+	JobPool *shared_pool;
+	JobPoolSlot *slot;
+	Size start_memory;
+	int64 jobs_run = 0;
+	bool idle_timed_out = false;
+	bool attached = false;
+
+	memcpy(&params, MyBgworkerEntry->bgw_extra, sizeof(BgwParams));
+	Ensure(OidIsValid(params.user_oid) && params.pool_slot >= 0,
+		   "invalid job pool worker parameters - pool_slot: %d, user_oid: %d",
+		   params.pool_slot,
+		   params.user_oid);
+
+	ts_bgw_job_worker_init(db_oid, params.user_oid);
+
+	seg = dsm_attach(params.pool_segment);
+	if (seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map job pool shared memory segment")));
+
+	shared_pool = dsm_segment_address(seg);
+	Ensure(params.pool_slot < shared_pool->num_slots,
+		   "job pool slot %d out of range",
+		   params.pool_slot);
+	slot = &shared_pool->slots[params.pool_slot];
+
+	SpinLockAcquire(&slot->mutex);
+	if (slot->pid == 0 && slot->user_oid == params.user_oid)
+	{
+		slot->pid = MyProcPid;
+		slot->latch = MyLatch;
+		attached = true;
+	}
+	SpinLockRelease(&slot->mutex);
+
+	if (!attached)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("job pool slot %d is already in use", params.pool_slot)));
+
+	pgstat_report_appname(JOB_POOL_APPNAME);
+	start_memory = MemoryContextMemAllocated(TopMemoryContext, true);
+
+	for (;;)
+	{
+		BgwParams job_params = {
+			.user_oid = params.user_oid,
+		};
+		bool have_job = false;
+		bool exit_worker = false;
+
+		SpinLockAcquire(&slot->mutex);
+		if (slot->state == JOB_POOL_SLOT_ASSIGNED)
+		{
+			job_params.job_id = slot->job_id;
+			job_params.job_history_id = slot->job_history_id;
+			job_params.job_history_execution_start = slot->job_history_execution_start;
+			slot->state = JOB_POOL_SLOT_RUNNING;
+			have_job = true;
+		}
+		else if (slot->state == JOB_POOL_SLOT_IDLE && (slot->exit_requested || idle_timed_out))
+		{
+			slot->state = JOB_POOL_SLOT_EXITING;
+			exit_worker = true;
+		}
+		SpinLockRelease(&slot->mutex);
+
+		if (exit_worker)
+			break;
+
+		if (!have_job)
+		{
+			int rc = WaitLatch(MyLatch,
+							   WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+							   ts_guc_bgw_job_pool_idle_timeout,
+							   PG_WAIT_EXTENSION);
+
+			ResetLatch(MyLatch);
+			CHECK_FOR_INTERRUPTS();
+			idle_timed_out = (rc & WL_TIMEOUT) != 0;
+			continue;
+		}
+
+		idle_timed_out = false;
+
+		/* An error in the job terminates the worker */
+		ts_bgw_job_run(&job_params);
+		jobs_run++;
+
+		job_pool_worker_reset_session(params.user_oid);
+		pgstat_report_appname(JOB_POOL_APPNAME);
+		exit_worker = job_pool_worker_should_recycle(jobs_run, start_memory);
+
+		SpinLockAcquire(&slot->mutex);
+		slot->state = exit_worker ? JOB_POOL_SLOT_EXITING : JOB_POOL_SLOT_IDLE;
+		slot->jobs_run = jobs_run;
+		SpinLockRelease(&slot->mutex);
+
+		SetLatch(shared_pool->scheduler_latch);
+
+		if (exit_worker)
+		{
+			elog(DEBUG1, "recycling pooled job worker after " INT64_FORMAT " jobs", jobs_run);
+			break;
+		}
+	}
+
+	/* Let the scheduler reap the worker and release its reservation */
+	SetLatch(shared_pool->scheduler_latch);
+	dsm_detach(seg);
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,32 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#pragma once
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <postmaster/bgworker.h>
+
+#include "export.h"
+#include "job.h"
+
+#define JOB_POOL_APPNAME "TimescaleDB Job Pool Worker"
+
+/* Scheduler side */
+extern void ts_bgw_job_pool_init(MemoryContext mctx);
+extern int ts_bgw_job_pool_reserve_idle(Oid user_oid);
+extern BackgroundWorkerHandle *ts_bgw_job_pool_start_job(BgwJob *job, Oid user_oid, int *slotno);
+extern bool ts_bgw_job_pool_job_done(int slotno, int32 job_id);
+extern void ts_bgw_job_pool_release(int slotno);
+extern void ts_bgw_job_pool_reap(void);
+extern int ts_bgw_job_pool_release_idle(void);
+extern void ts_bgw_job_pool_wait_for_jobs(void);
+extern void ts_bgw_job_pool_set_entrypoint_function_name(char *func_name);
+extern void ts_bgw_job_pool_request_shutdown(void);
+extern void ts_bgw_job_pool_shutdown(void);
+extern void ts_bgw_job_pool_terminate_all(void);
+
+/* Worker side */
+extern TSDLLEXPORT Datum ts_bgw_job_pool_entrypoint(PG_FUNCTION_ARGS);
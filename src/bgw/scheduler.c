@@ -12,7 +12,9 @@
  */
 #include <postgres.h>
 
+#include <access/htup_details.h>
 #include <access/xact.h>
+#include <funcapi.h>
 #include <miscadmin.h>
 #include <nodes/pg_list.h>
 #include <pgstat.h>
@@ -21,6 +23,7 @@
 #include <storage/latch.h>
 #include <storage/lwlock.h>
 #include <storage/proc.h>
+#include <storage/procarray.h>
 #include <storage/shmem.h>
 #include <tcop/tcopprot.h>
 #include <utils/acl.h>
@@ -31,11 +34,16 @@
 #include <utils/timestamp.h>
 
 #include "compat/compat.h"
+#include "debug_assert.h"
 #include "extension.h"
+#include "extension_constants.h"
 #include "guc.h"
 #include "job.h"
+#include "job_cost.h"
+#include "job_pool.h"
 #include "job_stat.h"
 #include "launcher_interface.h"
+#include "loader/scheduler_stats.h"
 #include "scheduler.h"
 #include "timer.h"
 #include "version.h"
@@ -51,6 +59,7 @@ least_timestamp(TimestampTz left, TimestampTz right)
 }
 
 TS_FUNCTION_INFO_V1(ts_bgw_scheduler_main);
+TS_FUNCTION_INFO_V1(ts_bgw_scheduler_stats);
 
 /*
  * Global so the invalidate cache message can set. Don't need to protect
@@ -107,8 +116,120 @@ typedef struct ScheduledBgwJob
 	 */
 	bool may_need_mark_end;
 	int32 consecutive_failed_launches;
+
+	/*
+	 * Slot in the job pool if the job runs on a pooled worker, otherwise
+	 * -1. The handle of a pooled worker is owned by the pool.
+	 */
+	int pool_slot;
+
+	/*
+	 * Position of the job in the start queue and running queue,
+	 * respectively, or -1 if the job is not in the queue.
+	 */
+	int start_queue_pos;
+	int running_queue_pos;
+
+	/* Tie-breaker between jobs that are due at the same time. Lower is first. */
+	int priority;
+
+	/* Admission control state, see job_admit() */
+	bool admitted;
+	int admitted_priority;
+	int64 admitted_cost;
+	int64 estimated_cost;
+	TimestampTz cost_estimated_at;
 } ScheduledBgwJob;
 
+/*
+ * Priorities for jobs that are due at the same time. Continuous aggregate
+ * refreshes are user-visible, so they go first. Retention frees space and is
+ * cheap, so it goes before the more expensive compression, reorder and merge
+ * chunks policies. User-defined and all other jobs go last.
+ */
+typedef enum JobPriority
+{
+	JOB_PRIORITY_REFRESH = 0,
+	JOB_PRIORITY_RETENTION,
+	JOB_PRIORITY_COMPRESSION,
+	JOB_PRIORITY_REORDER,
+	JOB_PRIORITY_DEFAULT,
+} JobPriority;
+
+/*
+ * Indexed binary min-heap of jobs.
+ *
+ * Each job stores its position in the heap (at pos_offset) so that it can be
+ * removed in O(log n) when it changes state, without searching for it.
+ */
+typedef struct JobQueue
+{
+	ScheduledBgwJob **jobs;
+	int num_jobs;
+	int capacity;
+	size_t pos_offset;
+	int (*cmp)(const ScheduledBgwJob *left, const ScheduledBgwJob *right);
+} JobQueue;
+
+static int cmp_start_queue(const ScheduledBgwJob *left, const ScheduledBgwJob *right);
+static int cmp_running_queue(const ScheduledBgwJob *left, const ScheduledBgwJob *right);
+
+/* Jobs in JOB_STATE_SCHEDULED ordered by next_start */
+static JobQueue start_queue = {
+	.pos_offset = offsetof(ScheduledBgwJob, start_queue_pos),
+	.cmp = cmp_start_queue,
+};
+
+/* Jobs in JOB_STATE_STARTED or JOB_STATE_TERMINATING ordered by timeout */
+static JobQueue running_queue = {
+	.pos_offset = offsetof(ScheduledBgwJob, running_queue_pos),
+	.cmp = cmp_running_queue,
+};
+
+/*
+ * Statistics about the latency of the scheduler main loop. "Work" is the time
+ * spent in a loop iteration excluding the wait for the next wakeup, and "lag"
+ * is how much later than planned the scheduler woke up.
+ */
+typedef struct SchedulerLoopStats
+{
+	int64 iterations;
+	int64 jobs_started;
+	int64 total_work_us;
+	int64 max_work_us;
+	int64 total_lag_us;
+	int64 max_lag_us;
+	/* The planned time of the next wakeup */
+	TimestampTz next_wakeup;
+} SchedulerLoopStats;
+
+static SchedulerLoopStats loop_stats;
+
+/*
+ * The slot of this scheduler in the shared statistics that are shown by the
+ * timescaledb_information.job_scheduler_stats view. NULL if the loader is not
+ * preloaded or all the slots are taken.
+ */
+static SchedulerStatsSlot *stats_slot = NULL;
+
+/* Reuse cost estimates for deferred jobs for this long */
+#define COST_ESTIMATE_TTL_MS (60 * INT64CONST(1000)) /* 1 minute */
+
+/*
+ * Compression and refresh jobs that are running, and the sum of their
+ * estimated costs, for admission control.
+ */
+typedef struct AdmissionState
+{
+	int running_compression_jobs;
+	int running_refresh_jobs;
+	int64 running_cost;
+} AdmissionState;
+
+static AdmissionState admission;
+
+static void job_admission_release(ScheduledBgwJob *sjob);
+
 static void on_failure_to_start_job(ScheduledBgwJob *sjob);
 
 static volatile sig_atomic_t got_SIGHUP = false;
@@ -212,7 +333,16 @@ worker_state_cleanup(ScheduledBgwJob *sjob)
 	 * This function needs to be safe wrt failures occurring at any point in
 	 * the job starting process.
 	 */
-	if (sjob->handle != NULL)
+	job_admission_release(sjob);
+
+	if (sjob->pool_slot >= 0)
+	{
+		/* The pooled worker keeps running, so only give the slot back */
+		ts_bgw_job_pool_release(sjob->pool_slot);
+		sjob->pool_slot = -1;
+		sjob->handle = NULL;
+	}
+	else if (sjob->handle != NULL)
 	{
 #ifdef USE_ASSERT_CHECKING
 		/* Sanity check: worker has stopped (if it was started) */
@@ -319,10 +449,23 @@ scheduled_bgw_job_transition_state_to(ScheduledBgwJob *sjob, JobState new_state)
 				return;
 			}
 
+			/*
+			 * Prefer an idle pooled worker since it is already running and
+			 * does not need a worker reservation of its own.
+			 */
+			sjob->pool_slot = ts_bgw_job_pool_reserve_idle(sjob->job.fd.owner);
+
 			/* If we are unable to reserve a worker go back to the scheduled state */
-			sjob->reserved_worker = ts_bgw_worker_reserve();
-			if (!sjob->reserved_worker)
+			if (sjob->pool_slot < 0)
+				sjob->reserved_worker = ts_bgw_worker_reserve();
+			if (sjob->pool_slot < 0 && !sjob->reserved_worker)
 			{
+				/*
+				 * Idle pooled workers hold on to their reservations, so ask
+				 * them to exit to make room for this job on a later
+				 * attempt.
+				 */
+				ts_bgw_job_pool_release_idle();
 				elog(WARNING,
 					 "failed to launch job %d \"%s\": out of background workers",
 					 sjob->job.fd.id,
@@ -355,7 +498,14 @@ scheduled_bgw_job_transition_state_to(ScheduledBgwJob *sjob, JobState new_state)
 				 sjob->job.fd.id,
 				 NameStr(sjob->job.fd.application_name));
 
-			sjob->handle = ts_bgw_job_start(&sjob->job, sjob->job.fd.owner);
+			sjob->handle =
+				ts_bgw_job_pool_start_job(&sjob->job, sjob->job.fd.owner, &sjob->pool_slot);
+			if (sjob->handle != NULL)
+				/* A new pooled worker takes over the reservation */
+				sjob->reserved_worker = false;
+			else
+				sjob->handle = ts_bgw_job_start(&sjob->job, sjob->job.fd.owner);
+
 			if (sjob->handle == NULL)
 			{
 				elog(WARNING,
@@ -365,12 +515,12 @@ scheduled_bgw_job_transition_state_to(ScheduledBgwJob *sjob, JobState new_state)
 				on_failure_to_start_job(sjob);
 				return;
 			}
-			Assert(sjob->reserved_worker);
+			Assert(sjob->reserved_worker || sjob->pool_slot >= 0);
 			break;
 		case JOB_STATE_TERMINATING:
 			Assert(prev_state == JOB_STATE_STARTED);
 			Assert(sjob->handle != NULL);
-			Assert(sjob->reserved_worker);
+			Assert(sjob->reserved_worker || sjob->pool_slot >= 0);
 			TerminateBackgroundWorker(sjob->handle);
 			break;
 	}
@@ -441,7 +591,7 @@ scheduled_ts_bgw_job_start(ScheduledBgwJob *sjob,
 		return;
 
 	Assert(sjob->handle != NULL);
-	if (bgw_register != NULL)
+	if (bgw_register != NULL && sjob->pool_slot < 0)
 		bgw_register(sjob->handle, scheduler_mctx);
 
 	status = WaitForBackgroundWorkerStartup(sjob->handle, &pid);
@@ -490,9 +640,14 @@ ts_update_scheduled_jobs_list(List *cur_jobs_list, MemoryContext mctx)
 	List *new_jobs = ts_bgw_job_get_scheduled(sizeof(ScheduledBgwJob), mctx);
 	ListCell *new_ptr = list_head(new_jobs);
 	ListCell *cur_ptr = list_head(cur_jobs_list);
+	ListCell *lc;
 
 	elog(DEBUG2, "updating scheduled jobs list");
 
+	/* Existing jobs get this from the current list below */
+	foreach (lc, new_jobs)
+		((ScheduledBgwJob *) lfirst(lc))->pool_slot = -1;
+
 	while (cur_ptr != NULL && new_ptr != NULL)
 	{
 		ScheduledBgwJob *new_sjob = lfirst(new_ptr);
@@ -584,96 +739,476 @@ ts_populate_scheduled_job_tuple(ScheduledBgwJob *sjob, Datum *values)
 #endif
 
 static int
-cmp_next_start(const ListCell *left_cell, const ListCell *right_cell)
+job_priority(const BgwJob *job)
 {
-	ScheduledBgwJob *left_sjob = lfirst(left_cell);
-	ScheduledBgwJob *right_sjob = lfirst(right_cell);
+	if (namestrcmp(&job->fd.proc_schema, FUNCTIONS_SCHEMA_NAME) != 0)
+		return JOB_PRIORITY_DEFAULT;
+
+	if (namestrcmp(&job->fd.proc_name, "policy_refresh_continuous_aggregate") == 0)
+		return JOB_PRIORITY_REFRESH;
+	else if (namestrcmp(&job->fd.proc_name, "policy_retention") == 0)
+		return JOB_PRIORITY_RETENTION;
+	else if (namestrcmp(&job->fd.proc_name, "policy_compression") == 0 ||
+			 namestrcmp(&job->fd.proc_name, "policy_recompression") == 0)
+		return JOB_PRIORITY_COMPRESSION;
+	else if (namestrcmp(&job->fd.proc_name, "policy_reorder") == 0 ||
+			 namestrcmp(&job->fd.proc_name, "policy_merge_chunks") == 0)
+		return JOB_PRIORITY_REORDER;
+
+	return JOB_PRIORITY_DEFAULT;
+}
 
-	if (left_sjob->next_start < right_sjob->next_start)
+static int
+cmp_job_id(const ScheduledBgwJob *left, const ScheduledBgwJob *right)
+{
+	if (left->job.fd.id < right->job.fd.id)
 		return -1;
 
-	if (left_sjob->next_start > right_sjob->next_start)
+	if (left->job.fd.id > right->job.fd.id)
 		return 1;
 
 	return 0;
 }
 
+static int
+cmp_start_queue(const ScheduledBgwJob *left, const ScheduledBgwJob *right)
+{
+	if (left->next_start < right->next_start)
+		return -1;
+
+	if (left->next_start > right->next_start)
+		return 1;
+
+	if (left->priority != right->priority)
+		return left->priority < right->priority ? -1 : 1;
+
+	return cmp_job_id(left, right);
+}
+
+/*
+ * Jobs that are terminating no longer have a timeout, so they sort last.
+ */
+static inline TimestampTz
+running_job_timeout(const ScheduledBgwJob *sjob)
+{
+	return sjob->state == JOB_STATE_STARTED ? sjob->timeout_at : DT_NOEND;
+}
+
+static int
+cmp_running_queue(const ScheduledBgwJob *left, const ScheduledBgwJob *right)
+{
+	TimestampTz left_timeout = running_job_timeout(left);
+	TimestampTz right_timeout = running_job_timeout(right);
+
+	if (left_timeout < right_timeout)
+		return -1;
+
+	if (left_timeout > right_timeout)
+		return 1;
+
+	return cmp_job_id(left, right);
+}
+
+static inline int *
+job_queue_pos(const JobQueue *queue, ScheduledBgwJob *sjob)
+{
+	return (int *) ((char *) sjob + queue->pos_offset);
+}
+
+static inline void
+job_queue_set(JobQueue *queue, int pos, ScheduledBgwJob *sjob)
+{
+	queue->jobs[pos] = sjob;
+	*job_queue_pos(queue, sjob) = pos;
+}
+
 static void
-start_scheduled_jobs(register_background_worker_callback_type bgw_register)
+job_queue_sift_up(JobQueue *queue, int pos)
+{
+	ScheduledBgwJob *sjob = queue->jobs[pos];
+
+	while (pos > 0)
+	{
+		int parent = (pos - 1) / 2;
+
+		if (queue->cmp(sjob, queue->jobs[parent]) >= 0)
+			break;
+
+		job_queue_set(queue, pos, queue->jobs[parent]);
+		pos = parent;
+	}
+
+	job_queue_set(queue, pos, sjob);
+}
+
+static void
+job_queue_sift_down(JobQueue *queue, int pos)
+{
+	ScheduledBgwJob *sjob = queue->jobs[pos];
+
+	for (;;)
+	{
+		int child = 2 * pos + 1;
+
+		if (child >= queue->num_jobs)
+			break;
+
+		if (child + 1 < queue->num_jobs &&
+			queue->cmp(queue->jobs[child + 1], queue->jobs[child]) < 0)
+			child++;
+
+		if (queue->cmp(queue->jobs[child], sjob) >= 0)
+			break;
+
+		job_queue_set(queue, pos, queue->jobs[child]);
+		pos = child;
+	}
+
+	job_queue_set(queue, pos, sjob);
+}
+
+static void
+job_queue_add(JobQueue *queue, ScheduledBgwJob *sjob)
+{
+	Assert(*job_queue_pos(queue, sjob) == -1);
+
+	if (queue->num_jobs >= queue->capacity)
+	{
+		int new_capacity = Max(16, queue->capacity * 2);
+
+		if (queue->jobs == NULL)
+			queue->jobs =
+				MemoryContextAlloc(scheduler_mctx, new_capacity * sizeof(ScheduledBgwJob *));
+		else
+			queue->jobs = repalloc(queue->jobs, new_capacity * sizeof(ScheduledBgwJob *));
+
+		queue->capacity = new_capacity;
+	}
+
+	queue->jobs[queue->num_jobs] = sjob;
+	queue->num_jobs++;
+	job_queue_sift_up(queue, queue->num_jobs - 1);
+}
+
+/*
+ * Remove a job from the queue, if it is in the queue.
+ *
+ * The sort key of the removed job is allowed to have changed since it was
+ * added, since it is not compared against during removal.
+ */
+static void
+job_queue_remove(JobQueue *queue, ScheduledBgwJob *sjob)
+{
+	int *pos = job_queue_pos(queue, sjob);
+	int removed_pos = *pos;
+	ScheduledBgwJob *last;
+
+	if (removed_pos < 0)
+		return;
+
+	Assert(removed_pos < queue->num_jobs && queue->jobs[removed_pos] == sjob);
+	*pos = -1;
+	queue->num_jobs--;
+
+	if (removed_pos == queue->num_jobs)
+		return;
+
+	last = queue->jobs[queue->num_jobs];
+	job_queue_set(queue, removed_pos, last);
+	job_queue_sift_up(queue, removed_pos);
+	job_queue_sift_down(queue, *job_queue_pos(queue, last));
+}
+
+/*
+ * Put the job in the queue that corresponds to its current state. This needs
+ * to be called whenever the state, next_start, or timeout_at of a job has
+ * changed.
+ */
+static void
+job_queues_update(ScheduledBgwJob *sjob)
+{
+	job_queue_remove(&start_queue, sjob);
+	job_queue_remove(&running_queue, sjob);
+
+	switch (sjob->state)
+	{
+		case JOB_STATE_SCHEDULED:
+			job_queue_add(&start_queue, sjob);
+			break;
+		case JOB_STATE_STARTED:
+		case JOB_STATE_TERMINATING:
+			job_queue_add(&running_queue, sjob);
+			break;
+		case JOB_STATE_DISABLED:
+			break;
+	}
+}
+
+/*
+ * Rebuild the queues from the list of scheduled jobs. Needs to be called
+ * after the jobs list has been updated since the old job entries are freed
+ * and the new ones have copies of the old queue positions.
+ */
+static void
+job_queues_rebuild(void)
 {
-	List *ordered_scheduled_jobs;
 	ListCell *lc;
-	Assert(CurrentMemoryContext == scratch_mctx);
 
-	/* Order jobs by increasing next_start */
-	/* list_sort does in-place sort - so make a copy and sort that */
-	ordered_scheduled_jobs = list_copy(scheduled_jobs);
-	list_sort(ordered_scheduled_jobs, cmp_next_start);
+	start_queue.num_jobs = 0;
+	running_queue.num_jobs = 0;
 
-	foreach (lc, ordered_scheduled_jobs)
+	foreach (lc, scheduled_jobs)
 	{
 		ScheduledBgwJob *sjob = lfirst(lc);
 
+		sjob->start_queue_pos = -1;
+		sjob->running_queue_pos = -1;
+		sjob->priority = job_priority(&sjob->job);
+		job_queues_update(sjob);
+	}
+}
+
+static void
+job_queues_reset(void)
+{
+	start_queue.jobs = NULL;
+	start_queue.num_jobs = 0;
+	start_queue.capacity = 0;
+	running_queue.jobs = NULL;
+	running_queue.num_jobs = 0;
+	running_queue.capacity = 0;
+}
+
+static bool
+job_needs_admission(const ScheduledBgwJob *sjob)
+{
+	return sjob->priority == JOB_PRIORITY_COMPRESSION || sjob->priority == JOB_PRIORITY_REFRESH;
+}
+
+static int64
+job_estimate_cost(ScheduledBgwJob *sjob)
+{
+	TimestampTz now = ts_timer_get_current_timestamp();
+
+	if (sjob->cost_estimated_at != 0 &&
+		now < TimestampTzPlusMilliseconds(sjob->cost_estimated_at, COST_ESTIMATE_TTL_MS))
+		return sjob->estimated_cost;
+
+	StartTransactionCommand();
+	PushActiveSnapshot(GetTransactionSnapshot());
+
+	if (sjob->priority == JOB_PRIORITY_COMPRESSION)
+		sjob->estimated_cost = ts_bgw_job_estimate_compression_cost(sjob->job.fd.id);
+	else
+		sjob->estimated_cost = ts_bgw_job_estimate_refresh_cost(sjob->job.fd.hypertable_id);
+
+	PopActiveSnapshot();
+	CommitTransactionCommand();
+	MemoryContextSwitchTo(scratch_mctx);
+
+	sjob->cost_estimated_at = now;
+	elog(DEBUG2,
+		 "estimated cost of job %d is " INT64_FORMAT " bytes",
+		 sjob->job.fd.id,
+		 sjob->estimated_cost);
+
+	return sjob->estimated_cost;
+}
+
+/*
+ * Decide if a due job can start now.
+ *
+ * Compression and refresh jobs are limited by the number of running jobs of
+ * the same type and by the sum of the estimated costs of all running
+ * compression and refresh jobs. A job is always admitted if no such job is
+ * running, so that jobs with a cost above the limit still run.
+ *
+ * Jobs that are not admitted keep their start time, so they keep their place
+ * in the start queue and are retried after START_RETRY_MS.
+ */
+static bool
+job_admit(ScheduledBgwJob *sjob)
+{
+	int64 cost_limit = (int64) ts_guc_bgw_maintenance_cost_limit * 1024;
+	int running_jobs = admission.running_compression_jobs + admission.running_refresh_jobs;
+	int64 cost;
+
+	sjob->admitted_cost = 0;
+
+	if (!job_needs_admission(sjob))
+		return true;
+
+	if (sjob->priority == JOB_PRIORITY_COMPRESSION && ts_guc_bgw_max_compression_jobs > 0 &&
+		admission.running_compression_jobs >= ts_guc_bgw_max_compression_jobs)
+	{
+		elog(DEBUG1,
+			 "deferring job %d: %d compression jobs are running",
+			 sjob->job.fd.id,
+			 admission.running_compression_jobs);
+		return false;
+	}
+
+	if (sjob->priority == JOB_PRIORITY_REFRESH && ts_guc_bgw_max_refresh_jobs > 0 &&
+		admission.running_refresh_jobs >= ts_guc_bgw_max_refresh_jobs)
+	{
+		elog(DEBUG1,
+			 "deferring job %d: %d refresh jobs are running",
+			 sjob->job.fd.id,
+			 admission.running_refresh_jobs);
+		return false;
+	}
+
+	if (cost_limit == 0)
+		return true;
+
+	cost = job_estimate_cost(sjob);
+
+	if (running_jobs > 0 && admission.running_cost + cost > cost_limit)
+	{
+		elog(DEBUG1,
+			 "deferring job %d: estimated cost " INT64_FORMAT " bytes exceeds the remaining "
+			 "budget of " INT64_FORMAT " bytes",
+			 sjob->job.fd.id,
+			 cost,
+			 Max(cost_limit - admission.running_cost, 0));
+		return false;
+	}
+
+	sjob->admitted_cost = cost;
+	return true;
+}
+
+static void
+job_admission_acquire(ScheduledBgwJob *sjob)
+{
+	if (!job_needs_admission(sjob))
+		return;
+
+	Assert(!sjob->admitted);
+	sjob->admitted = true;
+	sjob->admitted_priority = sjob->priority;
+	/* The job changes the data, so estimate again before the next run */
+	sjob->cost_estimated_at = 0;
+
+	if (sjob->priority == JOB_PRIORITY_COMPRESSION)
+		admission.running_compression_jobs++;
+	else
+		admission.running_refresh_jobs++;
+
+	admission.running_cost += sjob->admitted_cost;
+}
+
+static void
+job_admission_release(ScheduledBgwJob *sjob)
+{
+	if (!sjob->admitted)
+		return;
+
+	sjob->admitted = false;
+
+	/* The job might have been altered while running, so use the admitted type */
+	if (sjob->admitted_priority == JOB_PRIORITY_COMPRESSION)
+		admission.running_compression_jobs--;
+	else
+		admission.running_refresh_jobs--;
+
+	admission.running_cost -= sjob->admitted_cost;
+	Assert(admission.running_compression_jobs >= 0 && admission.running_refresh_jobs >= 0 &&
+		   admission.running_cost >= 0);
+}
+
+static void
+start_scheduled_jobs(register_background_worker_callback_type bgw_register)
+{
+	List *attempted_jobs = NIL;
+	ListCell *lc;
+	Assert(CurrentMemoryContext == scratch_mctx);
+
+	/*
+	 * Start jobs in order of increasing next_start until we find a job that
+	 * is not due yet. Jobs are taken out of the queue while being started and
+	 * put back afterwards, so that a job that failed to start is not retried
+	 * in the same round.
+	 */
+	while (start_queue.num_jobs > 0)
+	{
+		ScheduledBgwJob *sjob = start_queue.jobs[0];
 		int64 job_start_diff = sjob->next_start - ts_timer_get_current_timestamp();
 
-		if (sjob->state == JOB_STATE_SCHEDULED &&
-			(job_start_diff <= 0 || sjob->next_start == DT_NOBEGIN))
-		{
-			elog(DEBUG2, "starting scheduled job %d", sjob->job.fd.id);
-			scheduled_ts_bgw_job_start(sjob, bgw_register);
-		}
-		else
+		Assert(sjob->state == JOB_STATE_SCHEDULED);
+
+		if (job_start_diff > 0 && sjob->next_start != DT_NOBEGIN)
 		{
 			elog(DEBUG5,
 				 "starting scheduled job %d in " INT64_FORMAT " seconds",
 				 sjob->job.fd.id,
 				 job_start_diff / ONE_SECOND_IN_MICROSECONDS);
+			break;
+		}
+
+		job_queue_remove(&start_queue, sjob);
+		attempted_jobs = lappend(attempted_jobs, sjob);
+
+		if (!job_admit(sjob))
+			continue;
+
+		elog(DEBUG2, "starting scheduled job %d", sjob->job.fd.id);
+		scheduled_ts_bgw_job_start(sjob, bgw_register);
+
+		if (sjob->state == JOB_STATE_STARTED)
+		{
+			loop_stats.jobs_started++;
+			job_admission_acquire(sjob);
 		}
 	}
 
-	list_free(ordered_scheduled_jobs);
+	foreach (lc, attempted_jobs)
+		job_queues_update(lfirst(lc));
+
+	list_free(attempted_jobs);
 }
 
-/* Returns the earliest time the scheduler should start a job that is waiting to be started */
+/*
+ * Find the earliest wakeup time in the subtree of the start queue rooted at
+ * pos. Jobs with a start time in the past have already been tried and failed
+ * to start, so they are retried after START_RETRY_MS. Since the children of
+ * a node never start before the node itself, we only need to descend below
+ * the jobs that are past due.
+ */
 static TimestampTz
-earliest_wakeup_to_start_next_job()
+earliest_wakeup_in_subtree(int pos, TimestampTz now)
 {
-	ListCell *lc;
-	TimestampTz earliest = DT_NOEND;
-	TimestampTz now = ts_timer_get_current_timestamp();
+	ScheduledBgwJob *sjob;
+	TimestampTz earliest;
 
-	foreach (lc, scheduled_jobs)
-	{
-		ScheduledBgwJob *sjob = lfirst(lc);
+	if (pos >= start_queue.num_jobs)
+		return DT_NOEND;
 
-		if (sjob->state == JOB_STATE_SCHEDULED)
-		{
-			TimestampTz start = sjob->next_start;
-			/* if the start is less than now, this means we tried and failed to start it already, so
-			 * use the retry period */
-			if (start < now)
-				start = TimestampTzPlusMilliseconds(now, START_RETRY_MS);
-			earliest = least_timestamp(earliest, start);
-		}
-	}
-	return earliest;
+	sjob = start_queue.jobs[pos];
+
+	if (sjob->next_start >= now)
+		return sjob->next_start;
+
+	earliest = TimestampTzPlusMilliseconds(now, START_RETRY_MS);
+	earliest = least_timestamp(earliest, earliest_wakeup_in_subtree(2 * pos + 1, now));
+	return least_timestamp(earliest, earliest_wakeup_in_subtree(2 * pos + 2, now));
+}
+
+/* Returns the earliest time the scheduler should start a job that is waiting to be started */
+static TimestampTz
+earliest_wakeup_to_start_next_job()
+{
+	return earliest_wakeup_in_subtree(0, ts_timer_get_current_timestamp());
 }
 
 /* Returns the earliest time the scheduler needs to kill a job according to its timeout  */
 static TimestampTz
 earliest_job_timeout()
 {
-	ListCell *lc;
-	TimestampTz earliest = DT_NOEND;
+	if (running_queue.num_jobs == 0)
+		return DT_NOEND;
 
-	foreach (lc, scheduled_jobs)
-	{
-		ScheduledBgwJob *sjob = lfirst(lc);
-
-		if (sjob->state == JOB_STATE_STARTED)
-			earliest = least_timestamp(earliest, sjob->timeout_at);
-	}
-	return earliest;
+	return running_job_timeout(running_queue.jobs[0]);
 }
 
 /* Special exit function only used in shmem_exit_callback.
@@ -705,6 +1240,8 @@ terminate_all_jobs_and_release_workers()
 			sjob->reserved_worker = false;
 		}
 	}
+
+	ts_bgw_job_pool_terminate_all();
 }
 
 static void
@@ -724,20 +1261,35 @@ wait_for_all_jobs_to_shutdown()
 static void
 check_for_stopped_and_timed_out_jobs()
 {
-	ListCell *lc;
+	ScheduledBgwJob **running_jobs;
+	int num_running_jobs = running_queue.num_jobs;
 
-	foreach (lc, scheduled_jobs)
+	if (num_running_jobs == 0)
+		return;
+
+	/*
+	 * Only running jobs need to be checked. Take a copy of them since the
+	 * queue changes as the jobs change state.
+	 */
+	running_jobs = palloc(num_running_jobs * sizeof(ScheduledBgwJob *));
+	memcpy(running_jobs, running_queue.jobs, num_running_jobs * sizeof(ScheduledBgwJob *));
+
+	for (int i = 0; i < num_running_jobs; i++)
 	{
 		BgwHandleStatus status;
 		pid_t pid;
-		ScheduledBgwJob *sjob = lfirst(lc);
+		ScheduledBgwJob *sjob = running_jobs[i];
 		TimestampTz now = ts_timer_get_current_timestamp();
 
-		if (sjob->state != JOB_STATE_STARTED && sjob->state != JOB_STATE_TERMINATING)
-			continue;
+		Assert(sjob->state == JOB_STATE_STARTED || sjob->state == JOB_STATE_TERMINATING);
 
 		status = GetBackgroundWorkerPid(sjob->handle, &pid);
 
+		/* A pooled worker keeps running after the job has finished */
+		if (status == BGWH_STARTED && sjob->pool_slot >= 0 &&
+			ts_bgw_job_pool_job_done(sjob->pool_slot, sjob->job.fd.id))
+			status = BGWH_STOPPED;
+
 		switch (status)
 		{
 			case BGWH_POSTMASTER_DIED:
@@ -767,7 +1319,163 @@ check_for_stopped_and_timed_out_jobs()
 				Assert(sjob->state != JOB_STATE_STARTED);
 				break;
 		}
+
+		job_queues_update(sjob);
+	}
+
+	pfree(running_jobs);
+}
+
+static void
+log_scheduler_loop_stats(int elevel)
+{
+	if (loop_stats.iterations == 0)
+		return;
+
+	elog(elevel,
+		 "scheduler loop statistics for database %u: " INT64_FORMAT " iterations, " INT64_FORMAT
+		 " jobs started, work avg " INT64_FORMAT " us max " INT64_FORMAT
+		 " us, wakeup lag avg " INT64_FORMAT " us max " INT64_FORMAT " us",
+		 MyDatabaseId,
+		 loop_stats.iterations,
+		 loop_stats.jobs_started,
+		 loop_stats.total_work_us / loop_stats.iterations,
+		 loop_stats.max_work_us,
+		 loop_stats.total_lag_us / loop_stats.iterations,
+		 loop_stats.max_lag_us);
+}
+
+static SchedulerStatsRendezvous *
+scheduler_stats_rendezvous(void)
+{
+	return *(SchedulerStatsRendezvous **) find_rendezvous_variable(RENDEZVOUS_SCHEDULER_STATS);
+}
+
+/*
+ * Claim the shared statistics slot of this database, or a slot that is free
+ * or was used by a scheduler that has exited, and reset the statistics.
+ */
+static void
+scheduler_stats_claim_slot(void)
+{
+	SchedulerStatsRendezvous *stats = scheduler_stats_rendezvous();
+	SchedulerStatsSlot *free_slot = NULL;
+
+	stats_slot = NULL;
+	if (stats == NULL)
+		return;
+
+	LWLockAcquire(stats->lock, LW_EXCLUSIVE);
+	for (int i = 0; i < stats->num_slots; i++)
+	{
+		SchedulerStatsSlot *slot = &stats->slots[i];
+
+		if (slot->dbid == MyDatabaseId)
+		{
+			stats_slot = slot;
+			break;
+		}
+
+		if (free_slot == NULL &&
+			(slot->dbid == InvalidOid || BackendPidGetProc(slot->pid) == NULL))
+			free_slot = slot;
+	}
+
+	if (stats_slot == NULL)
+		stats_slot = free_slot;
+
+	if (stats_slot != NULL)
+	{
+		stats_slot->dbid = MyDatabaseId;
+		stats_slot->pid = MyProcPid;
+		for (int i = 0; i < SCHEDULER_STATS_MAX_COUNTERS; i++)
+			pg_atomic_write_u64(&stats_slot->counters[i], 0);
+	}
+	LWLockRelease(stats->lock);
+}
+
+/*
+ * Copy the loop statistics to shared memory. Only this scheduler writes to
+ * its slot, so the lock is not needed.
+ */
+static void
+publish_scheduler_loop_stats(void)
+{
+	if (stats_slot == NULL)
+		return;
+
+	pg_atomic_write_u64(&stats_slot->counters[SSC_Iterations], loop_stats.iterations);
+	pg_atomic_write_u64(&stats_slot->counters[SSC_JobsStarted], loop_stats.jobs_started);
+	pg_atomic_write_u64(&stats_slot->counters[SSC_TotalWorkUs], loop_stats.total_work_us);
+	pg_atomic_write_u64(&stats_slot->counters[SSC_MaxWorkUs], loop_stats.max_work_us);
+	pg_atomic_write_u64(&stats_slot->counters[SSC_TotalLagUs], loop_stats.total_lag_us);
+	pg_atomic_write_u64(&stats_slot->counters[SSC_MaxLagUs], loop_stats.max_lag_us);
+	pg_atomic_write_u64(&stats_slot->counters[SSC_ScheduledJobs], start_queue.num_jobs);
+	pg_atomic_write_u64(&stats_slot->counters[SSC_RunningJobs], running_queue.num_jobs);
+	pg_atomic_write_u64(&stats_slot->counters[SSC_NextWakeup], (uint64) loop_stats.next_wakeup);
+}
+
+/*
+ * Return the main loop statistics of the scheduler of the current database.
+ * The pid is null when the scheduler is not running anymore.
+ */
+Datum
+ts_bgw_scheduler_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		TupleDesc tupdesc;
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+		Ensure(tupdesc->natts == 1 + _SSC_Max,
+			   "unexpected number of columns in scheduler statistics");
+
+		Datum *values = palloc0(sizeof(Datum) * tupdesc->natts);
+		bool *nulls = palloc0(sizeof(bool) * tupdesc->natts);
+		bool found = false;
+		SchedulerStatsRendezvous *stats = scheduler_stats_rendezvous();
+
+		if (stats != NULL)
+		{
+			LWLockAcquire(stats->lock, LW_SHARED);
+			for (int i = 0; i < stats->num_slots && !found; i++)
+			{
+				SchedulerStatsSlot *slot = &stats->slots[i];
+
+				if (slot->dbid != MyDatabaseId)
+					continue;
+
+				found = true;
+				values[0] = Int32GetDatum(slot->pid);
+				nulls[0] = BackendPidGetProc(slot->pid) == NULL;
+				for (int j = 0; j < _SSC_Max; j++)
+					values[1 + j] = Int64GetDatum((int64) pg_atomic_read_u64(&slot->counters[j]));
+				values[1 + SSC_NextWakeup] = TimestampTzGetDatum(
+					(TimestampTz) pg_atomic_read_u64(&slot->counters[SSC_NextWakeup]));
+			}
+			LWLockRelease(stats->lock);
+		}
+
+		funcctx->user_fctx =
+			found ? heap_form_tuple(BlessTupleDesc(tupdesc), values, nulls) : NULL;
+		funcctx->max_calls = found ? 1 : 0;
+		MemoryContextSwitchTo(oldcontext);
 	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	if (funcctx->call_cntr >= funcctx->max_calls)
+		SRF_RETURN_DONE(funcctx);
+
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum((HeapTuple) funcctx->user_fctx));
 }
 
 /* This is the guts of the scheduler which runs the main loop.
@@ -817,8 +1525,10 @@ ts_bgw_scheduler_process(int32 run_for_interval_ms,
 	PopActiveSnapshot();
 	CommitTransactionCommand();
 	MemoryContextSwitchTo(scratch_mctx);
+	job_queues_rebuild();
 
 	jobs_list_needs_update = false;
+	scheduler_stats_claim_slot();
 
 	if (run_for_interval_ms > 0)
 		quit_time = TimestampTzPlusMilliseconds(start, run_for_interval_ms);
@@ -834,6 +1544,9 @@ ts_bgw_scheduler_process(int32 run_for_interval_ms,
 	while (quit_time > ts_timer_get_current_timestamp() && !ProcDiePending && !ts_shutdown_bgw)
 	{
 		TimestampTz next_wakeup = quit_time;
+		TimestampTz work_start = ts_timer_get_current_timestamp();
+		TimestampTz woke_up_at;
+		int64 work_us;
 		Assert(CurrentMemoryContext == scratch_mctx);
 
 		/* start jobs, and then check when to next wake up */
@@ -842,10 +1555,23 @@ ts_bgw_scheduler_process(int32 run_for_interval_ms,
 		next_wakeup = least_timestamp(next_wakeup, earliest_wakeup_to_start_next_job());
 		next_wakeup = least_timestamp(next_wakeup, earliest_job_timeout());
 
+		work_us = ts_timer_get_current_timestamp() - work_start;
+		loop_stats.next_wakeup = next_wakeup;
+		publish_scheduler_loop_stats();
+
 		pgstat_report_activity(STATE_IDLE, NULL);
 		ts_timer_wait(next_wakeup);
 		pgstat_report_activity(STATE_RUNNING, NULL);
 
+		/* Waking up early due to a latch is not lag */
+		woke_up_at = ts_timer_get_current_timestamp();
+		if (woke_up_at > next_wakeup)
+		{
+			loop_stats.total_lag_us += woke_up_at - next_wakeup;
+			loop_stats.max_lag_us = Max(loop_stats.max_lag_us, woke_up_at - next_wakeup);
+		}
+		work_start = woke_up_at;
+
 		CHECK_FOR_INTERRUPTS();
 
 		if (got_SIGHUP)
@@ -868,14 +1594,30 @@ ts_bgw_scheduler_process(int32 run_for_interval_ms,
 			scheduled_jobs = ts_update_scheduled_jobs_list(scheduled_jobs, scheduler_mctx);
 			CommitTransactionCommand();
 			MemoryContextSwitchTo(scratch_mctx);
+			job_queues_rebuild();
 			jobs_list_needs_update = false;
 		}
 
 		check_for_stopped_and_timed_out_jobs();
+		ts_bgw_job_pool_reap();
+
+		work_us += ts_timer_get_current_timestamp() - work_start;
+		loop_stats.iterations++;
+		loop_stats.total_work_us += work_us;
+		loop_stats.max_work_us = Max(loop_stats.max_work_us, work_us);
+		elog(DEBUG5,
+			 "scheduler loop iteration took " INT64_FORMAT " us with %d scheduled and %d running "
+			 "jobs",
+			 work_us,
+			 start_queue.num_jobs,
+			 running_queue.num_jobs);
 
 		MemoryContextReset(scratch_mctx);
 	}
 
+	log_scheduler_loop_stats(DEBUG1);
+	publish_scheduler_loop_stats();
+
 	elog(DEBUG1,
 		 "scheduler for database %u exiting with exit status %d",
 		 MyDatabaseId,
@@ -889,9 +1631,14 @@ ts_bgw_scheduler_process(int32 run_for_interval_ms,
 scheduler_exit:
 	CHECK_FOR_INTERRUPTS();
 
+	/* Pooled workers exit once their current job has finished */
+	ts_bgw_job_pool_request_shutdown();
 	wait_for_all_jobs_to_shutdown();
 	check_for_stopped_and_timed_out_jobs();
+	ts_bgw_job_pool_shutdown();
 	scheduled_jobs = NIL;
+	start_queue.num_jobs = 0;
+	running_queue.num_jobs = 0;
 	proc_exit(ts_debug_bgw_scheduler_exit_status);
 }
 
@@ -917,6 +1664,13 @@ ts_bgw_scheduler_setup_mctx()
 	scratch_mctx =
 		AllocSetContextCreate(scheduler_mctx, "SchedulerScratch", ALLOCSET_DEFAULT_SIZES);
 	MemoryContextSwitchTo(scratch_mctx);
+
+	/* The queues and the job pool are allocated in scheduler_mctx */
+	job_queues_reset();
+	ts_bgw_job_pool_init(scheduler_mctx);
+	memset(&admission, 0, sizeof(admission));
+	memset(&loop_stats, 0, sizeof(loop_stats));
+	loop_stats.next_wakeup = DT_NOEND;
 }
 
 static void
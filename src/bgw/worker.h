@@ -8,6 +8,7 @@
 #include <postgres.h>
 
 #include <postmaster/bgworker.h>
+#include <storage/dsm.h>
 
 /**
  * Parameters to background workers.
@@ -16,14 +17,16 @@
  * using memcpy(3). If it is necessary to add fields that cannot simply be
  * copied, we need to start using the send and recv functions for the types.
  *
- * Only one of `job_id` and `ttl` is passed currently, with `job_id` being used
- * for normal jobs and `ttl` being used for tests.
+ * Only one of `job_id`, `ttl`, and `pool_slot` is passed currently, with
+ * `job_id` being used for normal jobs, `pool_slot` for pooled job workers,
+ * and `ttl` being used for tests.
  *
  * The `bgw_main` is the function to execute when starting the job and is
  * different depending on whether this is a test runner or the real runner.
  *
  * @see ts_bgw_db_scheduler_test_main
  * @see ts_bgw_job_entrypoint
+ * @see ts_bgw_job_pool_entrypoint
  */
 typedef struct BgwParams
 {
@@ -41,8 +44,16 @@ typedef struct BgwParams
 	/** Time to live. Only used in tests. */
 	int32 ttl;
 
-	/** Name of function to call when starting the background worker. */
-	char bgw_main[BGW_MAXLEN];
+	/** Shared memory segment and slot of a pooled job worker. */
+	dsm_handle pool_segment;
+	int32 pool_slot;
+
+	/**
+	 * Name of function to call when starting the background worker. This is
+	 * a C function name, so it is limited to NAMEDATALEN like any other
+	 * identifier, which leaves room for the fields above in bgw_extra.
+	 */
+	char bgw_main[NAMEDATALEN];
 } BgwParams;
 
 /**
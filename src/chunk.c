@@ -2518,6 +2518,23 @@ get_chunks_in_time_range(Hypertable *ht, int64 older_than, int64 newer_than, Mem
 	return chunks;
 }
 
+/*
+ * Get the chunks of a hypertable in the given range of the primary dimension
+ * without locking the dimension slices. Use PG_INT64_MIN and PG_INT64_MAX
+ * for unbounded ranges.
+ */
+Chunk *
+ts_chunk_get_chunks_in_time_range(Hypertable *ht, int64 older_than, int64 newer_than,
+								  uint64 *num_chunks)
+{
+	return get_chunks_in_time_range(ht,
+									older_than,
+									newer_than,
+									CurrentMemoryContext,
+									num_chunks,
+									NULL);
+}
+
 Chunk *
 ts_chunk_copy(const Chunk *chunk)
 {
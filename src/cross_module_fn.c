@@ -43,6 +43,9 @@ CROSSMODULE_WRAPPER(policy_retention_add);
 CROSSMODULE_WRAPPER(policy_retention_proc);
 CROSSMODULE_WRAPPER(policy_retention_check);
 CROSSMODULE_WRAPPER(policy_retention_remove);
+CROSSMODULE_WRAPPER(policy_merge_chunks_add);
+CROSSMODULE_WRAPPER(policy_merge_chunks_check);
+CROSSMODULE_WRAPPER(policy_merge_chunks_remove);
 
 CROSSMODULE_WRAPPER(job_add);
 CROSSMODULE_WRAPPER(job_delete);
@@ -315,6 +318,9 @@ TSDLLEXPORT CrossModuleFunctions ts_cm_functions_default = {
 	.policy_retention_proc = error_no_default_fn_pg_community,
 	.policy_retention_check = error_no_default_fn_pg_community,
 	.policy_retention_remove = error_no_default_fn_pg_community,
+	.policy_merge_chunks_add = error_no_default_fn_pg_community,
+	.policy_merge_chunks_check = error_no_default_fn_pg_community,
+	.policy_merge_chunks_remove = error_no_default_fn_pg_community,
 
 	.job_add = error_no_default_fn_pg_community,
 	.job_alter = error_no_default_fn_pg_community,
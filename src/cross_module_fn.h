@@ -60,6 +60,9 @@ typedef struct CrossModuleFunctions
 	PGFunction policy_retention_proc;
 	PGFunction policy_retention_check;
 	PGFunction policy_retention_remove;
+	PGFunction policy_merge_chunks_add;
+	PGFunction policy_merge_chunks_check;
+	PGFunction policy_merge_chunks_remove;
 
 	PGFunction policies_add;
 	PGFunction policies_remove;
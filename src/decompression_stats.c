@@ -0,0 +1,242 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+/*
+ * Cumulative per-chunk and per-column decompression and vectorization
+ * statistics, shown by the timescaledb_information.decompression_stats view.
+ *
+ * The shared hash table is allocated by the loader. The counters are updated
+ * with atomic operations under a shared lock, and the exclusive lock is only
+ * needed to insert or remove the entries, same as for the function telemetry.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <funcapi.h>
+#include <miscadmin.h>
+#include <utils/builtins.h>
+
+#include "debug_assert.h"
+#include "decompression_stats.h"
+#include "guc.h"
+
+TS_FUNCTION_INFO_V1(ts_decompression_stats);
+TS_FUNCTION_INFO_V1(ts_decompression_stats_reset);
+
+static LWLock *decompression_stats_lock = NULL;
+static HTAB *decompression_stats = NULL;
+
+/*
+ * Find the shared hash table allocated by the loader. It is not available
+ * when the loader is not preloaded.
+ */
+static bool
+decompression_stats_attach(void)
+{
+	if (decompression_stats != NULL)
+		return true;
+
+	DecompressionStatsRendezvous **rendezvous =
+		(DecompressionStatsRendezvous **) find_rendezvous_variable(RENDEZVOUS_DECOMPRESSION_STATS);
+
+	if (*rendezvous == NULL)
+		return false;
+
+	decompression_stats = (*rendezvous)->stats;
+	decompression_stats_lock = (*rendezvous)->lock;
+	return true;
+}
+
+bool
+ts_decompression_stats_enabled(void)
+{
+	return ts_guc_track_decompression_stats && decompression_stats_attach();
+}
+
+static void
+add_counts(DecompressionStatsHashEntry *entry, const DecompressionStatsCounts *counts)
+{
+	for (int i = 0; i < _DSC_Max; i++)
+	{
+		if (counts->counters[i] != 0)
+			pg_atomic_fetch_add_u64(&entry->counters[i], counts->counters[i]);
+	}
+}
+
+/*
+ * Add the locally accumulated counters to the shared statistics of the given
+ * chunk (attno = 0) or chunk column.
+ */
+void
+ts_decompression_stats_add(Oid relid, AttrNumber attno, const DecompressionStatsCounts *counts)
+{
+	if (!ts_decompression_stats_enabled())
+		return;
+
+	DecompressionStatsKey key;
+	memset(&key, 0, sizeof(key));
+	key.dbid = MyDatabaseId;
+	key.relid = relid;
+	key.attno = attno;
+
+	/*
+	 * At steady state the entry usually exists, so first try to update it
+	 * under the shared lock.
+	 */
+	LWLockAcquire(decompression_stats_lock, LW_SHARED);
+	DecompressionStatsHashEntry *entry = hash_search(decompression_stats, &key, HASH_FIND, NULL);
+	if (entry != NULL)
+		add_counts(entry, counts);
+	LWLockRelease(decompression_stats_lock);
+
+	if (entry != NULL)
+		return;
+
+	LWLockAcquire(decompression_stats_lock, LW_EXCLUSIVE);
+	bool found = false;
+	entry = hash_search(decompression_stats, &key, HASH_ENTER_NULL, &found);
+	if (entry != NULL)
+	{
+		/* The statistics are lost when the hash table is full. */
+		if (!found)
+		{
+			for (int i = 0; i < DECOMPRESSION_STATS_MAX_COUNTERS; i++)
+				pg_atomic_init_u64(&entry->counters[i], 0);
+		}
+		add_counts(entry, counts);
+	}
+	LWLockRelease(decompression_stats_lock);
+}
+
+/*
+ * Add a value to a single counter, see ts_decompression_stats_add().
+ */
+void
+ts_decompression_stats_count(Oid relid, AttrNumber attno, DecompressionStatsCounter counter,
+							 uint64 value)
+{
+	DecompressionStatsCounts counts = { 0 };
+	Assert(counter < _DSC_Max);
+	counts.counters[counter] = value;
+	ts_decompression_stats_add(relid, attno, &counts);
+}
+
+typedef struct DecompressionStatsRow
+{
+	Oid relid;
+	int32 attno;
+	uint64 counters[_DSC_Max];
+} DecompressionStatsRow;
+
+/*
+ * Return the decompression statistics of the current database, one row per
+ * chunk or chunk column.
+ */
+Datum
+ts_decompression_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		TupleDesc tupdesc;
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+		Ensure(tupdesc->natts == 2 + _DSC_Max,
+			   "unexpected number of columns in decompression statistics");
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		/*
+		 * Copy the entries so that we don't hold the lock while returning
+		 * them.
+		 */
+		DecompressionStatsRow *rows = NULL;
+		uint64 num_rows = 0;
+		if (decompression_stats_attach())
+		{
+			LWLockAcquire(decompression_stats_lock, LW_SHARED);
+
+			const long max_rows = hash_get_num_entries(decompression_stats);
+			rows = palloc(sizeof(DecompressionStatsRow) * Max(max_rows, 1));
+
+			HASH_SEQ_STATUS hash_seq;
+			DecompressionStatsHashEntry *entry;
+			hash_seq_init(&hash_seq, decompression_stats);
+			while ((entry = hash_seq_search(&hash_seq)) != NULL)
+			{
+				if (entry->key.dbid != MyDatabaseId)
+					continue;
+
+				Assert(num_rows < (uint64) max_rows);
+				DecompressionStatsRow *row = &rows[num_rows++];
+				row->relid = entry->key.relid;
+				row->attno = entry->key.attno;
+				for (int i = 0; i < _DSC_Max; i++)
+					row->counters[i] = pg_atomic_read_u64(&entry->counters[i]);
+			}
+
+			LWLockRelease(decompression_stats_lock);
+		}
+
+		funcctx->user_fctx = rows;
+		funcctx->max_calls = num_rows;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	if (funcctx->call_cntr >= funcctx->max_calls)
+		SRF_RETURN_DONE(funcctx);
+
+	const DecompressionStatsRow *row =
+		&((DecompressionStatsRow *) funcctx->user_fctx)[funcctx->call_cntr];
+	Datum values[2 + _DSC_Max];
+	bool nulls[2 + _DSC_Max] = { false };
+
+	values[0] = ObjectIdGetDatum(row->relid);
+	values[1] = Int16GetDatum(row->attno);
+	for (int i = 0; i < _DSC_Max; i++)
+		values[2 + i] = Int64GetDatum((int64) row->counters[i]);
+
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*
+ * Remove the decompression statistics of the current database.
+ */
+Datum
+ts_decompression_stats_reset(PG_FUNCTION_ARGS)
+{
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("must be superuser to reset decompression statistics")));
+
+	if (!decompression_stats_attach())
+		PG_RETURN_VOID();
+
+	LWLockAcquire(decompression_stats_lock, LW_EXCLUSIVE);
+
+	HASH_SEQ_STATUS hash_seq;
+	DecompressionStatsHashEntry *entry;
+	hash_seq_init(&hash_seq, decompression_stats);
+	while ((entry = hash_seq_search(&hash_seq)) != NULL)
+	{
+		/* Removing the current element during the sequential scan is allowed. */
+		if (entry->key.dbid == MyDatabaseId)
+			hash_search(decompression_stats, &entry->key, HASH_REMOVE, NULL);
+	}
+
+	LWLockRelease(decompression_stats_lock);
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,29 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#pragma once
+
+#include <postgres.h>
+#include <access/attnum.h>
+
+#include "export.h"
+#include "loader/decompression_stats.h"
+
+/*
+ * Local accumulator for the decompression counters. The executor nodes
+ * accumulate the counters locally and flush them to shared memory once, when
+ * they finish, to avoid taking the shared lock for each compressed batch.
+ */
+typedef struct DecompressionStatsCounts
+{
+	uint64 counters[_DSC_Max];
+} DecompressionStatsCounts;
+
+extern TSDLLEXPORT bool ts_decompression_stats_enabled(void);
+extern TSDLLEXPORT void ts_decompression_stats_add(Oid relid, AttrNumber attno,
+												   const DecompressionStatsCounts *counts);
+extern TSDLLEXPORT void ts_decompression_stats_count(Oid relid, AttrNumber attno,
+													 DecompressionStatsCounter counter,
+													 uint64 value);
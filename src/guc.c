@@ -116,6 +116,11 @@ TSDLLEXPORT bool ts_guc_enable_in_memory_recompression = true;
 TSDLLEXPORT bool ts_guc_enable_exclusive_locking_recompression = false;
 TSDLLEXPORT bool ts_guc_enable_bool_compression = true;
 TSDLLEXPORT bool ts_guc_enable_uuid_compression = true;
+TSDLLEXPORT bool ts_guc_enable_decimal_compression = false;
+TSDLLEXPORT bool ts_guc_enable_jsonb_compression = false;
+TSDLLEXPORT bool ts_guc_enable_merge_chunks_rebatch = false;
+TSDLLEXPORT int ts_guc_reorder_lock_retries = 20;
+TSDLLEXPORT int ts_guc_reorder_lock_retry_delay = 50;
 TSDLLEXPORT int ts_guc_compression_batch_size_limit = 1000;
 TSDLLEXPORT bool ts_guc_compression_enable_compressor_batch_limit = false;
 TSDLLEXPORT CompressTruncateBehaviour ts_guc_compress_truncate_behaviour = COMPRESS_TRUNCATE_ONLY;
@@ -131,7 +136,17 @@ TSDLLEXPORT bool ts_guc_enable_compression_ratio_warnings = true;
  * disabled, regular sequence scans will be used instead. */
 TSDLLEXPORT bool ts_guc_enable_columnarscan = true;
 TSDLLEXPORT bool ts_guc_enable_columnarindexscan = false;
+TSDLLEXPORT bool ts_guc_explain_decompression_profile = false;
+TSDLLEXPORT bool ts_guc_track_decompression_stats = true;
+TSDLLEXPORT bool ts_guc_enable_compressed_toast_prefetch = true;
 TSDLLEXPORT int ts_guc_bgw_log_level = WARNING;
+int ts_guc_bgw_job_pool_size = 0;
+int ts_guc_bgw_job_pool_max_jobs = 1000;
+int ts_guc_bgw_job_pool_max_memory = 256 * 1024;
+int ts_guc_bgw_job_pool_idle_timeout = 60 * 1000;
+int ts_guc_bgw_max_compression_jobs = 0;
+int ts_guc_bgw_max_refresh_jobs = 0;
+int ts_guc_bgw_maintenance_cost_limit = 0;
 TSDLLEXPORT bool ts_guc_enable_skip_scan = true;
 #if PG16_GE
 TSDLLEXPORT bool ts_guc_enable_skip_scan_for_distinct_aggregates = true;
@@ -1005,6 +1020,70 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_decimal_compression"),
+							 "Enable decimal compression functionality",
+							 "Enable decimal compression of numeric and float columns",
+							 &ts_guc_enable_decimal_compression,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_jsonb_compression"),
+							 "Enable jsonb compression functionality",
+							 "Enable compression of jsonb columns with the frequent top-level "
+							 "keys stored as separate columns",
+							 &ts_guc_enable_jsonb_compression,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_merge_chunks_rebatch"),
+							 "Enable merging of compressed batches in merge_chunks",
+							 "Merge the compressed batches of the merged chunks per segment and "
+							 "recompress the undersized neighboring batches into full ones",
+							 &ts_guc_enable_merge_chunks_rebatch,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomIntVariable(MAKE_EXTOPTION("reorder_lock_retries"),
+							"Number of attempts to take the lock for the heap swap in reorder",
+							"Number of times reorder tries to upgrade to an AccessExclusiveLock "
+							"without waiting before it queues for the lock. Set to 0 to always "
+							"queue for the lock",
+							&ts_guc_reorder_lock_retries,
+							20,
+							0,
+							1000,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable(MAKE_EXTOPTION("reorder_lock_retry_delay"),
+							"Delay between attempts to take the lock for the heap swap in reorder",
+							"Time to wait between two attempts to upgrade to an "
+							"AccessExclusiveLock without waiting in the lock queue",
+							&ts_guc_reorder_lock_retry_delay,
+							50,
+							1,
+							60 * 1000,
+							PGC_USERSET,
+							GUC_UNIT_MS,
+							NULL,
+							NULL,
+							NULL);
+
 	DefineCustomIntVariable(MAKE_EXTOPTION("compression_batch_size_limit"),
 							"The max number of tuples that can be batched together during "
 							"compression",
@@ -1203,6 +1282,42 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable(MAKE_EXTOPTION("explain_decompression_profile"),
+							 "Show the decompression profile in EXPLAIN",
+							 "Collect detailed decompression counters for ColumnarScan and show "
+							 "them in EXPLAIN (ANALYZE, VERBOSE)",
+							 &ts_guc_explain_decompression_profile,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable(MAKE_EXTOPTION("track_decompression_stats"),
+							 "Collect cumulative decompression statistics",
+							 "Collect the per-chunk and per-column decompression and vectorization "
+							 "statistics shown in timescaledb_information.decompression_stats",
+							 &ts_guc_track_decompression_stats,
+							 true,
+							 PGC_SUSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_compressed_toast_prefetch"),
+							 "Prefetch the TOAST pages of compressed batches",
+							 "Issue the prefetch requests for the out-of-line compressed columns "
+							 "of a batch before detoasting them",
+							 &ts_guc_enable_compressed_toast_prefetch,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomIntVariable(MAKE_EXTOPTION("max_open_chunks_per_insert"),
 							"Maximum open chunks per insert",
 							"Maximum number of open chunk tables per insert",
@@ -1355,6 +1470,113 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomIntVariable(MAKE_EXTOPTION("bgw_job_pool_size"),
+							"Maximum number of pooled job workers per database",
+							"Pooled job workers run jobs back to back instead of starting a "
+							"new background worker for every job run. The pool is created when "
+							"the scheduler starts, so increasing the size requires a scheduler "
+							"restart. Setting this to 0 disables the pool.",
+							&ts_guc_bgw_job_pool_size,
+							0,
+							0,
+							1000,
+							PGC_SIGHUP,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable(MAKE_EXTOPTION("bgw_job_pool_max_jobs"),
+							"Number of jobs a pooled job worker runs before it is recycled",
+							"A pooled job worker exits after running this many jobs and a new "
+							"worker is started when needed.",
+							&ts_guc_bgw_job_pool_max_jobs,
+							1000,
+							1,
+							2147483647,
+							PGC_SIGHUP,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable(MAKE_EXTOPTION("bgw_job_pool_max_memory"),
+							"Memory growth after which a pooled job worker is recycled",
+							"A pooled job worker exits after a job if its memory usage has "
+							"grown by more than this amount since it started. Setting this to "
+							"0 disables the check.",
+							&ts_guc_bgw_job_pool_max_memory,
+							256 * 1024,
+							0,
+							MAX_KILOBYTES,
+							PGC_SIGHUP,
+							GUC_UNIT_KB,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable(MAKE_EXTOPTION("bgw_job_pool_idle_timeout"),
+							"Time after which an idle pooled job worker exits",
+							"A pooled job worker that has not been given a job for this long "
+							"exits and releases its worker reservation.",
+							&ts_guc_bgw_job_pool_idle_timeout,
+							60 * 1000,
+							1,
+							2147483647,
+							PGC_SIGHUP,
+							GUC_UNIT_MS,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable(MAKE_EXTOPTION("bgw_max_compression_jobs"),
+							"Maximum number of concurrent compression jobs per database",
+							"The scheduler defers compression policy jobs that are due while "
+							"this many compression jobs are running. Setting this to 0 "
+							"disables the limit.",
+							&ts_guc_bgw_max_compression_jobs,
+							0,
+							0,
+							1000,
+							PGC_SIGHUP,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable(MAKE_EXTOPTION("bgw_max_refresh_jobs"),
+							"Maximum number of concurrent continuous aggregate refresh jobs per "
+							"database",
+							"The scheduler defers continuous aggregate refresh policy jobs that "
+							"are due while this many refresh jobs are running. Setting this to 0 "
+							"disables the limit.",
+							&ts_guc_bgw_max_refresh_jobs,
+							0,
+							0,
+							1000,
+							PGC_SIGHUP,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable(MAKE_EXTOPTION("bgw_maintenance_cost_limit"),
+							"Amount of data that compression and refresh jobs may process "
+							"concurrently",
+							"The scheduler estimates how much data a compression or refresh job "
+							"will process and defers jobs that would make the total for running "
+							"jobs exceed this limit. A job is always started if no other such "
+							"job is running. Setting this to 0 disables the limit.",
+							&ts_guc_bgw_maintenance_cost_limit,
+							0,
+							0,
+							MAX_KILOBYTES,
+							PGC_SIGHUP,
+							GUC_UNIT_KB,
+							NULL,
+							NULL,
+							NULL);
+
 	/* this information is useful in general on customer deployments */
 	DefineCustomBoolVariable(/* name= */ MAKE_EXTOPTION("debug_compression_path_info"),
 							 /* short_desc= */ "show various compression-related debug info",
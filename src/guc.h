@@ -67,6 +67,11 @@ extern TSDLLEXPORT bool ts_guc_enable_in_memory_recompression;
 extern TSDLLEXPORT bool ts_guc_enable_exclusive_locking_recompression;
 extern TSDLLEXPORT bool ts_guc_enable_bool_compression;
 extern TSDLLEXPORT bool ts_guc_enable_uuid_compression;
+extern TSDLLEXPORT bool ts_guc_enable_decimal_compression;
+extern TSDLLEXPORT bool ts_guc_enable_jsonb_compression;
+extern TSDLLEXPORT bool ts_guc_enable_merge_chunks_rebatch;
+extern TSDLLEXPORT int ts_guc_reorder_lock_retries;
+extern TSDLLEXPORT int ts_guc_reorder_lock_retry_delay;
 extern TSDLLEXPORT int ts_guc_compression_batch_size_limit;
 extern TSDLLEXPORT bool ts_guc_compression_enable_compressor_batch_limit;
 #if PG16_GE
@@ -111,7 +116,17 @@ extern TSDLLEXPORT bool ts_guc_enable_sparse_index_bloom;
 extern TSDLLEXPORT bool ts_guc_read_legacy_bloom1_v1;
 extern TSDLLEXPORT bool ts_guc_enable_columnarscan;
 extern TSDLLEXPORT bool ts_guc_enable_columnarindexscan;
+extern TSDLLEXPORT bool ts_guc_explain_decompression_profile;
+extern TSDLLEXPORT bool ts_guc_track_decompression_stats;
+extern TSDLLEXPORT bool ts_guc_enable_compressed_toast_prefetch;
 extern TSDLLEXPORT int ts_guc_bgw_log_level;
+extern int ts_guc_bgw_job_pool_size;
+extern int ts_guc_bgw_job_pool_max_jobs;
+extern int ts_guc_bgw_job_pool_max_memory;
+extern int ts_guc_bgw_job_pool_idle_timeout;
+extern int ts_guc_bgw_max_compression_jobs;
+extern int ts_guc_bgw_max_refresh_jobs;
+extern int ts_guc_bgw_maintenance_cost_limit;
 
 /*
  * Exit code to use when scheduler exits.
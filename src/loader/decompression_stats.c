@@ -0,0 +1,69 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+#include <postgres.h>
+#include <fmgr.h>
+
+#include <storage/shmem.h>
+
+#include "loader/decompression_stats.h"
+
+/*
+ * Decompression statistics hash table size. Each chunk takes one entry plus
+ * one entry for each of its compressed columns that was decompressed. When
+ * the table is full, the statistics for the new chunks are not recorded.
+ */
+#define DECOMPRESSION_STATS_HASH_SIZE 10000
+
+StaticAssertDecl(_DSC_Max <= DECOMPRESSION_STATS_MAX_COUNTERS,
+				 "too many decompression statistics counters");
+
+static DecompressionStatsRendezvous rendezvous;
+
+void
+ts_decompression_stats_shmem_startup(void)
+{
+	HASHCTL hash_info = {
+		.keysize = sizeof(DecompressionStatsKey),
+		.entrysize = sizeof(DecompressionStatsHashEntry),
+	};
+	bool found;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+	/*
+	 * GetNamedLWLockTranche must only be run once on windows, see
+	 * ts_function_telemetry_shmem_startup().
+	 */
+	LWLock **lock = (LWLock **) ShmemInitStruct("decompression_stats_detect_first_run",
+												sizeof(LWLock *),
+												&found);
+	if (!found)
+		*lock = &(GetNamedLWLockTranche(DECOMPRESSION_STATS_LWLOCK_TRANCHE_NAME))->lock;
+
+	HTAB *stats = ShmemInitHash("timescaledb decompression stats hash",
+								DECOMPRESSION_STATS_HASH_SIZE,
+								DECOMPRESSION_STATS_HASH_SIZE,
+								&hash_info,
+								HASH_ELEM | HASH_BLOBS);
+	LWLockRelease(AddinShmemInitLock);
+
+	rendezvous.lock = *lock;
+	rendezvous.stats = stats;
+
+	DecompressionStatsRendezvous **rendezvous_ptr =
+		(DecompressionStatsRendezvous **) find_rendezvous_variable(RENDEZVOUS_DECOMPRESSION_STATS);
+	*rendezvous_ptr = &rendezvous;
+}
+
+void
+ts_decompression_stats_shmem_alloc(void)
+{
+	Size size =
+		hash_estimate_size(DECOMPRESSION_STATS_HASH_SIZE, sizeof(DecompressionStatsHashEntry));
+	RequestAddinShmemSpace(add_size(size, sizeof(LWLock *)));
+	RequestNamedLWLockTranche(DECOMPRESSION_STATS_LWLOCK_TRANCHE_NAME, 1);
+}
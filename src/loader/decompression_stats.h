@@ -0,0 +1,71 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#pragma once
+
+#include <postgres.h>
+#include <port/atomics.h>
+#include <storage/lwlock.h>
+#include <utils/hsearch.h>
+
+#define RENDEZVOUS_DECOMPRESSION_STATS "ts_decompression_stats"
+#define DECOMPRESSION_STATS_LWLOCK_TRANCHE_NAME "ts_decompression_stats_lwlock_tranche"
+
+/*
+ * The cumulative decompression counters. The shared memory is allocated by
+ * the loader, so the layout of the entries must stay compatible across the
+ * extension versions. New counters can only be added at the end, and the
+ * total number must not exceed DECOMPRESSION_STATS_MAX_COUNTERS.
+ */
+typedef enum DecompressionStatsCounter
+{
+	/* Compressed batches and rows decompressed by the scans. */
+	DSC_BatchesDecompressed = 0,
+	DSC_RowsDecompressed,
+	/* Size of the compressed data that had to be detoasted. */
+	DSC_BytesDetoasted,
+	/* Compressed batches and rows decompressed by INSERT, UPDATE and DELETE. */
+	DSC_DmlBatchesDecompressed,
+	DSC_DmlRowsDecompressed,
+	/* Partial aggregation plans over the chunk, vectorized or not. */
+	DSC_VectorizedAggregations,
+	DSC_FallbackAggregations,
+	/* Reasons why the aggregation was not vectorized. */
+	DSC_FallbackUnsupportedAggregate,
+	DSC_FallbackAggregateArgument,
+	DSC_FallbackReverseOrder,
+	DSC_FallbackGrouping,
+	DSC_FallbackFilter,
+	_DSC_Max,
+} DecompressionStatsCounter;
+
+#define DECOMPRESSION_STATS_MAX_COUNTERS 32
+
+/*
+ * The statistics are kept per chunk (attno = 0) and per column of the chunk.
+ * The hypertable is found through the chunk catalog when reading them.
+ */
+typedef struct DecompressionStatsKey
+{
+	Oid dbid;
+	Oid relid;
+	int32 attno;
+} DecompressionStatsKey;
+
+typedef struct DecompressionStatsHashEntry
+{
+	DecompressionStatsKey key;
+	pg_atomic_uint64 counters[DECOMPRESSION_STATS_MAX_COUNTERS];
+} DecompressionStatsHashEntry;
+
+typedef struct DecompressionStatsRendezvous
+{
+	LWLock *lock;
+	HTAB *stats;
+} DecompressionStatsRendezvous;
+
+extern void ts_decompression_stats_shmem_startup(void);
+
+extern void ts_decompression_stats_shmem_alloc(void);
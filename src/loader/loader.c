@@ -38,9 +38,11 @@
 #include "loader/bgw_interface.h"
 #include "loader/bgw_launcher.h"
 #include "loader/bgw_message_queue.h"
+#include "loader/decompression_stats.h"
 #include "loader/function_telemetry.h"
 #include "loader/loader.h"
 #include "loader/lwlocks.h"
+#include "loader/scheduler_stats.h"
 
 /*
  * Loading process:
@@ -588,6 +590,8 @@ timescaledb_shmem_startup_hook(void)
 	ts_bgw_message_queue_shmem_startup();
 	ts_lwlocks_shmem_startup();
 	ts_function_telemetry_shmem_startup();
+	ts_decompression_stats_shmem_startup();
+	ts_scheduler_stats_shmem_startup();
 }
 
 /*
@@ -605,6 +609,8 @@ timescaledb_shmem_request_hook(void)
 	ts_bgw_message_queue_alloc();
 	ts_lwlocks_shmem_alloc();
 	ts_function_telemetry_shmem_alloc();
+	ts_decompression_stats_shmem_alloc();
+	ts_scheduler_stats_shmem_alloc();
 }
 
 static void
@@ -0,0 +1,78 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+#include <postgres.h>
+#include <fmgr.h>
+
+#include <miscadmin.h>
+#include <storage/shmem.h>
+
+#include "loader/scheduler_stats.h"
+
+StaticAssertDecl(_SSC_Max <= SCHEDULER_STATS_MAX_COUNTERS, "too many scheduler statistics counters");
+
+typedef struct SchedulerStatsShmem
+{
+	LWLock *lock;
+	SchedulerStatsSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} SchedulerStatsShmem;
+
+static SchedulerStatsRendezvous rendezvous;
+
+/*
+ * The schedulers are background workers, so there can't be more of them
+ * running at the same time than there are worker processes.
+ */
+static Size
+scheduler_stats_shmem_size(void)
+{
+	return add_size(offsetof(SchedulerStatsShmem, slots),
+					mul_size(max_worker_processes, sizeof(SchedulerStatsSlot)));
+}
+
+void
+ts_scheduler_stats_shmem_startup(void)
+{
+	bool found;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+	SchedulerStatsShmem *shmem = (SchedulerStatsShmem *) ShmemInitStruct("timescaledb scheduler stats",
+																		  scheduler_stats_shmem_size(),
+																		  &found);
+
+	/*
+	 * GetNamedLWLockTranche must only be run once on windows, see
+	 * ts_function_telemetry_shmem_startup().
+	 */
+	if (!found)
+	{
+		shmem->lock = &(GetNamedLWLockTranche(SCHEDULER_STATS_LWLOCK_TRANCHE_NAME))->lock;
+		for (int i = 0; i < max_worker_processes; i++)
+		{
+			shmem->slots[i].dbid = InvalidOid;
+			shmem->slots[i].pid = 0;
+			for (int j = 0; j < SCHEDULER_STATS_MAX_COUNTERS; j++)
+				pg_atomic_init_u64(&shmem->slots[i].counters[j], 0);
+		}
+	}
+	LWLockRelease(AddinShmemInitLock);
+
+	rendezvous.lock = shmem->lock;
+	rendezvous.num_slots = max_worker_processes;
+	rendezvous.slots = shmem->slots;
+
+	SchedulerStatsRendezvous **rendezvous_ptr =
+		(SchedulerStatsRendezvous **) find_rendezvous_variable(RENDEZVOUS_SCHEDULER_STATS);
+	*rendezvous_ptr = &rendezvous;
+}
+
+void
+ts_scheduler_stats_shmem_alloc(void)
+{
+	RequestAddinShmemSpace(scheduler_stats_shmem_size());
+	RequestNamedLWLockTranche(SCHEDULER_STATS_LWLOCK_TRANCHE_NAME, 1);
+}
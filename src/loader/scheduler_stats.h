@@ -0,0 +1,65 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#pragma once
+
+#include <postgres.h>
+#include <port/atomics.h>
+#include <storage/lwlock.h>
+
+#define RENDEZVOUS_SCHEDULER_STATS "ts_scheduler_stats"
+#define SCHEDULER_STATS_LWLOCK_TRANCHE_NAME "ts_scheduler_stats_lwlock_tranche"
+
+/*
+ * The statistics of the database scheduler main loop. The shared memory is
+ * allocated by the loader, so the layout of the slots must stay compatible
+ * across the extension versions. New counters can only be added at the end,
+ * and the total number must not exceed SCHEDULER_STATS_MAX_COUNTERS.
+ */
+typedef enum SchedulerStatsCounter
+{
+	/* Main loop iterations and the jobs started by them. */
+	SSC_Iterations = 0,
+	SSC_JobsStarted,
+	/* Time spent in the loop iterations, not counting the wait for wakeup. */
+	SSC_TotalWorkUs,
+	SSC_MaxWorkUs,
+	/* How much later than planned the scheduler woke up. */
+	SSC_TotalLagUs,
+	SSC_MaxLagUs,
+	/* Jobs waiting to be started and jobs running at the end of the loop. */
+	SSC_ScheduledJobs,
+	SSC_RunningJobs,
+	/* The time the scheduler planned to wake up next, as TimestampTz. */
+	SSC_NextWakeup,
+	_SSC_Max,
+} SchedulerStatsCounter;
+
+#define SCHEDULER_STATS_MAX_COUNTERS 16
+
+/*
+ * One slot per database scheduler. The slot is claimed by the scheduler when
+ * it starts, and keeps the statistics after the scheduler has exited, until
+ * the slot is claimed by a scheduler for another database. The counters are
+ * only written by the scheduler that owns the slot.
+ */
+typedef struct SchedulerStatsSlot
+{
+	Oid dbid;
+	pid_t pid;
+	pg_atomic_uint64 counters[SCHEDULER_STATS_MAX_COUNTERS];
+} SchedulerStatsSlot;
+
+typedef struct SchedulerStatsRendezvous
+{
+	/* Protects the dbid and pid of the slots. */
+	LWLock *lock;
+	int num_slots;
+	SchedulerStatsSlot *slots;
+} SchedulerStatsRendezvous;
+
+extern void ts_scheduler_stats_shmem_startup(void);
+
+extern void ts_scheduler_stats_shmem_alloc(void);
@@ -16,7 +16,7 @@
 #include "ts_catalog/compression_settings.h"
 #include <utils/palloc.h>
 
-TSDLLEXPORT const char *ts_sparse_index_type_names[] = { "bloom", "minmax" };
+TSDLLEXPORT const char *ts_sparse_index_type_names[] = { "bloom", "minmax", "sum" };
 TSDLLEXPORT const char *ts_sparse_index_source_names[] = { "config", "default", "orderby" };
 TSDLLEXPORT const char *ts_sparse_index_common_keys[] = { "type", "column", "source", NULL };
 static ScanTupleResult compression_settings_tuple_update(TupleInfo *ti, void *data);
@@ -625,11 +625,15 @@ ts_add_orderby_sparse_index(CompressionSettings *settings)
 		/*
 		 * check if sparse index for column already exists
 		 * Validation is done by ts_compression_settings_update
+		 * The sum sparse index doesn't replace the orderby minmax one.
 		 */
 		if (settings->fd.index &&
-			ts_jsonb_has_key_value_str_field(settings->fd.index,
-											 ts_sparse_index_common_keys[SparseIndexKeyCol],
-											 TextDatumGetCString(datum)))
+			(contains_sparse_index_config(settings->fd.index,
+										  TextDatumGetCString(datum),
+										  ts_sparse_index_type_names[_SparseIndexTypeEnumMinmax]) ||
+			 contains_sparse_index_config(settings->fd.index,
+										  TextDatumGetCString(datum),
+										  ts_sparse_index_type_names[_SparseIndexTypeEnumBloom])))
 		{
 			continue;
 		}
@@ -19,6 +19,7 @@ typedef enum SparseIndexTypeEnum
 {
 	_SparseIndexTypeEnumBloom = 0,
 	_SparseIndexTypeEnumMinmax,
+	_SparseIndexTypeEnumSum,
 	_SparseIndexTypeEnumMax
 } SparseIndexTypeEnum;
 
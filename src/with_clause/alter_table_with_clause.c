@@ -66,6 +66,10 @@ static const WithClauseDefinition sparse_index_with_clause_def[] = {
 		.arg_names = {"compress_minmax", "minmax", "compress_min_max", "min_max", NULL},
 		.type_id = TEXTOID,
 	},
+	[_SparseIndexTypeEnumSum] = {
+		.arg_names = {"compress_sum", "sum", NULL},
+		.type_id = TEXTOID,
+	},
 };
 
 WithClauseResult *
@@ -407,7 +411,7 @@ sparse_index_type_with_clause_parse(const char *parse, const WithClauseDefinitio
 
 static void
 parse_sparse_index_config(JsonbParseState *parse_state, FuncCall *sparse_index_details,
-						  Hypertable *hypertable, ArrayType **collist)
+						  Hypertable *hypertable, ArrayType **collist, ArrayType **sum_collist)
 {
 	Oid coltypid;
 	char *colname;
@@ -464,15 +468,18 @@ parse_sparse_index_config(JsonbParseState *parse_state, FuncCall *sparse_index_d
 	coltypid = get_atttype(hypertable->main_table_relid, col_attno);
 
 	/*
-	 * Note: currently only one sparse index per column is supported.
+	 * Note: currently only one filtering sparse index per column is supported.
+	 * The sum sparse index only stores the aggregates and can be combined
+	 * with one of them, so it is tracked separately.
 	 */
-	if (ts_array_is_member(*collist, colname))
+	ArrayType **index_collist = config.base.type == _SparseIndexTypeEnumSum ? sum_collist : collist;
+	if (ts_array_is_member(*index_collist, colname))
 		ereport(ERROR,
 				(errcode(ERRCODE_SYNTAX_ERROR),
 				 errmsg("duplicate column name \"%s\"", colname),
 				 errhint("The sparse index option must reference distinct "
 						 "column.")));
-	*collist = ts_array_add_element_text(*collist, pstrdup(colname));
+	*index_collist = ts_array_add_element_text(*index_collist, pstrdup(colname));
 
 	/* extract custom sparse index type config */
 	switch (config.base.type)
@@ -512,6 +519,21 @@ parse_sparse_index_config(JsonbParseState *parse_state, FuncCall *sparse_index_d
 						 errmsg("invalid minmax column type %s", format_type_be(coltypid)),
 						 errdetail("Could not identify a less-than operator for the type.")));
 
+			config.base.col = colname;
+			break;
+		case _SparseIndexTypeEnumSum:
+			/*
+			 * The per-batch sums are stored as bigint or double precision, so
+			 * only the built-in integer and floating-point types are supported.
+			 */
+			if (coltypid != INT2OID && coltypid != INT4OID && coltypid != INT8OID &&
+				coltypid != FLOAT4OID && coltypid != FLOAT8OID)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATATYPE_MISMATCH),
+						 errmsg("invalid sum column type %s", format_type_be(coltypid)),
+						 errdetail("The sum sparse index supports only integer and "
+								   "floating-point columns.")));
+
 			config.base.col = colname;
 			break;
 		default:
@@ -595,6 +617,7 @@ parse_sparse_index_config_list(char *inpstr, Hypertable *hypertable)
 	pushJsonbValue(&parse_state, WJB_BEGIN_ARRAY, NULL);
 
 	ArrayType *collist = NULL;
+	ArrayType *sum_collist = NULL;
 	foreach (lc, select->targetList)
 	{
 		ResTarget *target = lfirst_node(ResTarget, lc);
@@ -604,10 +627,13 @@ parse_sparse_index_config_list(char *inpstr, Hypertable *hypertable)
 
 		FuncCall *fc = (FuncCall *) target->val;
 
-		parse_sparse_index_config(parse_state, fc, hypertable, &collist);
+		parse_sparse_index_config(parse_state, fc, hypertable, &collist, &sum_collist);
 	}
 
-	pfree(collist);
+	if (collist)
+		pfree(collist);
+	if (sum_collist)
+		pfree(sum_collist);
 	return JsonbValueToJsonb(pushJsonbValue(&parse_state, WJB_END_ARRAY, NULL));
 }
 
@@ -134,6 +134,10 @@ emit_log_hook_callback(ErrorData *edata)
 void
 ts_register_emit_log_hook()
 {
+	/* Pooled job workers register the hook for every job they run */
+	if (emit_log_hook == emit_log_hook_callback)
+		return;
+
 	prev_emit_log_hook = emit_log_hook;
 	emit_log_hook = emit_log_hook_callback;
 }
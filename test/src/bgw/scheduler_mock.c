@@ -25,6 +25,7 @@
 #include <utils/timestamp.h>
 
 #include "bgw/job.h"
+#include "bgw/job_pool.h"
 #include "bgw/job_stat.h"
 #include "bgw/scheduler.h"
 #include "cross_module_fn.h"
@@ -40,6 +41,7 @@ TS_FUNCTION_INFO_V1(ts_bgw_db_scheduler_test_run);
 TS_FUNCTION_INFO_V1(ts_bgw_db_scheduler_test_wait_for_scheduler_finish);
 TS_FUNCTION_INFO_V1(ts_bgw_db_scheduler_test_main);
 TS_FUNCTION_INFO_V1(ts_bgw_job_execute_test);
+TS_FUNCTION_INFO_V1(ts_bgw_job_pool_execute_test);
 /* function for testing the correctness of the next_scheduled_slot calculation */
 TS_FUNCTION_INFO_V1(ts_test_next_scheduled_execution_slot);
 
@@ -184,6 +186,7 @@ ts_bgw_db_scheduler_test_main(PG_FUNCTION_ARGS)
 	ts_timer_set(&ts_mock_timer);
 
 	ts_bgw_job_set_job_entrypoint_function_name("ts_bgw_job_execute_test");
+	ts_bgw_job_pool_set_entrypoint_function_name("ts_bgw_job_pool_execute_test");
 
 	pgstat_report_appname("DB Scheduler Test");
 
@@ -434,3 +437,12 @@ ts_bgw_job_execute_test(PG_FUNCTION_ARGS)
 
 	return ts_bgw_job_entrypoint(fcinfo);
 }
+
+Datum
+ts_bgw_job_pool_execute_test(PG_FUNCTION_ARGS)
+{
+	ts_timer_set(&ts_mock_timer);
+	ts_bgw_job_set_scheduler_test_hook(test_job_dispatcher);
+
+	return ts_bgw_job_pool_entrypoint(fcinfo);
+}
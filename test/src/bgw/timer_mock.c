@@ -14,6 +14,7 @@
 #include <utils/rel.h>
 
 #include "annotations.h"
+#include "bgw/job_pool.h"
 #include "bgw/launcher_interface.h"
 #include "log.h"
 #include "params.h"
@@ -61,6 +62,8 @@ mock_wait(TimestampTz until)
 				WaitForBackgroundWorkerShutdown(bgw_handle);
 			}
 			bgw_handles = NIL;
+			/* Pooled workers keep running, so wait for their jobs instead */
+			ts_bgw_job_pool_wait_for_jobs();
 			TS_FALLTHROUGH;
 		case IMMEDIATELY_SET_UNTIL:
 			ts_params_set_time(until, false);
@@ -408,7 +408,8 @@ policy_refresh_cagg_execute(int32 job_id, Jsonb *config)
 						PGC_S_SESSION);
 	}
 
-	ContinuousAggRefreshContext context = { .callctx = CAGG_REFRESH_POLICY };
+	ContinuousAggRefreshContext context = { .callctx = CAGG_REFRESH_POLICY,
+											.cascade = policy_data.cascade };
 
 	/* Try to split window range into a list of ranges */
 	List *refresh_window_list =
@@ -534,6 +535,8 @@ policy_refresh_cagg_read_and_validate_config(Jsonb *config, PolicyContinuousAggD
 		ts_jsonb_get_bool_field(config,
 								POL_REFRESH_CONF_KEY_PROCESS_HYPERTABLE_INVALIDATIONS,
 								&process_hypertable_invalidations_found);
+	bool cascade_found;
+	bool cascade = ts_jsonb_get_bool_field(config, POL_REFRESH_CONF_KEY_CASCADE, &cascade_found);
 	if (policy_data)
 	{
 		policy_data->refresh_window.type = dim_type;
@@ -549,6 +552,7 @@ policy_refresh_cagg_read_and_validate_config(Jsonb *config, PolicyContinuousAggD
 		policy_data->refresh_newest_first = refresh_newest_first;
 		policy_data->process_hypertable_invalidations =
 			!process_hypertable_invalidations_found || process_hypertable_invalidations;
+		policy_data->cascade = cascade_found && cascade;
 	}
 }
 
@@ -48,6 +48,7 @@ typedef struct PolicyContinuousAggData
 	int32 max_batches_per_execution;
 	bool refresh_newest_first;
 	bool process_hypertable_invalidations;
+	bool cascade;
 } PolicyContinuousAggData;
 
 typedef struct PolicyCompressionData
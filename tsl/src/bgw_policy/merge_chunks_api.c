@@ -0,0 +1,319 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include <postgres.h>
+#include <miscadmin.h>
+#include <utils/builtins.h>
+#include <utils/lsyscache.h>
+#include <utils/timestamp.h>
+
+#include <hypertable_cache.h>
+#include <jsonb_utils.h>
+
+#include "bgw/job.h"
+#include "bgw/job_stat.h"
+#include "bgw/timer.h"
+#include "bgw_policy/job.h"
+#include "bgw_policy/job_api.h"
+#include "bgw_policy/merge_chunks_api.h"
+#include "bgw_policy/policy_config.h"
+#include "compression/compression.h"
+#include "guc.h"
+#include "hypertable.h"
+#include "utils.h"
+
+/* Default schedule interval for merge chunks jobs is 1 day */
+#define DEFAULT_SCHEDULE_INTERVAL                                                                  \
+	{                                                                                              \
+		.day = 1                                                                                   \
+	}
+
+/* Default max runtime for a merge chunks job is unlimited */
+#define DEFAULT_MAX_RUNTIME                                                                        \
+	DatumGetIntervalP(DirectFunctionCall3(interval_in, CStringGetDatum("0"), InvalidOid, -1))
+
+/* Default retry period for merge chunks jobs is 1 hour */
+#define DEFAULT_RETRY_PERIOD                                                                       \
+	DatumGetIntervalP(DirectFunctionCall3(interval_in, CStringGetDatum("1 hour"), InvalidOid, -1))
+
+/*
+ * Chunks with compressed batches that have fewer rows than this on average
+ * are merged by default, even if they are not below the target size.
+ */
+#define DEFAULT_MIN_BATCH_ROWS (TARGET_COMPRESSED_BATCH_SIZE / 2)
+
+#define POLICY_MERGE_CHUNKS_PROC_NAME "policy_merge_chunks"
+#define POLICY_MERGE_CHUNKS_CHECK_NAME "policy_merge_chunks_check"
+
+static void
+validate_merge_chunks_settings(int64 target_size, int32 min_batch_rows, int32 max_merges)
+{
+	if (target_size <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid target size for merge chunks policy"),
+				 errdetail("The target size must be a positive number of bytes.")));
+
+	if (min_batch_rows < 0 || min_batch_rows > TARGET_COMPRESSED_BATCH_SIZE)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid minimum batch rows for merge chunks policy"),
+				 errdetail("The minimum batch rows must be between 0 and %d.",
+						   TARGET_COMPRESSED_BATCH_SIZE)));
+
+	if (max_merges < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid maximum number of merges for merge chunks policy"),
+				 errdetail("The maximum number of merges per job must not be negative.")));
+}
+
+static void
+policy_merge_chunks_read_and_validate_config(Jsonb *config)
+{
+	int32 htid = policy_config_get_hypertable_id(config);
+	Hypertable *ht = ts_hypertable_get_by_id(htid);
+	bool found;
+
+	if (!ht)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("configuration hypertable id %d not found", htid)));
+
+	int64 target_size =
+		ts_jsonb_get_int64_field(config, POL_MERGE_CHUNKS_CONF_KEY_TARGET_SIZE, &found);
+
+	if (!found)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("could not find %s in config for job",
+						POL_MERGE_CHUNKS_CONF_KEY_TARGET_SIZE)));
+
+	int32 min_batch_rows =
+		ts_jsonb_get_int32_field(config, POL_MERGE_CHUNKS_CONF_KEY_MIN_BATCH_ROWS, &found);
+
+	if (!found)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("could not find %s in config for job",
+						POL_MERGE_CHUNKS_CONF_KEY_MIN_BATCH_ROWS)));
+
+	int32 max_merges =
+		ts_jsonb_get_int32_field(config, POL_MERGE_CHUNKS_CONF_KEY_MAX_MERGES, &found);
+
+	if (!found)
+		max_merges = 0;
+
+	validate_merge_chunks_settings(target_size, min_batch_rows, max_merges);
+}
+
+Datum
+policy_merge_chunks_check(PG_FUNCTION_ARGS)
+{
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (PG_ARGISNULL(0))
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED), errmsg("config must not be NULL")));
+	}
+
+	policy_merge_chunks_read_and_validate_config(PG_GETARG_JSONB_P(0));
+
+	PG_RETURN_VOID();
+}
+
+Datum
+policy_merge_chunks_add(PG_FUNCTION_ARGS)
+{
+	/* behave like a strict function */
+	if (PG_ARGISNULL(0) || PG_ARGISNULL(1) || PG_ARGISNULL(3))
+		PG_RETURN_NULL();
+
+	NameData application_name;
+	NameData proc_name, proc_schema, check_name, check_schema, owner;
+	int32 job_id;
+	Oid ht_oid = PG_GETARG_OID(0);
+	int64 target_size = PG_GETARG_INT64(1);
+	int32 min_batch_rows = PG_ARGISNULL(2) ? DEFAULT_MIN_BATCH_ROWS : PG_GETARG_INT32(2);
+	bool if_not_exists = PG_GETARG_BOOL(3);
+	Interval schedule_interval = DEFAULT_SCHEDULE_INTERVAL;
+	TimestampTz initial_start = PG_ARGISNULL(5) ? DT_NOBEGIN : PG_GETARG_TIMESTAMPTZ(5);
+	bool fixed_schedule = !PG_ARGISNULL(5);
+	text *timezone = PG_ARGISNULL(6) ? NULL : PG_GETARG_TEXT_PP(6);
+	char *valid_timezone = NULL;
+	Cache *hcache;
+	Hypertable *ht;
+	int32 hypertable_id;
+	Oid owner_id;
+	List *jobs;
+
+	ts_feature_flag_check(FEATURE_POLICY);
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (!PG_ARGISNULL(4))
+		schedule_interval = *PG_GETARG_INTERVAL_P(4);
+
+	if (timezone != NULL)
+		valid_timezone = ts_bgw_job_validate_timezone(PG_GETARG_DATUM(6));
+
+	validate_merge_chunks_settings(target_size, min_batch_rows, 0);
+
+	ht = ts_hypertable_cache_get_cache_and_entry(ht_oid, CACHE_FLAG_NONE, &hcache);
+	Assert(ht != NULL);
+	hypertable_id = ht->fd.id;
+
+	/* First verify that the hypertable corresponds to a valid table */
+	owner_id = ts_hypertable_permissions_check(ht_oid, GetUserId());
+
+	if (TS_HYPERTABLE_IS_INTERNAL_COMPRESSION_TABLE(ht))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot add merge chunks policy to compressed hypertable \"%s\"",
+						get_rel_name(ht_oid)),
+				 errhint("Please add the policy to the corresponding uncompressed hypertable "
+						 "instead.")));
+
+	/* Only chunks in the columnstore are merged by the policy */
+	if (!TS_HYPERTABLE_HAS_COMPRESSION_ENABLED(ht))
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("columnstore not enabled on hypertable \"%s\"", get_rel_name(ht_oid)),
+				 errhint("Enable columnstore before adding a merge chunks policy.")));
+
+	/* Verify that the hypertable owner can create a background worker */
+	ts_bgw_job_validate_job_owner(owner_id);
+
+	/* Make sure that an existing merge chunks policy doesn't exist on this hypertable */
+	jobs = ts_bgw_job_find_by_proc_and_hypertable_id(POLICY_MERGE_CHUNKS_PROC_NAME,
+													 FUNCTIONS_SCHEMA_NAME,
+													 hypertable_id);
+
+	ts_cache_release(&hcache);
+
+	if (jobs != NIL)
+	{
+		BgwJob *existing = linitial(jobs);
+		bool found;
+		Assert(list_length(jobs) == 1);
+
+		if (!if_not_exists)
+			ereport(ERROR,
+					(errcode(ERRCODE_DUPLICATE_OBJECT),
+					 errmsg("merge chunks policy already exists for hypertable \"%s\"",
+							get_rel_name(ht_oid))));
+
+		if (ts_jsonb_get_int64_field(existing->fd.config,
+									 POL_MERGE_CHUNKS_CONF_KEY_TARGET_SIZE,
+									 &found) != target_size ||
+			ts_jsonb_get_int32_field(existing->fd.config,
+									 POL_MERGE_CHUNKS_CONF_KEY_MIN_BATCH_ROWS,
+									 &found) != min_batch_rows)
+		{
+			ereport(WARNING,
+					(errmsg("merge chunks policy already exists for hypertable \"%s\"",
+							get_rel_name(ht_oid)),
+					 errdetail("A policy already exists with different arguments."),
+					 errhint("Remove the existing policy before adding a new one.")));
+			PG_RETURN_INT32(-1);
+		}
+		/* If all arguments are the same, do nothing */
+		ereport(NOTICE,
+				(errmsg("merge chunks policy already exists on hypertable \"%s\", skipping",
+						get_rel_name(ht_oid))));
+		PG_RETURN_INT32(-1);
+	}
+
+	/* if users pass in -infinity for initial_start, then use the current_timestamp instead */
+	if (fixed_schedule)
+	{
+		ts_bgw_job_validate_schedule_interval(&schedule_interval);
+		if (TIMESTAMP_NOT_FINITE(initial_start))
+			initial_start = ts_timer_get_current_timestamp();
+	}
+
+	/* Next, insert a new job into jobs table */
+	namestrcpy(&application_name, "Merge Chunks Policy");
+	namestrcpy(&proc_name, POLICY_MERGE_CHUNKS_PROC_NAME);
+	namestrcpy(&proc_schema, FUNCTIONS_SCHEMA_NAME);
+	namestrcpy(&check_name, POLICY_MERGE_CHUNKS_CHECK_NAME);
+	namestrcpy(&check_schema, FUNCTIONS_SCHEMA_NAME);
+	namestrcpy(&owner, GetUserNameFromId(owner_id, false));
+
+	JsonbParseState *parse_state = NULL;
+
+	pushJsonbValue(&parse_state, WJB_BEGIN_OBJECT, NULL);
+	ts_jsonb_add_int32(parse_state, POLICY_CONFIG_KEY_HYPERTABLE_ID, hypertable_id);
+	ts_jsonb_add_int64(parse_state, POL_MERGE_CHUNKS_CONF_KEY_TARGET_SIZE, target_size);
+	ts_jsonb_add_int32(parse_state, POL_MERGE_CHUNKS_CONF_KEY_MIN_BATCH_ROWS, min_batch_rows);
+	JsonbValue *result = pushJsonbValue(&parse_state, WJB_END_OBJECT, NULL);
+	Jsonb *config = JsonbValueToJsonb(result);
+
+	job_id = ts_bgw_job_insert_relation(&application_name,
+										&schedule_interval,
+										DEFAULT_MAX_RUNTIME,
+										JOB_RETRY_UNLIMITED,
+										DEFAULT_RETRY_PERIOD,
+										&proc_schema,
+										&proc_name,
+										&check_schema,
+										&check_name,
+										owner_id,
+										true,
+										fixed_schedule,
+										hypertable_id,
+										config,
+										initial_start,
+										valid_timezone);
+
+	if (!TIMESTAMP_NOT_FINITE(initial_start))
+		ts_bgw_job_stat_upsert_next_start(job_id, initial_start);
+
+	PG_RETURN_INT32(job_id);
+}
+
+Datum
+policy_merge_chunks_remove(PG_FUNCTION_ARGS)
+{
+	Oid hypertable_oid = PG_GETARG_OID(0);
+	bool if_exists = PG_GETARG_BOOL(1);
+	Hypertable *ht;
+	Cache *hcache;
+
+	ts_feature_flag_check(FEATURE_POLICY);
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	ht = ts_hypertable_cache_get_cache_and_entry(hypertable_oid, CACHE_FLAG_NONE, &hcache);
+
+	List *jobs = ts_bgw_job_find_by_proc_and_hypertable_id(POLICY_MERGE_CHUNKS_PROC_NAME,
+														   FUNCTIONS_SCHEMA_NAME,
+														   ht->fd.id);
+	ts_cache_release(&hcache);
+
+	if (jobs == NIL)
+	{
+		if (!if_exists)
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_OBJECT),
+					 errmsg("merge chunks policy not found for hypertable \"%s\"",
+							get_rel_name(hypertable_oid))));
+		else
+		{
+			ereport(NOTICE,
+					(errmsg("merge chunks policy not found for hypertable \"%s\", skipping",
+							get_rel_name(hypertable_oid))));
+			PG_RETURN_NULL();
+		}
+	}
+	Assert(list_length(jobs) == 1);
+	BgwJob *job = linitial(jobs);
+
+	ts_hypertable_permissions_check(hypertable_oid, GetUserId());
+
+	ts_bgw_job_delete_by_id(job->fd.id);
+
+	PG_RETURN_NULL();
+}
@@ -0,0 +1,18 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#pragma once
+
+#include <postgres.h>
+#include <utils/jsonb.h>
+
+#define POL_MERGE_CHUNKS_CONF_KEY_TARGET_SIZE "target_size"
+#define POL_MERGE_CHUNKS_CONF_KEY_MIN_BATCH_ROWS "min_batch_rows"
+#define POL_MERGE_CHUNKS_CONF_KEY_MAX_MERGES "max_merges_per_job"
+
+/* User-facing API functions */
+extern Datum policy_merge_chunks_add(PG_FUNCTION_ARGS);
+extern Datum policy_merge_chunks_remove(PG_FUNCTION_ARGS);
+extern Datum policy_merge_chunks_check(PG_FUNCTION_ARGS);
@@ -4,7 +4,9 @@
  * LICENSE-TIMESCALE for a copy of the license.
  */
 #include <postgres.h>
+#include <access/heapam.h>
 #include <access/multixact.h>
+#include <access/tableam.h>
 #include <access/xact.h>
 #include <catalog/catalog.h>
 #include <catalog/dependency.h>
@@ -27,21 +29,28 @@
 #include <utils/acl.h>
 #include <utils/elog.h>
 #include <utils/guc.h>
+#include <utils/lsyscache.h>
 #include <utils/memutils.h>
 #include <utils/palloc.h>
 #include <utils/rel.h>
 #include <utils/relcache.h>
 #include <utils/snapmgr.h>
 #include <utils/syscache.h>
+#include <utils/tuplesort.h>
 
 #include "chunk.h"
 #include "chunk_index.h"
+#include "compression/compression.h"
+#include "compression/create.h"
 #include "debug_point.h"
+#include "guc.h"
 #include "hypercube.h"
 #include "import/heapswap.h"
+#include "ts_catalog/array_utils.h"
 #include "ts_catalog/catalog.h"
 #include "ts_catalog/chunk_rewrite.h"
 #include "ts_catalog/compression_chunk_size.h"
+#include "ts_catalog/compression_settings.h"
 
 typedef struct RelationMergeInfo
 {
@@ -53,6 +62,7 @@ typedef struct RelationMergeInfo
 	char relpersistence;
 	bool isresult;
 	bool iscompressed_rel;
+	Oid uncompressed_relid; /* Chunk of a compressed relation */
 	ItemPointerData chunk_rewrite_tid;
 	List *ind_oids_old;
 	List *ind_oids_new;
@@ -684,6 +694,399 @@ append_rellock(List *rellocks, Relation rel, LOCKMODE lockmode, MemoryContext mc
 	return rellocks;
 }
 
+/*
+ * Check if the compressed relations can be merged batch by batch.
+ *
+ * The batches can be merged only if all chunks are compressed with the same
+ * settings into compressed relations with the same layout. Returns the
+ * compression settings of the merged chunk, or NULL if the compressed
+ * relations should be copied as-is.
+ */
+static CompressionSettings *
+get_batch_merge_settings(RelationMergeInfo *relinfos, int nrelids, int mergeindex)
+{
+	RelationMergeInfo *result_minfo = &relinfos[mergeindex];
+	TupleDesc result_desc;
+	CompressionSettings *settings;
+
+	if (!ts_guc_enable_merge_chunks_rebatch || !result_minfo->iscompressed_rel)
+		return NULL;
+
+	settings = ts_compression_settings_get(result_minfo->uncompressed_relid);
+
+	if (settings == NULL)
+		return NULL;
+
+	result_desc = RelationGetDescr(result_minfo->rel);
+
+	for (int i = 0; i < nrelids; i++)
+	{
+		RelationMergeInfo *relinfo = &relinfos[i];
+
+		if (relinfo->rel == NULL || i == mergeindex)
+			continue;
+
+		CompressionSettings *other = ts_compression_settings_get(relinfo->uncompressed_relid);
+
+		if (other == NULL || !ts_compression_settings_equal(settings, other))
+			return NULL;
+
+		TupleDesc desc = RelationGetDescr(relinfo->rel);
+
+		if (desc->natts != result_desc->natts)
+			return NULL;
+
+		for (int attno = 0; attno < desc->natts; attno++)
+		{
+			Form_pg_attribute attr = TupleDescAttr(desc, attno);
+			Form_pg_attribute result_attr = TupleDescAttr(result_desc, attno);
+
+			if (attr->attisdropped != result_attr->attisdropped ||
+				attr->atttypid != result_attr->atttypid ||
+				namestrcmp(&attr->attname, NameStr(result_attr->attname)) != 0)
+				return NULL;
+		}
+	}
+
+	return settings;
+}
+
+/*
+ * Create a sort over the compressed batches that orders them by the
+ * segmentby columns and then by the min/max metadata of the orderby columns,
+ * in the same order as the index on the compressed relation.
+ *
+ * The number of leading segmentby sort keys is returned in num_segmentby.
+ */
+static Tuplesortstate *
+batch_merge_tuplesort_begin(const CompressionSettings *settings, Relation uncompressed_rel,
+							Relation compressed_rel, AttrNumber **segmentby_attnos,
+							int *num_segmentby)
+{
+	Oid uncompressed_relid = RelationGetRelid(uncompressed_rel);
+	Oid compressed_relid = RelationGetRelid(compressed_rel);
+	int nsegmentby = ts_array_length(settings->fd.segmentby);
+	int norderby = ts_array_length(settings->fd.orderby);
+	int max_keys = nsegmentby + 2 * norderby;
+	AttrNumber *sort_keys = palloc(sizeof(*sort_keys) * max_keys);
+	Oid *sort_operators = palloc(sizeof(*sort_operators) * max_keys);
+	Oid *sort_collations = palloc(sizeof(*sort_collations) * max_keys);
+	bool *nulls_first = palloc(sizeof(*nulls_first) * max_keys);
+	int n_keys = 0;
+
+	for (int i = 1; i <= nsegmentby; i++)
+	{
+		const char *attname = ts_array_get_element_text(settings->fd.segmentby, i);
+		AttrNumber attno;
+
+		compress_chunk_populate_sort_info_for_column(settings,
+													 uncompressed_relid,
+													 attname,
+													 &attno,
+													 &sort_operators[n_keys],
+													 &sort_collations[n_keys],
+													 &nulls_first[n_keys]);
+		sort_keys[n_keys] = get_attnum(compressed_relid, attname);
+		Ensure(AttributeNumberIsValid(sort_keys[n_keys]),
+			   "segmentby column \"%s\" not found in compressed relation",
+			   attname);
+		n_keys++;
+	}
+
+	for (int i = 1; i <= norderby; i++)
+	{
+		const char *attname = ts_array_get_element_text(settings->fd.orderby, i);
+		AttrNumber min_attno = get_attnum(compressed_relid, column_segment_min_name(i));
+		AttrNumber max_attno = get_attnum(compressed_relid, column_segment_max_name(i));
+		AttrNumber attno;
+		Oid sort_operator;
+		Oid collation;
+		bool orderby_nulls_first;
+
+		if (!AttributeNumberIsValid(min_attno) || !AttributeNumberIsValid(max_attno))
+			break;
+
+		compress_chunk_populate_sort_info_for_column(settings,
+													 uncompressed_relid,
+													 attname,
+													 &attno,
+													 &sort_operator,
+													 &collation,
+													 &orderby_nulls_first);
+
+		sort_keys[n_keys] = min_attno;
+		sort_keys[n_keys + 1] = max_attno;
+
+		for (int k = n_keys; k < n_keys + 2; k++)
+		{
+			sort_operators[k] = sort_operator;
+			sort_collations[k] = collation;
+			nulls_first[k] = orderby_nulls_first;
+		}
+
+		n_keys += 2;
+	}
+
+	*segmentby_attnos = sort_keys;
+	*num_segmentby = nsegmentby;
+
+	return tuplesort_begin_heap(CreateTupleDescCopy(RelationGetDescr(compressed_rel)),
+								n_keys,
+								sort_keys,
+								sort_operators,
+								sort_collations,
+								nulls_first,
+								maintenance_work_mem,
+								NULL,
+								false /*=randomAccess*/);
+}
+
+typedef struct BatchMergeState
+{
+	Relation out_rel;
+	Relation uncompressed_rel;
+	BulkWriter writer;
+	RowDecompressor decompressor;
+	RowCompressor compressor;
+	Tuplesortstate *row_sort;
+
+	/* Consecutive undersized batches of the current segment */
+	MemoryContext run_mcxt;
+	List *run;
+	int64 run_rows;
+
+	int64 batches_written;
+	int64 batches_recompressed;
+} BatchMergeState;
+
+static void
+batch_merge_write(BatchMergeState *state, HeapTuple tuple)
+{
+	heap_insert(state->writer.out_rel,
+				tuple,
+				state->writer.mycid,
+				state->writer.insert_options,
+				state->writer.bistate);
+	state->batches_written++;
+}
+
+/*
+ * Write out the current run of undersized batches.
+ *
+ * If the rows of the run fit into fewer batches, decompress the run and
+ * compress the rows again into full batches. Otherwise, the batches are
+ * written as-is since recompressing them would not reduce the number of
+ * batches.
+ */
+static void
+batch_merge_flush_run(BatchMergeState *state)
+{
+	int nbatches = list_length(state->run);
+	int64 target = ts_guc_compression_batch_size_limit;
+	ListCell *lc;
+
+	if (nbatches == 0)
+		return;
+
+	if (nbatches == 1 || (state->run_rows + target - 1) / target >= nbatches)
+	{
+		foreach (lc, state->run)
+			batch_merge_write(state, (HeapTuple) lfirst(lc));
+	}
+	else
+	{
+		int64 num_compressed_rows = state->compressor.num_compressed_rows;
+
+		foreach (lc, state->run)
+		{
+			heap_deform_tuple((HeapTuple) lfirst(lc),
+							  RelationGetDescr(state->out_rel),
+							  state->decompressor.compressed_datums,
+							  state->decompressor.compressed_is_nulls);
+
+			row_decompressor_decompress_row_to_tuplesort(&state->decompressor, state->row_sort);
+		}
+
+		tuplesort_performsort(state->row_sort);
+		row_compressor_reset(&state->compressor);
+		row_compressor_append_sorted_rows(&state->compressor,
+										  state->row_sort,
+										  state->uncompressed_rel,
+										  &state->writer);
+		tuplesort_reset(state->row_sort);
+
+		state->batches_written += state->compressor.num_compressed_rows - num_compressed_rows;
+		state->batches_recompressed += nbatches;
+	}
+
+	MemoryContextReset(state->run_mcxt);
+	state->run = NIL;
+	state->run_rows = 0;
+}
+
+/*
+ * Merge the compressed batches of all compressed relations into the new
+ * relation.
+ *
+ * The batches of all relations are merged by segment and orderby metadata,
+ * which is the same order as produced by compression. Full batches are
+ * written as-is, while neighboring undersized batches of the same segment
+ * (typically the tails of the segments in each of the merged chunks) are
+ * decompressed and compressed again into full batches. This avoids
+ * recompressing the whole merged chunk to get rid of the small batches.
+ *
+ * Returns the number of batches written to the new relation.
+ */
+static double
+merge_compressed_batches(RelationMergeInfo *relinfos, int nrelids, int mergeindex,
+						 CompressionSettings *settings, Relation new_rel)
+{
+	RelationMergeInfo *result_minfo = &relinfos[mergeindex];
+	Relation uncompressed_rel = table_open(result_minfo->uncompressed_relid, NoLock);
+	TupleDesc compressed_desc = RelationGetDescr(new_rel);
+	AttrNumber count_attno = get_attnum(RelationGetRelid(new_rel),
+										COMPRESSION_COLUMN_METADATA_COUNT_NAME);
+	AttrNumber *segmentby_attnos;
+	int num_segmentby;
+	SegmentInfo **segment_info;
+	Tuplesortstate *batch_sort;
+	TupleTableSlot *slot;
+	bool first_batch = true;
+	BatchMergeState state = {
+		.out_rel = new_rel,
+		.uncompressed_rel = uncompressed_rel,
+		.writer = bulk_writer_build(new_rel, 0),
+		.decompressor = build_decompressor(compressed_desc, RelationGetDescr(uncompressed_rel)),
+		.row_sort = compression_create_tuplesort_state(settings, uncompressed_rel),
+		.run_mcxt = AllocSetContextCreate(CurrentMemoryContext,
+										  "merge compressed batches",
+										  ALLOCSET_DEFAULT_SIZES),
+	};
+
+	Ensure(AttributeNumberIsValid(count_attno), "count column not found in compressed relation");
+
+	row_compressor_init(&state.compressor,
+						settings,
+						RelationGetDescr(uncompressed_rel),
+						compressed_desc);
+
+	batch_sort = batch_merge_tuplesort_begin(settings,
+											 uncompressed_rel,
+											 new_rel,
+											 &segmentby_attnos,
+											 &num_segmentby);
+
+	/*
+	 * Step 1: sort the batches of all the relations. This is effectively a
+	 * k-way merge since the batches of each relation are already ordered
+	 * within each segment.
+	 */
+	for (int i = 0; i < nrelids; i++)
+	{
+		RelationMergeInfo *relinfo = &relinfos[i];
+
+		if (relinfo->rel == NULL)
+			continue;
+
+		TupleTableSlot *scan_slot = table_slot_create(relinfo->rel, NULL);
+		TableScanDesc scan = table_beginscan(relinfo->rel, GetActiveSnapshot(), 0, NULL);
+
+		while (table_scan_getnextslot(scan, ForwardScanDirection, scan_slot))
+			tuplesort_puttupleslot(batch_sort, scan_slot);
+
+		table_endscan(scan);
+		ExecDropSingleTupleTableSlot(scan_slot);
+	}
+
+	tuplesort_performsort(batch_sort);
+
+	/*
+	 * Step 2: write the merged batches and recompress the runs of undersized
+	 * batches within each segment.
+	 */
+	segment_info = palloc(sizeof(SegmentInfo *) * num_segmentby);
+
+	for (int i = 0; i < num_segmentby; i++)
+	{
+		AttrNumber attoff = AttrNumberGetAttrOffset(segmentby_attnos[i]);
+
+		segment_info[i] = segment_info_new(TupleDescAttr(compressed_desc, attoff));
+	}
+
+	slot = MakeSingleTupleTableSlot(compressed_desc, &TTSOpsMinimalTuple);
+
+	while (tuplesort_gettupleslot(batch_sort, true /*=forward*/, false /*=copy*/, slot, NULL))
+	{
+		bool changed_segment = first_batch;
+		bool isnull;
+
+		for (int i = 0; i < num_segmentby && !changed_segment; i++)
+		{
+			Datum value = slot_getattr(slot, segmentby_attnos[i], &isnull);
+
+			changed_segment = !segment_info_datum_is_in_group(segment_info[i], value, isnull);
+		}
+
+		if (changed_segment)
+		{
+			batch_merge_flush_run(&state);
+
+			for (int i = 0; i < num_segmentby; i++)
+			{
+				Datum value = slot_getattr(slot, segmentby_attnos[i], &isnull);
+
+				segment_info_update(segment_info[i], value, isnull);
+			}
+
+			first_batch = false;
+		}
+
+		int32 count = DatumGetInt32(slot_getattr(slot, count_attno, &isnull));
+
+		Assert(!isnull);
+
+		if (count >= ts_guc_compression_batch_size_limit)
+		{
+			bool should_free;
+			HeapTuple tuple = ExecFetchSlotHeapTuple(slot, false, &should_free);
+
+			/* Keep the batch order by writing out the preceding run first */
+			batch_merge_flush_run(&state);
+			batch_merge_write(&state, tuple);
+
+			if (should_free)
+				heap_freetuple(tuple);
+		}
+		else
+		{
+			MemoryContext oldmcxt = MemoryContextSwitchTo(state.run_mcxt);
+			state.run = lappend(state.run, ExecCopySlotHeapTuple(slot));
+			state.run_rows += count;
+			MemoryContextSwitchTo(oldmcxt);
+		}
+	}
+
+	batch_merge_flush_run(&state);
+
+	elog(LOG,
+		 "merged compressed batches into \"%s\": batches " INT64_FORMAT
+		 " recompressed " INT64_FORMAT,
+		 RelationGetRelationName(new_rel),
+		 state.batches_written,
+		 state.batches_recompressed);
+
+	ExecDropSingleTupleTableSlot(slot);
+	tuplesort_end(batch_sort);
+	tuplesort_end(state.row_sort);
+	row_compressor_close(&state.compressor);
+	row_decompressor_close(&state.decompressor);
+	bulk_writer_close(&state.writer);
+	MemoryContextDelete(state.run_mcxt);
+	table_close(uncompressed_rel, NoLock);
+
+	return (double) state.batches_written;
+}
+
 static Oid
 merge_relinfos(RelationMergeInfo *relinfos, int nrelids, int mergeindex, LOCKMODE old_heap_lockmode,
 			   List **rellocks, RelationMergeStats *stats, MemoryContext merge_mcxt,
@@ -714,19 +1117,36 @@ merge_relinfos(RelationMergeInfo *relinfos, int nrelids, int mergeindex, LOCKMOD
 
 	*rellocks = append_rellock(*rellocks, new_rel, AccessExclusiveLock, merge_mcxt);
 
-	pg17_workaround_init(new_rel, relinfos, nrelids);
+	/*
+	 * Compressed relations with matching compression settings are merged
+	 * batch by batch so that the merged chunk does not end up with the
+	 * undersized batches from each of the merged chunks. The batches are
+	 * inserted into the new relation, so the PG17 workaround for copying
+	 * relations must not be used in that case.
+	 */
+	CompressionSettings *settings = get_batch_merge_settings(relinfos, nrelids, mergeindex);
+
+	if (settings != NULL)
+		stats->reltuples =
+			merge_compressed_batches(relinfos, nrelids, mergeindex, settings, new_rel);
+	else
+		pg17_workaround_init(new_rel, relinfos, nrelids);
 
 	/* Step 3: write the data from all the rels into a new merged heap */
 	for (int i = 0; i < nrelids; i++)
 	{
-		RelationMergeInfo *relinfo = get_relmergeinfo(relinfos, nrelids, i);
+		RelationMergeInfo *relinfo =
+			settings != NULL ? &relinfos[i] : get_relmergeinfo(relinfos, nrelids, i);
 		struct VacuumCutoffs *cutoffs_i = &relinfo->cutoffs;
 		double num_tuples = 0.0;
 
 		if (relinfo->rel)
 		{
-			num_tuples = copy_table_data(relinfo->rel, new_rel, cutoffs_i, merged_cutoffs);
-			stats->reltuples += num_tuples;
+			if (settings == NULL)
+			{
+				num_tuples = copy_table_data(relinfo->rel, new_rel, cutoffs_i, merged_cutoffs);
+				stats->reltuples += num_tuples;
+			}
 
 			if (concurrently)
 			{
@@ -766,6 +1186,10 @@ merge_relinfos(RelationMergeInfo *relinfos, int nrelids, int mergeindex, LOCKMOD
 		stats->ccs.numrows_frozen_immediately += relinfo->ccs.numrows_frozen_immediately;
 	}
 
+	/* The number of batches changes when the batches are merged */
+	if (settings != NULL)
+		stats->ccs.numrows_post_compression = (int64) stats->reltuples;
+
 	/*
 	 * Rebuild indexes on new heap (if in concurrent mode). In non-concurrent
 	 * mode, indexes are rebuilt as part of the heap swap (this is how PG
@@ -781,12 +1205,16 @@ merge_relinfos(RelationMergeInfo *relinfos, int nrelids, int mergeindex, LOCKMOD
 	}
 
 	stats->num_pages = RelationGetNumberOfBlocks(new_rel);
-	pg17_workaround_cleanup(new_rel);
+
+	if (settings == NULL)
+	{
+		pg17_workaround_cleanup(new_rel);
+	}
 
 	/* Now close all relations */
 	for (int i = 0; i < nrelids; i++)
 	{
-		RelationMergeInfo *relinfo = get_relmergeinfo(relinfos, nrelids, i);
+		RelationMergeInfo *relinfo = &relinfos[i];
 
 		/*
 		 * Close the relations before the heap swap, but keep the locks until
@@ -1310,6 +1738,7 @@ chunk_merge_chunks(PG_FUNCTION_ARGS)
 			crelinfo->rel = table_open(crelinfo->relid, lockmode);
 			crelinfo->isresult = relinfos[i].isresult;
 			crelinfo->iscompressed_rel = true;
+			crelinfo->uncompressed_relid = relinfos[i].relid;
 			crelinfo->relpersistence = crelinfo->rel->rd_rel->relpersistence;
 			compute_rel_vacuum_cutoffs(crelinfos[i].rel, &crelinfos[i].cutoffs);
 			rellocks = append_rellock(rellocks, crelinfo->rel, lockmode, merge_cxt);
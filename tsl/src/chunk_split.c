@@ -56,6 +56,11 @@ typedef struct SplitPoint
 	 * or non-compressed relations are split.
 	 */
 	HeapTuple (*route_next_tuple)(TupleTableSlot *slot, SplitContext *scontext, int *routing_index);
+	/*
+	 * Optional function to release the routing state once all tuples are
+	 * routed.
+	 */
+	void (*route_end)(SplitContext *scontext);
 } SplitPoint;
 
 /*
@@ -73,6 +78,15 @@ typedef struct CompressedSplitPoint
 	AttrNumber attnum_max;
 	AttrNumber attnum_count;
 	TupleDesc noncompressed_tupdesc;
+	/*
+	 * Decompressor for the segments that straddle the split point. The
+	 * decompressor, and a compressor per result relation, is set up on first
+	 * use and then reused for every straddling segment. Allocated in the
+	 * long-lived memory context "mcxt".
+	 */
+	MemoryContext mcxt;
+	RowDecompressor decompressor;
+	bool recompress_initialized;
 } CompressedSplitPoint;
 
 typedef struct RewriteStats
@@ -335,6 +349,49 @@ route_next_non_compressed_tuple(TupleTableSlot *slot, SplitContext *scontext, in
 	return ExecFetchSlotHeapTuple(slot, false, NULL);
 }
 
+/*
+ * Set up the decompressor and the per-partition compressors used to split
+ * segments that straddle the split point.
+ */
+static void
+compressed_split_point_init_recompress(CompressedSplitPoint *csp, SplitContext *scontext)
+{
+	MemoryContext oldcxt = MemoryContextSwitchTo(csp->mcxt);
+	CompressionSettings *csettings =
+		ts_compression_settings_get_by_compress_relid(RelationGetRelid(scontext->rel));
+
+	csp->decompressor =
+		build_decompressor(RelationGetDescr(scontext->rel), csp->noncompressed_tupdesc);
+
+	for (int i = 0; i < scontext->split_factor; i++)
+	{
+		RelationWriteState *rws = &scontext->rws[i];
+		row_compressor_init(&rws->compressor,
+							csettings,
+							csp->noncompressed_tupdesc,
+							RelationGetDescr(rws->targetrel));
+	}
+
+	csp->recompress_initialized = true;
+	MemoryContextSwitchTo(oldcxt);
+}
+
+static void
+route_compressed_end(SplitContext *scontext)
+{
+	CompressedSplitPoint *csp = (CompressedSplitPoint *) scontext->sp;
+
+	if (!csp->recompress_initialized)
+		return;
+
+	row_decompressor_close(&csp->decompressor);
+
+	for (int i = 0; i < scontext->split_factor; i++)
+		row_compressor_close(&scontext->rws[i].compressor);
+
+	csp->recompress_initialized = false;
+}
+
 /*
  * Route a compressed tuple (segment) to its corresponding result partition
  * for the split.
@@ -384,11 +441,16 @@ route_next_compressed_tuple(TupleTableSlot *slot, SplitContext *scontext, int *r
 
 		new_tuple->t_tableOid = RelationGetRelid(rws->targetrel);
 
-		row_compressor_clear_batch(&rws->compressor, false);
-		rws->stats.tuples_in_segments += rws->compressor.rowcnt_pre_compression;
+		/*
+		 * Clear the compressor, including the segmentby values, so that it
+		 * can be reused for the next straddling segment, which might be in a
+		 * different segment group.
+		 */
+		rws->stats.tuples_in_segments += rws->compressor.rows_compressed_into_current_value;
+		row_compressor_clear_batch(&rws->compressor, true);
+		row_compressor_reset(&rws->compressor);
 		*routing_index = scontext->rws_index;
 		scontext->rws_index++;
-		row_compressor_close(&rws->compressor);
 
 		return new_tuple;
 	}
@@ -402,33 +464,24 @@ route_next_compressed_tuple(TupleTableSlot *slot, SplitContext *scontext, int *r
 		 * to be split across the partitions by decompressing and
 		 * recompressing into sub-segments.
 		 */
-		HeapTuple tuple;
-		CompressionSettings *csettings =
-			ts_compression_settings_get_by_compress_relid(RelationGetRelid(scontext->rel));
-
-		tuple = ExecFetchSlotHeapTuple(slot, false, NULL);
+		HeapTuple tuple = ExecFetchSlotHeapTuple(slot, false, NULL);
+		RowDecompressor *decompressor = &csp->decompressor;
 
-		RowDecompressor decompressor =
-			build_decompressor(slot->tts_tupleDescriptor, csp->noncompressed_tupdesc);
+		if (!csp->recompress_initialized)
+			compressed_split_point_init_recompress(csp, scontext);
 
 		heap_deform_tuple(tuple,
-						  decompressor.in_desc,
-						  decompressor.compressed_datums,
-						  decompressor.compressed_is_nulls);
-
-		int nrows = decompress_batch(&decompressor);
+						  decompressor->in_desc,
+						  decompressor->compressed_datums,
+						  decompressor->compressed_is_nulls);
 
 		/*
-		 * Initialize a compressor for each new partition.
+		 * The decompressor creates its output slots on first use, so they
+		 * must not end up in the per-tuple memory context.
 		 */
-		for (int i = 0; i < scontext->split_factor; i++)
-		{
-			RelationWriteState *rws = &scontext->rws[i];
-			row_compressor_init(&rws->compressor,
-								csettings,
-								csp->noncompressed_tupdesc,
-								RelationGetDescr(scontext->rws[i].targetrel));
-		}
+		MemoryContext oldcxt = MemoryContextSwitchTo(csp->mcxt);
+		int nrows = decompress_batch(decompressor);
+		MemoryContextSwitchTo(oldcxt);
 
 		/*
 		 * Route each decompressed tuple to its corresponding partition's
@@ -436,7 +489,7 @@ route_next_compressed_tuple(TupleTableSlot *slot, SplitContext *scontext, int *r
 		 */
 		for (int i = 0; i < nrows; i++)
 		{
-			int routing_index = route_tuple(decompressor.decompressed_slots[i], scontext->sp);
+			int routing_index = route_tuple(decompressor->decompressed_slots[i], scontext->sp);
 			Assert(routing_index == 0 || routing_index == 1);
 			RelationWriteState *rws = &scontext->rws[routing_index];
 			/*
@@ -446,10 +499,10 @@ route_next_compressed_tuple(TupleTableSlot *slot, SplitContext *scontext, int *r
 			 * smaller.
 			 */
 			row_compressor_append_ordered_slot(&rws->compressor,
-											   decompressor.decompressed_slots[i]);
+											   decompressor->decompressed_slots[i]);
 		}
 
-		row_decompressor_close(&decompressor);
+		row_decompressor_reset(decompressor);
 		scontext->rws_index = 0;
 
 		/*
@@ -588,6 +641,30 @@ copy_tuples_for_split(SplitContext *scontext)
 
 		LockBuffer(buf, BUFFER_LOCK_UNLOCK);
 
+		if (isdead)
+		{
+			/*
+			 * Dead tuples are not copied, so there is no need to route them,
+			 * which would mean decompressing and recompressing a compressed
+			 * segment that straddles the split point. The heap rewrite module
+			 * still needs to see them, and since the update chain might be
+			 * in any of the partitions, all of them are told.
+			 */
+			tups_vacuumed += 1;
+
+			for (int i = 0; i < scontext->split_factor; i++)
+			{
+				if (rewrite_heap_dead_tuple(scontext->rws[i].rwstate, tuple))
+				{
+					/* A previous recently-dead tuple is now known dead */
+					tups_vacuumed += 1;
+					tups_recently_dead -= 1;
+				}
+			}
+
+			continue;
+		}
+
 		HeapTuple tuple2;
 
 		/*
@@ -600,33 +677,21 @@ copy_tuples_for_split(SplitContext *scontext)
 		{
 			Assert(routingindex >= 0 && routingindex < scontext->split_factor);
 			rws = &scontext->rws[routingindex];
+			num_tuples++;
+			rws->stats.tuples_written++;
 
-			if (isdead)
-			{
-				tups_vacuumed += 1;
-				/* heap rewrite module still needs to see it... */
-				if (rewrite_heap_dead_tuple(rws->rwstate, tuple2))
-				{
-					/* A previous recently-dead tuple is now known dead */
-					tups_vacuumed += 1;
-					tups_recently_dead -= 1;
-				}
-			}
-			else
-			{
-				num_tuples++;
-				rws->stats.tuples_written++;
-
-				if (isalive)
-					rws->stats.tuples_alive++;
+			if (isalive)
+				rws->stats.tuples_alive++;
 
-				reform_and_rewrite_tuple(tuple2, srcrel, rws);
-			}
+			reform_and_rewrite_tuple(tuple2, srcrel, rws);
 		}
 	}
 
 	MemoryContextSwitchTo(oldcxt);
 
+	if (sp->route_end)
+		sp->route_end(scontext);
+
 	const char *nspname = get_namespace_name(RelationGetNamespace(srcrel));
 
 	ereport(DEBUG1,
@@ -1172,11 +1237,13 @@ chunk_split_chunk(PG_FUNCTION_ARGS)
 				.point = split_at,
 				.dim = hyperspace_get_open_dimension(ht->space, 0),
 				.route_next_tuple = route_next_compressed_tuple,
+				.route_end = route_compressed_end,
 			},
 			.attnum_min = get_attnum(compress_settings->fd.compress_relid, min_attname),
 			.attnum_max = get_attnum(compress_settings->fd.compress_relid, max_attname),
 			.attnum_count = get_attnum(compress_settings->fd.compress_relid, COMPRESSION_COLUMN_METADATA_COUNT_NAME),
 			.noncompressed_tupdesc = CreateTupleDescCopy(RelationGetDescr(srcrel)),
+			.mcxt = CurrentMemoryContext,
 		};
 
 		csplit_relations[0] = (SplitRelationInfo){ .relid = compress_settings->fd.compress_relid,
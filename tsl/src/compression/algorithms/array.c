@@ -498,7 +498,11 @@ static ArrowArray *tsl_text_array_decompress_all(Datum compressed_array, Oid ele
 static ArrowArray *tsl_uuid_array_decompress_all(Datum compressed_array, Oid element_type,
 												 MemoryContext dest_mctx);
 
-/* Pass through to the specialized functions below for BOOL and TEXT */
+/*
+ * Pass through to the specialized functions below for BOOL, TEXT and UUID.
+ * NUMERIC has a varlena binary representation that can be decompressed the
+ * same way as TEXT.
+ */
 ArrowArray *
 tsl_array_decompress_all(Datum compressed_array, Oid element_type, MemoryContext dest_mctx)
 {
@@ -507,6 +511,7 @@ tsl_array_decompress_all(Datum compressed_array, Oid element_type, MemoryContext
 		case BOOLOID:
 			return tsl_bool_array_decompress_all(compressed_array, element_type, dest_mctx);
 		case TEXTOID:
+		case NUMERICOID:
 			return tsl_text_array_decompress_all(compressed_array, element_type, dest_mctx);
 		case UUIDOID:
 			return tsl_uuid_array_decompress_all(compressed_array, element_type, dest_mctx);
@@ -673,7 +678,31 @@ tsl_uuid_array_decompress_all(Datum compressed_array, Oid element_type, MemoryCo
 static ArrowArray *
 tsl_text_array_decompress_all(Datum compressed_array, Oid element_type, MemoryContext dest_mctx)
 {
-	Assert(element_type == TEXTOID);
+	Assert(element_type == TEXTOID || element_type == NUMERICOID);
+	void *compressed_data = PG_DETOAST_DATUM(compressed_array);
+	StringInfoData si = { .data = compressed_data, .len = VARSIZE(compressed_data) };
+	ArrayCompressed *header = consumeCompressedData(&si, sizeof(ArrayCompressed));
+
+	Assert(header->compression_algorithm == COMPRESSION_ALGORITHM_ARRAY);
+	CheckCompressedData(header->element_type == element_type);
+
+	return text_array_decompress_all_serialized_no_header(&si,
+														  header->has_nulls,
+														  /* selection = */ NULL,
+														  dest_mctx);
+}
+
+/*
+ * Decompress a text array, but only copy the values of the rows that are set
+ * in the given selection bitmap. The other non-null rows are returned as empty
+ * strings. This is used for late materialization of the columns when the
+ * vectorized filters pass only some rows of the batch, and allows to skip
+ * copying most of the data for selective filters.
+ */
+ArrowArray *
+tsl_text_array_decompress_selected(Datum compressed_array, const uint64 *selection,
+								   MemoryContext dest_mctx)
+{
 	void *compressed_data = PG_DETOAST_DATUM(compressed_array);
 	StringInfoData si = { .data = compressed_data, .len = VARSIZE(compressed_data) };
 	ArrayCompressed *header = consumeCompressedData(&si, sizeof(ArrayCompressed));
@@ -681,17 +710,22 @@ tsl_text_array_decompress_all(Datum compressed_array, Oid element_type, MemoryCo
 	Assert(header->compression_algorithm == COMPRESSION_ALGORITHM_ARRAY);
 	CheckCompressedData(header->element_type == TEXTOID);
 
-	return text_array_decompress_all_serialized_no_header(&si, header->has_nulls, dest_mctx);
+	return text_array_decompress_all_serialized_no_header(&si,
+														  header->has_nulls,
+														  selection,
+														  dest_mctx);
 }
 
 ArrowArray *
 text_array_decompress_all_serialized_no_header(StringInfo si, bool has_nulls,
-											   MemoryContext dest_mctx)
+											   const uint64 *selection, MemoryContext dest_mctx)
 {
 	Simple8bRleSerialized *nulls_serialized = NULL;
+	Simple8bRleBitmap nulls = { 0 };
 	if (has_nulls)
 	{
 		nulls_serialized = bytes_deserialize_simple8b_and_advance(si);
+		nulls = simple8brle_bitmap_decompress(nulls_serialized);
 	}
 
 	Simple8bRleSerialized *sizes_serialized = bytes_deserialize_simple8b_and_advance(si);
@@ -708,6 +742,7 @@ text_array_decompress_all_serialized_no_header(StringInfo si, bool has_nulls,
 		(uint8 *) MemoryContextAlloc(dest_mctx, pad_to_multiple(64, si->len - si->cursor));
 
 	uint32 offset = 0;
+	uint32 row = 0;
 	for (uint32 i = 0; i < n_notnull; i++)
 	{
 		const void *unaligned = consumeCompressedData(si, sizes[i]);
@@ -762,7 +797,23 @@ text_array_decompress_all_serialized_no_header(StringInfo si, bool has_nulls,
 		const Datum alignment_bytes = PointerGetDatum(vardata) - PointerGetDatum(unaligned);
 		CheckCompressedData(VARSIZE_ANY(vardata) + alignment_bytes == sizes[i]);
 
-		const uint32 textlen = VARSIZE_ANY_EXHDR(vardata);
+		/*
+		 * Find the row number of this element to check whether it is selected.
+		 */
+		bool selected = true;
+		if (selection != NULL)
+		{
+			if (has_nulls)
+			{
+				for (; row < n_total && simple8brle_bitmap_get_at(&nulls, row); row++)
+					;
+				CheckCompressedData(row < n_total);
+			}
+			selected = arrow_row_is_valid(selection, row);
+			row++;
+		}
+
+		const uint32 textlen = selected ? VARSIZE_ANY_EXHDR(vardata) : 0;
 		memcpy(&arrow_bodies[offset], VARDATA_ANY(vardata), textlen);
 
 		offsets[i] = offset;
@@ -796,7 +847,6 @@ text_array_decompress_all_serialized_no_header(StringInfo si, bool has_nulls,
 		 * We have decompressed the data with nulls skipped, reshuffle it
 		 * according to the nulls bitmap.
 		 */
-		const Simple8bRleBitmap nulls = simple8brle_bitmap_decompress(nulls_serialized);
 		CheckCompressedData(n_notnull + simple8brle_bitmap_num_ones(&nulls) == n_total);
 
 		int current_notnull_element = n_notnull - 1;
@@ -72,7 +72,11 @@ extern Datum tsl_array_compressor_finish(PG_FUNCTION_ARGS);
 ArrowArray *tsl_array_decompress_all(Datum compressed_array, Oid element_type,
 									 MemoryContext dest_mctx);
 
+ArrowArray *tsl_text_array_decompress_selected(Datum compressed_array, const uint64 *selection,
+											   MemoryContext dest_mctx);
+
 ArrowArray *text_array_decompress_all_serialized_no_header(StringInfo si, bool has_nulls,
+														   const uint64 *selection,
 														   MemoryContext dest_mctx);
 
 #define ARRAY_ALGORITHM_DEFINITION                                                                 \
@@ -0,0 +1,882 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include <postgres.h>
+#include <catalog/pg_type.h>
+#include <libpq/pqformat.h>
+#include <utils/builtins.h>
+#include <utils/memutils.h>
+#include <utils/numeric.h>
+
+#include <math.h>
+
+#include "decimal_compress.h"
+#include "array.h"
+#include "compression/arrow_c_data_interface.h"
+#include "compression/compression.h"
+#include "datum_serialize.h"
+#include "deltadelta.h"
+#include "float_utils.h"
+#include "gorilla.h"
+#include "numeric_utils.h"
+
+typedef struct DecimalCompressed
+{
+	CompressedDataHeaderFields; /* this uses 5 bytes */
+	uint8 scale;
+	uint16 num_exceptions;
+	Oid element_type;
+	uint32 values_size;
+	uint32 exceptions_size;
+	uint32 padding;
+	/* 8-byte alignment sentinel for the following fields */
+	uint64 alignment_sentinel[FLEXIBLE_ARRAY_MEMBER];
+} DecimalCompressed;
+
+static void
+pg_attribute_unused() assertions(void)
+{
+	StaticAssertStmt(sizeof(DecimalCompressed) == 24, "DecimalCompressed wrong size");
+	StaticAssertStmt(offsetof(DecimalCompressed, alignment_sentinel) % MAXIMUM_ALIGNOF == 0,
+					 "variable sized data must be 8-byte aligned");
+}
+
+typedef struct DecimalDecompressionIterator
+{
+	DecompressionIterator base;
+	int32 position;		  /* position within the total */
+	int32 total_elements; /* total number of entries plus nulls */
+	ArrowArray *arrow;	  /* init does a decompress_all to get this */
+} DecimalDecompressionIterator;
+
+/*
+ * If more than 1/DECIMAL_MAX_EXCEPTIONS_DIVISOR of the non-null values of a
+ * batch can't be represented at the common scale, the batch is compressed with
+ * the default algorithm for the type instead.
+ */
+#define DECIMAL_MAX_EXCEPTIONS_DIVISOR 8
+
+/*
+ * The floats are only encoded when the scaled value is an integer that can be
+ * converted to double exactly.
+ */
+#define DECIMAL_MAX_EXACT_INTEGER 9007199254740992.0 /* 2^53 */
+
+/*
+ * The decimal compressor has to see all the values of the batch to choose the
+ * scale, so it buffers them until finish.
+ */
+struct DecimalCompressor
+{
+	Oid element_type;
+	int32 num_values;
+	int32 num_nulls;
+	int32 capacity;
+	bool *nulls;
+	/* The float4 values are stored as double, which is exact. */
+	double *float_values;
+	/* Detoasted copies of the numeric values. */
+	Numeric *numeric_values;
+};
+
+typedef struct ExtendedCompressor
+{
+	Compressor base;
+	DecimalCompressor *internal;
+	Oid element_type;
+} ExtendedCompressor;
+
+/*
+ * Local helpers
+ */
+static void decimal_compressor_append_datum(Compressor *compressor, Datum val);
+static void decimal_compressor_append_null_value(Compressor *compressor);
+static void *decimal_compressor_finish_and_reset(Compressor *compressor);
+static void decompression_iterator_init(DecimalDecompressionIterator *iter, void *compressed,
+										Oid element_type, bool forward);
+
+const Compressor decimal_compressor_initializer = {
+	.append_val = decimal_compressor_append_datum,
+	.append_null = decimal_compressor_append_null_value,
+	.is_full = NULL,
+	.finish = decimal_compressor_finish_and_reset,
+};
+
+static inline uint32
+decimal_positions_size(uint32 num_exceptions)
+{
+	return pad_to_multiple(sizeof(uint64), sizeof(uint16) * num_exceptions);
+}
+
+static pg_attribute_always_inline double
+decimal_float8_from_scaled(int64 value, int scale)
+{
+	return (double) value / (double) numeric_pow10[scale];
+}
+
+static pg_attribute_always_inline float
+decimal_float4_from_scaled(int64 value, int scale)
+{
+	return (float) decimal_float8_from_scaled(value, scale);
+}
+
+/*
+ * Find the integer that gives exactly the same float value when divided by
+ * 10^scale. This is false for the values that have more decimal digits, and
+ * also for NaN, infinities and negative zero.
+ */
+static pg_attribute_always_inline bool
+decimal_float_to_scaled(Oid element_type, double value, int scale, int64 *result)
+{
+	const double scaled = rint(value * (double) numeric_pow10[scale]);
+	if (!(fabs(scaled) <= DECIMAL_MAX_EXACT_INTEGER))
+	{
+		return false;
+	}
+
+	const int64 candidate = (int64) scaled;
+	if (element_type == FLOAT4OID)
+	{
+		if (float_get_bits(decimal_float4_from_scaled(candidate, scale)) !=
+			float_get_bits((float) value))
+		{
+			return false;
+		}
+	}
+	else if (double_get_bits(decimal_float8_from_scaled(candidate, scale)) !=
+			 double_get_bits(value))
+	{
+		return false;
+	}
+
+	*result = candidate;
+	return true;
+}
+
+/*
+ * Decode the numeric value into the fixed-point representation, if it is
+ * restored exactly by numeric_body_from_fixed().
+ */
+static bool
+decimal_numeric_to_fixed(Numeric value, FixedNumeric *result)
+{
+	const uint8 *body = (const uint8 *) VARDATA_ANY(value);
+	const uint32 len = VARSIZE_ANY_EXHDR(value);
+	if (!numeric_body_to_fixed(body, len, result) || result->scale > NUMERIC_MAX_POW10)
+	{
+		return false;
+	}
+
+	uint8 encoded[NUMERIC_FIXED_MAX_BODY_BYTES];
+	const uint32 encoded_len = numeric_body_from_fixed(*result, encoded);
+	return encoded_len == len && memcmp(encoded, body, len) == 0;
+}
+
+/*
+ * Compressor framework functions and definitions for the decimal_compress algorithm.
+ */
+
+extern DecimalCompressor *
+decimal_compressor_alloc(Oid element_type)
+{
+	Assert(element_type == NUMERICOID || element_type == FLOAT4OID ||
+		   element_type == FLOAT8OID);
+
+	DecimalCompressor *compressor = palloc0(sizeof(*compressor));
+	compressor->element_type = element_type;
+	compressor->capacity = TARGET_COMPRESSED_BATCH_SIZE;
+	compressor->nulls = palloc(sizeof(bool) * compressor->capacity);
+	if (element_type == NUMERICOID)
+		compressor->numeric_values = palloc(sizeof(Numeric) * compressor->capacity);
+	else
+		compressor->float_values = palloc(sizeof(double) * compressor->capacity);
+	return compressor;
+}
+
+static void
+decimal_compressor_reserve(DecimalCompressor *compressor)
+{
+	if (compressor->num_values < compressor->capacity)
+		return;
+
+	compressor->capacity *= 2;
+	compressor->nulls = repalloc(compressor->nulls, sizeof(bool) * compressor->capacity);
+	if (compressor->element_type == NUMERICOID)
+		compressor->numeric_values =
+			repalloc(compressor->numeric_values, sizeof(Numeric) * compressor->capacity);
+	else
+		compressor->float_values =
+			repalloc(compressor->float_values, sizeof(double) * compressor->capacity);
+}
+
+extern void
+decimal_compressor_append_null(DecimalCompressor *compressor)
+{
+	decimal_compressor_reserve(compressor);
+	compressor->nulls[compressor->num_values] = true;
+	compressor->num_values++;
+	compressor->num_nulls++;
+}
+
+extern void
+decimal_compressor_append_value(DecimalCompressor *compressor, Datum next_val)
+{
+	decimal_compressor_reserve(compressor);
+	const int row = compressor->num_values;
+	compressor->nulls[row] = false;
+	switch (compressor->element_type)
+	{
+		case FLOAT8OID:
+			compressor->float_values[row] = DatumGetFloat8(next_val);
+			break;
+		case FLOAT4OID:
+			compressor->float_values[row] = DatumGetFloat4(next_val);
+			break;
+		default:
+			Assert(compressor->element_type == NUMERICOID);
+			compressor->numeric_values[row] = DatumGetNumericCopy(next_val);
+			break;
+	}
+	compressor->num_values++;
+}
+
+/*
+ * Compress the batch with the default algorithm for the type, for when it has
+ * too many values that can't be represented at a common scale.
+ */
+static void *
+decimal_compressor_finish_default(DecimalCompressor *compressor)
+{
+	if (compressor->element_type == NUMERICOID)
+	{
+		ArrayCompressor *array = array_compressor_alloc(NUMERICOID);
+		for (int row = 0; row < compressor->num_values; row++)
+		{
+			if (compressor->nulls[row])
+				array_compressor_append_null(array);
+			else
+				array_compressor_append(array, NumericGetDatum(compressor->numeric_values[row]));
+		}
+		return array_compressor_finish(array);
+	}
+
+	GorillaCompressor *gorilla = gorilla_compressor_alloc();
+	for (int row = 0; row < compressor->num_values; row++)
+	{
+		if (compressor->nulls[row])
+			gorilla_compressor_append_null(gorilla);
+		else if (compressor->element_type == FLOAT4OID)
+			gorilla_compressor_append_value(gorilla,
+											float_get_bits((float) compressor->float_values[row]));
+		else
+			gorilla_compressor_append_value(gorilla,
+											double_get_bits(compressor->float_values[row]));
+	}
+	return gorilla_compressor_finish(gorilla);
+}
+
+static DecimalCompressed *
+decimal_compressed_from_parts(Oid element_type, uint8 scale, const void *values,
+							  const uint16 *positions, uint16 num_exceptions,
+							  const void *exceptions)
+{
+	const uint32 values_size = VARSIZE(values);
+	const uint32 positions_size = decimal_positions_size(num_exceptions);
+	const uint32 exceptions_size = num_exceptions > 0 ? VARSIZE(exceptions) : 0;
+	const Size total_size =
+		sizeof(DecimalCompressed) + values_size + positions_size + exceptions_size;
+	CheckCompressedData(total_size <= MaxAllocSize);
+
+	/* Zero the padding so that the compressed data is deterministic. */
+	char *data = palloc0(total_size);
+	DecimalCompressed *compressed = (DecimalCompressed *) data;
+	SET_VARSIZE(&compressed->vl_len_, total_size);
+	compressed->compression_algorithm = COMPRESSION_ALGORITHM_DECIMAL;
+	compressed->scale = scale;
+	compressed->num_exceptions = num_exceptions;
+	compressed->element_type = element_type;
+	compressed->values_size = values_size;
+	compressed->exceptions_size = exceptions_size;
+
+	data += sizeof(DecimalCompressed);
+	memcpy(data, values, values_size);
+	data += values_size;
+	memcpy(data, positions, sizeof(uint16) * num_exceptions);
+	data += positions_size;
+	if (num_exceptions > 0)
+		memcpy(data, exceptions, exceptions_size);
+
+	return compressed;
+}
+
+extern void *
+decimal_compressor_finish(DecimalCompressor *compressor)
+{
+	if (compressor == NULL)
+		return NULL;
+
+	const int num_values = compressor->num_values;
+	const int num_notnull = num_values - compressor->num_nulls;
+	if (num_notnull == 0)
+		return NULL;
+
+	Ensure(num_values <= GLOBAL_MAX_ROWS_PER_COMPRESSION,
+		   "too many rows %d for decimal compression",
+		   num_values);
+
+	const int max_exceptions = num_notnull / DECIMAL_MAX_EXCEPTIONS_DIVISOR;
+	const Oid element_type = compressor->element_type;
+
+	/*
+	 * Find the smallest scale for each value, or -1 if it can't be represented
+	 * as a scaled integer. For numeric, this is the display scale which we have
+	 * to preserve, so the scaled values are computed right away.
+	 */
+	int8 *row_scales = palloc(sizeof(int8) * num_values);
+	int64 *scaled_values = palloc(sizeof(int64) * num_values);
+	int scale_counts[NUMERIC_MAX_POW10 + 1] = { 0 };
+	for (int row = 0; row < num_values; row++)
+	{
+		row_scales[row] = -1;
+		if (compressor->nulls[row])
+			continue;
+
+		if (element_type == NUMERICOID)
+		{
+			FixedNumeric fixed;
+			if (decimal_numeric_to_fixed(compressor->numeric_values[row], &fixed))
+			{
+				row_scales[row] = fixed.scale;
+				scaled_values[row] = fixed.mantissa;
+				scale_counts[fixed.scale]++;
+			}
+			continue;
+		}
+
+		for (int scale = 0; scale <= NUMERIC_MAX_POW10; scale++)
+		{
+			int64 scaled;
+			if (decimal_float_to_scaled(element_type,
+										compressor->float_values[row],
+										scale,
+										&scaled))
+			{
+				row_scales[row] = scale;
+				scale_counts[scale]++;
+				break;
+			}
+		}
+	}
+
+	/*
+	 * For numeric, the common scale is the most frequent one, and the values
+	 * with other scales are exceptions. For floats, any value is represented
+	 * at a larger scale as well, so we choose the smallest scale that leaves
+	 * few enough exceptions.
+	 */
+	int scale = -1;
+	if (element_type == NUMERICOID)
+	{
+		int best_count = 0;
+		for (int i = 0; i <= NUMERIC_MAX_POW10; i++)
+		{
+			if (scale_counts[i] > best_count)
+			{
+				best_count = scale_counts[i];
+				scale = i;
+			}
+		}
+	}
+	else
+	{
+		int representable = 0;
+		for (int i = 0; i <= NUMERIC_MAX_POW10; i++)
+		{
+			representable += scale_counts[i];
+			if (num_notnull - representable <= max_exceptions)
+			{
+				scale = i;
+				break;
+			}
+		}
+	}
+
+	uint16 *positions = palloc(sizeof(uint16) * num_values);
+	int num_exceptions = 0;
+	if (scale >= 0)
+	{
+		for (int row = 0; row < num_values; row++)
+		{
+			if (compressor->nulls[row])
+				continue;
+
+			bool regular;
+			if (element_type == NUMERICOID)
+				regular = row_scales[row] == scale;
+			else
+				regular = row_scales[row] >= 0 && row_scales[row] <= scale &&
+						  decimal_float_to_scaled(element_type,
+												  compressor->float_values[row],
+												  scale,
+												  &scaled_values[row]);
+
+			if (!regular)
+				positions[num_exceptions++] = row;
+		}
+	}
+
+	if (scale < 0 || num_exceptions > max_exceptions || num_exceptions == num_notnull)
+	{
+		pfree(row_scales);
+		pfree(scaled_values);
+		pfree(positions);
+		return decimal_compressor_finish_default(compressor);
+	}
+
+	/*
+	 * The exceptions are stored in the scaled values as a copy of the previous
+	 * value, so that they don't break the delta-delta encoding, and then
+	 * replaced at decompression.
+	 */
+	DeltaDeltaCompressor *values = delta_delta_compressor_alloc();
+	ArrayCompressor *exceptions = num_exceptions > 0 ? array_compressor_alloc(element_type) : NULL;
+	int64 previous = 0;
+	int exception_index = 0;
+	for (int row = 0; row < num_values; row++)
+	{
+		if (compressor->nulls[row])
+		{
+			delta_delta_compressor_append_null(values);
+			continue;
+		}
+
+		if (exception_index < num_exceptions && positions[exception_index] == row)
+		{
+			exception_index++;
+			delta_delta_compressor_append_value(values, previous);
+			switch (element_type)
+			{
+				case FLOAT8OID:
+					array_compressor_append(exceptions,
+											Float8GetDatum(compressor->float_values[row]));
+					break;
+				case FLOAT4OID:
+					array_compressor_append(exceptions,
+											Float4GetDatum((float) compressor->float_values[row]));
+					break;
+				default:
+					array_compressor_append(exceptions,
+											NumericGetDatum(compressor->numeric_values[row]));
+					break;
+			}
+			continue;
+		}
+
+		delta_delta_compressor_append_value(values, scaled_values[row]);
+		previous = scaled_values[row];
+	}
+
+	void *values_compressed = delta_delta_compressor_finish(values);
+	void *exceptions_compressed = exceptions != NULL ? array_compressor_finish(exceptions) : NULL;
+	DecimalCompressed *compressed = decimal_compressed_from_parts(element_type,
+																  scale,
+																  values_compressed,
+																  positions,
+																  num_exceptions,
+																  exceptions_compressed);
+
+	pfree(values_compressed);
+	if (exceptions_compressed != NULL)
+		pfree(exceptions_compressed);
+	pfree(row_scales);
+	pfree(scaled_values);
+	pfree(positions);
+	return compressed;
+}
+
+extern bool
+decimal_compressed_has_nulls(const CompressedDataHeader *header)
+{
+	const DecimalCompressed *compressed = (const DecimalCompressed *) header;
+	return deltadelta_compressed_has_nulls(
+		(const CompressedDataHeader *) compressed->alignment_sentinel);
+}
+
+static pg_attribute_always_inline DecompressResult
+decimal_decompression_iterator_get(DecimalDecompressionIterator *iter, int row)
+{
+	const ArrowArray *arrow = iter->arrow;
+	if (!arrow_row_is_valid(arrow->buffers[0], row))
+	{
+		return (DecompressResult){
+			.is_null = true,
+		};
+	}
+
+	switch (iter->base.element_type)
+	{
+		case FLOAT8OID:
+			return (DecompressResult){
+				.val = Float8GetDatum(((const float8 *) arrow->buffers[1])[row]),
+			};
+		case FLOAT4OID:
+			return (DecompressResult){
+				.val = Float4GetDatum(((const float4 *) arrow->buffers[1])[row]),
+			};
+		default:
+		{
+			Assert(iter->base.element_type == NUMERICOID);
+			const uint32 *offsets = (const uint32 *) arrow->buffers[1];
+			const uint8 *bodies = (const uint8 *) arrow->buffers[2];
+			const uint32 len = offsets[row + 1] - offsets[row];
+			struct varlena *result = palloc(VARHDRSZ + len);
+			SET_VARSIZE(result, VARHDRSZ + len);
+			memcpy(VARDATA(result), &bodies[offsets[row]], len);
+			return (DecompressResult){
+				.val = PointerGetDatum(result),
+			};
+		}
+	}
+}
+
+extern DecompressResult
+decimal_decompression_iterator_try_next_forward(DecompressionIterator *iter)
+{
+	Assert(iter->compression_algorithm == COMPRESSION_ALGORITHM_DECIMAL && iter->forward);
+
+	DecimalDecompressionIterator *decimal_iter = (DecimalDecompressionIterator *) iter;
+	if (decimal_iter->position >= decimal_iter->total_elements)
+		return (DecompressResult){
+			.is_done = true,
+		};
+
+	return decimal_decompression_iterator_get(decimal_iter, decimal_iter->position++);
+}
+
+extern DecompressionIterator *
+decimal_decompression_iterator_from_datum_forward(Datum decimal_compressed, Oid element_type)
+{
+	DecimalDecompressionIterator *iterator = palloc(sizeof(*iterator));
+	CheckCompressedData(DatumGetPointer(decimal_compressed) != NULL);
+	decompression_iterator_init(iterator,
+								(void *) PG_DETOAST_DATUM(decimal_compressed),
+								element_type,
+								true);
+	return &iterator->base;
+}
+
+extern DecompressResult
+decimal_decompression_iterator_try_next_reverse(DecompressionIterator *iter)
+{
+	Assert(iter->compression_algorithm == COMPRESSION_ALGORITHM_DECIMAL && !iter->forward);
+
+	DecimalDecompressionIterator *decimal_iter = (DecimalDecompressionIterator *) iter;
+	if (decimal_iter->position < 0)
+		return (DecompressResult){
+			.is_done = true,
+		};
+
+	return decimal_decompression_iterator_get(decimal_iter, decimal_iter->position--);
+}
+
+extern DecompressionIterator *
+decimal_decompression_iterator_from_datum_reverse(Datum decimal_compressed, Oid element_type)
+{
+	DecimalDecompressionIterator *iterator = palloc(sizeof(*iterator));
+	CheckCompressedData(DatumGetPointer(decimal_compressed) != NULL);
+	decompression_iterator_init(iterator,
+								(void *) PG_DETOAST_DATUM(decimal_compressed),
+								element_type,
+								false);
+	return &iterator->base;
+}
+
+extern void
+decimal_compressed_send(CompressedDataHeader *header, StringInfo buffer)
+{
+	const DecimalCompressed *data = (DecimalCompressed *) header;
+	Assert(header->compression_algorithm == COMPRESSION_ALGORITHM_DECIMAL);
+
+	pq_sendbyte(buffer, data->scale);
+	pq_sendint16(buffer, data->num_exceptions);
+	type_append_to_binary_string(data->element_type, buffer);
+
+	const char *ptr = (const char *) data->alignment_sentinel;
+	deltadelta_compressed_send((CompressedDataHeader *) ptr, buffer);
+	ptr += data->values_size;
+
+	const uint16 *positions = (const uint16 *) ptr;
+	for (uint32 i = 0; i < data->num_exceptions; i++)
+		pq_sendint16(buffer, positions[i]);
+	ptr += decimal_positions_size(data->num_exceptions);
+
+	if (data->num_exceptions > 0)
+		array_compressed_send((CompressedDataHeader *) ptr, buffer);
+}
+
+extern Datum
+decimal_compressed_recv(StringInfo buffer)
+{
+	const uint8 scale = pq_getmsgbyte(buffer);
+	CheckCompressedData(scale <= NUMERIC_MAX_POW10);
+	const uint16 num_exceptions = pq_getmsgint(buffer, 2);
+	CheckCompressedData(num_exceptions < GLOBAL_MAX_ROWS_PER_COMPRESSION);
+	const Oid element_type = binary_string_get_type(buffer);
+	CheckCompressedData(element_type == NUMERICOID || element_type == FLOAT4OID ||
+						element_type == FLOAT8OID);
+
+	Datum values = deltadelta_compressed_recv(buffer);
+	CheckCompressedData(VARSIZE(DatumGetPointer(values)) % sizeof(uint64) == 0);
+
+	uint16 *positions = palloc(sizeof(uint16) * Max(num_exceptions, 1));
+	for (uint32 i = 0; i < num_exceptions; i++)
+		positions[i] = pq_getmsgint(buffer, 2);
+
+	Datum exceptions = num_exceptions > 0 ? array_compressed_recv(buffer) : PointerGetDatum(NULL);
+
+	PG_RETURN_POINTER(decimal_compressed_from_parts(element_type,
+													scale,
+													DatumGetPointer(values),
+													positions,
+													num_exceptions,
+													DatumGetPointer(exceptions)));
+}
+
+extern Compressor *
+decimal_compressor_for_type(Oid element_type)
+{
+	ExtendedCompressor *compressor = palloc(sizeof(*compressor));
+	switch (element_type)
+	{
+		case NUMERICOID:
+		case FLOAT4OID:
+		case FLOAT8OID:
+			*compressor = (ExtendedCompressor){ .base = decimal_compressor_initializer,
+												.element_type = element_type };
+			return &compressor->base;
+		default:
+			elog(ERROR,
+				 "invalid type for decimal compressor \"%s\"",
+				 format_type_be(element_type));
+	}
+
+	pg_unreachable();
+}
+
+extern ArrowArray *
+decimal_decompress_all(Datum compressed, Oid element_type, MemoryContext dest_mctx)
+{
+	CheckCompressedData(DatumGetPointer(compressed) != NULL);
+
+	void *detoasted = PG_DETOAST_DATUM(compressed);
+	StringInfoData si = { .data = detoasted, .len = VARSIZE(detoasted) };
+	DecimalCompressed *header = consumeCompressedData(&si, sizeof(DecimalCompressed));
+
+	CheckCompressedData(header->compression_algorithm == COMPRESSION_ALGORITHM_DECIMAL);
+	CheckCompressedData(header->element_type == element_type);
+	CheckCompressedData(header->scale <= NUMERIC_MAX_POW10);
+	CheckCompressedData(header->num_exceptions < GLOBAL_MAX_ROWS_PER_COMPRESSION);
+	CheckCompressedData((header->num_exceptions == 0) == (header->exceptions_size == 0));
+
+	/* The values_size must accommodate the delta-delta header (24 bytes) */
+	CheckCompressedData(header->values_size > 24);
+	CheckCompressedData(header->values_size % sizeof(uint64) == 0);
+
+	/* A good enough to catch totally bogus values_size values, the actual limit is slightly
+	 * tighter */
+	CheckCompressedData(header->values_size <
+						(GLOBAL_MAX_ROWS_PER_COMPRESSION * (sizeof(uint64) + 1)));
+
+	char *values_data = consumeCompressedData(&si, header->values_size);
+	CheckCompressedData(VARSIZE(values_data) == header->values_size);
+	const uint16 *positions =
+		consumeCompressedData(&si, decimal_positions_size(header->num_exceptions));
+	char *exceptions_data = consumeCompressedData(&si, header->exceptions_size);
+	if (header->num_exceptions > 0)
+	{
+		/*
+		 * The nested array must fit into the region that the header accounts
+		 * for, otherwise its decompression could read past it.
+		 */
+		CheckCompressedData(header->exceptions_size >= sizeof(CompressedDataHeader));
+		CheckCompressedData(VARSIZE(exceptions_data) == header->exceptions_size);
+		CheckCompressedData(((CompressedDataHeader *) exceptions_data)->compression_algorithm ==
+							COMPRESSION_ALGORITHM_ARRAY);
+	}
+
+	const int scale = header->scale;
+	const int num_exceptions = header->num_exceptions;
+
+	MemoryContext old_context = MemoryContextSwitchTo(dest_mctx);
+
+	/*
+	 * The validity bitmap of the scaled values is directly usable in the
+	 * result array, but the values are converted to the element type.
+	 */
+	ArrowArray *scaled_array =
+		delta_delta_decompress_all(PointerGetDatum(values_data), INT8OID, CurrentMemoryContext);
+	const int n = scaled_array->length;
+	const uint64 *validity = scaled_array->buffers[0];
+	int64 *scaled_values = (int64 *) scaled_array->buffers[1];
+
+	/* The exceptions replace the non-null rows, in ascending order. */
+	Datum *exception_values = NULL;
+	Size exception_bytes = 0;
+	if (num_exceptions > 0)
+	{
+		exception_values = palloc(sizeof(Datum) * num_exceptions);
+		DecompressionIterator *iter =
+			tsl_array_decompression_iterator_from_datum_forward(PointerGetDatum(exceptions_data),
+																element_type);
+		for (int i = 0; i < num_exceptions; i++)
+		{
+			DecompressResult r = iter->try_next(iter);
+			CheckCompressedData(!r.is_done && !r.is_null);
+			CheckCompressedData(positions[i] < n);
+			CheckCompressedData(i == 0 || positions[i] > positions[i - 1]);
+			CheckCompressedData(arrow_row_is_valid(validity, positions[i]));
+			exception_values[i] = r.val;
+			if (element_type == NUMERICOID)
+				exception_bytes += VARSIZE_ANY_EXHDR(DatumGetPointer(r.val));
+		}
+		CheckCompressedData(iter->try_next(iter).is_done);
+	}
+
+	ArrowArray *result = scaled_array;
+	switch (element_type)
+	{
+		case FLOAT8OID:
+		{
+			float8 *restrict values =
+				palloc(sizeof(float8) * pad_to_multiple(64, n) + sizeof(uint64));
+			for (int row = 0; row < n; row++)
+				values[row] = decimal_float8_from_scaled(scaled_values[row], scale);
+			for (int i = 0; i < num_exceptions; i++)
+				values[positions[i]] = DatumGetFloat8(exception_values[i]);
+			scaled_array->buffers[1] = values;
+			break;
+		}
+		case FLOAT4OID:
+		{
+			float4 *restrict values =
+				palloc(sizeof(float4) * pad_to_multiple(64, n) + sizeof(uint64));
+			for (int row = 0; row < n; row++)
+				values[row] = decimal_float4_from_scaled(scaled_values[row], scale);
+			for (int i = 0; i < num_exceptions; i++)
+				values[positions[i]] = DatumGetFloat4(exception_values[i]);
+			scaled_array->buffers[1] = values;
+			break;
+		}
+		default:
+		{
+			/*
+			 * Numeric uses the same layout as text, with the bodies of the
+			 * numeric values without the varlena header.
+			 */
+			Assert(element_type == NUMERICOID);
+			uint32 *offsets = palloc(pad_to_multiple(64, sizeof(uint32) * (n + 1)));
+			uint8 *bodies =
+				palloc(pad_to_multiple(64, NUMERIC_FIXED_MAX_BODY_BYTES * n + exception_bytes));
+			uint32 offset = 0;
+			int exception_index = 0;
+			for (int row = 0; row < n; row++)
+			{
+				offsets[row] = offset;
+				if (!arrow_row_is_valid(validity, row))
+					continue;
+
+				if (exception_index < num_exceptions && positions[exception_index] == row)
+				{
+					const Datum value = exception_values[exception_index++];
+					const uint32 len = VARSIZE_ANY_EXHDR(DatumGetPointer(value));
+					memcpy(&bodies[offset], VARDATA_ANY(DatumGetPointer(value)), len);
+					offset += len;
+					continue;
+				}
+
+				const FixedNumeric fixed = { .mantissa = scaled_values[row], .scale = scale };
+				offset += numeric_body_from_fixed(fixed, &bodies[offset]);
+			}
+			offsets[n] = offset;
+
+			result = palloc0(sizeof(ArrowArray) + sizeof(void *) * 3);
+			const void **buffers = (const void **) &result[1];
+			buffers[0] = validity;
+			buffers[1] = offsets;
+			buffers[2] = bodies;
+			result->n_buffers = 3;
+			result->buffers = buffers;
+			result->length = n;
+			result->null_count = scaled_array->null_count;
+			pfree(scaled_array);
+			break;
+		}
+	}
+
+	pfree(scaled_values);
+	if (exception_values != NULL)
+		pfree(exception_values);
+	MemoryContextSwitchTo(old_context);
+
+	return result;
+}
+
+/*
+ * Local helpers
+ */
+static void
+decimal_compressor_append_datum(Compressor *compressor, Datum val)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = decimal_compressor_alloc(extended->element_type);
+
+	decimal_compressor_append_value(extended->internal, val);
+}
+
+static void
+decimal_compressor_append_null_value(Compressor *compressor)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = decimal_compressor_alloc(extended->element_type);
+
+	decimal_compressor_append_null(extended->internal);
+}
+
+static void *
+decimal_compressor_finish_and_reset(Compressor *compressor)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	void *compressed = NULL;
+	if (extended != NULL && extended->internal != NULL)
+	{
+		compressed = decimal_compressor_finish(extended->internal);
+		pfree(extended->internal);
+		extended->internal = NULL;
+	}
+	return compressed;
+}
+
+static void
+decompression_iterator_init(DecimalDecompressionIterator *iter, void *compressed,
+							Oid element_type, bool forward)
+{
+	ArrowArray *arrow_array =
+		decimal_decompress_all(PointerGetDatum(compressed), element_type, CurrentMemoryContext);
+	int32 total_elements = arrow_array->length;
+
+	*iter = (DecimalDecompressionIterator){
+		.base = { .compression_algorithm = COMPRESSION_ALGORITHM_DECIMAL,
+				  .forward = forward,
+				  .element_type = element_type,
+				  .try_next = (forward ? decimal_decompression_iterator_try_next_forward :
+										 decimal_decompression_iterator_try_next_reverse) },
+		.position = (forward ? 0 : total_elements - 1),
+		.total_elements = total_elements,
+		.arrow = arrow_array,
+	};
+}
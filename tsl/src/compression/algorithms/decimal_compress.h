@@ -0,0 +1,72 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#pragma once
+
+/*
+ * decimal_compress is used to encode the numeric and floating-point values
+ * that have few decimal digits after the point, like prices or meter readings.
+ * A common decimal scale is chosen for each batch, and the values are stored as
+ * integers multiplied by 10^scale:
+ *
+ *  - the scaled values : (delta-delta encoding)
+ *  - the positions of the exceptions that can't be represented at this scale
+ *  - the exception values : (array encoding)
+ *
+ * For numeric, the values are exact, and the exceptions are the values with a
+ * different display scale and the special values. For floats, only the values
+ * that are restored exactly from the scaled integer are encoded, similar to the
+ * ALP algorithm. If a batch has too many exceptions, it is compressed with the
+ * default algorithm for the type instead.
+ */
+
+#include <postgres.h>
+#include "compression/compression.h"
+#include <fmgr.h>
+#include <lib/stringinfo.h>
+
+typedef struct DecimalCompressor DecimalCompressor;
+typedef struct DecimalCompressed DecimalCompressed;
+
+/*
+ * Compressor framework functions and definitions for the decimal_compress algorithm.
+ */
+
+extern DecimalCompressor *decimal_compressor_alloc(Oid element_type);
+extern void decimal_compressor_append_null(DecimalCompressor *compressor);
+extern void decimal_compressor_append_value(DecimalCompressor *compressor, Datum next_val);
+extern void *decimal_compressor_finish(DecimalCompressor *compressor);
+extern bool decimal_compressed_has_nulls(const CompressedDataHeader *header);
+
+extern DecompressResult
+decimal_decompression_iterator_try_next_forward(DecompressionIterator *iter);
+
+extern DecompressionIterator *
+decimal_decompression_iterator_from_datum_forward(Datum decimal_compressed, Oid element_type);
+
+extern DecompressResult
+decimal_decompression_iterator_try_next_reverse(DecompressionIterator *iter);
+
+extern DecompressionIterator *
+decimal_decompression_iterator_from_datum_reverse(Datum decimal_compressed, Oid element_type);
+
+extern void decimal_compressed_send(CompressedDataHeader *header, StringInfo buffer);
+
+extern ArrowArray *decimal_decompress_all(Datum compressed, Oid element_type,
+										  MemoryContext dest_mctx);
+
+extern Datum decimal_compressed_recv(StringInfo buf);
+
+extern Compressor *decimal_compressor_for_type(Oid element_type);
+
+#define DECIMAL_COMPRESS_ALGORITHM_DEFINITION                                                      \
+	{                                                                                              \
+		.iterator_init_forward = decimal_decompression_iterator_from_datum_forward,                \
+		.iterator_init_reverse = decimal_decompression_iterator_from_datum_reverse,                \
+		.decompress_all = decimal_decompress_all, .compressed_data_send = decimal_compressed_send, \
+		.compressed_data_recv = decimal_compressed_recv,                                           \
+		.compressor_for_type = decimal_compressor_for_type,                                        \
+		.compressed_data_storage = TOAST_STORAGE_EXTERNAL,                                         \
+	}
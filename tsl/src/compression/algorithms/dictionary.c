@@ -687,7 +687,10 @@ tsl_text_dictionary_decompress_all(Datum compressed, Oid element_type, MemoryCon
 
 	/* Decompress the actual values in the dictionary. */
 	ArrowArray *dict =
-		text_array_decompress_all_serialized_no_header(&si, /* has_nulls = */ false, dest_mctx);
+		text_array_decompress_all_serialized_no_header(&si,
+													   /* has_nulls = */ false,
+													   /* selection = */ NULL,
+													   dest_mctx);
 	CheckCompressedData(header->num_distinct == dict->length);
 
 	uint64 *restrict validity_bitmap = NULL;
@@ -0,0 +1,1064 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include <postgres.h>
+#include <catalog/pg_type.h>
+#include <libpq/pqformat.h>
+#include <utils/builtins.h>
+#include <utils/hsearch.h>
+#include <utils/jsonb.h>
+#include <utils/memutils.h>
+#include <utils/numeric.h>
+
+#include "jsonb_compress.h"
+#include "compression/arrow_c_data_interface.h"
+#include "compression/compression.h"
+#include "dictionary.h"
+
+typedef enum JsonbFieldType
+{
+	JSONB_FIELD_STRING = 0,
+	JSONB_FIELD_NUMERIC = 1,
+	JSONB_FIELD_BOOL = 2,
+	JSONB_FIELD_TYPE_COUNT = 3, /* Must be last */
+} JsonbFieldType;
+
+/* The types of the columns that store the field values. */
+static const Oid jsonb_field_type_oids[JSONB_FIELD_TYPE_COUNT] = {
+	[JSONB_FIELD_STRING] = TEXTOID,
+	[JSONB_FIELD_NUMERIC] = NUMERICOID,
+	[JSONB_FIELD_BOOL] = BOOLOID,
+};
+
+typedef struct JsonbCompressed
+{
+	CompressedDataHeaderFields; /* this uses 5 bytes */
+	uint8 num_fields;
+	uint8 has_nulls;
+	uint8 padding;
+	uint32 keys_size;
+	uint32 residual_size;
+	/* 8-byte alignment sentinel for the following fields */
+	uint64 alignment_sentinel[FLEXIBLE_ARRAY_MEMBER];
+} JsonbCompressed;
+
+/*
+ * The header is followed by the descriptions of the fields, then by their
+ * names, then by the compressed data of the fields and of the residual
+ * documents. Each part is padded to 8 bytes.
+ */
+typedef struct JsonbCompressedField
+{
+	uint32 data_size;
+	uint16 key_len;
+	uint8 value_type;
+	uint8 padding;
+} JsonbCompressedField;
+
+static void
+pg_attribute_unused() assertions(void)
+{
+	StaticAssertStmt(sizeof(JsonbCompressed) == 16, "JsonbCompressed wrong size");
+	StaticAssertStmt(sizeof(JsonbCompressedField) == 8, "JsonbCompressedField wrong size");
+	StaticAssertStmt(offsetof(JsonbCompressed, alignment_sentinel) % MAXIMUM_ALIGNOF == 0,
+					 "variable sized data must be 8-byte aligned");
+}
+
+/*
+ * At most this many keys are shredded into separate columns for a batch. The
+ * key must occur with the same type of value in at least
+ * 1/JSONB_MIN_FIELD_FREQUENCY_DIVISOR of the non-null documents, and the long
+ * keys are never shredded.
+ */
+#define JSONB_MAX_FIELDS 16
+#define JSONB_MIN_FIELD_FREQUENCY_DIVISOR 2
+#define JSONB_MAX_KEY_BYTES 64
+
+/*
+ * A shredded field of the compressed batch.
+ */
+typedef struct JsonbField
+{
+	const char *key;
+	int key_len;
+	JsonbFieldType type;
+	/* The compressed data of the field values. */
+	Datum data;
+} JsonbField;
+
+/*
+ * The occurrences of a top-level key in the batch, by the type of the value.
+ */
+typedef struct JsonbKeyStats
+{
+	char key[JSONB_MAX_KEY_BYTES]; /* hash key, must be first */
+	int counts[JSONB_FIELD_TYPE_COUNT];
+} JsonbKeyStats;
+
+/*
+ * The jsonb compressor has to see all the documents of the batch to choose
+ * the fields, so it buffers them until finish.
+ */
+struct JsonbCompressor
+{
+	int32 num_values;
+	int32 num_nulls;
+	int32 capacity;
+	/* Detoasted copies of the documents, NULL for the null values. */
+	Jsonb **values;
+};
+
+typedef struct ExtendedCompressor
+{
+	Compressor base;
+	JsonbCompressor *internal;
+} ExtendedCompressor;
+
+typedef struct JsonbDecompressionIterator
+{
+	DecompressionIterator base;
+	int32 position;		  /* position within the total */
+	int32 total_elements; /* total number of entries plus nulls */
+	Datum *values;		  /* the reconstructed documents, zero for nulls */
+} JsonbDecompressionIterator;
+
+/*
+ * Local helpers
+ */
+static void jsonb_compressor_append_datum(Compressor *compressor, Datum val);
+static void jsonb_compressor_append_null_value(Compressor *compressor);
+static void *jsonb_compressor_finish_and_reset(Compressor *compressor);
+static void decompression_iterator_init(JsonbDecompressionIterator *iter, void *compressed,
+										Oid element_type, bool forward);
+
+const Compressor jsonb_compressor_initializer = {
+	.append_val = jsonb_compressor_append_datum,
+	.append_null = jsonb_compressor_append_null_value,
+	.is_full = NULL,
+	.finish = jsonb_compressor_finish_and_reset,
+};
+
+static inline uint32
+jsonb_padded_size(uint32 size)
+{
+	return pad_to_multiple(sizeof(uint64), size);
+}
+
+/*
+ * The type of the field for a jsonb value, or -1 if such values are not
+ * shredded.
+ */
+static int
+jsonb_value_field_type(const JsonbValue *value)
+{
+	switch (value->type)
+	{
+		case jbvString:
+			return JSONB_FIELD_STRING;
+		case jbvNumeric:
+			return JSONB_FIELD_NUMERIC;
+		case jbvBool:
+			return JSONB_FIELD_BOOL;
+		default:
+			return -1;
+	}
+}
+
+static Datum
+jsonb_field_value_to_datum(const JsonbValue *value)
+{
+	switch (value->type)
+	{
+		case jbvString:
+			return PointerGetDatum(
+				cstring_to_text_with_len(value->val.string.val, value->val.string.len));
+		case jbvNumeric:
+			return NumericGetDatum(value->val.numeric);
+		case jbvBool:
+			return BoolGetDatum(value->val.boolean);
+		default:
+			elog(ERROR, "unexpected jsonb value type %d for a field", value->type);
+			pg_unreachable();
+	}
+}
+
+static void
+jsonb_field_value_from_datum(JsonbFieldType type, Datum datum, JsonbValue *value)
+{
+	switch (type)
+	{
+		case JSONB_FIELD_STRING:
+		{
+			text *str = DatumGetTextPP(datum);
+			value->type = jbvString;
+			value->val.string.val = VARDATA_ANY(str);
+			value->val.string.len = VARSIZE_ANY_EXHDR(str);
+			break;
+		}
+		case JSONB_FIELD_NUMERIC:
+			value->type = jbvNumeric;
+			value->val.numeric = DatumGetNumeric(datum);
+			break;
+		case JSONB_FIELD_BOOL:
+			value->type = jbvBool;
+			value->val.boolean = DatumGetBool(datum);
+			break;
+		default:
+			CheckCompressedData(false);
+	}
+}
+
+/*
+ * Append the text representation of the value, the same as the ->> operator
+ * returns. The value must not be a json null.
+ */
+static void
+jsonb_value_append_text(const JsonbValue *value, StringInfo out)
+{
+	switch (value->type)
+	{
+		case jbvString:
+			appendBinaryStringInfo(out, value->val.string.val, value->val.string.len);
+			break;
+		case jbvNumeric:
+			appendStringInfoString(out,
+								   DatumGetCString(
+									   DirectFunctionCall1(numeric_out,
+														   NumericGetDatum(value->val.numeric))));
+			break;
+		case jbvBool:
+			appendStringInfoString(out, value->val.boolean ? "true" : "false");
+			break;
+		case jbvBinary:
+			JsonbToCString(out, value->val.binary.data, value->val.binary.len);
+			break;
+		default:
+			elog(ERROR, "unexpected jsonb value type %d", value->type);
+	}
+}
+
+static int
+jsonb_find_field(const JsonbField *fields, int num_fields, const char *key, int key_len)
+{
+	for (int i = 0; i < num_fields; i++)
+	{
+		if (fields[i].key_len == key_len && memcmp(fields[i].key, key, key_len) == 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+static bool
+jsonb_nested_algorithm_valid(uint8 algorithm)
+{
+	return algorithm > _INVALID_COMPRESSION_ALGORITHM && algorithm < _END_COMPRESSION_ALGORITHMS &&
+		   algorithm != COMPRESSION_ALGORITHM_NULL && algorithm != COMPRESSION_ALGORITHM_JSONB;
+}
+
+static DecompressionIterator *
+jsonb_nested_iterator(Datum nested, Oid element_type)
+{
+	const CompressedDataHeader *header = (const CompressedDataHeader *) DatumGetPointer(nested);
+	return tsl_get_decompression_iterator_init(header->compression_algorithm,
+											   /* reverse = */ false)(nested, element_type);
+}
+
+static void
+jsonb_nested_send(Datum nested, StringInfo buffer)
+{
+	CompressedDataHeader *header = (CompressedDataHeader *) DatumGetPointer(nested);
+	pq_sendbyte(buffer, header->compression_algorithm);
+	algorithm_definition(header->compression_algorithm)->compressed_data_send(header, buffer);
+}
+
+static Datum
+jsonb_nested_recv(StringInfo buffer)
+{
+	const uint8 algorithm = pq_getmsgbyte(buffer);
+	CheckCompressedData(jsonb_nested_algorithm_valid(algorithm));
+	return algorithm_definition(algorithm)->compressed_data_recv(buffer);
+}
+
+static Datum
+jsonb_consume_nested(StringInfo si, uint32 size)
+{
+	CheckCompressedData(size >= sizeof(CompressedDataHeader));
+	CompressedDataHeader *nested = consumeCompressedData(si, jsonb_padded_size(size));
+	CheckCompressedData(VARSIZE(nested) == size);
+	CheckCompressedData(jsonb_nested_algorithm_valid(nested->compression_algorithm));
+	return PointerGetDatum(nested);
+}
+
+/*
+ * Find the fields and the residual documents in the compressed data. The
+ * returned pointers point into the compressed data.
+ */
+static int
+jsonb_compressed_parse(void *detoasted, JsonbField *fields, Datum *residual)
+{
+	StringInfoData si = { .data = detoasted, .len = VARSIZE(detoasted) };
+	JsonbCompressed *header = consumeCompressedData(&si, sizeof(JsonbCompressed));
+	CheckCompressedData(header->compression_algorithm == COMPRESSION_ALGORITHM_JSONB);
+	CheckCompressedData(header->num_fields > 0 && header->num_fields <= JSONB_MAX_FIELDS);
+
+	const int num_fields = header->num_fields;
+	const JsonbCompressedField *stored_fields =
+		consumeCompressedData(&si, sizeof(JsonbCompressedField) * num_fields);
+	const char *keys = consumeCompressedData(&si, header->keys_size);
+	uint32 key_offset = 0;
+	for (int i = 0; i < num_fields; i++)
+	{
+		const JsonbCompressedField *stored = &stored_fields[i];
+		CheckCompressedData(stored->value_type < JSONB_FIELD_TYPE_COUNT);
+		CheckCompressedData(stored->key_len < JSONB_MAX_KEY_BYTES);
+		CheckCompressedData(stored->key_len <= header->keys_size - key_offset);
+
+		fields[i] = (JsonbField){
+			.key = keys + key_offset,
+			.key_len = stored->key_len,
+			.type = stored->value_type,
+			.data = jsonb_consume_nested(&si, stored->data_size),
+		};
+		key_offset += stored->key_len;
+	}
+
+	*residual = jsonb_consume_nested(&si, header->residual_size);
+	return num_fields;
+}
+
+static JsonbCompressed *
+jsonb_compressed_from_parts(const JsonbField *fields, int num_fields, Datum residual,
+							bool has_nulls)
+{
+	uint32 keys_size = 0;
+	Size total_size = sizeof(JsonbCompressed) + sizeof(JsonbCompressedField) * num_fields;
+	for (int i = 0; i < num_fields; i++)
+	{
+		keys_size += fields[i].key_len;
+		total_size += jsonb_padded_size(VARSIZE(DatumGetPointer(fields[i].data)));
+	}
+	keys_size = jsonb_padded_size(keys_size);
+	const uint32 residual_size = VARSIZE(DatumGetPointer(residual));
+	total_size += keys_size + jsonb_padded_size(residual_size);
+	CheckCompressedData(total_size <= MaxAllocSize);
+
+	/* Zero the padding so that the compressed data is deterministic. */
+	char *data = palloc0(total_size);
+	JsonbCompressed *compressed = (JsonbCompressed *) data;
+	SET_VARSIZE(&compressed->vl_len_, total_size);
+	compressed->compression_algorithm = COMPRESSION_ALGORITHM_JSONB;
+	compressed->num_fields = num_fields;
+	compressed->has_nulls = has_nulls;
+	compressed->keys_size = keys_size;
+	compressed->residual_size = residual_size;
+
+	JsonbCompressedField *stored_fields = (JsonbCompressedField *) compressed->alignment_sentinel;
+	char *keys = (char *) &stored_fields[num_fields];
+	char *ptr = keys + keys_size;
+	for (int i = 0; i < num_fields; i++)
+	{
+		const uint32 data_size = VARSIZE(DatumGetPointer(fields[i].data));
+		stored_fields[i] = (JsonbCompressedField){
+			.data_size = data_size,
+			.key_len = fields[i].key_len,
+			.value_type = fields[i].type,
+		};
+		memcpy(keys, fields[i].key, fields[i].key_len);
+		keys += fields[i].key_len;
+		memcpy(ptr, DatumGetPointer(fields[i].data), data_size);
+		ptr += jsonb_padded_size(data_size);
+	}
+	memcpy(ptr, DatumGetPointer(residual), residual_size);
+
+	return compressed;
+}
+
+/*
+ * Compressor framework functions and definitions for the jsonb_compress algorithm.
+ */
+
+extern JsonbCompressor *
+jsonb_compressor_alloc(void)
+{
+	JsonbCompressor *compressor = palloc0(sizeof(*compressor));
+	compressor->capacity = TARGET_COMPRESSED_BATCH_SIZE;
+	compressor->values = palloc(sizeof(Jsonb *) * compressor->capacity);
+	return compressor;
+}
+
+static void
+jsonb_compressor_append(JsonbCompressor *compressor, Jsonb *value)
+{
+	if (compressor->num_values >= compressor->capacity)
+	{
+		compressor->capacity *= 2;
+		compressor->values =
+			repalloc(compressor->values, sizeof(Jsonb *) * compressor->capacity);
+	}
+	compressor->values[compressor->num_values++] = value;
+}
+
+extern void
+jsonb_compressor_append_null(JsonbCompressor *compressor)
+{
+	jsonb_compressor_append(compressor, NULL);
+	compressor->num_nulls++;
+}
+
+extern void
+jsonb_compressor_append_value(JsonbCompressor *compressor, Datum next_val)
+{
+	jsonb_compressor_append(compressor, DatumGetJsonbPCopy(next_val));
+}
+
+static int
+compare_key_stats(const void *a, const void *b)
+{
+	const JsonbKeyStats *sa = *(const JsonbKeyStats *const *) a;
+	const JsonbKeyStats *sb = *(const JsonbKeyStats *const *) b;
+	int count_a = 0;
+	int count_b = 0;
+	for (int i = 0; i < JSONB_FIELD_TYPE_COUNT; i++)
+	{
+		count_a = Max(count_a, sa->counts[i]);
+		count_b = Max(count_b, sb->counts[i]);
+	}
+
+	if (count_a != count_b)
+	{
+		return count_a > count_b ? -1 : 1;
+	}
+	return strcmp(sa->key, sb->key);
+}
+
+/*
+ * Choose the keys to shred into separate columns: the most frequent ones with
+ * the most frequent type of value for each.
+ */
+static int
+jsonb_compressor_choose_fields(JsonbCompressor *compressor, JsonbField *fields)
+{
+	const int num_notnull = compressor->num_values - compressor->num_nulls;
+
+	HASHCTL ctl = {
+		.keysize = JSONB_MAX_KEY_BYTES,
+		.entrysize = sizeof(JsonbKeyStats),
+		.hcxt = CurrentMemoryContext,
+	};
+	HTAB *stats = hash_create("jsonb compression key stats",
+							  64,
+							  &ctl,
+							  HASH_ELEM | HASH_STRINGS | HASH_CONTEXT);
+
+	for (int row = 0; row < compressor->num_values; row++)
+	{
+		Jsonb *jb = compressor->values[row];
+		if (jb == NULL || !JB_ROOT_IS_OBJECT(jb))
+			continue;
+
+		JsonbIterator *it = JsonbIteratorInit(&jb->root);
+		JsonbValue key;
+		JsonbValue value;
+		JsonbIteratorToken token;
+		while ((token = JsonbIteratorNext(&it, &key, /* skipNested = */ true)) != WJB_DONE)
+		{
+			if (token != WJB_KEY)
+				continue;
+
+			token = JsonbIteratorNext(&it, &value, /* skipNested = */ true);
+			Assert(token == WJB_VALUE);
+
+			const int type = jsonb_value_field_type(&value);
+			if (type < 0 || key.val.string.len >= JSONB_MAX_KEY_BYTES)
+				continue;
+
+			char keybuf[JSONB_MAX_KEY_BYTES];
+			memcpy(keybuf, key.val.string.val, key.val.string.len);
+			keybuf[key.val.string.len] = '\0';
+
+			bool found;
+			JsonbKeyStats *entry = hash_search(stats, keybuf, HASH_ENTER, &found);
+			if (!found)
+				memset(entry->counts, 0, sizeof(entry->counts));
+			entry->counts[type]++;
+		}
+	}
+
+	JsonbKeyStats **candidates =
+		palloc(sizeof(JsonbKeyStats *) * (hash_get_num_entries(stats) + 1));
+	int num_candidates = 0;
+	HASH_SEQ_STATUS status;
+	hash_seq_init(&status, stats);
+	for (JsonbKeyStats *entry = hash_seq_search(&status); entry != NULL;
+		 entry = hash_seq_search(&status))
+	{
+		for (int type = 0; type < JSONB_FIELD_TYPE_COUNT; type++)
+		{
+			if (entry->counts[type] * JSONB_MIN_FIELD_FREQUENCY_DIVISOR >= num_notnull)
+			{
+				candidates[num_candidates++] = entry;
+				break;
+			}
+		}
+	}
+
+	qsort(candidates, num_candidates, sizeof(*candidates), compare_key_stats);
+
+	const int num_fields = Min(num_candidates, JSONB_MAX_FIELDS);
+	for (int i = 0; i < num_fields; i++)
+	{
+		int best_type = 0;
+		for (int type = 1; type < JSONB_FIELD_TYPE_COUNT; type++)
+		{
+			if (candidates[i]->counts[type] > candidates[i]->counts[best_type])
+				best_type = type;
+		}
+
+		fields[i] = (JsonbField){
+			.key = candidates[i]->key,
+			.key_len = strlen(candidates[i]->key),
+			.type = best_type,
+		};
+	}
+
+	pfree(candidates);
+	return num_fields;
+}
+
+/*
+ * Compress the batch with the default algorithm for jsonb, for when it has no
+ * frequent keys.
+ */
+static void *
+jsonb_compressor_finish_default(JsonbCompressor *compressor)
+{
+	DictionaryCompressor *dictionary = dictionary_compressor_alloc(JSONBOID);
+	for (int row = 0; row < compressor->num_values; row++)
+	{
+		if (compressor->values[row] == NULL)
+			dictionary_compressor_append_null(dictionary);
+		else
+			dictionary_compressor_append(dictionary, JsonbPGetDatum(compressor->values[row]));
+	}
+	return dictionary_compressor_finish(dictionary);
+}
+
+extern void *
+jsonb_compressor_finish(JsonbCompressor *compressor)
+{
+	if (compressor == NULL)
+		return NULL;
+
+	if (compressor->num_values == compressor->num_nulls)
+		return NULL;
+
+	JsonbField fields[JSONB_MAX_FIELDS];
+	const int num_fields = jsonb_compressor_choose_fields(compressor, fields);
+	if (num_fields == 0)
+		return jsonb_compressor_finish_default(compressor);
+
+	Compressor *field_compressors[JSONB_MAX_FIELDS];
+	for (int i = 0; i < num_fields; i++)
+	{
+		const Oid type = jsonb_field_type_oids[fields[i].type];
+		field_compressors[i] =
+			algorithm_definition(compression_get_default_algorithm(type))->compressor_for_type(
+				type);
+	}
+
+	/*
+	 * Split the documents into the field values and the residual documents
+	 * with the rest of the keys. The values of a field that have a different
+	 * type stay in the residual documents.
+	 */
+	DictionaryCompressor *residual = dictionary_compressor_alloc(JSONBOID);
+	for (int row = 0; row < compressor->num_values; row++)
+	{
+		Jsonb *jb = compressor->values[row];
+		bool present[JSONB_MAX_FIELDS] = { 0 };
+		if (jb == NULL)
+		{
+			dictionary_compressor_append_null(residual);
+		}
+		else if (!JB_ROOT_IS_OBJECT(jb))
+		{
+			dictionary_compressor_append(residual, JsonbPGetDatum(jb));
+		}
+		else
+		{
+			JsonbParseState *state = NULL;
+			pushJsonbValue(&state, WJB_BEGIN_OBJECT, NULL);
+
+			JsonbIterator *it = JsonbIteratorInit(&jb->root);
+			JsonbValue key;
+			JsonbValue value;
+			JsonbIteratorToken token;
+			while ((token = JsonbIteratorNext(&it, &key, /* skipNested = */ true)) != WJB_DONE)
+			{
+				if (token != WJB_KEY)
+					continue;
+
+				token = JsonbIteratorNext(&it, &value, /* skipNested = */ true);
+				Assert(token == WJB_VALUE);
+
+				const int field =
+					jsonb_find_field(fields, num_fields, key.val.string.val, key.val.string.len);
+				if (field >= 0 && (int) fields[field].type == jsonb_value_field_type(&value))
+				{
+					field_compressors[field]->append_val(field_compressors[field],
+														 jsonb_field_value_to_datum(&value));
+					present[field] = true;
+				}
+				else
+				{
+					pushJsonbValue(&state, WJB_KEY, &key);
+					pushJsonbValue(&state, WJB_VALUE, &value);
+				}
+			}
+
+			JsonbValue *result = pushJsonbValue(&state, WJB_END_OBJECT, NULL);
+			dictionary_compressor_append(residual, JsonbPGetDatum(JsonbValueToJsonb(result)));
+		}
+
+		for (int i = 0; i < num_fields; i++)
+		{
+			if (!present[i])
+				field_compressors[i]->append_null(field_compressors[i]);
+		}
+	}
+
+	for (int i = 0; i < num_fields; i++)
+	{
+		void *field_compressed = field_compressors[i]->finish(field_compressors[i]);
+		Ensure(field_compressed != NULL, "no values for jsonb field \"%s\"", fields[i].key);
+		fields[i].data = PointerGetDatum(field_compressed);
+	}
+
+	return jsonb_compressed_from_parts(fields,
+									   num_fields,
+									   PointerGetDatum(dictionary_compressor_finish(residual)),
+									   compressor->num_nulls > 0);
+}
+
+extern bool
+jsonb_compressed_has_nulls(const CompressedDataHeader *header)
+{
+	const JsonbCompressed *compressed = (const JsonbCompressed *) header;
+	return compressed->has_nulls;
+}
+
+/*
+ * Add the field values back into the residual document.
+ */
+static Datum
+jsonb_merge_fields(Jsonb *residual, const JsonbField *fields, const DecompressResult *values,
+				   int num_fields)
+{
+	JsonbParseState *state = NULL;
+	JsonbValue *result = NULL;
+	JsonbIterator *it = JsonbIteratorInit(&residual->root);
+	JsonbValue v;
+	JsonbIteratorToken token;
+	while ((token = JsonbIteratorNext(&it, &v, /* skipNested = */ true)) != WJB_DONE)
+	{
+		if (token == WJB_END_OBJECT)
+		{
+			for (int i = 0; i < num_fields; i++)
+			{
+				if (values[i].is_null)
+					continue;
+
+				JsonbValue key = {
+					.type = jbvString,
+					.val.string = { .len = fields[i].key_len, .val = (char *) fields[i].key },
+				};
+				JsonbValue value;
+				jsonb_field_value_from_datum(fields[i].type, values[i].val, &value);
+				pushJsonbValue(&state, WJB_KEY, &key);
+				pushJsonbValue(&state, WJB_VALUE, &value);
+			}
+		}
+
+		result = pushJsonbValue(&state, token, token < WJB_BEGIN_ARRAY ? &v : NULL);
+	}
+
+	return JsonbPGetDatum(JsonbValueToJsonb(result));
+}
+
+/*
+ * Reconstruct all the documents of the compressed batch.
+ */
+static Datum *
+jsonb_decompress_documents(void *detoasted, int *num_values)
+{
+	JsonbField fields[JSONB_MAX_FIELDS];
+	Datum residual;
+	const int num_fields = jsonb_compressed_parse(detoasted, fields, &residual);
+
+	DecompressionIterator *residual_iter = jsonb_nested_iterator(residual, JSONBOID);
+	DecompressionIterator *field_iters[JSONB_MAX_FIELDS];
+	for (int i = 0; i < num_fields; i++)
+	{
+		field_iters[i] =
+			jsonb_nested_iterator(fields[i].data, jsonb_field_type_oids[fields[i].type]);
+	}
+
+	int capacity = TARGET_COMPRESSED_BATCH_SIZE;
+	int n = 0;
+	Datum *values = palloc(sizeof(Datum) * capacity);
+	for (DecompressResult r = residual_iter->try_next(residual_iter); !r.is_done;
+		 r = residual_iter->try_next(residual_iter))
+	{
+		CheckCompressedData(n < GLOBAL_MAX_ROWS_PER_COMPRESSION);
+		if (n >= capacity)
+		{
+			capacity *= 2;
+			values = repalloc(values, sizeof(Datum) * capacity);
+		}
+
+		DecompressResult field_values[JSONB_MAX_FIELDS];
+		bool have_fields = false;
+		for (int i = 0; i < num_fields; i++)
+		{
+			field_values[i] = field_iters[i]->try_next(field_iters[i]);
+			CheckCompressedData(!field_values[i].is_done);
+			have_fields |= !field_values[i].is_null;
+		}
+
+		if (r.is_null)
+		{
+			CheckCompressedData(!have_fields);
+			values[n++] = (Datum) 0;
+			continue;
+		}
+
+		Jsonb *residual_doc = DatumGetJsonbP(r.val);
+		if (!have_fields)
+		{
+			values[n++] = JsonbPGetDatum(residual_doc);
+			continue;
+		}
+
+		CheckCompressedData(JB_ROOT_IS_OBJECT(residual_doc));
+		values[n++] = jsonb_merge_fields(residual_doc, fields, field_values, num_fields);
+	}
+
+	for (int i = 0; i < num_fields; i++)
+	{
+		CheckCompressedData(field_iters[i]->try_next(field_iters[i]).is_done);
+	}
+
+	*num_values = n;
+	return values;
+}
+
+extern DecompressResult
+jsonb_decompression_iterator_try_next_forward(DecompressionIterator *iter)
+{
+	Assert(iter->compression_algorithm == COMPRESSION_ALGORITHM_JSONB && iter->forward);
+	Assert(iter->element_type == JSONBOID);
+
+	JsonbDecompressionIterator *jsonb_iter = (JsonbDecompressionIterator *) iter;
+	if (jsonb_iter->position >= jsonb_iter->total_elements)
+		return (DecompressResult){
+			.is_done = true,
+		};
+
+	const Datum value = jsonb_iter->values[jsonb_iter->position++];
+	return (DecompressResult){
+		.val = value,
+		.is_null = value == (Datum) 0,
+	};
+}
+
+extern DecompressionIterator *
+jsonb_decompression_iterator_from_datum_forward(Datum jsonb_compressed, Oid element_type)
+{
+	JsonbDecompressionIterator *iterator = palloc(sizeof(*iterator));
+	CheckCompressedData(DatumGetPointer(jsonb_compressed) != NULL);
+	decompression_iterator_init(iterator,
+								(void *) PG_DETOAST_DATUM(jsonb_compressed),
+								element_type,
+								true);
+	return &iterator->base;
+}
+
+extern DecompressResult
+jsonb_decompression_iterator_try_next_reverse(DecompressionIterator *iter)
+{
+	Assert(iter->compression_algorithm == COMPRESSION_ALGORITHM_JSONB && !iter->forward);
+	Assert(iter->element_type == JSONBOID);
+
+	JsonbDecompressionIterator *jsonb_iter = (JsonbDecompressionIterator *) iter;
+	if (jsonb_iter->position < 0)
+		return (DecompressResult){
+			.is_done = true,
+		};
+
+	const Datum value = jsonb_iter->values[jsonb_iter->position--];
+	return (DecompressResult){
+		.val = value,
+		.is_null = value == (Datum) 0,
+	};
+}
+
+extern DecompressionIterator *
+jsonb_decompression_iterator_from_datum_reverse(Datum jsonb_compressed, Oid element_type)
+{
+	JsonbDecompressionIterator *iterator = palloc(sizeof(*iterator));
+	CheckCompressedData(DatumGetPointer(jsonb_compressed) != NULL);
+	decompression_iterator_init(iterator,
+								(void *) PG_DETOAST_DATUM(jsonb_compressed),
+								element_type,
+								false);
+	return &iterator->base;
+}
+
+extern void
+jsonb_compressed_send(CompressedDataHeader *header, StringInfo buffer)
+{
+	const JsonbCompressed *data = (JsonbCompressed *) header;
+	Assert(header->compression_algorithm == COMPRESSION_ALGORITHM_JSONB);
+
+	JsonbField fields[JSONB_MAX_FIELDS];
+	Datum residual;
+	const int num_fields = jsonb_compressed_parse(header, fields, &residual);
+
+	pq_sendbyte(buffer, num_fields);
+	pq_sendbyte(buffer, data->has_nulls);
+	for (int i = 0; i < num_fields; i++)
+	{
+		pq_sendbyte(buffer, fields[i].type);
+		pq_sendint16(buffer, fields[i].key_len);
+		pq_sendbytes(buffer, fields[i].key, fields[i].key_len);
+		jsonb_nested_send(fields[i].data, buffer);
+	}
+	jsonb_nested_send(residual, buffer);
+}
+
+extern Datum
+jsonb_compressed_recv(StringInfo buffer)
+{
+	const uint8 num_fields = pq_getmsgbyte(buffer);
+	CheckCompressedData(num_fields > 0 && num_fields <= JSONB_MAX_FIELDS);
+	const bool has_nulls = pq_getmsgbyte(buffer) != 0;
+
+	JsonbField fields[JSONB_MAX_FIELDS];
+	for (int i = 0; i < num_fields; i++)
+	{
+		const uint8 type = pq_getmsgbyte(buffer);
+		CheckCompressedData(type < JSONB_FIELD_TYPE_COUNT);
+		const uint16 key_len = pq_getmsgint(buffer, 2);
+		CheckCompressedData(key_len < JSONB_MAX_KEY_BYTES);
+		fields[i] = (JsonbField){
+			.type = type,
+			.key_len = key_len,
+			.key = pq_getmsgbytes(buffer, key_len),
+		};
+		fields[i].data = jsonb_nested_recv(buffer);
+	}
+	Datum residual = jsonb_nested_recv(buffer);
+
+	PG_RETURN_POINTER(jsonb_compressed_from_parts(fields, num_fields, residual, has_nulls));
+}
+
+extern Compressor *
+jsonb_compressor_for_type(Oid element_type)
+{
+	ExtendedCompressor *compressor = palloc(sizeof(*compressor));
+	switch (element_type)
+	{
+		case JSONBOID:
+			*compressor = (ExtendedCompressor){ .base = jsonb_compressor_initializer };
+			return &compressor->base;
+		default:
+			elog(ERROR, "invalid type for jsonb compressor \"%s\"", format_type_be(element_type));
+	}
+
+	pg_unreachable();
+}
+
+/*
+ * The result of "jb ->> key" for a single document, or NULL.
+ */
+extern text *
+jsonb_get_field_text(Jsonb *jb, const char *key, int keylen)
+{
+	if (!JB_ROOT_IS_OBJECT(jb))
+		return NULL;
+
+	JsonbValue vbuf;
+	JsonbValue *value = getKeyJsonValueFromContainer(&jb->root, key, keylen, &vbuf);
+	if (value == NULL || value->type == jbvNull)
+		return NULL;
+
+	StringInfoData buf;
+	initStringInfo(&buf);
+	jsonb_value_append_text(value, &buf);
+	return cstring_to_text_with_len(buf.data, buf.len);
+}
+
+/*
+ * Compute "column ->> key" for all rows of a compressed batch of jsonb, as an
+ * arrow array of text. If the key is shredded into a separate column, we
+ * don't have to reconstruct the documents, and only have to look into the
+ * residual documents for the rows where the field has a value of another type.
+ * This works for the batches compressed with the other algorithms as well, by
+ * looking into the entire documents.
+ *
+ * The result is allocated in dest_mctx, and the temporary allocations are
+ * made in the current memory context.
+ */
+extern ArrowArray *
+jsonb_compressed_field_text(Datum compressed, int n_rows, const char *key, int keylen,
+							MemoryContext dest_mctx)
+{
+	CompressedDataHeader *header = (CompressedDataHeader *) PG_DETOAST_DATUM(compressed);
+	Assert(header->compression_algorithm != COMPRESSION_ALGORITHM_NULL);
+
+	Datum residual = PointerGetDatum(header);
+	DecompressionIterator *field_iter = NULL;
+	JsonbField fields[JSONB_MAX_FIELDS];
+	int field = -1;
+	if (header->compression_algorithm == COMPRESSION_ALGORITHM_JSONB)
+	{
+		const int num_fields = jsonb_compressed_parse(header, fields, &residual);
+		field = jsonb_find_field(fields, num_fields, key, keylen);
+		if (field >= 0)
+		{
+			const Oid field_type = jsonb_field_type_oids[fields[field].type];
+			field_iter = jsonb_nested_iterator(fields[field].data, field_type);
+		}
+	}
+	DecompressionIterator *residual_iter = jsonb_nested_iterator(residual, JSONBOID);
+
+	uint64 *validity = MemoryContextAllocZero(dest_mctx, pad_to_multiple(64, n_rows) / 8);
+	uint32 *offsets =
+		MemoryContextAlloc(dest_mctx, pad_to_multiple(64, sizeof(uint32) * (n_rows + 1)));
+	StringInfoData bodies;
+	MemoryContext old_context = MemoryContextSwitchTo(dest_mctx);
+	initStringInfo(&bodies);
+	MemoryContextSwitchTo(old_context);
+
+	int row = 0;
+	int null_count = 0;
+	for (DecompressResult r = residual_iter->try_next(residual_iter); !r.is_done;
+		 r = residual_iter->try_next(residual_iter))
+	{
+		CheckCompressedData(row < n_rows);
+		offsets[row] = bodies.len;
+
+		bool valid = false;
+		if (field_iter != NULL)
+		{
+			DecompressResult f = field_iter->try_next(field_iter);
+			CheckCompressedData(!f.is_done);
+			if (!f.is_null)
+			{
+				JsonbValue value;
+				jsonb_field_value_from_datum(fields[field].type, f.val, &value);
+				jsonb_value_append_text(&value, &bodies);
+				valid = true;
+			}
+		}
+
+		if (!valid && !r.is_null)
+		{
+			Jsonb *jb = DatumGetJsonbP(r.val);
+			if (JB_ROOT_IS_OBJECT(jb))
+			{
+				JsonbValue vbuf;
+				JsonbValue *value = getKeyJsonValueFromContainer(&jb->root, key, keylen, &vbuf);
+				if (value != NULL && value->type != jbvNull)
+				{
+					jsonb_value_append_text(value, &bodies);
+					valid = true;
+				}
+			}
+		}
+
+		arrow_set_row_validity(validity, row, valid);
+		null_count += !valid;
+		row++;
+	}
+	CheckCompressedData(row == n_rows);
+	CheckCompressedData(field_iter == NULL || field_iter->try_next(field_iter).is_done);
+	offsets[n_rows] = bodies.len;
+
+	/* Pad the bodies the same way as the other text arrays. */
+	enlargeStringInfo(&bodies, pad_to_multiple(64, bodies.len) - bodies.len);
+
+	ArrowArray *result = MemoryContextAllocZero(dest_mctx, sizeof(ArrowArray) + sizeof(void *) * 3);
+	const void **buffers = (const void **) &result[1];
+	buffers[0] = validity;
+	buffers[1] = offsets;
+	buffers[2] = bodies.data;
+	result->n_buffers = 3;
+	result->buffers = buffers;
+	result->length = n_rows;
+	result->null_count = null_count;
+	return result;
+}
+
+/*
+ * Local helpers
+ */
+static void
+jsonb_compressor_append_datum(Compressor *compressor, Datum val)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = jsonb_compressor_alloc();
+
+	jsonb_compressor_append_value(extended->internal, val);
+}
+
+static void
+jsonb_compressor_append_null_value(Compressor *compressor)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = jsonb_compressor_alloc();
+
+	jsonb_compressor_append_null(extended->internal);
+}
+
+static void *
+jsonb_compressor_finish_and_reset(Compressor *compressor)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	void *compressed = NULL;
+	if (extended != NULL && extended->internal != NULL)
+	{
+		compressed = jsonb_compressor_finish(extended->internal);
+		pfree(extended->internal);
+		extended->internal = NULL;
+	}
+	return compressed;
+}
+
+static void
+decompression_iterator_init(JsonbDecompressionIterator *iter, void *compressed, Oid element_type,
+							bool forward)
+{
+	Assert(element_type == JSONBOID);
+
+	int total_elements = 0;
+	Datum *values = jsonb_decompress_documents(compressed, &total_elements);
+
+	*iter = (JsonbDecompressionIterator){
+		.base = { .compression_algorithm = COMPRESSION_ALGORITHM_JSONB,
+				  .forward = forward,
+				  .element_type = element_type,
+				  .try_next = (forward ? jsonb_decompression_iterator_try_next_forward :
+										 jsonb_decompression_iterator_try_next_reverse) },
+		.position = (forward ? 0 : total_elements - 1),
+		.total_elements = total_elements,
+		.values = values,
+	};
+}
@@ -0,0 +1,74 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#pragma once
+
+/*
+ * jsonb_compress is used to encode the jsonb documents that have a common set
+ * of top-level keys, like telemetry payloads. The frequent top-level keys with
+ * scalar values of a consistent type are shredded into separate columns:
+ *
+ *  - the string fields : (the default algorithm for text)
+ *  - the number fields : (the default algorithm for numeric)
+ *  - the boolean fields : (the default algorithm for bool)
+ *  - the residual documents with the rest of the keys : (dictionary encoding)
+ *
+ * The documents are reconstructed by merging the fields back into the
+ * residual documents. A single field can be read without reconstructing the
+ * documents, which is used by the vectorized filters on "column ->> 'key'".
+ */
+
+#include <postgres.h>
+#include "compression/compression.h"
+#include <fmgr.h>
+#include <lib/stringinfo.h>
+#include <utils/jsonb.h>
+
+typedef struct JsonbCompressor JsonbCompressor;
+typedef struct JsonbCompressed JsonbCompressed;
+
+/*
+ * Compressor framework functions and definitions for the jsonb_compress algorithm.
+ */
+
+extern JsonbCompressor *jsonb_compressor_alloc(void);
+extern void jsonb_compressor_append_null(JsonbCompressor *compressor);
+extern void jsonb_compressor_append_value(JsonbCompressor *compressor, Datum next_val);
+extern void *jsonb_compressor_finish(JsonbCompressor *compressor);
+extern bool jsonb_compressed_has_nulls(const CompressedDataHeader *header);
+
+extern DecompressResult jsonb_decompression_iterator_try_next_forward(DecompressionIterator *iter);
+
+extern DecompressionIterator *
+jsonb_decompression_iterator_from_datum_forward(Datum jsonb_compressed, Oid element_type);
+
+extern DecompressResult jsonb_decompression_iterator_try_next_reverse(DecompressionIterator *iter);
+
+extern DecompressionIterator *
+jsonb_decompression_iterator_from_datum_reverse(Datum jsonb_compressed, Oid element_type);
+
+extern void jsonb_compressed_send(CompressedDataHeader *header, StringInfo buffer);
+
+extern Datum jsonb_compressed_recv(StringInfo buf);
+
+extern Compressor *jsonb_compressor_for_type(Oid element_type);
+
+/*
+ * Field access for the vectorized filters.
+ */
+extern text *jsonb_get_field_text(Jsonb *jb, const char *key, int keylen);
+
+extern ArrowArray *jsonb_compressed_field_text(Datum compressed, int n_rows, const char *key,
+											   int keylen, MemoryContext dest_mctx);
+
+#define JSONB_COMPRESS_ALGORITHM_DEFINITION                                                        \
+	{                                                                                              \
+		.iterator_init_forward = jsonb_decompression_iterator_from_datum_forward,                  \
+		.iterator_init_reverse = jsonb_decompression_iterator_from_datum_reverse,                  \
+		.decompress_all = NULL, .compressed_data_send = jsonb_compressed_send,                     \
+		.compressed_data_recv = jsonb_compressed_recv,                                             \
+		.compressor_for_type = jsonb_compressor_for_type,                                          \
+		.compressed_data_storage = TOAST_STORAGE_EXTENDED,                                         \
+	}
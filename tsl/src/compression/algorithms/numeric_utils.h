@@ -0,0 +1,265 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#pragma once
+
+/*
+ * Conversion of the numeric values between the binary representation of the
+ * numeric type and a fixed-point representation with an int64 mantissa and a
+ * decimal scale. Used by the decimal compression algorithm and the vectorized
+ * numeric aggregate functions.
+ */
+
+#include <postgres.h>
+
+#include <common/int.h>
+
+/*
+ * The parts of the numeric binary representation that we need. Copied from
+ * numeric.c.
+ */
+#define NBASE 10000
+#define DEC_DIGITS 4
+
+#define NUMERIC_SIGN_MASK 0xC000
+#define NUMERIC_NEG 0x4000
+#define NUMERIC_SHORT 0x8000
+#define NUMERIC_SPECIAL 0xC000
+
+#define NUMERIC_EXT_SIGN_MASK 0xF000
+#define NUMERIC_PINF 0xD000
+#define NUMERIC_NINF 0xF000
+
+#define NUMERIC_DSCALE_MASK 0x3FFF
+
+#define NUMERIC_SHORT_SIGN_MASK 0x2000
+#define NUMERIC_SHORT_DSCALE_MASK 0x1F80
+#define NUMERIC_SHORT_DSCALE_SHIFT 7
+#define NUMERIC_SHORT_WEIGHT_SIGN_MASK 0x0040
+#define NUMERIC_SHORT_WEIGHT_MASK 0x003F
+
+#define NUMERIC_MAX_POW10 18
+
+static const int64 numeric_pow10[NUMERIC_MAX_POW10 + 1] = {
+	1LL,
+	10LL,
+	100LL,
+	1000LL,
+	10000LL,
+	100000LL,
+	1000000LL,
+	10000000LL,
+	100000000LL,
+	1000000000LL,
+	10000000000LL,
+	100000000000LL,
+	1000000000000LL,
+	10000000000000LL,
+	100000000000000LL,
+	1000000000000000LL,
+	10000000000000000LL,
+	100000000000000000LL,
+	1000000000000000000LL,
+};
+
+/*
+ * A numeric value in the fixed-point representation, mantissa * 10^-scale.
+ */
+typedef struct
+{
+	int64 mantissa;
+	int32 scale;
+} FixedNumeric;
+
+/*
+ * Convert the numeric value given by its binary representation without the
+ * varlena header to the fixed-point representation with the display scale of
+ * the value. Returns false for the special values and for the values that don't
+ * fit into int64 mantissa at this scale.
+ */
+static pg_attribute_always_inline bool
+numeric_body_to_fixed(const uint8 *body, uint32 len, FixedNumeric *result)
+{
+	uint16 header;
+	if (unlikely(len < sizeof(header)))
+	{
+		return false;
+	}
+	memcpy(&header, body, sizeof(header));
+
+	bool negative;
+	int weight;
+	int scale;
+	const uint8 *digits;
+	if ((header & NUMERIC_SIGN_MASK) == NUMERIC_SPECIAL)
+	{
+		return false;
+	}
+	else if ((header & NUMERIC_SIGN_MASK) == NUMERIC_SHORT)
+	{
+		negative = (header & NUMERIC_SHORT_SIGN_MASK) != 0;
+		scale = (header & NUMERIC_SHORT_DSCALE_MASK) >> NUMERIC_SHORT_DSCALE_SHIFT;
+		weight = ((header & NUMERIC_SHORT_WEIGHT_SIGN_MASK) ? ~NUMERIC_SHORT_WEIGHT_MASK : 0) |
+				 (header & NUMERIC_SHORT_WEIGHT_MASK);
+		digits = body + sizeof(header);
+	}
+	else
+	{
+		int16 long_weight;
+		if (unlikely(len < sizeof(header) + sizeof(long_weight)))
+		{
+			return false;
+		}
+		negative = (header & NUMERIC_SIGN_MASK) == NUMERIC_NEG;
+		scale = header & NUMERIC_DSCALE_MASK;
+		memcpy(&long_weight, body + sizeof(header), sizeof(long_weight));
+		weight = long_weight;
+		digits = body + sizeof(header) + sizeof(long_weight);
+	}
+
+	const int ndigits = (body + len - digits) / sizeof(int16);
+
+	/* The base-NBASE digits give the value * NBASE^(ndigits - 1 - weight). */
+	int64 acc = 0;
+	for (int i = 0; i < ndigits; i++)
+	{
+		int16 digit;
+		memcpy(&digit, digits + i * sizeof(digit), sizeof(digit));
+		if (unlikely(pg_mul_s64_overflow(acc, NBASE, &acc) ||
+					 pg_add_s64_overflow(acc, digit, &acc)))
+		{
+			return false;
+		}
+	}
+
+	if (acc != 0)
+	{
+		/* Bring the value to the display scale. */
+		const int shift = scale - DEC_DIGITS * (ndigits - 1 - weight);
+		if (shift >= 0)
+		{
+			if (shift > NUMERIC_MAX_POW10 ||
+				pg_mul_s64_overflow(acc, numeric_pow10[shift], &acc))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			/* Not expected, but check that we don't lose any nonzero digits. */
+			if (-shift > NUMERIC_MAX_POW10 || acc % numeric_pow10[-shift] != 0)
+			{
+				return false;
+			}
+			acc /= numeric_pow10[-shift];
+		}
+	}
+
+	result->mantissa = negative ? -acc : acc;
+	result->scale = scale;
+	return true;
+}
+
+/*
+ * The maximal size of the binary representation of a fixed-point value with
+ * int64 mantissa: the header and at most six base-NBASE digits.
+ */
+#define NUMERIC_FIXED_MAX_BODY_BYTES 16
+
+/*
+ * Write the binary representation without the varlena header of the given
+ * fixed-point value into dest, and return its size. This produces the same
+ * representation as make_result() in numeric.c: the leading and trailing zero
+ * digits are stripped, and the short format is used when possible.
+ */
+static inline uint32
+numeric_body_from_fixed(FixedNumeric value, uint8 *dest)
+{
+	Assert(value.scale >= 0 && value.scale <= NUMERIC_DSCALE_MASK);
+
+	/*
+	 * Pad the fractional part with zeros to a whole number of base-NBASE
+	 * digits, and split the decimal digits into base-NBASE ones, least
+	 * significant first.
+	 */
+	const int pad = (DEC_DIGITS - value.scale % DEC_DIGITS) % DEC_DIGITS;
+	uint64 abs = value.mantissa < 0 ? -(uint64) value.mantissa : (uint64) value.mantissa;
+	int16 digits[(NUMERIC_FIXED_MAX_BODY_BYTES - sizeof(uint16)) / sizeof(int16)];
+	int ndigits = 0;
+	int digit_position = pad;
+	int16 current_digit = 0;
+	int current_digit_multiplier = numeric_pow10[pad];
+	while (abs != 0)
+	{
+		current_digit += (abs % 10) * current_digit_multiplier;
+		current_digit_multiplier *= 10;
+		abs /= 10;
+		digit_position++;
+		if (digit_position % DEC_DIGITS == 0)
+		{
+			digits[ndigits++] = current_digit;
+			current_digit = 0;
+			current_digit_multiplier = 1;
+		}
+	}
+	if (current_digit != 0)
+	{
+		digits[ndigits++] = current_digit;
+	}
+
+	/* The weight of the least significant digit. */
+	int weight = -(value.scale + pad) / DEC_DIGITS;
+
+	/* Strip the trailing zero digits, there are no leading ones. */
+	int first_digit = 0;
+	while (first_digit < ndigits && digits[first_digit] == 0)
+	{
+		first_digit++;
+		weight++;
+	}
+
+	const bool negative = value.mantissa < 0;
+	if (first_digit == ndigits)
+	{
+		/* Zero has no digits, zero weight and positive sign. */
+		ndigits = 0;
+		weight = 0;
+	}
+	else
+	{
+		weight += ndigits - first_digit - 1;
+	}
+
+	uint32 len = 0;
+	if (value.scale <= (NUMERIC_SHORT_DSCALE_MASK >> NUMERIC_SHORT_DSCALE_SHIFT) &&
+		weight <= NUMERIC_SHORT_WEIGHT_MASK && weight >= ~NUMERIC_SHORT_WEIGHT_MASK)
+	{
+		const uint16 header =
+			NUMERIC_SHORT | (negative ? NUMERIC_SHORT_SIGN_MASK : 0) |
+			(value.scale << NUMERIC_SHORT_DSCALE_SHIFT) |
+			(weight < 0 ? NUMERIC_SHORT_WEIGHT_SIGN_MASK : 0) |
+			(weight & NUMERIC_SHORT_WEIGHT_MASK);
+		memcpy(dest, &header, sizeof(header));
+		len += sizeof(header);
+	}
+	else
+	{
+		const uint16 header = (negative ? NUMERIC_NEG : 0) | (value.scale & NUMERIC_DSCALE_MASK);
+		const int16 long_weight = weight;
+		memcpy(dest, &header, sizeof(header));
+		memcpy(dest + sizeof(header), &long_weight, sizeof(long_weight));
+		len += sizeof(header) + sizeof(long_weight);
+	}
+
+	/* The digits go most significant first. */
+	for (int i = ndigits - 1; i >= first_digit; i--)
+	{
+		memcpy(dest + len, &digits[i], sizeof(int16));
+		len += sizeof(int16);
+	}
+
+	Assert(len <= NUMERIC_FIXED_MAX_BODY_BYTES);
+	return len;
+}
@@ -22,3 +22,7 @@ BatchMetadataBuilder *batch_metadata_builder_minmax_create(Oid type, Oid collati
 														   int max_attr_offset);
 
 BatchMetadataBuilder *batch_metadata_builder_bloom1_create(Oid type, int bloom_attr_offset);
+
+BatchMetadataBuilder *batch_metadata_builder_sum_create(Oid type, int sum_attr_offset,
+														int count_attr_offset,
+														int sumsq_attr_offset);
@@ -0,0 +1,199 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Builder of the pre-aggregated per-batch metadata for the numeric columns:
+ * the sum of the values, the count of the non-null values, and the sum of
+ * squared deviations from the batch mean. The latter is the Sxx variable of the
+ * Youngs-Cramer algorithm used by the Postgres float8_accum() function, so the
+ * metadata of several batches can be combined in the same way as in
+ * float8_combine().
+ *
+ * These columns allow the aggregation nodes to compute sum(), count(), avg()
+ * and the like for the batches that fully pass the filters without
+ * decompressing them.
+ *
+ * The sum is a bigint for the integer columns and a double precision for the
+ * floating-point columns. When the bigint sum overflows, the sum and sum of
+ * squares are set to null and the consumers have to fall back to decompression.
+ * The floating-point sum follows the IEEE rules for infinities and NaNs, and the
+ * sum of squares is NaN in this case, same as in float8_accum().
+ */
+#include <postgres.h>
+
+#include <catalog/pg_type.h>
+#include <common/int.h>
+#include <utils/builtins.h>
+
+#include "compression.h"
+
+#include "batch_metadata_builder.h"
+
+typedef struct BatchMetadataBuilderSum
+{
+	BatchMetadataBuilder functions;
+
+	Oid type_oid;
+
+	/* Number of non-null values in the batch. */
+	int32 count;
+
+	/* The integer sum didn't overflow. */
+	bool valid;
+
+	/* Exact sum of the integer values. */
+	int64 int_sum;
+
+	/* Youngs-Cramer state, see float8_accum(). */
+	double Sx;
+	double Sxx;
+
+	int16 sum_attr_offset;
+	int16 count_attr_offset;
+	int16 sumsq_attr_offset;
+} BatchMetadataBuilderSum;
+
+static void
+sum_update_val(void *builder_, Datum val)
+{
+	BatchMetadataBuilderSum *builder = (BatchMetadataBuilderSum *) builder_;
+
+	double newval;
+	switch (builder->type_oid)
+	{
+		case INT2OID:
+			newval = DatumGetInt16(val);
+			builder->int_sum += DatumGetInt16(val);
+			break;
+		case INT4OID:
+			newval = DatumGetInt32(val);
+			builder->int_sum += DatumGetInt32(val);
+			break;
+		case INT8OID:
+			newval = (double) DatumGetInt64(val);
+			if (pg_add_s64_overflow(builder->int_sum, DatumGetInt64(val), &builder->int_sum))
+			{
+				builder->valid = false;
+			}
+			break;
+		case FLOAT4OID:
+			newval = DatumGetFloat4(val);
+			break;
+		case FLOAT8OID:
+			newval = DatumGetFloat8(val);
+			break;
+		default:
+			pg_unreachable();
+			return;
+	}
+
+	/*
+	 * This follows the Postgres float8_accum() transition function, see the
+	 * comments there, but doesn't error out on overflow.
+	 */
+	const double N = builder->count;
+	const double newN = N + 1.0;
+	const double newSx = builder->Sx + newval;
+	if (N > 0.0)
+	{
+		const double tmp = newval * newN - newSx;
+		builder->Sxx += tmp * tmp / (N * newN);
+	}
+	else
+	{
+		/* NaN for the infinite or NaN inputs, zero otherwise. */
+		builder->Sxx = newval * 0.0;
+	}
+
+	builder->Sx = newSx;
+	builder->count++;
+}
+
+static void
+sum_update_null(void *builder_)
+{
+	/*
+	 * The null values don't participate in sum() or count(column), so we
+	 * don't need to track them.
+	 */
+}
+
+static void
+sum_insert_to_compressed_row(void *builder_, RowCompressor *compressor)
+{
+	BatchMetadataBuilderSum *builder = (BatchMetadataBuilderSum *) builder_;
+
+	compressor->compressed_is_null[builder->count_attr_offset] = false;
+	compressor->compressed_values[builder->count_attr_offset] = Int32GetDatum(builder->count);
+
+	if (builder->count == 0 || !builder->valid)
+	{
+		compressor->compressed_is_null[builder->sum_attr_offset] = true;
+		compressor->compressed_is_null[builder->sumsq_attr_offset] = true;
+		return;
+	}
+
+	compressor->compressed_is_null[builder->sum_attr_offset] = false;
+	compressor->compressed_is_null[builder->sumsq_attr_offset] = false;
+
+	if (builder->type_oid == FLOAT4OID || builder->type_oid == FLOAT8OID)
+	{
+		compressor->compressed_values[builder->sum_attr_offset] = Float8GetDatum(builder->Sx);
+	}
+	else
+	{
+		compressor->compressed_values[builder->sum_attr_offset] = Int64GetDatum(builder->int_sum);
+	}
+	compressor->compressed_values[builder->sumsq_attr_offset] = Float8GetDatum(builder->Sxx);
+}
+
+static void
+sum_reset(void *builder_, RowCompressor *compressor)
+{
+	BatchMetadataBuilderSum *builder = (BatchMetadataBuilderSum *) builder_;
+
+	builder->count = 0;
+	builder->valid = true;
+	builder->int_sum = 0;
+	builder->Sx = 0;
+	builder->Sxx = 0;
+
+	compressor->compressed_is_null[builder->sum_attr_offset] = true;
+	compressor->compressed_is_null[builder->count_attr_offset] = true;
+	compressor->compressed_is_null[builder->sumsq_attr_offset] = true;
+	compressor->compressed_values[builder->sum_attr_offset] = 0;
+	compressor->compressed_values[builder->count_attr_offset] = 0;
+	compressor->compressed_values[builder->sumsq_attr_offset] = 0;
+}
+
+BatchMetadataBuilder *
+batch_metadata_builder_sum_create(Oid type_oid, int sum_attr_offset, int count_attr_offset,
+								  int sumsq_attr_offset)
+{
+	if (type_oid != INT2OID && type_oid != INT4OID && type_oid != INT8OID &&
+		type_oid != FLOAT4OID && type_oid != FLOAT8OID)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATATYPE_MISMATCH),
+				 errmsg("invalid sum column type %s", format_type_be(type_oid))));
+
+	BatchMetadataBuilderSum *builder = palloc(sizeof(*builder));
+	*builder = (BatchMetadataBuilderSum){
+		.functions =
+			(BatchMetadataBuilder){
+				.update_val = sum_update_val,
+				.update_null = sum_update_null,
+				.insert_to_compressed_row = sum_insert_to_compressed_row,
+				.reset = sum_reset,
+			},
+		.type_oid = type_oid,
+		.valid = true,
+		.sum_attr_offset = sum_attr_offset,
+		.count_attr_offset = count_attr_offset,
+		.sumsq_attr_offset = sumsq_attr_offset,
+	};
+
+	return &builder->functions;
+}
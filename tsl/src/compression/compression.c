@@ -25,13 +25,16 @@
 #include <utils/syscache.h>
 #include <utils/typcache.h>
 
+#include "annotations.h"
 #include "compat/compat.h"
 
 #include "algorithms/array.h"
 #include "algorithms/bool_compress.h"
+#include "algorithms/decimal_compress.h"
 #include "algorithms/deltadelta.h"
 #include "algorithms/dictionary.h"
 #include "algorithms/gorilla.h"
+#include "algorithms/jsonb_compress.h"
 #include "algorithms/null.h"
 #include "algorithms/uuid_compress.h"
 #include "batch_metadata_builder.h"
@@ -71,6 +74,8 @@ static const CompressionAlgorithmDefinition definitions[_END_COMPRESSION_ALGORIT
 	[COMPRESSION_ALGORITHM_BOOL] = BOOL_COMPRESS_ALGORITHM_DEFINITION,
 	[COMPRESSION_ALGORITHM_NULL] = NULL_COMPRESS_ALGORITHM_DEFINITION,
 	[COMPRESSION_ALGORITHM_UUID] = UUID_COMPRESS_ALGORITHM_DEFINITION,
+	[COMPRESSION_ALGORITHM_DECIMAL] = DECIMAL_COMPRESS_ALGORITHM_DEFINITION,
+	[COMPRESSION_ALGORITHM_JSONB] = JSONB_COMPRESS_ALGORITHM_DEFINITION,
 };
 
 static NameData compression_algorithm_name[] = {
@@ -82,6 +87,8 @@ static NameData compression_algorithm_name[] = {
 	[COMPRESSION_ALGORITHM_BOOL] = { "BOOL" },
 	[COMPRESSION_ALGORITHM_NULL] = { "NULL" },
 	[COMPRESSION_ALGORITHM_UUID] = { "UUID" },
+	[COMPRESSION_ALGORITHM_DECIMAL] = { "DECIMAL" },
+	[COMPRESSION_ALGORITHM_JSONB] = { "JSONB" },
 };
 
 Name
@@ -119,10 +126,11 @@ tsl_get_decompress_all_function(CompressionAlgorithm algorithm, Oid type)
 		elog(ERROR, "invalid compression algorithm %d", algorithm);
 
 	if (type != TEXTOID && type != BOOLOID && type != UUIDOID &&
+		!(type == NUMERICOID && algorithm == COMPRESSION_ALGORITHM_ARRAY) &&
 		(algorithm == COMPRESSION_ALGORITHM_DICTIONARY || algorithm == COMPRESSION_ALGORITHM_ARRAY))
 	{
 		/* Bulk decompression of array and dictionary is only supported for
-		 * text, bool and uuid */
+		 * text, bool and uuid, and of array also for numeric */
 		return NULL;
 	}
 
@@ -848,9 +856,42 @@ build_column_map(const CompressionSettings *settings, const TupleDesc in_desc,
 					batch_metadata_builder_bloom1_create(attr->atttypid, bloom_attr_offset);
 			}
 
+			const AttrNumber sum_attr_number =
+				compressed_column_metadata_attno(settings,
+												 settings->fd.relid,
+												 attr->attnum,
+												 settings->fd.compress_relid,
+												 "sum");
+			BatchMetadataBuilder *batch_sum_builder = NULL;
+			if (AttributeNumberIsValid(sum_attr_number))
+			{
+				const AttrNumber count_attr_number =
+					compressed_column_metadata_attno(settings,
+													 settings->fd.relid,
+													 attr->attnum,
+													 settings->fd.compress_relid,
+													 "count");
+				const AttrNumber sumsq_attr_number =
+					compressed_column_metadata_attno(settings,
+													 settings->fd.relid,
+													 attr->attnum,
+													 settings->fd.compress_relid,
+													 "sumsq");
+				Ensure(AttributeNumberIsValid(count_attr_number),
+					   "could not find the count metadata column");
+				Ensure(AttributeNumberIsValid(sumsq_attr_number),
+					   "could not find the sumsq metadata column");
+				batch_sum_builder =
+					batch_metadata_builder_sum_create(attr->atttypid,
+													  AttrNumberGetAttrOffset(sum_attr_number),
+													  AttrNumberGetAttrOffset(count_attr_number),
+													  AttrNumberGetAttrOffset(sumsq_attr_number));
+			}
+
 			*column = (PerColumn){
 				.compressor = compressor_for_type(attr->atttypid),
 				.metadata_builder = batch_minmax_builder,
+				.sum_metadata_builder = batch_sum_builder,
 				.segmentby_column_index = -1,
 			};
 		}
@@ -1225,6 +1266,7 @@ row_compressor_append_row(RowCompressor *row_compressor, TupleTableSlot *row)
 		 * useless overhead here, and we should just access the array directly.
 		 */
 		BatchMetadataBuilder *builder = row_compressor->per_column[col].metadata_builder;
+		BatchMetadataBuilder *sum_builder = row_compressor->per_column[col].sum_metadata_builder;
 		val = slot_getattr(row, AttrOffsetGetAttrNumber(col), &is_null);
 		if (is_null)
 		{
@@ -1233,6 +1275,10 @@ row_compressor_append_row(RowCompressor *row_compressor, TupleTableSlot *row)
 			{
 				builder->update_null(builder);
 			}
+			if (sum_builder != NULL)
+			{
+				sum_builder->update_null(sum_builder);
+			}
 		}
 		else
 		{
@@ -1241,6 +1287,10 @@ row_compressor_append_row(RowCompressor *row_compressor, TupleTableSlot *row)
 			{
 				builder->update_val(builder, val);
 			}
+			if (sum_builder != NULL)
+			{
+				sum_builder->update_val(sum_builder, val);
+			}
 		}
 	}
 
@@ -1288,6 +1338,12 @@ row_compressor_build_tuple(RowCompressor *row_compressor)
 				column->metadata_builder->insert_to_compressed_row(column->metadata_builder,
 																   row_compressor);
 			}
+
+			if (column->sum_metadata_builder != NULL)
+			{
+				column->sum_metadata_builder
+					->insert_to_compressed_row(column->sum_metadata_builder, row_compressor);
+			}
 		}
 		else if (column->segment_info != NULL)
 		{
@@ -1339,6 +1395,11 @@ row_compressor_clear_batch(RowCompressor *row_compressor, bool changed_groups)
 			column->metadata_builder->reset(column->metadata_builder, row_compressor);
 		}
 
+		if (column->sum_metadata_builder != NULL)
+		{
+			column->sum_metadata_builder->reset(column->sum_metadata_builder, row_compressor);
+		}
+
 		row_compressor->compressed_values[compressed_col] = 0;
 		row_compressor->compressed_is_null[compressed_col] = true;
 	}
@@ -2539,6 +2600,12 @@ tsl_compressed_data_info(PG_FUNCTION_ARGS)
 		case COMPRESSION_ALGORITHM_UUID:
 			has_nulls = uuid_compressed_has_nulls(header);
 			break;
+		case COMPRESSION_ALGORITHM_DECIMAL:
+			has_nulls = decimal_compressed_has_nulls(header);
+			break;
+		case COMPRESSION_ALGORITHM_JSONB:
+			has_nulls = jsonb_compressed_has_nulls(header);
+			break;
 		default:
 			elog(ERROR, "unknown compression algorithm %d", header->compression_algorithm);
 			break;
@@ -2586,6 +2653,12 @@ tsl_compressed_data_has_nulls(PG_FUNCTION_ARGS)
 		case COMPRESSION_ALGORITHM_UUID:
 			has_nulls = uuid_compressed_has_nulls(header);
 			break;
+		case COMPRESSION_ALGORITHM_DECIMAL:
+			has_nulls = decimal_compressed_has_nulls(header);
+			break;
+		case COMPRESSION_ALGORITHM_JSONB:
+			has_nulls = jsonb_compressed_has_nulls(header);
+			break;
 		default:
 			elog(ERROR, "unknown compression algorithm %d", header->compression_algorithm);
 			break;
@@ -2625,10 +2698,16 @@ compression_get_default_algorithm(Oid typeoid)
 
 		case FLOAT4OID:
 		case FLOAT8OID:
-			return COMPRESSION_ALGORITHM_GORILLA;
+			if (ts_guc_enable_decimal_compression)
+				return COMPRESSION_ALGORITHM_DECIMAL;
+			else
+				return COMPRESSION_ALGORITHM_GORILLA;
 
 		case NUMERICOID:
-			return COMPRESSION_ALGORITHM_ARRAY;
+			if (ts_guc_enable_decimal_compression)
+				return COMPRESSION_ALGORITHM_DECIMAL;
+			else
+				return COMPRESSION_ALGORITHM_ARRAY;
 
 		case BOOLOID:
 			if (ts_guc_enable_bool_compression)
@@ -2642,6 +2721,12 @@ compression_get_default_algorithm(Oid typeoid)
 			else
 				return COMPRESSION_ALGORITHM_DICTIONARY;
 
+		case JSONBOID:
+			if (ts_guc_enable_jsonb_compression)
+				return COMPRESSION_ALGORITHM_JSONB;
+			/* otherwise use the default algorithm */
+			TS_FALLTHROUGH;
+
 		default:
 		{
 			/* use dictionary if possible, otherwise use array */
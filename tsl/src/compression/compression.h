@@ -196,6 +196,8 @@ typedef enum CompressionAlgorithm
 	COMPRESSION_ALGORITHM_BOOL,
 	COMPRESSION_ALGORITHM_NULL,
 	COMPRESSION_ALGORITHM_UUID,
+	COMPRESSION_ALGORITHM_DECIMAL,
+	COMPRESSION_ALGORITHM_JSONB,
 
 	/* When adding an algorithm also add a static assert statement below */
 	/* end of real values */
@@ -219,6 +221,12 @@ typedef struct PerColumn
 	 * Only used for order-by columns right now, will be {-1, NULL} for others.
 	 */
 	BatchMetadataBuilder *metadata_builder;
+	/*
+	 * The per-batch sum metadata is independent of the sparse index above and
+	 * can be combined with it, so it has a separate builder. NULL if the
+	 * column has no sum sparse index.
+	 */
+	BatchMetadataBuilder *sum_metadata_builder;
 
 	/* segment info; only used if compressor is NULL */
 	SegmentInfo *segment_info;
@@ -331,13 +339,15 @@ pg_attribute_unused() assert_num_compression_algorithms_sane(void)
 	StaticAssertStmt(COMPRESSION_ALGORITHM_BOOL == 5, "algorithm index has changed");
 	StaticAssertStmt(COMPRESSION_ALGORITHM_NULL == 6, "algorithm index has changed");
 	StaticAssertStmt(COMPRESSION_ALGORITHM_UUID == 7, "algorithm index has changed");
+	StaticAssertStmt(COMPRESSION_ALGORITHM_DECIMAL == 8, "algorithm index has changed");
+	StaticAssertStmt(COMPRESSION_ALGORITHM_JSONB == 9, "algorithm index has changed");
 
 	/*
 	 * This should change when adding a new algorithm after adding the new
 	 * algorithm to the assert list above. This statement prevents adding a
 	 * new algorithm without updating the asserts above
 	 */
-	StaticAssertStmt(_END_COMPRESSION_ALGORITHMS == 8,
+	StaticAssertStmt(_END_COMPRESSION_ALGORITHMS == 10,
 					 "number of algorithms have changed, the asserts should be updated");
 }
 
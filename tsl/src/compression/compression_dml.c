@@ -9,6 +9,7 @@
 #include <access/tableam.h>
 #include <access/valid.h>
 #include <catalog/pg_am.h>
+#include <catalog/pg_collation.h>
 #include <nodes/nodeFuncs.h>
 #include <optimizer/optimizer.h>
 #include <parser/parse_coerce.h>
@@ -27,6 +28,7 @@
 #include <compression/create.h>
 #include <compression/wal_utils.h>
 #include <continuous_aggs/insert.h>
+#include <decompression_stats.h>
 #include <expression_utils.h>
 #include <indexing.h>
 #include <nodes/columnar_scan/vector_dict.h>
@@ -77,6 +79,8 @@ static BatchFilter *make_batchfilter(char *column_name, StrategyNumber strategy,
 									 RegProcedure opcode, Const *value, bool is_null_check,
 									 bool is_null, bool is_array_op);
 static void report_error(TM_Result result);
+static void report_decompression_stats(Relation chunk_rel,
+									   const struct decompress_batches_stats *stats);
 
 static bool key_column_is_null(tuple_filtering_constraints *constraints, Relation chunk_rel,
 							   Oid ht_relid, TupleTableSlot *slot);
@@ -330,6 +334,8 @@ decompress_batches_for_insert(ChunkInsertState *cis, TupleTableSlot *slot)
 		cis->skip_current_tuple = true;
 	}
 
+	report_decompression_stats(out_rel, &stats);
+
 	cis->counters->batches_deleted += stats.batches_deleted;
 	cis->counters->batches_filtered += stats.batches_filtered;
 	cis->counters->batches_decompressed += stats.batches_decompressed;
@@ -474,6 +480,8 @@ decompress_batches_for_update_delete(ModifyHypertableState *ht_state, Chunk *chu
 	if (stats.batches_decompressed > 0)
 		ts_chunk_set_partial(chunk);
 
+	report_decompression_stats(chunk_rel, &stats);
+
 	table_close(chunk_rel, NoLock);
 	table_close(comp_chunk_rel, NoLock);
 
@@ -1877,6 +1885,11 @@ can_vectorize_constraint_checks(tuple_filtering_constraints *constraints,
 		ScanKeyData *scankey = &mem_scankeys->scankeys[sk];
 		if (get_vector_const_predicate(scankey->sk_func.fn_oid) == NULL)
 			return false;
+
+		const Oid collation = scankey->sk_collation;
+		if (vector_const_predicate_needs_c_collation(scankey->sk_func.fn_oid) &&
+			collation != C_COLLATION_OID && collation != POSIX_COLLATION_OID)
+			return false;
 	}
 
 	while ((chunk_attno = bms_next_member(constraints->key_columns, chunk_attno)) > 0)
@@ -1906,3 +1919,19 @@ can_vectorize_constraint_checks(tuple_filtering_constraints *constraints,
 
 	return true;
 }
+
+/*
+ * Add the batches decompressed by DML to the cumulative decompression
+ * statistics of the chunk.
+ */
+static void
+report_decompression_stats(Relation chunk_rel, const struct decompress_batches_stats *stats)
+{
+	if (stats->batches_decompressed == 0 || !ts_decompression_stats_enabled())
+		return;
+
+	DecompressionStatsCounts counts = { 0 };
+	counts.counters[DSC_DmlBatchesDecompressed] = stats->batches_decompressed;
+	counts.counters[DSC_DmlRowsDecompressed] = stats->tuples_decompressed;
+	ts_decompression_stats_add(RelationGetRelid(chunk_rel), InvalidAttrNumber, &counts);
+}
@@ -59,7 +59,7 @@
 
 #include "bgw_policy/compression_api.h"
 
-static const char *sparse_index_types[] = { "min", "max" };
+static const char *sparse_index_types[] = { "min", "max", "sum", "count", "sumsq" };
 
 #ifdef USE_ASSERT_CHECKING
 static bool
@@ -298,6 +298,37 @@ create_sparse_index_column_def(Form_pg_attribute attr, const char *metadata_type
 		 */
 		column_def->storage = TYPSTORAGE_EXTERNAL;
 	}
+	else if (strcmp(metadata_type, "sum") == 0 || strcmp(metadata_type, "count") == 0 ||
+			 strcmp(metadata_type, "sumsq") == 0)
+	{
+		/*
+		 * The sum metadata is a bigint for integer columns, and double
+		 * precision for floating-point columns. The count of non-null values
+		 * and the sum of squared deviations have fixed types.
+		 */
+		Oid metadata_typid = FLOAT8OID;
+		if (strcmp(metadata_type, "count") == 0)
+			metadata_typid = INT4OID;
+		else if (strcmp(metadata_type, "sum") == 0 &&
+				 (attr->atttypid == INT2OID || attr->atttypid == INT4OID ||
+				  attr->atttypid == INT8OID))
+			metadata_typid = INT8OID;
+		else if (attr->atttypid != FLOAT4OID && attr->atttypid != FLOAT8OID &&
+				 attr->atttypid != INT2OID && attr->atttypid != INT4OID &&
+				 attr->atttypid != INT8OID)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATATYPE_MISMATCH),
+					 errmsg("invalid sum column type %s", format_type_be(attr->atttypid)),
+					 errdetail("The sum sparse index supports only integer and "
+							   "floating-point columns.")));
+
+		column_def =
+			makeColumnDef(compressed_column_metadata_name_v2(metadata_type, NameStr(attr->attname)),
+						  metadata_typid,
+						  /* typmod = */ -1,
+						  /* collation = */ InvalidOid);
+		column_def->storage = TYPSTORAGE_PLAIN;
+	}
 	else /* either min or max */
 	{
 		TypeCacheEntry *type = lookup_type_cache(attr->atttypid, TYPECACHE_LT_OPR);
@@ -460,6 +491,28 @@ build_columndefs(CompressionSettings *settings, Oid src_reloid)
 				compressed_column_defs = lappend(compressed_column_defs, def);
 			}
 		}
+
+		/*
+		 * The sum metadata is not a filter, so unlike the other sparse indexes
+		 * it can be combined with the minmax or bloom ones, and is allowed on
+		 * the orderby columns as well. Add the precomputed per-batch sum,
+		 * count and sum of squares for this column.
+		 */
+		if (settings->fd.index &&
+			ts_contains_sparse_index_config(settings,
+											NameStr(attr->attname),
+											ts_sparse_index_type_names[_SparseIndexTypeEnumSum]))
+		{
+			ColumnDef *def = create_sparse_index_column_def(attr, "sum");
+			compressed_column_defs = lappend(compressed_column_defs, def);
+
+			def = create_sparse_index_column_def(attr, "count");
+			compressed_column_defs = lappend(compressed_column_defs, def);
+
+			def = create_sparse_index_column_def(attr, "sumsq");
+			compressed_column_defs = lappend(compressed_column_defs, def);
+		}
+
 		compressed_column_defs = lappend(compressed_column_defs,
 										 makeColumnDef(NameStr(attr->attname),
 													   compresseddata_oid,
@@ -88,6 +88,10 @@ typedef struct ContinuousAggRefreshContext
 	ContinuousAggRefreshCallContext callctx;
 	int32 processing_batch;
 	int32 number_of_batches;
+	/* Refresh continuous aggregates defined on top of the refreshed one */
+	bool cascade;
+	/* Number of levels above the continuous aggregate that started the cascade */
+	int32 cascade_depth;
 } ContinuousAggRefreshContext;
 
 #define IS_TIME_BUCKET_INFO_TIME_BASED(bucket_function)                                            \
@@ -262,6 +262,44 @@ invalidation_hyper_log_add_entry(int32 hyper_id, int64 start, int64 end)
 		 end);
 }
 
+/*
+ * Check if a single entry in the hypertable invalidation log covers the range
+ * [start, end] (inclusive at both ends).
+ *
+ * This is used to avoid adding redundant entries for ranges that were already
+ * invalidated, for example, by the invalidation trigger on a materialized
+ * hypertable.
+ */
+bool
+invalidation_hyper_log_covers_range(int32 hyper_id, int64 start, int64 end)
+{
+	ScanIterator iterator;
+	bool covered = false;
+
+	hypertable_invalidation_scan_init(&iterator, hyper_id, AccessShareLock);
+
+	ts_scanner_foreach(&iterator)
+	{
+		bool should_free;
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		HeapTuple tuple = ts_scanner_fetch_heap_tuple(ti, false, &should_free);
+		Form_continuous_aggs_hypertable_invalidation_log form =
+			(Form_continuous_aggs_hypertable_invalidation_log) GETSTRUCT(tuple);
+
+		covered = form->lowest_modified_value <= start && form->greatest_modified_value >= end;
+
+		if (should_free)
+			heap_freetuple(tuple);
+
+		if (covered)
+			break;
+	}
+
+	ts_scan_iterator_close(&iterator);
+
+	return covered;
+}
+
 /*
  * Invalidate one or more continuous aggregates.
  *
@@ -40,6 +40,26 @@
 		 LOG :                                                                                     \
 		 DEBUG1)
 
+/*
+ * Windows materialized by a refresh. A window that overlaps or is adjacent to
+ * the last recorded one is merged into it.
+ *
+ * The list is allocated in the memory context of the caller of the refresh
+ * since it must survive the transactions started by the refresh and the
+ * SPI_finish() at the end of it.
+ */
+typedef struct MaterializedRanges
+{
+	MemoryContext mcxt;
+	List *ranges;
+} MaterializedRanges;
+
+/*
+ * Maximum number of levels a cascading refresh goes up in a hierarchy of
+ * continuous aggregates.
+ */
+#define CAGG_CASCADE_MAX_DEPTH 8
+
 typedef struct ContinuousAggRefreshState
 {
 	ContinuousAgg cagg;
@@ -47,6 +67,8 @@ typedef struct ContinuousAggRefreshState
 	InternalTimeRange refresh_window;
 	SchemaAndName partial_view;
 	bool bucketing_refresh_window;
+	/* Windows materialized by the refresh, if tracked */
+	MaterializedRanges *materialized_ranges;
 } ContinuousAggRefreshState;
 
 static Hypertable *cagg_get_hypertable_or_fail(int32 hypertable_id);
@@ -72,13 +94,20 @@ static void continuous_agg_refresh_with_window(const ContinuousAgg *cagg,
 											   const InvalidationStore *invalidations,
 
 											   const ContinuousAggRefreshContext context,
-											   bool bucketing_refresh_window);
+											   bool bucketing_refresh_window,
+											   MaterializedRanges *materialized_ranges);
+static void materialized_ranges_add(MaterializedRanges *materialized_ranges,
+									const InternalTimeRange *window);
 static void emit_up_to_date_notice(const ContinuousAgg *cagg,
 								   const ContinuousAggRefreshContext context);
+static void continuous_agg_refresh_cascade(int32 mat_hypertable_id,
+										   const MaterializedRanges *materialized_ranges,
+										   const ContinuousAggRefreshContext context);
 static bool process_cagg_invalidations_and_refresh(const ContinuousAgg *cagg,
 												   const InternalTimeRange *refresh_window,
 												   const ContinuousAggRefreshContext context,
-												   bool bucketing_refresh_window, bool force);
+												   bool bucketing_refresh_window, bool force,
+												   MaterializedRanges *materialized_ranges);
 static void fill_bucket_offset_origin(const ContinuousAgg *cagg,
 									  const InternalTimeRange *const refresh_window,
 									  NullableDatum *offset, NullableDatum *origin);
@@ -389,6 +418,7 @@ continuous_agg_refresh_init(ContinuousAggRefreshState *refresh, const Continuous
 	refresh->bucketing_refresh_window = bucketing_refresh_window;
 	refresh->partial_view.schema = &refresh->cagg.data.partial_view_schema;
 	refresh->partial_view.name = &refresh->cagg.data.partial_view_name;
+	refresh->materialized_ranges = NULL;
 }
 
 /*
@@ -450,11 +480,14 @@ continuous_agg_refresh_execute_wrapper(const InternalTimeRange *bucketed_refresh
 									   const ContinuousAggRefreshContext context,
 									   const long iteration, void *arg1_refresh)
 {
-	const ContinuousAggRefreshState *refresh = (const ContinuousAggRefreshState *) arg1_refresh;
+	ContinuousAggRefreshState *refresh = (ContinuousAggRefreshState *) arg1_refresh;
 	(void) iteration;
 
 	log_refresh_window(CAGG_REFRESH_LOG_LEVEL, &refresh->cagg, bucketed_refresh_window, context);
 	continuous_agg_refresh_execute(refresh, bucketed_refresh_window);
+
+	if (refresh->materialized_ranges != NULL)
+		materialized_ranges_add(refresh->materialized_ranges, bucketed_refresh_window);
 }
 
 static long
@@ -547,11 +580,13 @@ continuous_agg_refresh_with_window(const ContinuousAgg *cagg,
 								   const InternalTimeRange *refresh_window,
 								   const InvalidationStore *invalidations,
 								   const ContinuousAggRefreshContext context,
-								   bool bucketing_refresh_window)
+								   bool bucketing_refresh_window,
+								   MaterializedRanges *materialized_ranges)
 {
 	ContinuousAggRefreshState refresh;
 
 	continuous_agg_refresh_init(&refresh, cagg, refresh_window, bucketing_refresh_window);
+	refresh.materialized_ranges = materialized_ranges;
 
 	long count pg_attribute_unused();
 	count = continuous_agg_scan_refresh_window_ranges(cagg,
@@ -574,6 +609,7 @@ continuous_agg_refresh(PG_FUNCTION_ARGS)
 	bool force = PG_ARGISNULL(3) ? false : PG_GETARG_BOOL(3);
 	Jsonb *options = PG_ARGISNULL(4) ? NULL : PG_GETARG_JSONB_P(4);
 	bool process_hypertable_invalidations = true;
+	bool cascade = false;
 	ContinuousAgg *cagg;
 	InternalTimeRange refresh_window = {
 		.type = InvalidOid,
@@ -588,6 +624,9 @@ continuous_agg_refresh(PG_FUNCTION_ARGS)
 											 POL_REFRESH_CONF_KEY_PROCESS_HYPERTABLE_INVALIDATIONS,
 											 &found);
 		process_hypertable_invalidations = !found || value;
+
+		value = ts_jsonb_get_bool_field(options, POL_REFRESH_CONF_KEY_CASCADE, &found);
+		cascade = found && value;
 	}
 
 	cagg = cagg_get_by_relid_or_fail(cagg_relid);
@@ -610,7 +649,7 @@ continuous_agg_refresh(PG_FUNCTION_ARGS)
 	else
 		refresh_window.end = ts_time_get_noend_or_max(refresh_window.type);
 
-	ContinuousAggRefreshContext context = { .callctx = CAGG_REFRESH_WINDOW };
+	ContinuousAggRefreshContext context = { .callctx = CAGG_REFRESH_WINDOW, .cascade = cascade };
 	continuous_agg_refresh_internal(cagg,
 									&refresh_window,
 									context,
@@ -624,6 +663,88 @@ continuous_agg_refresh(PG_FUNCTION_ARGS)
 	PG_RETURN_VOID();
 }
 
+static int
+time_range_cmp(const ListCell *a, const ListCell *b)
+{
+	const InternalTimeRange *ra = lfirst(a);
+	const InternalTimeRange *rb = lfirst(b);
+
+	if (ra->start != rb->start)
+		return ra->start < rb->start ? -1 : 1;
+
+	if (ra->end != rb->end)
+		return ra->end < rb->end ? -1 : 1;
+
+	return 0;
+}
+
+static InternalTimeRange *
+time_range_copy(const InternalTimeRange *range)
+{
+	InternalTimeRange *copy = palloc(sizeof(InternalTimeRange));
+
+	*copy = *range;
+	return copy;
+}
+
+/*
+ * Sort a list of ranges and merge the ranges that overlap or are adjacent.
+ */
+static List *
+time_range_list_normalize(List *ranges)
+{
+	List *merged = NIL;
+	ListCell *lc;
+
+	list_sort(ranges, time_range_cmp);
+
+	foreach (lc, ranges)
+	{
+		const InternalTimeRange *range = lfirst(lc);
+		InternalTimeRange *last = merged != NIL ? llast(merged) : NULL;
+
+		if (last != NULL && range->start <= last->end)
+			last->end = Max(last->end, range->end);
+		else
+			merged = lappend(merged, time_range_copy(range));
+	}
+
+	return merged;
+}
+
+/*
+ * Record a materialized window.
+ *
+ * Windows that were not materialized are never added, so cascading a refresh
+ * only invalidates the buckets that actually changed, even when the refresh
+ * materialized several disjoint windows.
+ */
+static void
+materialized_ranges_add(MaterializedRanges *materialized_ranges, const InternalTimeRange *window)
+{
+	InternalTimeRange *last;
+	MemoryContext oldmctx;
+
+	if (window->start >= window->end)
+		return;
+
+	/* Windows are usually materialized in order, so try to extend the last one */
+	if (materialized_ranges->ranges != NIL)
+	{
+		last = llast(materialized_ranges->ranges);
+
+		if (window->start >= last->start && window->start <= last->end)
+		{
+			last->end = Max(last->end, window->end);
+			return;
+		}
+	}
+
+	oldmctx = MemoryContextSwitchTo(materialized_ranges->mcxt);
+	materialized_ranges->ranges = lappend(materialized_ranges->ranges, time_range_copy(window));
+	MemoryContextSwitchTo(oldmctx);
+}
+
 static void
 emit_up_to_date_notice(const ContinuousAgg *cagg, const ContinuousAggRefreshContext context)
 {
@@ -645,7 +766,8 @@ static bool
 process_cagg_invalidations_and_refresh(const ContinuousAgg *cagg,
 									   const InternalTimeRange *refresh_window,
 									   const ContinuousAggRefreshContext context,
-									   bool bucketing_refresh_window, bool force)
+									   bool bucketing_refresh_window, bool force,
+									   MaterializedRanges *materialized_ranges)
 {
 	InvalidationStore *invalidations;
 	Oid hyper_relid = ts_hypertable_id_to_relid(cagg->data.mat_hypertable_id, false);
@@ -688,7 +810,8 @@ process_cagg_invalidations_and_refresh(const ContinuousAgg *cagg,
 										   refresh_window,
 										   invalidations,
 										   context,
-										   bucketing_refresh_window);
+										   bucketing_refresh_window,
+										   materialized_ranges);
 		if (invalidations)
 			invalidation_store_free(invalidations);
 		return true;
@@ -708,6 +831,11 @@ continuous_agg_refresh_internal(const ContinuousAgg *cagg,
 	InternalTimeRange refresh_window = *refresh_window_arg;
 	int64 invalidation_threshold;
 	bool nonatomic = ts_process_utility_is_context_nonatomic();
+	/* Allocated in the caller's memory context, before connecting to SPI */
+	MaterializedRanges materialized_ranges = {
+		.mcxt = CurrentMemoryContext,
+		.ranges = NIL,
+	};
 
 	/* Reset the saved ProcessUtilityContext value promptly before
 	 * calling Prevent* checks so the potential unsupported (atomic)
@@ -889,7 +1017,8 @@ continuous_agg_refresh_internal(const ContinuousAgg *cagg,
 															&refresh_window,
 															context,
 															bucketing_refresh_window,
-															force);
+															force,
+															&materialized_ranges);
 
 	/* check if we have any pending materializations in our refresh window range,
 	 * if so, we need to process them
@@ -935,6 +1064,7 @@ continuous_agg_refresh_internal(const ContinuousAgg *cagg,
 		}
 
 		continuous_agg_refresh_execute(&refresh, &bucketed_refresh_window);
+		materialized_ranges_add(&materialized_ranges, &bucketed_refresh_window);
 	}
 
 	if (!refreshed && !has_pending_materializations)
@@ -953,6 +1083,119 @@ continuous_agg_refresh_internal(const ContinuousAgg *cagg,
 	rc = SPI_finish();
 	if (rc != SPI_OK_FINISH)
 		elog(ERROR, "SPI_finish failed: %s", SPI_result_code_string(rc));
+
+	if (context.cascade && materialized_ranges.ranges != NIL)
+		continuous_agg_refresh_cascade(mat_id, &materialized_ranges, context);
+}
+
+/*
+ * Refresh the continuous aggregates defined on top of a continuous aggregate.
+ *
+ * Materializing a range of a continuous aggregate invalidates the same range
+ * for all continuous aggregates that use its materialized hypertable as raw
+ * hypertable. Instead of leaving it to independent policies to pick up these
+ * invalidations later, we record the materialized ranges in the hypertable
+ * invalidation log, unless an existing entry already covers them, and refresh
+ * the dependent continuous aggregates right away for the buckets covering
+ * those ranges.
+ *
+ * Since every continuous aggregate has exactly one parent, the hierarchy is a
+ * tree and refreshing it depth-first (each dependent refresh cascades
+ * further) refreshes every level after the levels it depends on. The depth
+ * of the cascade is still limited to protect against a corrupt catalog
+ * forming a cycle and to bound the amount of work done by a single refresh.
+ */
+static void
+continuous_agg_refresh_cascade(int32 mat_hypertable_id,
+							   const MaterializedRanges *materialized_ranges,
+							   const ContinuousAggRefreshContext context)
+{
+	List *caggs = ts_continuous_aggs_find_by_raw_table_id(mat_hypertable_id);
+	List *ranges;
+	ListCell *lc;
+
+	if (caggs == NIL)
+		return;
+
+	/* Catalog data fetched during the refresh was released by SPI_finish() */
+	const ContinuousAgg *cagg =
+		ts_continuous_agg_find_by_mat_hypertable_id(mat_hypertable_id, false);
+
+	ranges = time_range_list_normalize(list_copy(materialized_ranges->ranges));
+
+	foreach (lc, ranges)
+	{
+		const InternalTimeRange *range = lfirst(lc);
+		/* Invalidations are inclusive at the end, while materialized ranges are not */
+		int64 end = ts_time_saturating_sub(range->end, 1, range->type);
+
+		if (!invalidation_hyper_log_covers_range(mat_hypertable_id, range->start, end))
+			invalidation_hyper_log_add_entry(mat_hypertable_id, range->start, end);
+	}
+
+	/* The invalidations are recorded, so the levels above will be refreshed
+	 * by their own policies even if we stop here. */
+	if (context.cascade_depth >= CAGG_CASCADE_MAX_DEPTH)
+	{
+		ereport(WARNING,
+				(errmsg("cascading refresh stopped at continuous aggregate \"%s\"",
+						NameStr(cagg->data.user_view_name)),
+				 errdetail("The maximum cascade depth of %d levels was reached.",
+						   CAGG_CASCADE_MAX_DEPTH),
+				 errhint("Continuous aggregates on the remaining levels are refreshed by their "
+						 "own refresh policies.")));
+		return;
+	}
+
+	foreach (lc, caggs)
+	{
+		const ContinuousAgg *dependent = lfirst(lc);
+		ContinuousAggRefreshContext dependent_context = {
+			.callctx = context.callctx == CAGG_REFRESH_POLICY_BATCHED ? CAGG_REFRESH_POLICY :
+																		context.callctx,
+			.cascade = true,
+			.cascade_depth = context.cascade_depth + 1,
+		};
+		List *refresh_windows = NIL;
+		ListCell *lc2;
+
+		/* Several materialized ranges can end up in the same bucket of the
+		 * dependent, so merge the bucketed windows before refreshing */
+		foreach (lc2, ranges)
+		{
+			InternalTimeRange refresh_window =
+				compute_circumscribed_bucketed_refresh_window(dependent,
+															  lfirst(lc2),
+															  dependent->bucket_function);
+
+			refresh_windows = lappend(refresh_windows, time_range_copy(&refresh_window));
+		}
+
+		refresh_windows = time_range_list_normalize(refresh_windows);
+
+		foreach (lc2, refresh_windows)
+		{
+			const InternalTimeRange *refresh_window = lfirst(lc2);
+
+			elog(CAGG_REFRESH_LOG_LEVEL,
+				 "cascading refresh from continuous aggregate \"%s\" to \"%s\" in window [ %s, "
+				 "%s ]",
+				 NameStr(cagg->data.user_view_name),
+				 NameStr(dependent->data.user_view_name),
+				 ts_internal_to_time_string(refresh_window->start, refresh_window->type),
+				 ts_internal_to_time_string(refresh_window->end, refresh_window->type));
+
+			continuous_agg_refresh_internal(dependent,
+											refresh_window,
+											dependent_context,
+											false, /* start_isnull */
+											false, /* end_isnull */
+											true,  /* bucketing_refresh_window */
+											false, /* force */
+											true,  /* process_hypertable_invalidations */
+											false /* extend_last_bucket */);
+		}
+	}
 }
 
 static void
@@ -11,6 +11,7 @@
 #include "bgw_policy/continuous_aggregate_api.h"
 #include "bgw_policy/job.h"
 #include "bgw_policy/job_api.h"
+#include "bgw_policy/merge_chunks_api.h"
 #include "bgw_policy/policies_v2.h"
 #include "bgw_policy/process_hyper_inval_api.h"
 #include "bgw_policy/reorder_api.h"
@@ -97,6 +98,9 @@ CrossModuleFunctions tsl_cm_functions = {
 	.policy_retention_proc = policy_retention_proc,
 	.policy_retention_check = policy_retention_check,
 	.policy_retention_remove = policy_retention_remove,
+	.policy_merge_chunks_add = policy_merge_chunks_add,
+	.policy_merge_chunks_check = policy_merge_chunks_check,
+	.policy_merge_chunks_remove = policy_merge_chunks_remove,
 
 	.job_add = job_add,
 	.job_alter = job_alter,
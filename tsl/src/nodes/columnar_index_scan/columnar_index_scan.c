@@ -6,12 +6,14 @@
 
 #include <postgres.h>
 
+#include <catalog/pg_type.h>
 #include <nodes/bitmapset.h>
 #include <nodes/makefuncs.h>
 #include <nodes/nodeFuncs.h>
 #include <nodes/pathnodes.h>
 #include <optimizer/optimizer.h>
 #include <parser/parsetree.h>
+#include <utils/fmgroids.h>
 
 #include "compression/create.h"
 #include "debug_assert.h"
@@ -53,7 +55,9 @@ _columnar_index_scan_init(void)
 /*
  * Check if an aggregate function can use compressed chunk sparse index.
  *
- * Currently supported aggregates are min, max, first, and last.
+ * Currently supported aggregates are min, max, first, and last, which use the
+ * minmax sparse index, and count(column) and sum(float8), which use the sum
+ * sparse index.
  * If supported, adds the chunk attno, metadata attno, and aggfnoid to the lists.
  */
 static bool
@@ -143,6 +147,18 @@ is_supported_aggregate(const CompressionInfo *info, Aggref *aggref, List **aggre
 		case F_MAX_XID8:
 			meta_type = "max";
 			break;
+		case F_SUM_FLOAT8:
+			/* The sum metadata has the same type only for float8 columns. */
+			if (var->vartype == FLOAT8OID)
+				meta_type = "sum";
+			break;
+		case F_COUNT_ANY:
+			/*
+			 * The per-batch counts are summed up, see
+			 * get_metadata_replacement_aggfnoid().
+			 */
+			meta_type = "count";
+			break;
 		default:
 			/* Initialize function cache for access to ts_first_func_oid and ts_last_func_oid */
 			if (!OidIsValid(ts_first_func_oid) || !OidIsValid(ts_last_func_oid))
@@ -184,6 +200,22 @@ is_supported_aggregate(const CompressionInfo *info, Aggref *aggref, List **aggre
 	return false;
 }
 
+/*
+ * Some aggregates have to be replaced by a different aggregate function over
+ * the metadata column. The count(column) is computed as sum(int4) over the
+ * per-batch counts, which has the same result and transition state type, so
+ * the partial aggregates remain compatible with the count() finalization.
+ * Returns InvalidOid if the aggregate is not replaced.
+ */
+static Oid
+get_metadata_replacement_aggfnoid(Oid aggfnoid)
+{
+	if (aggfnoid == F_COUNT_ANY)
+		return F_SUM_INT4;
+
+	return InvalidOid;
+}
+
 /*
  * Check if we can use a ColumnarIndexScan for the given query.
  *
@@ -427,10 +459,11 @@ build_output_map(ColumnarIndexScanPath *cispath, RelOptInfo *rel, List *output_t
 	List *custom_tlist = NIL;
 	List *output_map = NIL;
 
-	/* Three parallel lists for remap_info */
+	/* Four parallel lists for remap_info */
 	List *remap_original_positions = NIL;
 	List *remap_target_positions = NIL;
 	List *remap_aggfnoids = NIL;
+	List *remap_replacement_aggfnoids = NIL;
 
 	int resno = 0;
 
@@ -459,6 +492,14 @@ build_output_map(ColumnarIndexScanPath *cispath, RelOptInfo *rel, List *output_t
 
 			/* Create a new TargetEntry for this aggregate */
 			Var *new_var = copyObject(var);
+			const Oid replacement_aggfnoid = get_metadata_replacement_aggfnoid(aggfnoid);
+			if (OidIsValid(replacement_aggfnoid))
+			{
+				/* The per-batch counts are int4, not the type of the column. */
+				new_var->vartype = INT4OID;
+				new_var->vartypmod = -1;
+				new_var->varcollid = InvalidOid;
+			}
 			TargetEntry *new_tle = makeTargetEntry((Expr *) new_var, resno, NULL, false);
 			custom_tlist = lappend(custom_tlist, new_tle);
 
@@ -466,15 +507,18 @@ build_output_map(ColumnarIndexScanPath *cispath, RelOptInfo *rel, List *output_t
 			output_map = lappend_int(output_map, metadata_attno);
 
 			/*
-			 * Record remapping info when target position differs from original.
+			 * Record remapping info when target position differs from original,
+			 * or when the aggregate has to be replaced.
 			 * After setrefs, Aggrefs reference original_pos (position in output_targetlist).
 			 * We need to change them to reference resno (position in custom_tlist).
 			 */
-			if (resno != original_pos)
+			if (resno != original_pos || OidIsValid(replacement_aggfnoid))
 			{
 				remap_original_positions = lappend_int(remap_original_positions, original_pos);
 				remap_target_positions = lappend_int(remap_target_positions, resno);
 				remap_aggfnoids = lappend_oid(remap_aggfnoids, aggfnoid);
+				remap_replacement_aggfnoids =
+					lappend_oid(remap_replacement_aggfnoids, replacement_aggfnoid);
 			}
 			found_agg = true;
 
@@ -510,16 +554,19 @@ build_output_map(ColumnarIndexScanPath *cispath, RelOptInfo *rel, List *output_t
 				remap_original_positions = lappend_int(remap_original_positions, original_pos);
 				remap_aggfnoids = lappend_oid(remap_aggfnoids, InvalidOid);
 				remap_target_positions = lappend_int(remap_target_positions, resno);
+				remap_replacement_aggfnoids = lappend_oid(remap_replacement_aggfnoids, InvalidOid);
 			}
 		}
 	}
 
 	*output_map_out = output_map;
 
-	/* Store remap_info as three parallel lists, or NIL if no remapping needed */
+	/* Store remap_info as four parallel lists, or NIL if no remapping needed */
 	if (remap_original_positions != NIL)
-		*remap_info_out =
-			list_make3(remap_original_positions, remap_target_positions, remap_aggfnoids);
+		*remap_info_out = list_make4(remap_original_positions,
+									 remap_target_positions,
+									 remap_aggfnoids,
+									 remap_replacement_aggfnoids);
 	else
 		*remap_info_out = NIL;
 
@@ -571,8 +618,10 @@ columnar_index_scan_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *
  * Helper to fix Aggref args in an expression tree.
  * After setrefs, all Aggrefs referencing the same column have the same arg position.
  * We need to fix them based on aggfnoid to reference the correct position.
+ * The aggregates computed over a different metadata type are also replaced here.
  *
- * remap_info is list_make3(original_positions, target_positions, aggfnoids)
+ * remap_info is list_make4(original_positions, target_positions, aggfnoids,
+ * replacement_aggfnoids)
  */
 static bool
 fix_aggref_walker(Node *node, List *remap_info)
@@ -580,10 +629,11 @@ fix_aggref_walker(Node *node, List *remap_info)
 	if (node == NULL)
 		return false;
 
-	/* Extract the three parallel lists from remap_info */
+	/* Extract the parallel lists from remap_info */
 	List *original_positions = linitial(remap_info);
 	List *target_positions = lsecond(remap_info);
 	List *aggfnoids = lthird(remap_info);
+	List *replacement_aggfnoids = lfourth(remap_info);
 
 	if (IsA(node, Aggref))
 	{
@@ -594,6 +644,7 @@ fix_aggref_walker(Node *node, List *remap_info)
 		 * like first(val, time) which have multiple arguments that may all need
 		 * remapping.
 		 */
+		Oid replacement_aggfnoid = InvalidOid;
 		ListCell *arg_lc;
 		foreach (arg_lc, aggref->args)
 		{
@@ -607,10 +658,11 @@ fix_aggref_walker(Node *node, List *remap_info)
 			ListCell *pos_lc = list_head(original_positions);
 			ListCell *fnoid_lc = list_head(aggfnoids);
 			ListCell *target_lc = list_head(target_positions);
+			ListCell *replacement_lc = list_head(replacement_aggfnoids);
 
 			while (pos_lc != NULL)
 			{
-				Assert(fnoid_lc != NULL && target_lc != NULL);
+				Assert(fnoid_lc != NULL && target_lc != NULL && replacement_lc != NULL);
 
 				AttrNumber original_pos = lfirst_int(pos_lc);
 				Oid entry_aggfnoid = lfirst_oid(fnoid_lc);
@@ -620,14 +672,33 @@ fix_aggref_walker(Node *node, List *remap_info)
 				{
 					/* Apply remapping */
 					var->varattno = target_pos;
+					replacement_aggfnoid = lfirst_oid(replacement_lc);
 					break;
 				}
 
 				pos_lc = lnext(original_positions, pos_lc);
 				fnoid_lc = lnext(aggfnoids, fnoid_lc);
 				target_lc = lnext(target_positions, target_lc);
+				replacement_lc = lnext(replacement_aggfnoids, replacement_lc);
 			}
 		}
+
+		if (OidIsValid(replacement_aggfnoid))
+		{
+			/*
+			 * The only replacement is count(column) -> sum(int4) over the
+			 * per-batch counts, which has a single int4 argument.
+			 */
+			Assert(replacement_aggfnoid == F_SUM_INT4);
+			Assert(list_length(aggref->args) == 1);
+			Var *var = castNode(Var, linitial_node(TargetEntry, aggref->args)->expr);
+			var->vartype = INT4OID;
+			var->vartypmod = -1;
+			var->varcollid = InvalidOid;
+			aggref->aggfnoid = replacement_aggfnoid;
+			aggref->aggargtypes = list_make1_oid(INT4OID);
+		}
+
 		/* Don't recurse into Aggref args, we've handled it */
 		return false;
 	}
@@ -671,7 +742,8 @@ fix_aggref_walker(Node *node, List *remap_info)
 
 /*
  * Fix Aggref references in an Aggregate node's targetlist, qual, and grpColIdx.
- * remap_info is list_make3(original_positions, target_positions, aggfnoids)
+ * remap_info is list_make4(original_positions, target_positions, aggfnoids,
+ * replacement_aggfnoids)
  */
 static void
 fix_aggregate_aggrefs(Agg *agg, List *remap_info)
@@ -679,7 +751,7 @@ fix_aggregate_aggrefs(Agg *agg, List *remap_info)
 	fix_aggref_walker((Node *) agg->plan.targetlist, remap_info);
 	fix_aggref_walker((Node *) agg->plan.qual, remap_info);
 
-	/* Extract the three parallel lists from remap_info */
+	/* Extract the parallel lists from remap_info */
 	List *original_positions = linitial(remap_info);
 	List *target_positions = lsecond(remap_info);
 	List *aggfnoids = lthird(remap_info);
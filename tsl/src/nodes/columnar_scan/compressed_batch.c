@@ -6,13 +6,18 @@
 
 #include <postgres.h>
 
+#include <access/detoast.h>
 #include <executor/tuptable.h>
 #include <nodes/bitmapset.h>
 #include <utils/builtins.h>
 #include <utils/date.h>
+#include <utils/float.h>
+#include <utils/memutils.h>
 #include <utils/timestamp.h>
 #include <utils/uuid.h>
 
+#include "compression/algorithms/array.h"
+#include "compression/algorithms/jsonb_compress.h"
 #include "compression/arrow_c_data_interface.h"
 #include "compression/compression.h"
 #include "debug_assert.h"
@@ -140,8 +145,9 @@ make_single_value_arrow_text(Datum datum, bool isnull)
 ArrowArray *
 make_single_value_arrow(Oid pgtype, Datum datum, bool isnull)
 {
-	if (pgtype == TEXTOID)
+	if (pgtype == TEXTOID || pgtype == NUMERICOID)
 	{
+		/* Numeric has the same varlena columnar representation as text. */
 		return make_single_value_arrow_text(datum, isnull);
 	}
 
@@ -183,9 +189,125 @@ decompress_scalar_column(CompressedColumnValues *column, Datum value, bool isnul
 	*column->output_value = value;
 }
 
+/*
+ * Helpers for the detailed decompression profile. They do nothing when the
+ * node is not instrumented.
+ */
+static pg_attribute_always_inline void
+profile_start_timer(DecompressProfile *profile, instr_time *start)
+{
+	if (unlikely(profile != NULL) && profile->track_time)
+	{
+		INSTR_TIME_SET_CURRENT(*start);
+	}
+}
+
+static pg_attribute_always_inline void
+profile_accum_timer(DecompressProfile *profile, instr_time *start, instr_time *total)
+{
+	if (unlikely(profile != NULL) && profile->track_time)
+	{
+		instr_time end;
+		INSTR_TIME_SET_CURRENT(end);
+		INSTR_TIME_ACCUM_DIFF(*total, end, *start);
+		*start = end;
+	}
+}
+
+static void
+profile_count_detoast(DecompressProfile *profile, int column_index, Datum stored,
+					  Datum detoasted, instr_time *start)
+{
+	if (likely(profile == NULL))
+	{
+		return;
+	}
+
+	DecompressColumnProfile *column_profile = &profile->columns[column_index];
+	column_profile->bytes_read += toast_datum_size(stored);
+	if (VARATT_IS_EXTENDED(DatumGetPointer(stored)))
+	{
+		column_profile->bytes_detoasted += VARSIZE(DatumGetPointer(detoasted));
+	}
+
+	profile_accum_timer(profile, start, &profile->detoast_time);
+}
+
+static void
+profile_count_decompression(DecompressProfile *profile, CompressionAlgorithm algorithm,
+							instr_time *start)
+{
+	if (likely(profile == NULL))
+	{
+		return;
+	}
+
+	Assert(algorithm < _END_COMPRESSION_ALGORITHMS);
+	profile->algorithm_columns[algorithm]++;
+	profile_accum_timer(profile, start, &profile->algorithm_time[algorithm]);
+}
+
+static void
+profile_count_batch_memory(DecompressProfile *profile, DecompressBatchState *batch_state)
+{
+	if (likely(profile == NULL))
+	{
+		return;
+	}
+
+	const Size allocated = MemoryContextMemAllocated(batch_state->per_batch_context, true);
+	profile->max_batch_memory = Max(profile->max_batch_memory, allocated);
+}
+
+/*
+ * Prefetch the toast pages of all compressed columns that we are going to
+ * decompress for the current batch, so that the storage can read them
+ * concurrently instead of one synchronous read per toast chunk.
+ */
+static void
+prefetch_compressed_columns(DecompressContext *dcontext, DecompressBatchState *batch_state,
+							TupleTableSlot *compressed_slot)
+{
+	const int num_data_columns = dcontext->num_data_columns;
+	struct varlena **attrs = MemoryContextAlloc(batch_state->per_batch_context,
+												sizeof(struct varlena *) * num_data_columns);
+	int nattrs = 0;
+	for (int i = 0; i < num_data_columns; i++)
+	{
+		CompressionColumnDescription *column_description = &dcontext->compressed_chunk_columns[i];
+		if (batch_state->compressed_columns[i].decompression_type != DT_Invalid ||
+			column_description->decompress_on_demand)
+		{
+			continue;
+		}
+
+		bool isnull;
+		Datum value =
+			slot_getattr(compressed_slot, column_description->compressed_scan_attno, &isnull);
+		if (isnull || !VARATT_IS_EXTERNAL_ONDISK(DatumGetPointer(value)))
+		{
+			continue;
+		}
+
+		attrs[nattrs++] = (struct varlena *) DatumGetPointer(value);
+	}
+
+	if (nattrs > 0)
+	{
+		detoaster_prefetch(&dcontext->detoaster, attrs, nattrs);
+	}
+}
+
+/*
+ * Decompress the given column of the current batch.
+ *
+ * The selection bitmap, if not null, marks the rows that will be used after
+ * decompression. The values of the other rows can be left unmaterialized by
+ * the decompression algorithms that support this.
+ */
 static void
 decompress_column(DecompressContext *dcontext, DecompressBatchState *batch_state,
-				  TupleTableSlot *compressed_slot, int i)
+				  TupleTableSlot *compressed_slot, int i, const uint64 *selection)
 {
 	CompressionColumnDescription *column_description = &dcontext->compressed_chunk_columns[i];
 	CompressedColumnValues *column_values = &batch_state->compressed_columns[i];
@@ -214,17 +336,37 @@ decompress_column(DecompressContext *dcontext, DecompressBatchState *batch_state
 		return;
 	}
 
+	DecompressProfile *profile = dcontext->profile;
+	instr_time start;
+	INSTR_TIME_SET_ZERO(start);
+	profile_start_timer(profile, &start);
+
 	/* Detoast the compressed datum. */
+	const Datum stored_value = value;
 	value = PointerGetDatum(detoaster_detoast_attr_copy((struct varlena *) DatumGetPointer(value),
 														&dcontext->detoaster,
 														batch_state->per_batch_context));
 
+	profile_count_detoast(profile, i, stored_value, value, &start);
+
+	if (dcontext->column_stats != NULL)
+	{
+		DecompressionStatsCounts *column_stats = &dcontext->column_stats[i];
+		column_stats->counters[DSC_BatchesDecompressed]++;
+		column_stats->counters[DSC_RowsDecompressed] += batch_state->total_batch_rows;
+		if (VARATT_IS_EXTENDED(DatumGetPointer(stored_value)))
+		{
+			column_stats->counters[DSC_BytesDetoasted] += VARSIZE(DatumGetPointer(value));
+		}
+	}
+
 	CompressedDataHeader *header = (CompressedDataHeader *) value;
 
 	/* First check if this is a block of NULL values. */
 	if (header->compression_algorithm == COMPRESSION_ALGORITHM_NULL)
 	{
 		decompress_scalar_column(column_values, (Datum) NULL, /* isnull = */ true);
+		profile_count_decompression(profile, header->compression_algorithm, &start);
 		return;
 	}
 
@@ -246,13 +388,25 @@ decompress_column(DecompressContext *dcontext, DecompressBatchState *batch_state
 		MemoryContext context_before_decompression =
 			MemoryContextSwitchTo(dcontext->bulk_decompression_context);
 
-		arrow = decompress_all(PointerGetDatum(header),
-							   column_description->typid,
-							   batch_state->per_batch_context);
+		if (selection != NULL && header->compression_algorithm == COMPRESSION_ALGORITHM_ARRAY &&
+			column_description->typid == TEXTOID)
+		{
+			arrow = tsl_text_array_decompress_selected(PointerGetDatum(header),
+													   selection,
+													   batch_state->per_batch_context);
+		}
+		else
+		{
+			arrow = decompress_all(PointerGetDatum(header),
+								   column_description->typid,
+								   batch_state->per_batch_context);
+		}
 
 		MemoryContextSwitchTo(context_before_decompression);
 
 		MemoryContextReset(dcontext->bulk_decompression_context);
+
+		profile_count_decompression(profile, header->compression_algorithm, &start);
 	}
 
 	if (arrow == NULL)
@@ -265,6 +419,12 @@ decompress_column(DecompressContext *dcontext, DecompressBatchState *batch_state
 												dcontext->reverse)(PointerGetDatum(header),
 																   column_description->typid);
 		MemoryContextSwitchTo(old_context);
+
+		/*
+		 * Note that this only accounts for the iterator initialization, the
+		 * values are decompressed later row by row.
+		 */
+		profile_count_decompression(profile, header->compression_algorithm, &start);
 		return;
 	}
 
@@ -327,21 +487,12 @@ decompress_column(DecompressContext *dcontext, DecompressBatchState *batch_state
 }
 
 /*
- * Get the arrow array for the compressed batch via the VectorQualState.
- *
- * This is a ColumnarScan-specific implementation of the
- * VectorQualState->get_arrow_array() function used to interface with the
- * vector qual code across different scan nodes.
+ * Find the compressed column of the batch that is referenced by the given Var.
  */
-const ArrowArray *
-compressed_batch_get_arrow_array(VectorQualState *vqstate, Expr *expr, bool *is_default_value)
+static int
+find_compressed_column_index(DecompressContext *dcontext, const Var *var)
 {
-	CompressedBatchVectorQualState *cbvqstate = (CompressedBatchVectorQualState *) vqstate;
-	DecompressContext *dcontext = cbvqstate->dcontext;
-	DecompressBatchState *batch_state = cbvqstate->batch_state;
 	CompressionColumnDescription *column_description = NULL;
-	TupleTableSlot *compressed_slot = vqstate->slot;
-	const Var *var = castNode(Var, expr);
 	int column_index = 0;
 
 	for (; column_index < dcontext->num_data_columns; column_index++)
@@ -382,6 +533,103 @@ compressed_batch_get_arrow_array(VectorQualState *vqstate, Expr *expr, bool *is_
 	Assert(column_description != NULL);
 	Assert(column_description->typid == var->vartype);
 
+	return column_index;
+}
+
+/*
+ * Compute "column ->> 'key'" for a jsonb column of the compressed batch. This
+ * doesn't require reconstructing the documents if the key is stored as a
+ * separate field by the jsonb compression.
+ */
+static const ArrowArray *
+get_jsonb_field_arrow_array(CompressedBatchVectorQualState *cbvqstate, OpExpr *opexpr,
+							bool *is_default_value)
+{
+	DecompressContext *dcontext = cbvqstate->dcontext;
+	DecompressBatchState *batch_state = cbvqstate->batch_state;
+	TupleTableSlot *compressed_slot = cbvqstate->vqstate.slot;
+	const Var *var = castNode(Var, linitial(opexpr->args));
+	const Const *key = castNode(Const, lsecond(opexpr->args));
+	Ensure(!key->constisnull, "expected non-null key for jsonb field access");
+	text *key_text = DatumGetTextPP(key->constvalue);
+
+	const int column_index = find_compressed_column_index(dcontext, var);
+	CompressionColumnDescription *column_description =
+		&dcontext->compressed_chunk_columns[column_index];
+
+	bool isnull;
+	Datum value = slot_getattr(compressed_slot, column_description->compressed_scan_attno, &isnull);
+	if (isnull)
+	{
+		/*
+		 * The column has a default value for the entire batch, so the field
+		 * has the same value for the entire batch as well.
+		 */
+		Datum default_value = getmissingattr(dcontext->uncompressed_chunk_tdesc,
+											 column_description->uncompressed_chunk_attno,
+											 &isnull);
+		text *field = isnull ? NULL :
+							   jsonb_get_field_text(DatumGetJsonbP(default_value),
+													VARDATA_ANY(key_text),
+													VARSIZE_ANY_EXHDR(key_text));
+		*is_default_value = true;
+		return make_single_value_arrow(TEXTOID, PointerGetDatum(field), field == NULL);
+	}
+
+	value = PointerGetDatum(detoaster_detoast_attr_copy((struct varlena *) DatumGetPointer(value),
+														&dcontext->detoaster,
+														batch_state->per_batch_context));
+	CompressedDataHeader *header = (CompressedDataHeader *) DatumGetPointer(value);
+	if (header->compression_algorithm == COMPRESSION_ALGORITHM_NULL)
+	{
+		*is_default_value = true;
+		return make_single_value_arrow(TEXTOID, (Datum) 0, /* isnull = */ true);
+	}
+
+	if (dcontext->bulk_decompression_context == NULL)
+	{
+		dcontext->bulk_decompression_context =
+			create_bulk_decompression_mctx(MemoryContextGetParent(batch_state->per_batch_context));
+	}
+
+	MemoryContext context_before_decompression =
+		MemoryContextSwitchTo(dcontext->bulk_decompression_context);
+	ArrowArray *arrow = jsonb_compressed_field_text(value,
+													batch_state->total_batch_rows,
+													VARDATA_ANY(key_text),
+													VARSIZE_ANY_EXHDR(key_text),
+													batch_state->per_batch_context);
+	MemoryContextSwitchTo(context_before_decompression);
+	MemoryContextReset(dcontext->bulk_decompression_context);
+
+	*is_default_value = false;
+	return arrow;
+}
+
+/*
+ * Get the arrow array for the compressed batch via the VectorQualState.
+ *
+ * This is a ColumnarScan-specific implementation of the
+ * VectorQualState->get_arrow_array() function used to interface with the
+ * vector qual code across different scan nodes.
+ */
+const ArrowArray *
+compressed_batch_get_arrow_array(VectorQualState *vqstate, Expr *expr, bool *is_default_value)
+{
+	CompressedBatchVectorQualState *cbvqstate = (CompressedBatchVectorQualState *) vqstate;
+	DecompressContext *dcontext = cbvqstate->dcontext;
+	DecompressBatchState *batch_state = cbvqstate->batch_state;
+	TupleTableSlot *compressed_slot = vqstate->slot;
+
+	if (IsA(expr, OpExpr))
+	{
+		/* The planner only allows the jsonb field access here. */
+		return get_jsonb_field_arrow_array(cbvqstate, castNode(OpExpr, expr), is_default_value);
+	}
+
+	const int column_index = find_compressed_column_index(dcontext, castNode(Var, expr));
+	CompressionColumnDescription *column_description =
+		&dcontext->compressed_chunk_columns[column_index];
 	CompressedColumnValues *column_values = &batch_state->compressed_columns[column_index];
 
 	if (column_values->decompression_type == DT_Invalid)
@@ -391,7 +639,7 @@ compressed_batch_get_arrow_array(VectorQualState *vqstate, Expr *expr, bool *is_
 		 * skip decompressing some columns if the entire batch doesn't pass
 		 * the quals.
 		 */
-		decompress_column(dcontext, batch_state, compressed_slot, column_index);
+		decompress_column(dcontext, batch_state, compressed_slot, column_index, NULL);
 		Assert(column_values->decompression_type != DT_Invalid);
 	}
 
@@ -435,6 +683,80 @@ compressed_batch_get_arrow_array(VectorQualState *vqstate, Expr *expr, bool *is_
 	return vector;
 }
 
+/*
+ * Compute a "Var ? Var" predicate for two arithmetic columns of the batch.
+ */
+static void
+compute_vector_vector_qual(VectorQualState *vqstate, OpExpr *opexpr, uint64 *restrict result)
+{
+	VectorVectorPredicate *predicate = get_vector_vector_predicate(get_opcode(opexpr->opno));
+	Ensure(predicate != NULL, "vector-vector predicate not found for operator %u", opexpr->opno);
+
+	bool left_default = false;
+	bool right_default = false;
+	const ArrowArray *left =
+		vqstate->get_arrow_array(vqstate, linitial(opexpr->args), &left_default);
+	const ArrowArray *right =
+		vqstate->get_arrow_array(vqstate, lsecond(opexpr->args), &right_default);
+	Assert(left->dictionary == NULL && right->dictionary == NULL);
+
+	/*
+	 * If both columns have default values, compute the predicate for this
+	 * single pair of values, and apply it to the entire batch below.
+	 */
+	uint64 default_value_predicate_result[1] = { 1 };
+	const bool both_default = left_default && right_default;
+	uint64 *predicate_result = both_default ? default_value_predicate_result : result;
+	const size_t n_rows = both_default ? 1 : vqstate->num_results;
+
+	predicate(left, right, predicate_result);
+
+	/*
+	 * Account for nulls which shouldn't pass the predicate. If one of the
+	 * columns has a default value, its single validity bit applies to all rows.
+	 */
+	const size_t n_result_words = (n_rows + 63) / 64;
+	const ArrowArray *arrows[] = { left, right };
+	for (int i = 0; i < 2; i++)
+	{
+		const uint64 *validity = (const uint64 *) arrows[i]->buffers[0];
+		if (validity == NULL)
+		{
+			continue;
+		}
+
+		if ((size_t) arrows[i]->length < n_rows)
+		{
+			Assert(arrows[i]->length == 1);
+			const uint64 mask = (validity[0] & 1) ? ~0ULL : 0;
+			for (size_t word = 0; word < n_result_words; word++)
+			{
+				predicate_result[word] &= mask;
+			}
+		}
+		else
+		{
+			for (size_t word = 0; word < n_result_words; word++)
+			{
+				predicate_result[word] &= validity[word];
+			}
+		}
+	}
+
+	if (both_default && !(default_value_predicate_result[0] & 1))
+	{
+		/*
+		 * The default values didn't pass the predicate, so the entire batch
+		 * didn't pass.
+		 */
+		const size_t n_batch_result_words = (vqstate->num_results + 63) / 64;
+		for (size_t i = 0; i < n_batch_result_words; i++)
+		{
+			result[i] = 0;
+		}
+	}
+}
+
 static void
 compute_plain_qual(VectorQualState *vqstate, TupleTableSlot *slot, Node *qual,
 				   uint64 *restrict result)
@@ -470,8 +792,8 @@ compute_plain_qual(VectorQualState *vqstate, TupleTableSlot *slot, Node *qual,
 	}
 
 	/*
-	 * For now, we support NullTest, "Var ? Const" predicates,
-	 * boolean Variables, the negation of boolean variables
+	 * For now, we support NullTest, "Var ? Const" and "Var ? Var"
+	 * predicates, boolean Variables, the negation of boolean variables
 	 * and ScalarArrayOperations.
 	 */
 	List *args = NULL;
@@ -529,6 +851,12 @@ compute_plain_qual(VectorQualState *vqstate, TupleTableSlot *slot, Node *qual,
 		opexpr = castNode(OpExpr, qual);
 		args = opexpr->args;
 		vector_const_opcode = get_opcode(opexpr->opno);
+
+		if (IsA(lsecond(args), Var))
+		{
+			compute_vector_vector_qual(vqstate, opexpr, result);
+			return;
+		}
 	}
 
 	/*
@@ -699,6 +1027,41 @@ compute_qual_conjunction(VectorQualState *vqstate, TupleTableSlot *compressed_sl
 	}
 }
 
+/*
+ * Same as compute_qual_conjunction(), but also collects the runtime statistics
+ * of each qual for the adaptive reordering.
+ */
+static void
+compute_qual_conjunction_with_stats(VectorQualState *vqstate, TupleTableSlot *compressed_slot,
+									List *quals, uint64 *restrict result)
+{
+	int rows_in = arrow_num_valid(result, vqstate->num_results);
+	ListCell *lc;
+	foreach (lc, quals)
+	{
+		VectorQualStats *stats = &vqstate->qual_stats[foreach_current_index(lc)];
+
+		instr_time start;
+		instr_time end;
+		INSTR_TIME_SET_CURRENT(start);
+		compute_one_qual(vqstate, compressed_slot, lfirst(lc), result);
+		INSTR_TIME_SET_CURRENT(end);
+		INSTR_TIME_SUBTRACT(end, start);
+		stats->time += INSTR_TIME_GET_DOUBLE(end);
+
+		const int rows_passed = arrow_num_valid(result, vqstate->num_results);
+		stats->evaluations++;
+		stats->rows_in += rows_in;
+		stats->rows_passed += rows_passed;
+
+		if (rows_passed == 0)
+		{
+			return;
+		}
+		rows_in = rows_passed;
+	}
+}
+
 static void
 compute_qual_disjunction(VectorQualState *vqstate, TupleTableSlot *compressed_slot, List *quals,
 						 uint64 *restrict result)
@@ -813,14 +1176,109 @@ vector_qual_compute(VectorQualState *vqstate)
 	/*
 	 * Compute the quals.
 	 */
-	compute_qual_conjunction(vqstate,
-							 vqstate->slot,
-							 vqstate->vectorized_quals_constified,
-							 vqstate->vector_qual_result);
+	if (vqstate->qual_stats != NULL)
+	{
+		compute_qual_conjunction_with_stats(vqstate,
+											vqstate->slot,
+											vqstate->vectorized_quals_constified,
+											vqstate->vector_qual_result);
+	}
+	else
+	{
+		compute_qual_conjunction(vqstate,
+								 vqstate->slot,
+								 vqstate->vectorized_quals_constified,
+								 vqstate->vector_qual_result);
+	}
 
 	return get_vector_qual_summary(vqstate->vector_qual_result, n_rows);
 }
 
+/*
+ * The number of batches after which we reorder the vectorized quals according
+ * to their runtime statistics.
+ */
+#define VECTOR_QUAL_REORDER_INTERVAL 64
+
+typedef struct VectorQualRank
+{
+	Node *qual;
+	VectorQualStats stats;
+	double rank;
+	int position;
+} VectorQualRank;
+
+static int
+compare_vector_qual_rank(const void *a, const void *b)
+{
+	const VectorQualRank *ra = (const VectorQualRank *) a;
+	const VectorQualRank *rb = (const VectorQualRank *) b;
+	if (ra->rank != rb->rank)
+	{
+		return ra->rank < rb->rank ? -1 : 1;
+	}
+	return ra->position < rb->position ? -1 : (ra->position > rb->position);
+}
+
+/*
+ * Reorder the vectorized quals by their runtime statistics, so that the quals
+ * that eliminate the most rows per unit of evaluation time go first. Since we
+ * stop evaluating the quals once no rows of the batch pass, this avoids
+ * decompressing the columns for the subsequent quals in more batches.
+ *
+ * The rank of a qual is its average evaluation time per batch divided by the
+ * fraction of rows it eliminates. The quals that were not evaluated since the
+ * last reordering keep their relative order after the evaluated ones. The
+ * statistics are decayed after each reordering so that we adapt to the changes
+ * in the data distribution over the scan.
+ */
+static void
+reorder_vector_quals(DecompressContext *dcontext)
+{
+	List *quals = dcontext->vectorized_quals_constified;
+	const int nquals = list_length(quals);
+
+	VectorQualRank *ranks = palloc(sizeof(VectorQualRank) * nquals);
+	for (int i = 0; i < nquals; i++)
+	{
+		VectorQualStats *stats = &dcontext->vector_qual_stats[i];
+		double rank = get_float8_infinity();
+		if (stats->evaluations > 0 && stats->rows_in > 0)
+		{
+			const double time_per_batch = stats->time / stats->evaluations;
+			const double eliminated = 1.0 - stats->rows_passed / stats->rows_in;
+			rank = time_per_batch / Max(eliminated, 1e-6);
+		}
+
+		ranks[i] = (VectorQualRank){
+			.qual = list_nth(quals, i),
+			.stats = *stats,
+			.rank = rank,
+			.position = i,
+		};
+	}
+
+	qsort(ranks, nquals, sizeof(VectorQualRank), compare_vector_qual_rank);
+
+	/*
+	 * The list is allocated in the executor memory context, so we reorder it
+	 * in place.
+	 */
+	for (int i = 0; i < nquals; i++)
+	{
+		lfirst(list_nth_cell(quals, i)) = ranks[i].qual;
+
+		VectorQualStats *stats = &dcontext->vector_qual_stats[i];
+		*stats = ranks[i].stats;
+		stats->evaluations /= 2;
+		stats->rows_in /= 2;
+		stats->rows_passed /= 2;
+		stats->time /= 2;
+	}
+
+	pfree(ranks);
+}
+
 /*
  * Scrolls the compressed batch to the end, discarding any tuples left in it.
  * This makes the batch ready to accept the next compressed tuple, but without
@@ -904,6 +1362,22 @@ compressed_batch_lazy_init(DecompressContext *dcontext, DecompressBatchState *ba
 	slot->tts_ops->init(slot);
 }
 
+/*
+ * Decompress a column of the current batch that was skipped by
+ * compressed_batch_set_compressed_tuple() because it is decompressed on demand.
+ */
+void
+compressed_batch_decompress_column(DecompressContext *dcontext, DecompressBatchState *batch_state,
+								   TupleTableSlot *compressed_slot, int column_index)
+{
+	Assert(column_index < dcontext->num_data_columns);
+	if (batch_state->compressed_columns[column_index].decompression_type == DT_Invalid)
+	{
+		decompress_column(dcontext, batch_state, compressed_slot, column_index, NULL);
+		Assert(batch_state->compressed_columns[column_index].decompression_type != DT_Invalid);
+	}
+}
+
 /*
  * Initialize the batch decompression state with the new compressed  tuple.
  */
@@ -930,6 +1404,11 @@ compressed_batch_set_compressed_tuple(DecompressContext *dcontext,
 
 	MemoryContextReset(batch_state->per_batch_context);
 
+	if (dcontext->profile != NULL)
+	{
+		dcontext->profile->batches_read++;
+	}
+
 	for (int i = 0; i < dcontext->num_columns_with_metadata; i++)
 	{
 		CompressionColumnDescription *column_description = &dcontext->compressed_chunk_columns[i];
@@ -1041,10 +1520,18 @@ compressed_batch_set_compressed_tuple(DecompressContext *dcontext,
 		.dcontext = dcontext,
 	};
 	VectorQualState *vqstate = &cbvqstate.vqstate;
+	vqstate->qual_stats = dcontext->vector_qual_stats;
 
 	BatchQualSummary vector_qual_summary =
 		vqstate->vectorized_quals_constified != NIL ? vector_qual_compute(vqstate) : AllRowsPass;
 
+	if (dcontext->vector_qual_stats != NULL &&
+		++dcontext->batches_since_qual_reorder >= VECTOR_QUAL_REORDER_INTERVAL)
+	{
+		reorder_vector_quals(dcontext);
+		dcontext->batches_since_qual_reorder = 0;
+	}
+
 	batch_state->vector_qual_result = vqstate->vector_qual_result;
 
 	if (vector_qual_summary == NoRowsPass && !dcontext->batch_sorted_merge)
@@ -1059,6 +1546,20 @@ compressed_batch_set_compressed_tuple(DecompressContext *dcontext,
 		 * columns. This can be improved by only decompressing the columns
 		 * needed for sorting.
 		 */
+		DecompressProfile *profile = dcontext->profile;
+		if (profile != NULL)
+		{
+			profile->rows_removed_by_vectorized_filter += batch_state->total_batch_rows;
+			for (int i = 0; i < dcontext->num_data_columns; i++)
+			{
+				if (batch_state->compressed_columns[i].decompression_type == DT_Invalid)
+				{
+					profile->columns_skipped++;
+				}
+			}
+			profile_count_batch_memory(profile, batch_state);
+		}
+
 		compressed_batch_discard_tuples(batch_state);
 
 		InstrCountTuples2(dcontext->ps, 1);
@@ -1070,13 +1571,30 @@ compressed_batch_set_compressed_tuple(DecompressContext *dcontext,
 		 * We have some rows in the batch that pass the vectorized filters, so
 		 * we have to decompress the rest of the compressed columns.
 		 */
+		if (dcontext->enable_toast_prefetch)
+		{
+			prefetch_compressed_columns(dcontext, batch_state, compressed_slot);
+		}
+
+		/*
+		 * When only some rows pass, we don't have to materialize the values
+		 * of the other rows. This doesn't work with batch sorted merge, which
+		 * also reads the first row of the batch regardless of the filters.
+		 */
+		const uint64 *selection = NULL;
+		if (vector_qual_summary == SomeRowsPass && !dcontext->batch_sorted_merge)
+		{
+			selection = batch_state->vector_qual_result;
+		}
+
 		const int num_data_columns = dcontext->num_data_columns;
 		for (int i = 0; i < num_data_columns; i++)
 		{
 			CompressedColumnValues *column_values = &batch_state->compressed_columns[i];
-			if (column_values->decompression_type == DT_Invalid)
+			if (column_values->decompression_type == DT_Invalid &&
+				!dcontext->compressed_chunk_columns[i].decompress_on_demand)
 			{
-				decompress_column(dcontext, batch_state, compressed_slot, i);
+				decompress_column(dcontext, batch_state, compressed_slot, i, selection);
 				Assert(column_values->decompression_type != DT_Invalid);
 			}
 		}
@@ -1090,6 +1608,14 @@ compressed_batch_set_compressed_tuple(DecompressContext *dcontext,
 			batch_state->vector_qual_result = NULL;
 			vqstate->vector_qual_result = NULL;
 		}
+
+		profile_count_batch_memory(dcontext->profile, batch_state);
+
+		if (dcontext->chunk_stats != NULL)
+		{
+			dcontext->chunk_stats->counters[DSC_BatchesDecompressed]++;
+			dcontext->chunk_stats->counters[DSC_RowsDecompressed] += batch_state->total_batch_rows;
+		}
 	}
 }
 
@@ -1197,6 +1723,10 @@ compressed_batch_advance(DecompressContext *dcontext, DecompressBatchState *batc
 				}
 			}
 
+			if (dcontext->profile != NULL)
+			{
+				dcontext->profile->rows_removed_by_vectorized_filter++;
+			}
 			InstrCountFiltered1(dcontext->ps, 1);
 			continue;
 		}
@@ -1209,6 +1739,10 @@ compressed_batch_advance(DecompressContext *dcontext, DecompressBatchState *batc
 			 * The tuple didn't pass the qual, fetch the next one in the next
 			 * iteration.
 			 */
+			if (dcontext->profile != NULL)
+			{
+				dcontext->profile->rows_removed_by_filter++;
+			}
 			InstrCountFiltered1(dcontext->ps, 1);
 			continue;
 		}
@@ -1279,12 +1813,19 @@ compressed_batch_save_first_tuple(DecompressContext *dcontext, DecompressBatchSt
 	 * Check the quals and advance, so that the batch is in the correct state
 	 * for the subsequent calls (matching tuple is in decompressed scan slot).
 	 */
-	const bool qual_passed =
-		vector_qual(batch_state, arrow_row) && postgres_qual(dcontext, batch_state);
+	const bool vector_qual_passed = vector_qual(batch_state, arrow_row);
+	const bool qual_passed = vector_qual_passed && postgres_qual(dcontext, batch_state);
 	batch_state->next_batch_row++;
 
 	if (!qual_passed)
 	{
+		if (dcontext->profile != NULL)
+		{
+			if (vector_qual_passed)
+				dcontext->profile->rows_removed_by_filter++;
+			else
+				dcontext->profile->rows_removed_by_vectorized_filter++;
+		}
 		InstrCountFiltered1(dcontext->ps, 1);
 		compressed_batch_advance(dcontext, batch_state);
 	}
@@ -124,6 +124,10 @@ extern void compressed_batch_set_compressed_tuple(DecompressContext *dcontext,
 												  DecompressBatchState *batch_state,
 												  TupleTableSlot *compressed_slot);
 
+extern void compressed_batch_decompress_column(DecompressContext *dcontext,
+											   DecompressBatchState *batch_state,
+											   TupleTableSlot *compressed_slot, int column_index);
+
 extern void compressed_batch_advance(DecompressContext *dcontext,
 									 DecompressBatchState *batch_state);
 
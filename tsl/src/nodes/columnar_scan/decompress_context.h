@@ -11,9 +11,13 @@
 #include <executor/tuptable.h>
 #include <nodes/execnodes.h>
 #include <nodes/pg_list.h>
+#include <portability/instr_time.h>
 
 #include "batch_array.h"
+#include "compression/compression.h"
+#include "decompression_stats.h"
 #include "detoaster.h"
+#include "vector_quals.h"
 
 typedef enum CompressionColumnType
 {
@@ -50,8 +54,58 @@ typedef struct CompressionColumnDescription
 	AttrNumber compressed_scan_attno;
 
 	bool bulk_decompression_supported;
+
+	/*
+	 * Don't decompress this column when some rows of the batch pass the
+	 * vectorized quals, the consumer decompresses it on demand. VectorAgg uses
+	 * this for the columns that it can aggregate using the batch metadata.
+	 */
+	bool decompress_on_demand;
 } CompressionColumnDescription;
 
+typedef struct DecompressColumnProfile
+{
+	/* Stored size of the compressed data, possibly compressed by TOAST. */
+	int64 bytes_read;
+
+	/* Size of the compressed data that had to be detoasted. */
+	int64 bytes_detoasted;
+} DecompressColumnProfile;
+
+/*
+ * Detailed decompression counters shown by EXPLAIN (ANALYZE, VERBOSE). They
+ * are collected only when the node is instrumented and the
+ * timescaledb.explain_decompression_profile GUC is enabled. The timings are
+ * collected only when the instrumentation needs the timer.
+ */
+typedef struct DecompressProfile
+{
+	bool track_time;
+
+	int64 batches_read;
+
+	int64 rows_removed_by_vectorized_filter;
+	int64 rows_removed_by_filter;
+
+	/*
+	 * Compressed columns that we didn't have to decompress because no rows of
+	 * the batch passed the vectorized quals.
+	 */
+	int64 columns_skipped;
+
+	/* Peak memory allocated in the per-batch memory context. */
+	Size max_batch_memory;
+
+	instr_time detoast_time;
+
+	/* These are indexed by the compression algorithm. */
+	int64 algorithm_columns[_END_COMPRESSION_ALGORITHMS];
+	instr_time algorithm_time[_END_COMPRESSION_ALGORITHMS];
+
+	/* This follows the data columns of DecompressContext.compressed_chunk_columns. */
+	DecompressColumnProfile *columns;
+} DecompressProfile;
+
 typedef struct DecompressContext
 {
 	/*
@@ -72,9 +126,19 @@ typedef struct DecompressContext
 	int num_data_columns;
 
 	List *vectorized_quals_constified;
+
+	/*
+	 * Runtime statistics of the vectorized quals, used to periodically reorder
+	 * them so that the cheap and selective quals are evaluated first. Set when
+	 * there are several quals.
+	 */
+	VectorQualStats *vector_qual_stats;
+	int batches_since_qual_reorder;
+
 	bool reverse;
 	bool batch_sorted_merge; /* Batch sorted merge optimization enabled. */
 	bool enable_bulk_decompression;
+	bool enable_toast_prefetch;
 
 	/*
 	 * Scratch space for bulk decompression which might need a lot of temporary
@@ -94,6 +158,17 @@ typedef struct DecompressContext
 
 	PlanState *ps; /* Set for filtering and instrumentation */
 
+	/* Set when the decompression profile is collected for EXPLAIN ANALYZE. */
+	DecompressProfile *profile;
+
+	/*
+	 * The cumulative decompression statistics of the chunk and of its data
+	 * columns, set when they are collected. They are flushed to shared memory
+	 * when the node ends.
+	 */
+	DecompressionStatsCounts *chunk_stats;
+	DecompressionStatsCounts *column_stats;
+
 	Detoaster detoaster;
 
 	int32 chunk_status;
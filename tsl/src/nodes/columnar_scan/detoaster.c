@@ -15,19 +15,65 @@
 #include <access/table.h>
 #include <access/tableam.h>
 #include <access/toast_internals.h>
+#include <storage/bufmgr.h>
 #include <utils/expandeddatum.h>
 #include <utils/fmgroids.h>
 #include <utils/rel.h>
 #include <utils/relcache.h>
+#include <utils/spccache.h>
 
 #include <compat/compat.h>
 #include "debug_assert.h"
 #include <compression/compression.h>
 
+#if PG17_GE
+#include <storage/read_stream.h>
+#endif
+
 /* We redefine this postgres macro to fix a warning about signed integer comparison. */
 #define TS_VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer)                                            \
 	(((int32) VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer)) < (toast_pointer).va_rawsize - VARHDRSZ)
 
+/*
+ * Open the toast relation and its index, if not yet open.
+ */
+static void
+detoaster_open(Detoaster *detoaster, Oid toastrelid)
+{
+	if (detoaster->toastrel != NULL)
+	{
+		Ensure(detoaster->toastrel->rd_id == toastrelid,
+			   "unexpected toast pointer relid %d, expected %d",
+			   toastrelid,
+			   detoaster->toastrel->rd_id);
+		return;
+	}
+
+	MemoryContext old_mctx = MemoryContextSwitchTo(detoaster->mctx);
+	detoaster->toastrel = table_open(toastrelid, AccessShareLock);
+
+	int num_indexes;
+	Relation *toastidxs;
+	/* Look for the valid index of toast relation */
+	const int validIndex =
+		toast_open_indexes(detoaster->toastrel, AccessShareLock, &toastidxs, &num_indexes);
+	detoaster->index = toastidxs[validIndex];
+	for (int i = 0; i < num_indexes; i++)
+	{
+		if (i != validIndex)
+		{
+			index_close(toastidxs[i], AccessShareLock);
+		}
+	}
+
+#if PG18_GE
+	detoaster->SnapshotToast = *get_toast_snapshot();
+#else
+	init_toast_snapshot(&detoaster->SnapshotToast);
+#endif
+	MemoryContextSwitchTo(old_mctx);
+}
+
 /*
  * Fetch a TOAST slice from a heap table.
  *
@@ -44,24 +90,11 @@ ts_fetch_toast(Detoaster *detoaster, struct varatt_external *toast_pointer, stru
 	/*
 	 * Open the toast relation and its indexes
 	 */
-	if (detoaster->toastrel == NULL)
+	detoaster_open(detoaster, toast_pointer->va_toastrelid);
+
+	if (detoaster->toastscan == NULL)
 	{
 		MemoryContext old_mctx = MemoryContextSwitchTo(detoaster->mctx);
-		detoaster->toastrel = table_open(toast_pointer->va_toastrelid, AccessShareLock);
-
-		int num_indexes;
-		Relation *toastidxs;
-		/* Look for the valid index of toast relation */
-		const int validIndex =
-			toast_open_indexes(detoaster->toastrel, AccessShareLock, &toastidxs, &num_indexes);
-		detoaster->index = toastidxs[validIndex];
-		for (int i = 0; i < num_indexes; i++)
-		{
-			if (i != validIndex)
-			{
-				index_close(toastidxs[i], AccessShareLock);
-			}
-		}
 
 		/* Set up a scan key to fetch from the index. */
 		ScanKeyInit(&detoaster->toastkey,
@@ -71,11 +104,6 @@ ts_fetch_toast(Detoaster *detoaster, struct varatt_external *toast_pointer, stru
 					ObjectIdGetDatum(valueid));
 
 		/* Prepare for scan */
-#if PG18_GE
-		detoaster->SnapshotToast = *get_toast_snapshot();
-#else
-		init_toast_snapshot(&detoaster->SnapshotToast);
-#endif
 		detoaster->toastscan = systable_beginscan_ordered(detoaster->toastrel,
 														  detoaster->index,
 														  &detoaster->SnapshotToast,
@@ -85,10 +113,6 @@ ts_fetch_toast(Detoaster *detoaster, struct varatt_external *toast_pointer, stru
 	}
 	else
 	{
-		Ensure(detoaster->toastrel->rd_id == toast_pointer->va_toastrelid,
-			   "unexpected toast pointer relid %d, expected %d",
-			   toast_pointer->va_toastrelid,
-			   detoaster->toastrel->rd_id);
 		detoaster->toastkey.sk_argument = ObjectIdGetDatum(valueid);
 		index_rescan(detoaster->toastscan->iscan, &detoaster->toastkey, 1, NULL, 0);
 	}
@@ -224,6 +248,14 @@ void
 detoaster_init(Detoaster *detoaster, MemoryContext mctx)
 {
 	detoaster->toastrel = NULL;
+	detoaster->index = NULL;
+	detoaster->toastscan = NULL;
+	detoaster->prefetch_scan = NULL;
+	detoaster->prefetch_stream = NULL;
+	detoaster->prefetch_blocks = NULL;
+	detoaster->num_prefetch_blocks = 0;
+	detoaster->max_prefetch_blocks = 0;
+	detoaster->next_prefetch_block = 0;
 	detoaster->mctx = mctx;
 }
 
@@ -233,7 +265,23 @@ detoaster_close(Detoaster *detoaster)
 	/* Close toast table */
 	if (detoaster->toastrel != NULL)
 	{
-		systable_endscan_ordered(detoaster->toastscan);
+		if (detoaster->toastscan != NULL)
+		{
+			systable_endscan_ordered(detoaster->toastscan);
+			detoaster->toastscan = NULL;
+		}
+		if (detoaster->prefetch_scan != NULL)
+		{
+			index_endscan(detoaster->prefetch_scan);
+			detoaster->prefetch_scan = NULL;
+		}
+#if PG17_GE
+		if (detoaster->prefetch_stream != NULL)
+		{
+			read_stream_end(detoaster->prefetch_stream);
+			detoaster->prefetch_stream = NULL;
+		}
+#endif
 		table_close(detoaster->toastrel, AccessShareLock);
 		index_close(detoaster->index, AccessShareLock);
 		detoaster->toastrel = NULL;
@@ -241,6 +289,172 @@ detoaster_close(Detoaster *detoaster)
 	}
 }
 
+static int
+compare_block_numbers(const void *a, const void *b)
+{
+	const BlockNumber block_a = *(const BlockNumber *) a;
+	const BlockNumber block_b = *(const BlockNumber *) b;
+	return (block_a > block_b) - (block_a < block_b);
+}
+
+/*
+ * Add the toast relation blocks that store the given value to the prefetch
+ * list. The index lookups don't check the visibility, so we might also add the
+ * blocks of dead toast tuples, which is harmless.
+ */
+static void
+detoaster_collect_blocks(Detoaster *detoaster, Oid valueid)
+{
+	if (detoaster->prefetch_scan == NULL)
+	{
+		MemoryContext old_mctx = MemoryContextSwitchTo(detoaster->mctx);
+		ScanKeyInit(&detoaster->prefetch_key,
+					(AttrNumber) 1,
+					BTEqualStrategyNumber,
+					F_OIDEQ,
+					ObjectIdGetDatum(valueid));
+		detoaster->prefetch_scan = index_beginscan_compat(detoaster->toastrel,
+														  detoaster->index,
+														  &detoaster->SnapshotToast,
+														  NULL,
+														  1,
+														  0);
+		MemoryContextSwitchTo(old_mctx);
+	}
+	else
+	{
+		detoaster->prefetch_key.sk_argument = ObjectIdGetDatum(valueid);
+	}
+	index_rescan(detoaster->prefetch_scan, &detoaster->prefetch_key, 1, NULL, 0);
+
+	ItemPointer tid;
+	while ((tid = index_getnext_tid(detoaster->prefetch_scan, ForwardScanDirection)) != NULL)
+	{
+		if (detoaster->num_prefetch_blocks >= detoaster->max_prefetch_blocks)
+		{
+			const int new_max = Max(64, detoaster->max_prefetch_blocks * 2);
+			if (detoaster->prefetch_blocks == NULL)
+			{
+				detoaster->prefetch_blocks =
+					MemoryContextAlloc(detoaster->mctx, sizeof(BlockNumber) * new_max);
+			}
+			else
+			{
+				detoaster->prefetch_blocks =
+					repalloc(detoaster->prefetch_blocks, sizeof(BlockNumber) * new_max);
+			}
+			detoaster->max_prefetch_blocks = new_max;
+		}
+		detoaster->prefetch_blocks[detoaster->num_prefetch_blocks++] =
+			ItemPointerGetBlockNumber(tid);
+	}
+}
+
+#if PG17_GE
+static BlockNumber
+detoaster_read_stream_next_block(ReadStream *stream, void *callback_private_data,
+								 void *per_buffer_data)
+{
+	Detoaster *detoaster = (Detoaster *) callback_private_data;
+	if (detoaster->next_prefetch_block >= detoaster->num_prefetch_blocks)
+	{
+		return InvalidBlockNumber;
+	}
+	return detoaster->prefetch_blocks[detoaster->next_prefetch_block++];
+}
+#endif
+
+/*
+ * Prefetch the toast relation pages that store the given values, before they
+ * are detoasted one by one with detoaster_detoast_attr_copy().
+ *
+ * The compressed columns of a batch are usually stored out of line, and
+ * detoasting them issues a separate synchronous read for each toast chunk
+ * that is not in the buffer cache. Here we look up the locations of all toast
+ * chunks of the given values in the toast index together, and read the
+ * distinct heap pages in the physical order. This mostly helps cold-cache
+ * scans on high-latency storage.
+ *
+ * On Postgres 17 and later, the pages are read into the shared buffers
+ * through a read stream, which combines the adjacent pages into larger reads
+ * and keeps several of them in flight according to the I/O concurrency of the
+ * tablespace. On older versions, we only issue the prefetch requests.
+ */
+void
+detoaster_prefetch(Detoaster *detoaster, struct varlena **attrs, int nattrs)
+{
+	detoaster->num_prefetch_blocks = 0;
+	detoaster->next_prefetch_block = 0;
+
+	for (int i = 0; i < nattrs; i++)
+	{
+		if (!VARATT_IS_EXTERNAL_ONDISK(attrs[i]))
+		{
+			continue;
+		}
+
+		struct varatt_external toast_pointer;
+		VARATT_EXTERNAL_GET_POINTER(toast_pointer, attrs[i]);
+
+		detoaster_open(detoaster, toast_pointer.va_toastrelid);
+		detoaster_collect_blocks(detoaster, toast_pointer.va_valueid);
+	}
+
+	if (detoaster->num_prefetch_blocks == 0)
+	{
+		return;
+	}
+
+	/* Sort and deduplicate the blocks. */
+	BlockNumber *blocks = detoaster->prefetch_blocks;
+	qsort(blocks, detoaster->num_prefetch_blocks, sizeof(BlockNumber), compare_block_numbers);
+	int num_blocks = 1;
+	for (int i = 1; i < detoaster->num_prefetch_blocks; i++)
+	{
+		if (blocks[i] != blocks[num_blocks - 1])
+		{
+			blocks[num_blocks++] = blocks[i];
+		}
+	}
+	detoaster->num_prefetch_blocks = num_blocks;
+
+#if PG17_GE
+	if (detoaster->prefetch_stream == NULL)
+	{
+		MemoryContext old_mctx = MemoryContextSwitchTo(detoaster->mctx);
+		detoaster->prefetch_stream = read_stream_begin_relation(READ_STREAM_DEFAULT,
+																NULL,
+																detoaster->toastrel,
+																MAIN_FORKNUM,
+																detoaster_read_stream_next_block,
+																detoaster,
+																0);
+		MemoryContextSwitchTo(old_mctx);
+	}
+	else
+	{
+		read_stream_reset(detoaster->prefetch_stream);
+	}
+
+	Buffer buffer;
+	while ((buffer = read_stream_next_buffer(detoaster->prefetch_stream, NULL)) != InvalidBuffer)
+	{
+		ReleaseBuffer(buffer);
+	}
+#elif defined(USE_PREFETCH)
+	if (get_tablespace_io_concurrency(detoaster->toastrel->rd_rel->reltablespace) <= 0)
+	{
+		/* Prefetching is disabled for this tablespace. */
+		return;
+	}
+
+	for (int i = 0; i < num_blocks; i++)
+	{
+		PrefetchBuffer(detoaster->toastrel, MAIN_FORKNUM, blocks[i]);
+	}
+#endif
+}
+
 /*
  * Copy of Postgres' toast_fetch_datum(): Reconstruct an in memory Datum from
  * the chunks saved in the toast relation.
@@ -11,6 +11,7 @@
 #include <access/genam.h>
 #include <access/relscan.h>
 #include <access/skey.h>
+#include <storage/block.h>
 #include <utils/snapshot.h>
 
 typedef struct RelationData *Relation;
@@ -23,9 +24,24 @@ typedef struct Detoaster
 	SnapshotData SnapshotToast;
 	ScanKeyData toastkey;
 	SysScanDesc toastscan;
+
+	/* Index scan used to find the toast chunk locations for prefetching. */
+	ScanKeyData prefetch_key;
+	IndexScanDesc prefetch_scan;
+
+	/*
+	 * The sorted toast relation blocks to prefetch for the current batch, and
+	 * the read stream that reads them on Postgres 17 and later.
+	 */
+	BlockNumber *prefetch_blocks;
+	int num_prefetch_blocks;
+	int max_prefetch_blocks;
+	int next_prefetch_block;
+	struct ReadStream *prefetch_stream;
 } Detoaster;
 
 void detoaster_init(Detoaster *detoaster, MemoryContext mctx);
 void detoaster_close(Detoaster *detoaster);
+void detoaster_prefetch(Detoaster *detoaster, struct varlena **attrs, int nattrs);
 struct varlena *detoaster_detoast_attr_copy(struct varlena *attr, Detoaster *detoaster,
 											MemoryContext dest_mctx);
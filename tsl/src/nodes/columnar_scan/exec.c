@@ -15,6 +15,7 @@
 #include <parser/parsetree.h>
 #include <rewrite/rewriteManip.h>
 #include <tcop/tcopprot.h>
+#include <utils/builtins.h>
 #include <utils/datum.h>
 #include <utils/memutils.h>
 #include <utils/typcache.h>
@@ -161,6 +162,97 @@ constify_tableoid(List *node, Index chunk_index, Oid chunk_relid)
 pg_attribute_always_inline static TupleTableSlot *
 columnar_scan_exec_impl(ColumnarScanState *chunk_state, const BatchQueueFunctions *funcs);
 
+/*
+ * Estimate the relative cost of evaluating a vectorized qual, which is mostly
+ * the cost of decompressing the columns it references. The segmentby columns
+ * are free, the fixed-width columns are decompressed quickly, and the
+ * variable-width columns are the most expensive.
+ */
+static int
+vector_qual_cost(DecompressContext *dcontext, Node *qual)
+{
+	int cost = 0;
+	List *vars = pull_var_clause(qual, 0);
+	ListCell *lc;
+	foreach (lc, vars)
+	{
+		Var *var = castNode(Var, lfirst(lc));
+		for (int i = 0; i < dcontext->num_data_columns; i++)
+		{
+			CompressionColumnDescription *column = &dcontext->compressed_chunk_columns[i];
+			const AttrNumber attno = var->varno == INDEX_VAR ? column->custom_scan_attno :
+															   column->uncompressed_chunk_attno;
+			if (attno != var->varattno)
+			{
+				continue;
+			}
+
+			if (column->type == COMPRESSED_COLUMN)
+			{
+				cost += column->value_bytes > 0 ? 1 : 2;
+			}
+			break;
+		}
+	}
+	list_free(vars);
+	return cost;
+}
+
+typedef struct VectorQualOrder
+{
+	Node *qual;
+	int cost;
+	int position;
+} VectorQualOrder;
+
+static int
+compare_vector_qual_order(const void *a, const void *b)
+{
+	const VectorQualOrder *qa = (const VectorQualOrder *) a;
+	const VectorQualOrder *qb = (const VectorQualOrder *) b;
+	if (qa->cost != qb->cost)
+	{
+		return qa->cost < qb->cost ? -1 : 1;
+	}
+	return qa->position < qb->position ? -1 : (qa->position > qb->position);
+}
+
+/*
+ * Order the vectorized quals by the estimated cost of evaluation, keeping the
+ * original order for the quals of the same cost. We stop evaluating the quals
+ * for a batch as soon as no rows pass, so the cheap quals should go first to
+ * avoid decompressing the expensive columns for the batches they eliminate.
+ */
+static List *
+order_vector_quals_by_cost(DecompressContext *dcontext, List *quals)
+{
+	const int nquals = list_length(quals);
+	if (nquals < 2)
+	{
+		return quals;
+	}
+
+	VectorQualOrder *order = palloc(sizeof(VectorQualOrder) * nquals);
+	for (int i = 0; i < nquals; i++)
+	{
+		Node *qual = list_nth(quals, i);
+		order[i] = (VectorQualOrder){
+			.qual = qual,
+			.cost = vector_qual_cost(dcontext, qual),
+			.position = i,
+		};
+	}
+	qsort(order, nquals, sizeof(VectorQualOrder), compare_vector_qual_order);
+
+	List *result = NIL;
+	for (int i = 0; i < nquals; i++)
+	{
+		result = lappend(result, order[i].qual);
+	}
+	pfree(order);
+	return result;
+}
+
 static TupleTableSlot *
 columnar_scan_exec_fifo(CustomScanState *node)
 {
@@ -277,6 +369,20 @@ columnar_scan_begin(CustomScanState *node, EState *estate, int eflags)
 	dcontext->custom_scan_slot = node->ss.ss_ScanTupleSlot;
 	dcontext->uncompressed_chunk_tdesc = RelationGetDescr(node->ss.ss_currentRelation);
 	dcontext->ps = &node->ss.ps;
+	dcontext->enable_toast_prefetch = ts_guc_enable_compressed_toast_prefetch;
+
+	if (ts_guc_explain_decompression_profile && node->ss.ps.instrument != NULL)
+	{
+		dcontext->profile = palloc0(sizeof(DecompressProfile));
+		dcontext->profile->track_time = node->ss.ps.instrument->need_timer;
+		dcontext->profile->columns = palloc0(sizeof(DecompressColumnProfile) * num_data_columns);
+	}
+
+	if (ts_decompression_stats_enabled())
+	{
+		dcontext->chunk_stats = palloc0(sizeof(DecompressionStatsCounts));
+		dcontext->column_stats = palloc0(sizeof(DecompressionStatsCounts) * num_data_columns);
+	}
 
 	TupleDesc desc = dcontext->custom_scan_slot->tts_tupleDescriptor;
 
@@ -416,6 +522,19 @@ columnar_scan_begin(CustomScanState *node, EState *estate, int eflags)
 		dcontext->vectorized_quals_constified =
 			lappend(dcontext->vectorized_quals_constified, constified);
 	}
+	dcontext->vectorized_quals_constified =
+		order_vector_quals_by_cost(dcontext, dcontext->vectorized_quals_constified);
+
+	/*
+	 * With several vectorized quals, the initial order might be suboptimal
+	 * because we don't know their selectivity, so we collect their runtime
+	 * statistics to reorder them.
+	 */
+	if (list_length(dcontext->vectorized_quals_constified) > 1)
+	{
+		dcontext->vector_qual_stats =
+			palloc0(sizeof(VectorQualStats) * list_length(dcontext->vectorized_quals_constified));
+	}
 
 	detoaster_init(&dcontext->detoaster, CurrentMemoryContext);
 }
@@ -485,6 +604,32 @@ columnar_scan_rescan(CustomScanState *node)
 	ExecReScan(linitial(node->custom_ps));
 }
 
+/*
+ * Add the decompression statistics collected by this node to the cumulative
+ * statistics of the chunk and of its columns.
+ */
+static void
+report_decompression_stats(DecompressContext *dcontext, Oid chunk_relid)
+{
+	if (dcontext->chunk_stats == NULL)
+	{
+		return;
+	}
+
+	ts_decompression_stats_add(chunk_relid, InvalidAttrNumber, dcontext->chunk_stats);
+
+	for (int i = 0; i < dcontext->num_data_columns; i++)
+	{
+		const CompressionColumnDescription *column = &dcontext->compressed_chunk_columns[i];
+		const DecompressionStatsCounts *column_stats = &dcontext->column_stats[i];
+		if (column->type == COMPRESSED_COLUMN &&
+			column_stats->counters[DSC_BatchesDecompressed] > 0)
+		{
+			ts_decompression_stats_add(chunk_relid, column->uncompressed_chunk_attno, column_stats);
+		}
+	}
+}
+
 /* End the decompress operation and free the requested resources */
 static void
 columnar_scan_end(CustomScanState *node)
@@ -496,6 +641,113 @@ columnar_scan_end(CustomScanState *node)
 	ExecEndNode(linitial(node->custom_ps));
 
 	detoaster_close(&chunk_state->decompress_context.detoaster);
+
+	report_decompression_stats(&chunk_state->decompress_context,
+							   RelationGetRelid(node->ss.ss_currentRelation));
+}
+
+/*
+ * Show the detailed decompression profile for EXPLAIN (ANALYZE, VERBOSE).
+ */
+static void
+show_decompress_profile(DecompressContext *dcontext, ExplainState *es)
+{
+	const DecompressProfile *profile = dcontext->profile;
+	Assert(profile != NULL);
+
+	ExplainPropertyInteger("Batches Read", NULL, profile->batches_read, es);
+	ExplainPropertyInteger("Rows Removed by Vectorized Filter",
+						   NULL,
+						   profile->rows_removed_by_vectorized_filter,
+						   es);
+	ExplainPropertyInteger("Rows Removed by Row Filter", NULL, profile->rows_removed_by_filter, es);
+	ExplainPropertyInteger("Lazily Skipped Columns", NULL, profile->columns_skipped, es);
+	ExplainPropertyInteger("Peak Batch Memory",
+						   "kB",
+						   (profile->max_batch_memory + 1023) / 1024,
+						   es);
+	if (profile->track_time)
+	{
+		ExplainPropertyFloat("Detoast Time",
+							 "ms",
+							 INSTR_TIME_GET_MILLISEC(profile->detoast_time),
+							 3,
+							 es);
+	}
+
+	/* Per-algorithm decompression counts and timings. */
+	ExplainOpenGroup("Decompression", "Decompression", false, es);
+	for (int algorithm = 0; algorithm < _END_COMPRESSION_ALGORITHMS; algorithm++)
+	{
+		if (profile->algorithm_columns[algorithm] == 0)
+		{
+			continue;
+		}
+
+		const char *name = NameStr(*compression_get_algorithm_name(algorithm));
+		const double time_ms = INSTR_TIME_GET_MILLISEC(profile->algorithm_time[algorithm]);
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+		{
+			appendStringInfoSpaces(es->str, es->indent * 2);
+			appendStringInfo(es->str,
+							 "Decompression %s: columns=" INT64_FORMAT,
+							 name,
+							 profile->algorithm_columns[algorithm]);
+			if (profile->track_time)
+			{
+				appendStringInfo(es->str, " time=%.3f ms", time_ms);
+			}
+			appendStringInfoChar(es->str, '\n');
+		}
+		else
+		{
+			ExplainOpenGroup("Algorithm", NULL, true, es);
+			ExplainPropertyText("Algorithm", name, es);
+			ExplainPropertyInteger("Columns", NULL, profile->algorithm_columns[algorithm], es);
+			if (profile->track_time)
+			{
+				ExplainPropertyFloat("Time", "ms", time_ms, 3, es);
+			}
+			ExplainCloseGroup("Algorithm", NULL, true, es);
+		}
+	}
+	ExplainCloseGroup("Decompression", "Decompression", false, es);
+
+	/* Per-column sizes of the compressed data. */
+	TupleDesc desc = dcontext->custom_scan_slot->tts_tupleDescriptor;
+	ExplainOpenGroup("Compressed Columns", "Compressed Columns", false, es);
+	for (int i = 0; i < dcontext->num_data_columns; i++)
+	{
+		const CompressionColumnDescription *column = &dcontext->compressed_chunk_columns[i];
+		const DecompressColumnProfile *column_profile = &profile->columns[i];
+		if (column->type != COMPRESSED_COLUMN || column_profile->bytes_read == 0)
+		{
+			continue;
+		}
+
+		const Form_pg_attribute attr =
+			TupleDescAttr(desc, AttrNumberGetAttrOffset(column->custom_scan_attno));
+		const char *name = NameStr(attr->attname);
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+		{
+			appendStringInfoSpaces(es->str, es->indent * 2);
+			appendStringInfo(es->str,
+							 "Compressed Column %s: read=" INT64_FORMAT
+							 " bytes detoasted=" INT64_FORMAT " bytes\n",
+							 quote_identifier(name),
+							 column_profile->bytes_read,
+							 column_profile->bytes_detoasted);
+		}
+		else
+		{
+			ExplainOpenGroup("Compressed Column", NULL, true, es);
+			ExplainPropertyText("Column", name, es);
+			ExplainPropertyInteger("Bytes Read", "bytes", column_profile->bytes_read, es);
+			ExplainPropertyInteger("Bytes Detoasted", "bytes", column_profile->bytes_detoasted, es);
+			ExplainCloseGroup("Compressed Column", NULL, true, es);
+		}
+	}
+	ExplainCloseGroup("Compressed Columns", "Compressed Columns", false, es);
 }
 
 /*
@@ -565,4 +817,9 @@ columnar_scan_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 								es);
 		}
 	}
+
+	if (es->analyze && es->verbose && dcontext->profile != NULL)
+	{
+		show_decompress_profile(dcontext, es);
+	}
 }
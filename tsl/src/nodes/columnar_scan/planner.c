@@ -6,6 +6,7 @@
 
 #include <postgres.h>
 #include <access/sysattr.h>
+#include <catalog/pg_collation.h>
 #include <catalog/pg_namespace.h>
 #include <catalog/pg_operator.h>
 #include <nodes/bitmapset.h>
@@ -22,6 +23,7 @@
 #include <parser/parse_relation.h>
 #include <parser/parsetree.h>
 #include <utils/builtins.h>
+#include <utils/fmgroids.h>
 #include <utils/typcache.h>
 
 #include "compression/compression.h"
@@ -78,6 +80,11 @@ check_for_system_columns(Bitmapset *attrs_used)
 typedef struct
 {
 	bool bulk_decompression_possible;
+	/*
+	 * Whether the top-level fields of this jsonb column can be read without
+	 * decompressing the entire documents.
+	 */
+	bool jsonb_field_extraction_possible;
 	int custom_scan_attno;
 } UncompressedColumnInfo;
 
@@ -170,6 +177,20 @@ build_vector_attrs_array(const UncompressedColumnInfo *colinfo, const Compressio
 	return vector_attrs;
 }
 
+static bool *
+build_jsonb_field_attrs_array(const UncompressedColumnInfo *colinfo, const CompressionInfo *info)
+{
+	const AttrNumber arrlen = info->chunk_rel->max_attr + 1;
+	bool *jsonb_field_attrs = palloc(sizeof(bool) * arrlen);
+
+	for (AttrNumber attno = 0; attno < arrlen; attno++)
+	{
+		jsonb_field_attrs[attno] = colinfo[attno].jsonb_field_extraction_possible;
+	}
+
+	return jsonb_field_attrs;
+}
+
 /*
  * Try to make the custom scan targetlist that follows the order of the
  * pathtarget. This would allow us to avoid a projection from scan tuple to
@@ -403,6 +424,10 @@ build_decompression_map(DecompressionMapContext *context, List *compressed_outpu
 				NULL;
 		context->have_bulk_decompression_columns |= bulk_decompression_possible;
 
+		const bool jsonb_field_extraction_possible =
+			!is_segment && destination_attno > 0 && typoid == JSONBOID &&
+			compression_get_default_algorithm(typoid) == COMPRESSION_ALGORITHM_JSONB;
+
 		/*
 		 * Save information about decompressed columns in uncompressed chunk
 		 * for planning of vectorized filters.
@@ -411,6 +436,7 @@ build_decompression_map(DecompressionMapContext *context, List *compressed_outpu
 		{
 			context->uncompressed_attno_info[uncompressed_chunk_attno] = (UncompressedColumnInfo){
 				.bulk_decompression_possible = bulk_decompression_possible,
+				.jsonb_field_extraction_possible = jsonb_field_extraction_possible,
 				.custom_scan_attno = InvalidAttrNumber,
 			};
 		}
@@ -671,6 +697,82 @@ is_not_runtime_constant(Node *node)
 	return result;
 }
 
+/*
+ * Check whether the expression is "column ->> 'key'" for a jsonb column of
+ * this relation that stores the top-level fields separately.
+ */
+static bool
+is_vector_jsonb_field(Node *node, const VectorQualInfo *vqinfo)
+{
+	if (vqinfo->jsonb_field_attrs == NULL || !IsA(node, OpExpr))
+	{
+		return false;
+	}
+
+	OpExpr *opexpr = castNode(OpExpr, node);
+	if (get_opcode(opexpr->opno) != F_JSONB_OBJECT_FIELD_TEXT ||
+		list_length(opexpr->args) != 2 || !IsA(linitial(opexpr->args), Var) ||
+		!IsA(lsecond(opexpr->args), Const))
+	{
+		return false;
+	}
+
+	Var *var = castNode(Var, linitial(opexpr->args));
+	Const *key = castNode(Const, lsecond(opexpr->args));
+	return (Index) var->varno == vqinfo->rti && var->varattno > 0 &&
+		   var->varattno <= vqinfo->maxattno && vqinfo->jsonb_field_attrs[var->varattno] &&
+		   !key->constisnull;
+}
+
+/*
+ * Check whether the argument of a simple predicate is something we can get as
+ * an arrow array: a Var of this relation that supports bulk decompression, or
+ * a top-level field of a jsonb column.
+ */
+static bool
+is_vector_predicate_arg(Node *arg, const VectorQualInfo *vqinfo)
+{
+	if (is_vector_jsonb_field(arg, vqinfo))
+	{
+		return true;
+	}
+
+	if (!IsA(arg, Var))
+	{
+		return false;
+	}
+
+	Var *var = castNode(Var, arg);
+	if ((Index) var->varno != vqinfo->rti)
+	{
+		/*
+		 * We have a Var from other relation (join clause), can't vectorize it
+		 * at the moment.
+		 */
+		return false;
+	}
+
+	if (var->varattno <= 0)
+	{
+		/*
+		 * Can't vectorize operators with special variables such as whole-row var.
+		 */
+		return false;
+	}
+
+	/*
+	 * ExecQual is performed before ExecProject and operates on the decompressed
+	 * scan slot, so the qual attnos are the uncompressed chunk attnos.
+	 */
+	if (!vqinfo->vector_attrs[var->varattno])
+	{
+		/* This column doesn't support bulk decompression. */
+		return false;
+	}
+
+	return true;
+}
+
 /*
  * Try to check if the current qual is vectorizable, and if needed make a
  * commuted copy. If not, return NULL.
@@ -739,9 +841,9 @@ vector_qual_make(Node *qual, const VectorQualInfo *vqinfo)
 	}
 
 	/*
-	 * Among the simple predicates, we vectorize some "Var op Const" binary
-	 * predicates, scalar array operations with these predicates, boolean variables
-	 * and null test.
+	 * Among the simple predicates, we vectorize some "Var op Const" and
+	 * "Var op Var" binary predicates, scalar array operations with these
+	 * predicates, boolean variables and null test.
 	 */
 	NullTest *nulltest = NULL;
 	OpExpr *opexpr = NULL;
@@ -806,7 +908,7 @@ vector_qual_make(Node *qual, const VectorQualInfo *vqinfo)
 		return NULL;
 	}
 
-	if (opexpr && IsA(arg2, Var))
+	if (opexpr && !IsA(arg1, Var) && (IsA(arg2, Var) || is_vector_jsonb_field(arg2, vqinfo)))
 	{
 		/*
 		 * Try to commute the operator if we have Var on the right.
@@ -831,48 +933,36 @@ vector_qual_make(Node *qual, const VectorQualInfo *vqinfo)
 	}
 
 	/*
-	 * We can vectorize the operation where the left side is a Var.
+	 * We can vectorize the operation where the left side is a Var or a jsonb
+	 * field.
 	 */
-	if (!IsA(arg1, Var))
+	if (!is_vector_predicate_arg(arg1, vqinfo))
 	{
 		return NULL;
 	}
 
-	var = castNode(Var, arg1);
-	if ((Index) var->varno != vqinfo->rti)
+	if (nulltest)
 	{
 		/*
-		 * We have a Var from other relation (join clause), can't vectorize it
-		 * at the moment.
+		 * The checks we've done to this point is all that is required for null
+		 * test.
 		 */
-		return NULL;
+		return (Node *) nulltest;
 	}
 
-	if (var->varattno <= 0)
+	if (opexpr && IsA(arg2, Var))
 	{
 		/*
-		 * Can't vectorize operators with special variables such as whole-row var.
+		 * We can vectorize the comparison of two columns of this relation for
+		 * the arithmetic types.
 		 */
-		return NULL;
-	}
-
-	/*
-	 * ExecQual is performed before ExecProject and operates on the decompressed
-	 * scan slot, so the qual attnos are the uncompressed chunk attnos.
-	 */
-	if (!vqinfo->vector_attrs[var->varattno])
-	{
-		/* This column doesn't support bulk decompression. */
-		return NULL;
-	}
+		if (!IsA(arg1, Var) || !is_vector_predicate_arg(arg2, vqinfo) ||
+			get_vector_vector_predicate(get_opcode(opno)) == NULL)
+		{
+			return NULL;
+		}
 
-	if (nulltest)
-	{
-		/*
-		 * The checks we've done to this point is all that is required for null
-		 * test.
-		 */
-		return (Node *) nulltest;
+		return (Node *) opexpr;
 	}
 
 	/*
@@ -891,7 +981,8 @@ vector_qual_make(Node *qual, const VectorQualInfo *vqinfo)
 		return NULL;
 	}
 
-	if (OidIsValid(var->varcollid) && !get_collation_isdeterministic(var->varcollid))
+	const Oid collid = exprCollation(arg1);
+	if (OidIsValid(collid) && !get_collation_isdeterministic(collid))
 	{
 		/*
 		 * Can't vectorize string equality with a nondeterministic collation.
@@ -903,6 +994,19 @@ vector_qual_make(Node *qual, const VectorQualInfo *vqinfo)
 		return NULL;
 	}
 
+	if (vector_const_predicate_needs_c_collation(opcode))
+	{
+		const Oid inputcollid = opexpr ? opexpr->inputcollid : saop->inputcollid;
+		if (inputcollid != C_COLLATION_OID && inputcollid != POSIX_COLLATION_OID)
+		{
+			/*
+			 * Our implementation of this predicate is only valid for the C
+			 * collation.
+			 */
+			return NULL;
+		}
+	}
+
 	if (opexpr)
 	{
 		/*
@@ -964,6 +1068,8 @@ find_vectorized_quals(DecompressionMapContext *context, ColumnarScanPath *path,
 	VectorQualInfo vqi = {
 		.maxattno = path->info->chunk_rel->max_attr,
 		.vector_attrs = build_vector_attrs_array(context->uncompressed_attno_info, path->info),
+		.jsonb_field_attrs =
+			build_jsonb_field_attrs_array(context->uncompressed_attno_info, path->info),
 		.rti = path->info->chunk_rel->relid,
 	};
 
@@ -992,6 +1098,7 @@ find_vectorized_quals(DecompressionMapContext *context, ColumnarScanPath *path,
 	}
 
 	pfree(vqi.vector_attrs);
+	pfree(vqi.jsonb_field_attrs);
 }
 
 /*
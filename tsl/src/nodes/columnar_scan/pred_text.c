@@ -6,7 +6,9 @@
 
 #include "pred_text.h"
 
+#include <catalog/pg_collation.h>
 #include <miscadmin.h>
+#include <regex/regex.h>
 
 #include "compat/compat.h"
 
@@ -99,6 +101,23 @@ vector_const_textne(const ArrowArray *arrow, const Datum constdatum, uint64 *res
 
 #include "import/ts_like_match.c"
 
+/*
+ * The case-insensitive variant for ILIKE. Postgres lowercases both the text
+ * and the pattern for multibyte encodings, and under the C collation only the
+ * ASCII letters are lowercased, so we can do this on the fly. The bytes of the
+ * UTF8 multibyte characters are never in the ASCII range.
+ */
+#define NextChar(p, plen)                                                                          \
+	do                                                                                             \
+	{                                                                                              \
+		(p)++;                                                                                     \
+		(plen)--;                                                                                  \
+	} while ((plen) > 0 && (*(p) &0xC0) == 0x80)
+#define MATCH_LOWER(t) pg_ascii_tolower((unsigned char) (t))
+#define MatchText UTF8_ASCII_ICaseMatchText
+
+#include "import/ts_like_match.c"
+
 /*
  * ----------------------------------------------------------------------------
  * The copy of PG code ends here.
@@ -169,3 +188,200 @@ vector_const_textnlike_utf8(const ArrowArray *arrow, const Datum constdatum,
 {
 	vector_const_like_impl(arrow, constdatum, result, UTF8_MatchText, /* should_match = */ false);
 }
+
+void
+vector_const_texticlike_utf8(const ArrowArray *arrow, const Datum constdatum,
+							 uint64 *restrict result)
+{
+	vector_const_like_impl(arrow,
+						   constdatum,
+						   result,
+						   UTF8_ASCII_ICaseMatchText,
+						   /* should_match = */ true);
+}
+
+void
+vector_const_texticnlike_utf8(const ArrowArray *arrow, const Datum constdatum,
+							  uint64 *restrict result)
+{
+	vector_const_like_impl(arrow,
+						   constdatum,
+						   result,
+						   UTF8_ASCII_ICaseMatchText,
+						   /* should_match = */ false);
+}
+
+/*
+ * Regular expression match. The compiled regexes are cached by Postgres, so
+ * the compilation happens once per pattern. These predicates are only used
+ * with the C collation, see vector_const_predicate_needs_c_collation().
+ */
+static void
+vector_const_regex_impl(const ArrowArray *arrow, const Datum constdatum, uint64 *restrict result,
+						int cflags, bool should_match)
+{
+	Assert(!arrow->dictionary);
+
+	text *pattern = (text *) DatumGetPointer(constdatum);
+	const uint32 *offsets = (uint32 *) arrow->buffers[1];
+	char *values = (char *) arrow->buffers[2];
+
+	const size_t n = arrow->length;
+	for (size_t outer = 0; outer < (n + 63) / 64; outer++)
+	{
+		const size_t rows = Min(n - outer * 64, 64);
+		uint64 word = 0;
+		for (size_t inner = 0; inner < rows; inner++)
+		{
+			const size_t row = outer * 64 + inner;
+			const uint32 start = offsets[row];
+			const uint32 end = offsets[row + 1];
+			Assert(end >= start);
+			const bool match = RE_compile_and_execute(pattern,
+													  &values[start],
+													  end - start,
+													  cflags,
+													  C_COLLATION_OID,
+													  0,
+													  NULL);
+			word |= ((uint64) (match == should_match)) << inner;
+		}
+		result[outer] &= word;
+	}
+}
+
+void
+vector_const_textregexeq(const ArrowArray *arrow, const Datum constdatum, uint64 *restrict result)
+{
+	vector_const_regex_impl(arrow, constdatum, result, REG_ADVANCED, /* should_match = */ true);
+}
+
+void
+vector_const_textregexne(const ArrowArray *arrow, const Datum constdatum, uint64 *restrict result)
+{
+	vector_const_regex_impl(arrow, constdatum, result, REG_ADVANCED, /* should_match = */ false);
+}
+
+void
+vector_const_texticregexeq(const ArrowArray *arrow, const Datum constdatum,
+						   uint64 *restrict result)
+{
+	vector_const_regex_impl(arrow,
+							constdatum,
+							result,
+							REG_ADVANCED | REG_ICASE,
+							/* should_match = */ true);
+}
+
+void
+vector_const_texticregexne(const ArrowArray *arrow, const Datum constdatum,
+						   uint64 *restrict result)
+{
+	vector_const_regex_impl(arrow,
+							constdatum,
+							result,
+							REG_ADVANCED | REG_ICASE,
+							/* should_match = */ false);
+}
+
+/*
+ * Prefix match, the ^@ operator. For deterministic collations, this is a
+ * bytewise comparison, same as in the Postgres text_starts_with().
+ */
+void
+vector_const_text_starts_with(const ArrowArray *arrow, const Datum constdatum,
+							  uint64 *restrict result)
+{
+	Assert(!arrow->dictionary);
+
+	text *consttext = (text *) DatumGetPointer(constdatum);
+	const size_t textlen = VARSIZE_ANY_EXHDR(consttext);
+	const char *restrict cstring = VARDATA_ANY(consttext);
+	const uint32 *offsets = (uint32 *) arrow->buffers[1];
+	const char *restrict values = arrow->buffers[2];
+
+	const size_t n = arrow->length;
+	for (size_t outer = 0; outer < (n + 63) / 64; outer++)
+	{
+		const size_t rows = Min(n - outer * 64, 64);
+		uint64 word = 0;
+		for (size_t inner = 0; inner < rows; inner++)
+		{
+			const size_t row = outer * 64 + inner;
+			const uint32 start = offsets[row];
+			const uint32 end = offsets[row + 1];
+			Assert(end >= start);
+			const bool match =
+				end - start >= textlen && memcmp(&values[start], cstring, textlen) == 0;
+			word |= ((uint64) match) << inner;
+		}
+		result[outer] &= word;
+	}
+}
+
+/*
+ * Text ordering comparisons under the C collation, which compares the strings
+ * bytewise, and the shorter string is less if it is a prefix of the longer
+ * one. The comparison passes when the sign of the comparison result matches
+ * the required one, or when the strings are equal if this is allowed.
+ */
+static void
+vector_const_text_ordering_impl(const ArrowArray *arrow, const Datum constdatum,
+								uint64 *restrict result, int required_sign, bool allow_equal)
+{
+	Assert(!arrow->dictionary);
+
+	text *consttext = (text *) DatumGetPointer(constdatum);
+	const size_t textlen = VARSIZE_ANY_EXHDR(consttext);
+	const char *restrict cstring = VARDATA_ANY(consttext);
+	const uint32 *offsets = (uint32 *) arrow->buffers[1];
+	const char *restrict values = arrow->buffers[2];
+
+	const size_t n = arrow->length;
+	for (size_t outer = 0; outer < (n + 63) / 64; outer++)
+	{
+		const size_t rows = Min(n - outer * 64, 64);
+		uint64 word = 0;
+		for (size_t inner = 0; inner < rows; inner++)
+		{
+			const size_t row = outer * 64 + inner;
+			const uint32 start = offsets[row];
+			const uint32 end = offsets[row + 1];
+			Assert(end >= start);
+			const size_t veclen = end - start;
+			int cmp = memcmp(&values[start], cstring, Min(veclen, textlen));
+			if (cmp == 0)
+			{
+				cmp = (veclen > textlen) - (veclen < textlen);
+			}
+			const int sign = (cmp > 0) - (cmp < 0);
+			const bool valid = sign == required_sign || (allow_equal && sign == 0);
+			word |= ((uint64) valid) << inner;
+		}
+		result[outer] &= word;
+	}
+}
+
+void
+vector_const_text_lt_c(const ArrowArray *arrow, const Datum constdatum, uint64 *restrict result)
+{
+	vector_const_text_ordering_impl(arrow, constdatum, result, -1, /* allow_equal = */ false);
+}
+
+void
+vector_const_text_le_c(const ArrowArray *arrow, const Datum constdatum, uint64 *restrict result)
+{
+	vector_const_text_ordering_impl(arrow, constdatum, result, -1, /* allow_equal = */ true);
+}
+
+void
+vector_const_text_gt_c(const ArrowArray *arrow, const Datum constdatum, uint64 *restrict result)
+{
+	vector_const_text_ordering_impl(arrow, constdatum, result, 1, /* allow_equal = */ false);
+}
+
+void
+vector_const_text_ge_c(const ArrowArray *arrow, const Datum constdatum, uint64 *restrict result)
+{
+	vector_const_text_ordering_impl(arrow, constdatum, result, 1, /* allow_equal = */ true);
+}
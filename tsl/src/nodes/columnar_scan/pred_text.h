@@ -20,3 +20,36 @@ extern void vector_const_textlike_utf8(const ArrowArray *arrow, const Datum cons
 
 extern void vector_const_textnlike_utf8(const ArrowArray *arrow, const Datum constdatum,
 										uint64 *restrict result);
+
+extern void vector_const_texticlike_utf8(const ArrowArray *arrow, const Datum constdatum,
+										 uint64 *restrict result);
+
+extern void vector_const_texticnlike_utf8(const ArrowArray *arrow, const Datum constdatum,
+										  uint64 *restrict result);
+
+extern void vector_const_textregexeq(const ArrowArray *arrow, const Datum constdatum,
+									 uint64 *restrict result);
+
+extern void vector_const_textregexne(const ArrowArray *arrow, const Datum constdatum,
+									 uint64 *restrict result);
+
+extern void vector_const_texticregexeq(const ArrowArray *arrow, const Datum constdatum,
+									   uint64 *restrict result);
+
+extern void vector_const_texticregexne(const ArrowArray *arrow, const Datum constdatum,
+									   uint64 *restrict result);
+
+extern void vector_const_text_starts_with(const ArrowArray *arrow, const Datum constdatum,
+										  uint64 *restrict result);
+
+extern void vector_const_text_lt_c(const ArrowArray *arrow, const Datum constdatum,
+								   uint64 *restrict result);
+
+extern void vector_const_text_le_c(const ArrowArray *arrow, const Datum constdatum,
+								   uint64 *restrict result);
+
+extern void vector_const_text_gt_c(const ArrowArray *arrow, const Datum constdatum,
+								   uint64 *restrict result);
+
+extern void vector_const_text_ge_c(const ArrowArray *arrow, const Datum constdatum,
+								   uint64 *restrict result);
@@ -5,7 +5,8 @@
  */
 
 /*
- * Define all supported "vector ? const" predicates for arithmetic types.
+ * Define all supported "vector ? const" and "vector ? vector" predicates for
+ * arithmetic types.
  */
 
 /* int8 functions. */
@@ -16,10 +16,10 @@
 #define FUNCTION_NAME_HELPER(X, Y, Z) predicate_##X##_##Y##_vector_##Z##_const
 #define FUNCTION_NAME(X, Y, Z) FUNCTION_NAME_HELPER(X, Y, Z)
 
-#ifdef GENERATE_DISPATCH_TABLE
+#if defined(GENERATE_DISPATCH_TABLE)
 case PG_PREDICATE_HELPER(PREDICATE_NAME):
 	return FUNCTION_NAME(PREDICATE_NAME, VECTOR_CTYPE, CONST_CTYPE);
-#else
+#elif !defined(GENERATE_VECTOR_VECTOR_DISPATCH_TABLE)
 
 static pg_noinline void
 FUNCTION_NAME(PREDICATE_NAME, VECTOR_CTYPE,
@@ -0,0 +1,103 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Compute a vector-vector predicate for two columns of the batch and AND it to
+ * the filter bitmap. Specialized for particular arithmetic data types and
+ * predicate. One of the vectors can have a single value that applies to all
+ * rows, if the column has a default value in this batch.
+ *
+ * The predicate macros are undefined by the vector-const template which is
+ * included after this one.
+ */
+
+#define PG_PREDICATE_HELPER(X) PG_PREDICATE(X)
+
+#define VV_FUNCTION_NAME_HELPER(X, Y, Z) predicate_##X##_##Y##_vector_##Z##_vector
+#define VV_FUNCTION_NAME(X, Y, Z) VV_FUNCTION_NAME_HELPER(X, Y, Z)
+
+#define VV_IMPL_NAME_HELPER(X, Y, Z) predicate_##X##_##Y##_vector_##Z##_vector_impl
+#define VV_IMPL_NAME(X, Y, Z) VV_IMPL_NAME_HELPER(X, Y, Z)
+
+#if defined(GENERATE_VECTOR_VECTOR_DISPATCH_TABLE)
+case PG_PREDICATE_HELPER(PREDICATE_NAME):
+	return VV_FUNCTION_NAME(PREDICATE_NAME, VECTOR_CTYPE, CONST_CTYPE);
+#elif !defined(GENERATE_DISPATCH_TABLE)
+
+static pg_attribute_always_inline void
+VV_IMPL_NAME(PREDICATE_NAME, VECTOR_CTYPE,
+			 CONST_CTYPE)(const VECTOR_CTYPE *restrict left, bool left_scalar,
+						  const CONST_CTYPE *restrict right, bool right_scalar, size_t n,
+						  uint64 *restrict result)
+{
+	for (size_t outer = 0; outer < n / 64; outer++)
+	{
+		/* no need to check the values if the result is already invalid */
+		if (result[outer] == 0)
+			continue;
+
+		uint64 word = 0;
+		for (size_t inner = 0; inner < 64; inner++)
+		{
+			const size_t row = outer * 64 + inner;
+			const bool valid = PREDICATE_EXPRESSION(left[left_scalar ? 0 : row],
+													right[right_scalar ? 0 : row]);
+			word |= ((uint64) valid) << inner;
+		}
+		result[outer] &= word;
+	}
+
+	if (n % 64)
+	{
+		uint64 tail_word = 0;
+		for (size_t row = (n / 64) * 64; row < n; row++)
+		{
+			const bool valid = PREDICATE_EXPRESSION(left[left_scalar ? 0 : row],
+													right[right_scalar ? 0 : row]);
+			tail_word |= ((uint64) valid) << (row % 64);
+		}
+		result[n / 64] &= tail_word;
+	}
+}
+
+static pg_noinline void
+VV_FUNCTION_NAME(PREDICATE_NAME, VECTOR_CTYPE,
+				 CONST_CTYPE)(const ArrowArray *left_arrow, const ArrowArray *right_arrow,
+							  uint64 *restrict result)
+{
+	const VECTOR_CTYPE *left = (const VECTOR_CTYPE *) left_arrow->buffers[1];
+	const CONST_CTYPE *right = (const CONST_CTYPE *) right_arrow->buffers[1];
+
+	/*
+	 * Specialize the loop for the cases when one of the vectors is a single
+	 * default value.
+	 */
+	if (left_arrow->length == right_arrow->length)
+	{
+		VV_IMPL_NAME(PREDICATE_NAME, VECTOR_CTYPE, CONST_CTYPE)
+		(left, false, right, false, left_arrow->length, result);
+	}
+	else if (left_arrow->length == 1)
+	{
+		VV_IMPL_NAME(PREDICATE_NAME, VECTOR_CTYPE, CONST_CTYPE)
+		(left, true, right, false, right_arrow->length, result);
+	}
+	else
+	{
+		Assert(right_arrow->length == 1);
+		VV_IMPL_NAME(PREDICATE_NAME, VECTOR_CTYPE, CONST_CTYPE)
+		(left, false, right, true, left_arrow->length, result);
+	}
+}
+
+#endif
+
+#undef PG_PREDICATE_HELPER
+
+#undef VV_FUNCTION_NAME
+#undef VV_FUNCTION_NAME_HELPER
+#undef VV_IMPL_NAME
+#undef VV_IMPL_NAME_HELPER
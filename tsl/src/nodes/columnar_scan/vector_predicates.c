@@ -59,6 +59,33 @@ get_vector_const_predicate(Oid pg_predicate)
 		case F_UUID_NE:
 			return vector_uuidne;
 
+		case F_STARTS_WITH:
+			return vector_const_text_starts_with;
+
+		case F_TEXTREGEXEQ:
+			return vector_const_textregexeq;
+
+		case F_TEXTREGEXNE:
+			return vector_const_textregexne;
+
+		case F_TEXTICREGEXEQ:
+			return vector_const_texticregexeq;
+
+		case F_TEXTICREGEXNE:
+			return vector_const_texticregexne;
+
+		case F_TEXT_LT:
+			return vector_const_text_lt_c;
+
+		case F_TEXT_LE:
+			return vector_const_text_le_c;
+
+		case F_TEXT_GT:
+			return vector_const_text_gt_c;
+
+		case F_TEXT_GE:
+			return vector_const_text_ge_c;
+
 		default:
 			/*
 			 * More checks below, this branch is to placate the static analyzers.
@@ -75,6 +102,10 @@ get_vector_const_predicate(Oid pg_predicate)
 				return vector_const_textlike_utf8;
 			case F_TEXTNLIKE:
 				return vector_const_textnlike_utf8;
+			case F_TEXTICLIKE:
+				return vector_const_texticlike_utf8;
+			case F_TEXTICNLIKE:
+				return vector_const_texticnlike_utf8;
 			default:
 				/*
 				 * This branch is to placate the static analyzers.
@@ -86,6 +117,51 @@ get_vector_const_predicate(Oid pg_predicate)
 	return NULL;
 }
 
+/*
+ * Look up the vectorized implementation for a Postgres predicate that compares
+ * two columns of the batch. Only the arithmetic types are supported.
+ */
+VectorVectorPredicate *
+get_vector_vector_predicate(Oid pg_predicate)
+{
+	switch (pg_predicate)
+	{
+#define GENERATE_VECTOR_VECTOR_DISPATCH_TABLE
+#include "pred_vector_const_arithmetic_all.c"
+#undef GENERATE_VECTOR_VECTOR_DISPATCH_TABLE
+
+		default:
+			return NULL;
+	}
+}
+
+/*
+ * Some vectorized predicates implement the Postgres semantics only for the C
+ * collation, for example the text ordering is bytewise, and ILIKE only folds
+ * the case of ASCII letters. The planner must check the input collation of
+ * these predicates.
+ */
+bool
+vector_const_predicate_needs_c_collation(Oid pg_predicate)
+{
+	switch (pg_predicate)
+	{
+		case F_TEXTICLIKE:
+		case F_TEXTICNLIKE:
+		case F_TEXTREGEXEQ:
+		case F_TEXTREGEXNE:
+		case F_TEXTICREGEXEQ:
+		case F_TEXTICREGEXNE:
+		case F_TEXT_LT:
+		case F_TEXT_LE:
+		case F_TEXT_GT:
+		case F_TEXT_GE:
+			return true;
+		default:
+			return false;
+	}
+}
+
 void
 vector_nulltest(const ArrowArray *arrow, int test_type, uint64 *restrict result)
 {
@@ -35,10 +35,33 @@ typedef struct VectorQualInfo
 	bool *vector_attrs;
 	bool *segmentby_attrs;
 
+	/*
+	 * Optional array indexed by uncompressed attno indicating whether the
+	 * "column ->> 'key'" expressions can be vectorized for a jsonb column.
+	 */
+	bool *jsonb_field_attrs;
+
 	/* Max attribute number found in arrays above */
 	AttrNumber maxattno;
 } VectorQualInfo;
 
+/*
+ * Runtime statistics of a top-level vectorized qual, used for adaptive
+ * reordering of the qual conjunction.
+ */
+typedef struct VectorQualStats
+{
+	/* Number of batches for which the qual was evaluated. */
+	double evaluations;
+
+	/* Rows that passed the preceding quals, and the ones that passed this qual. */
+	double rows_in;
+	double rows_passed;
+
+	/* Total evaluation time in seconds, including the column decompression. */
+	double time;
+} VectorQualStats;
+
 /*
  * VectorQualState keeps the necessary state needed for the computation of
  * vectorized filters in scan nodes.
@@ -51,6 +74,12 @@ typedef struct VectorQualState
 	MemoryContext per_vector_mcxt;
 	TupleTableSlot *slot;
 
+	/*
+	 * Optional runtime statistics for each of vectorized_quals_constified,
+	 * in the same order. Collected when not null.
+	 */
+	VectorQualStats *qual_stats;
+
 	/*
 	 * Interface function to be provided by scan node.
 	 *
@@ -15,6 +15,8 @@
 #include <nodes/nodeFuncs.h>
 #include <nodes/pg_list.h>
 #include <optimizer/optimizer.h>
+#include <utils/lsyscache.h>
+#include <utils/timestamp.h>
 
 #include "nodes/vector_agg/exec.h"
 
@@ -58,6 +60,225 @@ get_input_offset(const DecompressContext *dcontext, const Var *var)
 	return index;
 }
 
+/* The default origin of time_bucket(), Monday 2000-01-03. */
+#define TIME_BUCKET_DEFAULT_ORIGIN (2 * USECS_PER_DAY)
+
+/*
+ * Inline version of time_bucket() for a fixed-width bucket on timestamps with
+ * the default origin. Returns false when the result has to be computed by the
+ * actual function, i.e. when it would error out.
+ */
+static pg_attribute_always_inline bool
+time_bucket_fixed_ts(int64 period, int64 origin_shift, int64 timestamp, int64 *result)
+{
+	if (TIMESTAMP_NOT_FINITE(timestamp))
+	{
+		*result = timestamp;
+		return true;
+	}
+
+	if (unlikely(timestamp < DT_NOBEGIN + origin_shift))
+	{
+		return false;
+	}
+
+	const int64 shifted = timestamp - origin_shift;
+	int64 bucket = shifted / period;
+	if (shifted % period < 0)
+	{
+		/* Division truncates toward zero, we need to round toward -inf. */
+		bucket--;
+	}
+
+	*result = bucket * period + origin_shift;
+	return true;
+}
+
+static pg_attribute_always_inline Datum
+arrow_fixed_value_get_datum(const void *values, int value_bytes, int row)
+{
+	switch (value_bytes)
+	{
+		case 2:
+			return Int16GetDatum(((const int16 *) values)[row]);
+		case 4:
+			return Int32GetDatum(((const int32 *) values)[row]);
+		case 8:
+			return Int64GetDatum(((const int64 *) values)[row]);
+		default:
+			pg_unreachable();
+			return 0;
+	}
+}
+
+static pg_attribute_always_inline void
+arrow_fixed_value_set_datum(void *values, int value_bytes, int row, Datum datum)
+{
+	switch (value_bytes)
+	{
+		case 2:
+			((int16 *) values)[row] = DatumGetInt16(datum);
+			break;
+		case 4:
+			((int32 *) values)[row] = DatumGetInt32(datum);
+			break;
+		case 8:
+			((int64 *) values)[row] = DatumGetInt64(datum);
+			break;
+		default:
+			pg_unreachable();
+	}
+}
+
+/*
+ * Compute a time_bucket() call for the rows of a compressed batch.
+ *
+ * The planner only accepts the calls where the bucketed column is the second
+ * argument and the other arguments are non-null constants, see
+ * is_vector_time_bucket(). Fixed-width buckets on timestamps with the default
+ * origin are computed inline, other variants go through the function manager
+ * row by row.
+ */
+static CompressedColumnValues
+vector_slot_evaluate_time_bucket(DecompressContext *dcontext, TupleTableSlot *slot,
+								 uint64 const *filter, const FuncExpr *func)
+{
+	const DecompressBatchState *batch_state = (const DecompressBatchState *) slot;
+	const int nargs = list_length(func->args);
+	Assert(nargs >= 2);
+
+	const CompressedColumnValues time_values =
+		vector_slot_evaluate_expression(dcontext, slot, filter, lsecond(func->args));
+	Ensure(time_values.decompression_type == DT_Scalar || time_values.decompression_type > 0,
+		   "unexpected decompression type %d for time_bucket() argument",
+		   time_values.decompression_type);
+
+	int16 result_bytes;
+	bool result_byval;
+	get_typlenbyval(func->funcresulttype, &result_bytes, &result_byval);
+	Ensure(result_byval && (result_bytes == 2 || result_bytes == 4 || result_bytes == 8),
+		   "unexpected result type %d of vectorized time_bucket()",
+		   func->funcresulttype);
+
+	MemoryContext old_mctx = MemoryContextSwitchTo(batch_state->per_batch_context);
+
+	FmgrInfo flinfo;
+	fmgr_info(func->funcid, &flinfo);
+	LOCAL_FCINFO(fcinfo, FUNC_MAX_ARGS);
+	InitFunctionCallInfoData(*fcinfo, &flinfo, nargs, func->inputcollid, NULL, NULL);
+	for (int i = 0; i < nargs; i++)
+	{
+		if (i == 1)
+		{
+			continue;
+		}
+
+		const Const *arg = castNode(Const, list_nth(func->args, i));
+		Assert(!arg->constisnull);
+		fcinfo->args[i].value = arg->constvalue;
+		fcinfo->args[i].isnull = false;
+	}
+	fcinfo->args[1].isnull = false;
+
+	if (time_values.decompression_type == DT_Scalar)
+	{
+		bool isnull = DatumGetBool(PointerGetDatum(time_values.buffers[0]));
+		Datum value = 0;
+		if (!isnull)
+		{
+			fcinfo->args[1].value = PointerGetDatum(time_values.buffers[1]);
+			value = FunctionCallInvoke(fcinfo);
+			isnull = fcinfo->isnull;
+		}
+
+		MemoryContextSwitchTo(old_mctx);
+
+		return (CompressedColumnValues){
+			.decompression_type = DT_Scalar,
+			.buffers = { DatumGetPointer(BoolGetDatum(isnull)), DatumGetPointer(value) },
+		};
+	}
+
+	/*
+	 * Fixed-width bucket on timestamps with the default origin, this is the
+	 * most common case so we compute it inline.
+	 */
+	int64 period = 0;
+	int64 origin_shift = 0;
+	if (nargs == 2 && exprType(lsecond(func->args)) == func->funcresulttype &&
+		(func->funcresulttype == TIMESTAMPTZOID || func->funcresulttype == TIMESTAMPOID))
+	{
+		const Const *width = linitial_node(Const, func->args);
+		const Interval *interval = DatumGetIntervalP(width->constvalue);
+		if (width->consttype == INTERVALOID && interval->month == 0)
+		{
+			period = interval->time + interval->day * USECS_PER_DAY;
+			if (period > 0)
+			{
+				origin_shift = TIME_BUCKET_DEFAULT_ORIGIN % period;
+			}
+		}
+	}
+
+	const int n = batch_state->total_batch_rows;
+	const int input_bytes = time_values.decompression_type;
+	Ensure(input_bytes == 2 || input_bytes == 4 || input_bytes == 8,
+		   "unexpected value size %d of vectorized time_bucket() argument",
+		   input_bytes);
+	const uint64 *validity = time_values.buffers[0];
+	const void *input_values = time_values.buffers[1];
+
+	struct ArrowWithBuffers
+	{
+		ArrowArray arrow;
+		const void *arrow_buffers_array_storage[2];
+	};
+	struct ArrowWithBuffers *result = palloc0(sizeof(struct ArrowWithBuffers));
+	/* The value buffer has 64-byte padding as required by Arrow. */
+	void *result_values = palloc(pad_to_multiple(64, result_bytes * n));
+
+	for (int row = 0; row < n; row++)
+	{
+		if (!arrow_row_both_valid(validity, filter, row))
+		{
+			arrow_fixed_value_set_datum(result_values, result_bytes, row, 0);
+			continue;
+		}
+
+		const Datum input = arrow_fixed_value_get_datum(input_values, input_bytes, row);
+		if (period > 0)
+		{
+			int64 bucket;
+			if (likely(time_bucket_fixed_ts(period, origin_shift, DatumGetInt64(input), &bucket)))
+			{
+				((int64 *) result_values)[row] = bucket;
+				continue;
+			}
+		}
+
+		fcinfo->args[1].value = input;
+		const Datum bucket = FunctionCallInvoke(fcinfo);
+		Ensure(!fcinfo->isnull, "unexpected null result of time_bucket()");
+		arrow_fixed_value_set_datum(result_values, result_bytes, row, bucket);
+	}
+
+	MemoryContextSwitchTo(old_mctx);
+
+	ArrowArray *arrow = &result->arrow;
+	arrow->length = n;
+	arrow->null_count = time_values.arrow != NULL ? time_values.arrow->null_count : 0;
+	arrow->n_buffers = 2;
+	arrow->buffers = result->arrow_buffers_array_storage;
+	arrow->buffers[0] = validity;
+	arrow->buffers[1] = result_values;
+
+	return (CompressedColumnValues){
+		.decompression_type = result_bytes,
+		.buffers = { validity, result_values },
+		.arrow = arrow,
+	};
+}
+
 /*
  * Return the arrow array or the datum (in case of single scalar value) for a
  * given expression as a CompressedColumnValues struct.
@@ -69,6 +290,11 @@ vector_slot_evaluate_expression(DecompressContext *dcontext, TupleTableSlot *slo
 	const DecompressBatchState *batch_state = (const DecompressBatchState *) slot;
 	switch (((Node *) argument)->type)
 	{
+		case T_FuncExpr:
+			return vector_slot_evaluate_time_bucket(dcontext,
+													slot,
+													filter,
+													(const FuncExpr *) argument);
 		case T_Var:
 		{
 			const Var *var = (const Var *) argument;
@@ -87,6 +313,163 @@ vector_slot_evaluate_expression(DecompressContext *dcontext, TupleTableSlot *slo
 	}
 }
 
+/*
+ * Mark the input columns referenced by the given expression as needed.
+ */
+static void
+mark_needed_input_columns(const DecompressContext *dcontext, Node *expr, bool *needed)
+{
+	List *vars = pull_var_clause(expr, 0);
+	ListCell *lc;
+	foreach (lc, vars)
+	{
+		Var *var = lfirst_node(Var, lc);
+		if (var->varattno > 0)
+		{
+			needed[get_input_offset(dcontext, var)] = true;
+		}
+	}
+	list_free(vars);
+}
+
+/*
+ * Set up the aggregate functions that can use the pre-aggregated batch
+ * metadata. The compressed columns that are used only by such functions are
+ * not decompressed for the batches where the metadata can be used, and are
+ * decompressed on demand for the other batches.
+ */
+static void
+vector_agg_init_batch_metadata(VectorAggState *vector_agg_state, DecompressContext *dcontext,
+							   List *batch_metadata)
+{
+	bool have_batch_metadata = false;
+	for (int i = 0; i < vector_agg_state->num_agg_defs; i++)
+	{
+		VectorAggDef *def = &vector_agg_state->agg_defs[i];
+		List *attnos = list_nth(batch_metadata, i);
+		if (attnos == NIL)
+		{
+			continue;
+		}
+
+		Assert(list_length(attnos) == 4);
+		def->batch_metadata_sum_attno = list_nth_int(attnos, 0);
+		def->batch_metadata_count_attno = list_nth_int(attnos, 1);
+		def->batch_metadata_sumsq_attno = list_nth_int(attnos, 2);
+		def->batch_metadata_float_sum = list_nth_int(attnos, 3);
+		def->batch_metadata_input_offset =
+			get_input_offset(dcontext, castNode(Var, def->argument));
+		have_batch_metadata = true;
+	}
+
+	if (!have_batch_metadata)
+	{
+		return;
+	}
+
+	bool *needed = palloc0(sizeof(bool) * dcontext->num_data_columns);
+	for (int i = 0; i < vector_agg_state->num_agg_defs; i++)
+	{
+		VectorAggDef *def = &vector_agg_state->agg_defs[i];
+		if (def->argument != NULL && def->batch_metadata_count_attno == InvalidAttrNumber)
+		{
+			mark_needed_input_columns(dcontext, (Node *) def->argument, needed);
+		}
+
+		mark_needed_input_columns(dcontext, (Node *) def->filter_clauses, needed);
+	}
+
+	for (int i = 0; i < vector_agg_state->num_grouping_columns; i++)
+	{
+		mark_needed_input_columns(dcontext,
+								  (Node *) vector_agg_state->grouping_columns[i].expr,
+								  needed);
+	}
+
+	for (int i = 0; i < vector_agg_state->num_agg_defs; i++)
+	{
+		VectorAggDef *def = &vector_agg_state->agg_defs[i];
+		if (def->batch_metadata_count_attno != InvalidAttrNumber &&
+			!needed[def->batch_metadata_input_offset])
+		{
+			dcontext->compressed_chunk_columns[def->batch_metadata_input_offset]
+				.decompress_on_demand = true;
+		}
+	}
+
+	pfree(needed);
+}
+
+/*
+ * Check whether the current batch can be aggregated using its metadata for the
+ * given aggregate function, and read the metadata. Otherwise, decompress the
+ * aggregated column if it is decompressed on demand.
+ */
+static void
+vector_agg_prepare_batch_metadata(VectorAggState *vector_agg_state, DecompressContext *dcontext,
+								  DecompressBatchState *batch_state, VectorAggDef *def)
+{
+	TupleTableSlot *compressed_slot = vector_agg_state->compressed_slot;
+	BatchSumMetadata *metadata = &def->batch_metadata;
+
+	def->use_batch_metadata = false;
+
+	/*
+	 * We can only use the metadata if all rows of the batch pass the filters.
+	 */
+	if (def->effective_batch_filter == NULL)
+	{
+		bool count_isnull;
+		const Datum count =
+			slot_getattr(compressed_slot, def->batch_metadata_count_attno, &count_isnull);
+
+		*metadata = (BatchSumMetadata){ 0 };
+		if (!count_isnull)
+		{
+			metadata->count = DatumGetInt32(count);
+			def->use_batch_metadata = true;
+		}
+
+		/*
+		 * The sum is null for empty batches, or when it can't be represented in
+		 * the metadata, and then we have to aggregate the decompressed values.
+		 */
+		if (def->use_batch_metadata && metadata->count > 0)
+		{
+			bool sum_isnull;
+			bool sumsq_isnull;
+			const Datum sum =
+				slot_getattr(compressed_slot, def->batch_metadata_sum_attno, &sum_isnull);
+			const Datum sumsq =
+				slot_getattr(compressed_slot, def->batch_metadata_sumsq_attno, &sumsq_isnull);
+			if (sum_isnull || sumsq_isnull)
+			{
+				def->use_batch_metadata = false;
+			}
+			else
+			{
+				if (def->batch_metadata_float_sum)
+				{
+					metadata->float_sum = DatumGetFloat8(sum);
+				}
+				else
+				{
+					metadata->int_sum = DatumGetInt64(sum);
+				}
+				metadata->sum_squares = DatumGetFloat8(sumsq);
+			}
+		}
+	}
+
+	if (!def->use_batch_metadata)
+	{
+		compressed_batch_decompress_column(dcontext,
+										   batch_state,
+										   compressed_slot,
+										   def->batch_metadata_input_offset);
+	}
+}
+
 static void
 vector_agg_begin(CustomScanState *node, EState *estate, int eflags)
 {
@@ -138,7 +521,7 @@ vector_agg_begin(CustomScanState *node, EState *estate, int eflags)
 		else
 		{
 			/* This is a grouping column. */
-			Assert(IsA(tlentry->expr, Var));
+			Assert(IsA(tlentry->expr, Var) || IsA(tlentry->expr, FuncExpr));
 			grouping_column_counter++;
 		}
 	}
@@ -178,12 +561,28 @@ vector_agg_begin(CustomScanState *node, EState *estate, int eflags)
 
 			if (list_length(aggref->args) > 0)
 			{
-				Assert(list_length(aggref->args) == 1);
-
 				/* The aggregate should be a partial aggregate */
 				Assert(aggref->aggsplit == AGGSPLIT_INITIAL_SERIAL);
 
-				def->argument = castNode(TargetEntry, linitial(aggref->args))->expr;
+				def->argument = vector_agg_aggregated_argument(func, aggref);
+
+				if (def->func.agg_bind_args != NULL)
+				{
+					/* The other arguments are constants, checked by the planner. */
+					List *const_args = NIL;
+					ListCell *lc;
+					for_each_from(lc, aggref->args, 1)
+					{
+						const_args = lappend(const_args, lfirst_node(TargetEntry, lc)->expr);
+					}
+					def->func.agg_bind_args(&def->func,
+											exprType((Node *) def->argument),
+											const_args);
+				}
+				else
+				{
+					Assert(list_length(aggref->args) == 1);
+				}
 			}
 			else
 			{
@@ -221,6 +620,15 @@ vector_agg_begin(CustomScanState *node, EState *estate, int eflags)
 		intVal(list_nth(cscan->custom_private, VASI_GroupingType));
 	if (grouping_type == VAGT_Batch)
 	{
+		/*
+		 * The batch metadata is only used when aggregating entire batches.
+		 */
+		ColumnarScanState *decompress_state =
+			(ColumnarScanState *) linitial(vector_agg_state->custom.custom_ps);
+		vector_agg_init_batch_metadata(vector_agg_state,
+									   &decompress_state->decompress_context,
+									   list_nth(cscan->custom_private, VASI_BatchMetadata));
+
 		/*
 		 * Per-batch grouping.
 		 */
@@ -318,6 +726,7 @@ compressed_batch_get_next_slot(VectorAggState *vector_agg_state)
 		}
 
 		compressed_batch_set_compressed_tuple(dcontext, batch_state, compressed_slot);
+		vector_agg_state->compressed_slot = compressed_slot;
 
 		/* If the entire batch is filtered out, then immediately read the next
 		 * one */
@@ -472,6 +881,11 @@ vector_agg_exec(CustomScanState *node)
 			{
 				agg_def->effective_batch_filter = batch_state->vector_qual_result;
 			}
+
+			if (agg_def->batch_metadata_count_attno != InvalidAttrNumber)
+			{
+				vector_agg_prepare_batch_metadata(vector_agg_state, dcontext, batch_state, agg_def);
+			}
 		}
 
 		/*
@@ -26,6 +26,25 @@ typedef struct VectorAggDef
 	 * FILTER clause, if present.
 	 */
 	uint64 const *effective_batch_filter;
+
+	/*
+	 * The attribute numbers of the pre-aggregated batch metadata in the
+	 * compressed scan tuple, if the function can use it, see
+	 * batch_metadata_builder_sum.c. The metadata is used for the batches where
+	 * all rows pass the filters.
+	 */
+	AttrNumber batch_metadata_sum_attno;
+	AttrNumber batch_metadata_count_attno;
+	AttrNumber batch_metadata_sumsq_attno;
+	bool batch_metadata_float_sum;
+	int batch_metadata_input_offset;
+
+	/*
+	 * Whether the current batch is aggregated using its metadata given below,
+	 * instead of the decompressed argument.
+	 */
+	bool use_batch_metadata;
+	BatchSumMetadata batch_metadata;
 } VectorAggDef;
 
 typedef struct GroupingColumn
@@ -57,6 +76,12 @@ typedef struct VectorAggState
 
 	GroupingPolicy *grouping;
 
+	/*
+	 * The compressed tuple of the current batch, used to read the batch
+	 * metadata and to decompress the columns on demand.
+	 */
+	TupleTableSlot *compressed_slot;
+
 	/*
 	 * Function for getting the next slot from the child node depending on
 	 * child node type.
@@ -316,6 +316,22 @@ FUNCTION_NAME(one)(void *restrict agg_state, const CTYPE value)
 	state->Sx = newSx;
 }
 
+/*
+ * The batch metadata has the Youngs-Cramer state of the batch, so we can just
+ * combine it with the aggregate function state.
+ */
+static void
+FUNCTION_NAME(batch_metadata)(void *restrict agg_state, const BatchSumMetadata *metadata)
+{
+	FUNCTION_NAME(state) *state = (FUNCTION_NAME(state) *) agg_state;
+	COMBINE(&state->N,
+			&state->Sx,
+			&state->Sxx,
+			(double) metadata->count,
+			metadata->float_sum,
+			metadata->sum_squares);
+}
+
 #include "agg_many_vector_helper.c"
 #include "agg_scalar_helper.c"
 #include "agg_vector_validity_helper.c"
@@ -327,6 +343,7 @@ VectorAggFunctions FUNCTION_NAME(argdef) = {
 	.agg_scalar = FUNCTION_NAME(scalar),
 	.agg_vector = FUNCTION_NAME(vector),
 	.agg_many_vector = FUNCTION_NAME(many_vector),
+	.agg_batch_metadata = FUNCTION_NAME(batch_metadata),
 };
 #undef UPDATE
 #undef COMBINE
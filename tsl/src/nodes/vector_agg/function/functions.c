@@ -169,6 +169,13 @@ count_any_vector(void *agg_state, const ArrowArray *vector, const uint64 *filter
 	}
 }
 
+static void
+count_any_batch_metadata(void *restrict agg_state, const BatchSumMetadata *metadata)
+{
+	CountState *state = (CountState *) agg_state;
+	state->count += metadata->count;
+}
+
 static void
 count_any_many_vector(void *restrict agg_states, const uint32 *offsets, const uint64 *filter,
 					  int start_row, int end_row, const ArrowArray *vector,
@@ -191,6 +198,7 @@ VectorAggFunctions count_any_agg = {
 	.agg_scalar = count_any_scalar,
 	.agg_vector = count_any_vector,
 	.agg_many_vector = count_any_many_vector,
+	.agg_batch_metadata = count_any_batch_metadata,
 };
 
 /*
@@ -212,9 +220,39 @@ get_vector_aggregate(Oid aggfnoid)
 #include "int24_avg_accum_templates.c"
 #include "int24_sum_templates.c"
 #include "minmax_templates.c"
+#include "numeric_templates.c"
 #include "sum_float_templates.c"
 #undef GENERATE_DISPATCH_TABLE
 		default:
-			return NULL;
+			return get_vector_histogram(aggfnoid);
+	}
+}
+
+/*
+ * The expression that is aggregated by the given aggregate function. This is
+ * the first argument, but the functions with constant arguments can also take
+ * a numeric column under an implicit cast to float8, and convert the values
+ * themselves.
+ */
+Expr *
+vector_agg_aggregated_argument(const VectorAggFunctions *func, const Aggref *aggref)
+{
+	Expr *argument = castNode(TargetEntry, linitial(aggref->args))->expr;
+	if (func->agg_bind_args == NULL || !IsA(argument, FuncExpr))
+	{
+		return argument;
+	}
+
+	FuncExpr *cast = castNode(FuncExpr, argument);
+	switch (cast->funcid)
+	{
+		case F_FLOAT8_INT2:
+		case F_FLOAT8_INT4:
+		case F_FLOAT8_INT8:
+		case F_FLOAT8_FLOAT4:
+			Assert(list_length(cast->args) == 1);
+			return linitial(cast->args);
+		default:
+			return argument;
 	}
 }
@@ -6,8 +6,28 @@
 
 #pragma once
 
+#include <nodes/pg_list.h>
+#include <nodes/primnodes.h>
+
 #include <compression/arrow_c_data_interface.h>
 
+/*
+ * The pre-aggregated metadata of a compressed batch for a numeric column, see
+ * batch_metadata_builder_sum.c.
+ */
+typedef struct BatchSumMetadata
+{
+	/* Number of non-null values. */
+	int64 count;
+
+	/* Sum of the values, for the integer and floating-point columns respectively. */
+	int64 int_sum;
+	double float_sum;
+
+	/* Sum of squared deviations from the batch mean. */
+	double sum_squares;
+} BatchSumMetadata;
+
 /*
  * Function table for a vectorized implementation of an aggregate function.
  *
@@ -18,7 +38,7 @@
  * state (no grouping keys), and to multiple aggregate function states laid out
  * contiguously in memory.
  */
-typedef struct
+typedef struct VectorAggFunctions
 {
 	/* Size of the aggregate function state. */
 	size_t state_bytes;
@@ -29,6 +49,30 @@ typedef struct
 	 */
 	void (*agg_init)(void *restrict agg_states, int n);
 
+	/*
+	 * The functions that have constant arguments besides the aggregated one,
+	 * like the bucket bounds of histogram(), bind them to their copy of this
+	 * table before use. The type of the aggregated expression is passed as well,
+	 * see vector_agg_aggregated_argument(). NULL for the other functions.
+	 */
+	void (*agg_bind_args)(struct VectorAggFunctions *func, Oid argtype, List *const_args);
+
+	/* The bound constant arguments, see agg_bind_args. */
+	void *agg_args;
+
+	/*
+	 * Same as agg_init for the functions that have the bound constant
+	 * arguments, see vector_agg_init_states().
+	 */
+	void (*agg_init_args)(void *restrict agg_states, int n, void *agg_args);
+
+	/*
+	 * The function also aggregates the rows where the argument is null. The
+	 * argument validity is then not combined into the filter that is passed to
+	 * the functions below, and they have to check it themselves.
+	 */
+	bool agg_accepts_nulls;
+
 	/* Aggregate a given arrow array. */
 	void (*agg_vector)(void *restrict agg_state, const ArrowArray *vector, const uint64 *filter,
 					   MemoryContext agg_extra_mctx);
@@ -53,8 +97,29 @@ typedef struct
 							int start_row, int end_row, Datum constvalue, bool constisnull,
 							MemoryContext agg_extra_mctx);
 
+	/*
+	 * Aggregate an entire batch using its pre-aggregated metadata instead of
+	 * the decompressed values. Can be NULL if the function can't use it.
+	 */
+	void (*agg_batch_metadata)(void *restrict agg_state, const BatchSumMetadata *metadata);
+
 	/* Emit a partial aggregation result. */
 	void (*agg_emit)(void *restrict agg_state, Datum *out_result, bool *out_isnull);
 } VectorAggFunctions;
 
 VectorAggFunctions *get_vector_aggregate(Oid aggfnoid);
+VectorAggFunctions *get_vector_histogram(Oid aggfnoid);
+Expr *vector_agg_aggregated_argument(const VectorAggFunctions *func, const Aggref *aggref);
+
+static inline void
+vector_agg_init_states(const VectorAggFunctions *func, void *restrict agg_states, int n)
+{
+	if (func->agg_init_args != NULL)
+	{
+		func->agg_init_args(agg_states, n, func->agg_args);
+	}
+	else
+	{
+		func->agg_init(agg_states, n);
+	}
+}
@@ -0,0 +1,174 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Vectorized histogram() for a given type of the aggregated column. The values
+ * are converted to float8, like the implicit cast in the original query does.
+ * The null values are counted as zeros, because this is what the row-by-row
+ * transition function does, so we check the argument validity here instead of
+ * it being combined into the filter, see agg_accepts_nulls.
+ */
+
+typedef HistogramState FUNCTION_NAME(state);
+
+/*
+ * Histogram of a batch. We first compute the bucket indexes for a word of the
+ * filter bitmap without looking at the filter, which can be vectorized, and
+ * then add the rows that pass the filter to the counts.
+ */
+static pg_attribute_always_inline void
+FUNCTION_NAME(vector_impl)(void *agg_state, int n, const CTYPE *values, const uint64 *validity,
+						   const uint64 *filter, MemoryContext agg_extra_mctx)
+{
+	HistogramState *state = (HistogramState *) agg_state;
+
+	if (arrow_num_valid(filter, n) == 0)
+	{
+		return;
+	}
+
+	MemoryContext old = MemoryContextSwitchTo(agg_extra_mctx);
+	int64 *restrict counts = histogram_get_counts(state);
+	MemoryContextSwitchTo(old);
+
+	const HistogramArgs *args = state->args;
+	int32 buckets[64];
+	for (int start_row = 0; start_row < n; start_row += 64)
+	{
+		const int end_row = Min(n, start_row + 64);
+
+		bool have_nan = false;
+		for (int row = start_row; row < end_row; row++)
+		{
+			const double value = arrow_row_is_valid(validity, row) ? (double) values[row] : 0;
+			buckets[row - start_row] = histogram_bucket(args, value);
+			have_nan |= isnan(value);
+		}
+
+		if (unlikely(have_nan))
+		{
+			for (int row = start_row; row < end_row; row++)
+			{
+				if (arrow_row_is_valid(filter, row) && arrow_row_is_valid(validity, row) &&
+					isnan((double) values[row]))
+				{
+					histogram_nan_error();
+				}
+			}
+		}
+
+		for (int row = start_row; row < end_row; row++)
+		{
+			counts[buckets[row - start_row]] += arrow_row_is_valid(filter, row);
+		}
+	}
+}
+
+static pg_noinline void
+FUNCTION_NAME(vector_all_valid)(void *agg_state, int n, const CTYPE *values,
+								MemoryContext agg_extra_mctx)
+{
+	FUNCTION_NAME(vector_impl)(agg_state, n, values, NULL, NULL, agg_extra_mctx);
+}
+
+static pg_noinline void
+FUNCTION_NAME(vector_with_nulls)(void *agg_state, int n, const CTYPE *values,
+								 const uint64 *validity, const uint64 *filter,
+								 MemoryContext agg_extra_mctx)
+{
+	FUNCTION_NAME(vector_impl)(agg_state, n, values, validity, filter, agg_extra_mctx);
+}
+
+static void
+FUNCTION_NAME(vector)(void *agg_state, const ArrowArray *vector, const uint64 *filter,
+					  MemoryContext agg_extra_mctx)
+{
+	const int n = vector->length;
+	const CTYPE *values = vector->buffers[1];
+	const uint64 *validity = vector->buffers[0];
+
+	if (filter == NULL && validity == NULL)
+	{
+		FUNCTION_NAME(vector_all_valid)(agg_state, n, values, agg_extra_mctx);
+	}
+	else
+	{
+		FUNCTION_NAME(vector_with_nulls)(agg_state, n, values, validity, filter, agg_extra_mctx);
+	}
+}
+
+static pg_attribute_always_inline void
+FUNCTION_NAME(one)(void *restrict agg_state, const CTYPE value)
+{
+	HistogramState *state = (HistogramState *) agg_state;
+	int64 *counts = histogram_get_counts(state);
+
+	if (unlikely(isnan((double) value)))
+	{
+		histogram_nan_error();
+	}
+
+	counts[histogram_bucket(state->args, (double) value)]++;
+}
+
+static void
+FUNCTION_NAME(scalar)(void *agg_state, Datum constvalue, bool constisnull, int n,
+					  MemoryContext agg_extra_mctx)
+{
+	HistogramState *state = (HistogramState *) agg_state;
+	const double value = constisnull ? 0 : (double) DATUM_TO_CTYPE(constvalue);
+
+	MemoryContext old = MemoryContextSwitchTo(agg_extra_mctx);
+	int64 *counts = histogram_get_counts(state);
+	MemoryContextSwitchTo(old);
+
+	if (unlikely(isnan(value)))
+	{
+		histogram_nan_error();
+	}
+
+	counts[histogram_bucket(state->args, value)] += n;
+}
+
+/*
+ * Add the rows of a batch to the states given by the offsets. Like the generic
+ * agg_many_vector_helper.c, but the null values are counted as zeros.
+ */
+static void
+FUNCTION_NAME(many_vector)(void *restrict agg_states, const uint32 *offsets, const uint64 *filter,
+						   int start_row, int end_row, const ArrowArray *vector,
+						   MemoryContext agg_extra_mctx)
+{
+	HistogramState *restrict states = (HistogramState *) agg_states;
+	const CTYPE *values = vector->buffers[1];
+	const uint64 *validity = vector->buffers[0];
+	MemoryContext old = MemoryContextSwitchTo(agg_extra_mctx);
+	for (int row = start_row; row < end_row; row++)
+	{
+		if (arrow_row_is_valid(filter, row))
+		{
+			Assert(offsets[row] != 0);
+			const CTYPE value = arrow_row_is_valid(validity, row) ? values[row] : 0;
+			FUNCTION_NAME(one)(&states[offsets[row]], value);
+		}
+	}
+	MemoryContextSwitchTo(old);
+}
+
+VectorAggFunctions FUNCTION_NAME(argdef) = {
+	.state_bytes = sizeof(FUNCTION_NAME(state)),
+	.agg_bind_args = histogram_bind_args,
+	.agg_init_args = histogram_init,
+	.agg_accepts_nulls = true,
+	.agg_emit = histogram_emit,
+	.agg_scalar = FUNCTION_NAME(scalar),
+	.agg_vector = FUNCTION_NAME(vector),
+	.agg_many_vector = FUNCTION_NAME(many_vector),
+};
+
+#undef PG_TYPE
+#undef CTYPE
+#undef DATUM_TO_CTYPE
@@ -0,0 +1,314 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Vectorized implementation of the histogram(value, min, max, nbuckets)
+ * aggregate function, see src/histogram.c for the row-by-row transition
+ * functions. The partial aggregation result is the serialized histogram
+ * state, so it can be combined with the partials of the row-by-row functions.
+ */
+
+#include <postgres.h>
+
+#include <math.h>
+
+#include <access/transam.h>
+#include <catalog/pg_type.h>
+#include <libpq/pqformat.h>
+#include <nodes/primnodes.h>
+#include <utils/fmgroids.h>
+#include <utils/lsyscache.h>
+
+#include "compat/compat.h"
+#include "debug_assert.h"
+#include "extension.h"
+#include "functions.h"
+#include "template_helper.h"
+#include <compression/arrow_c_data_interface.h>
+
+/*
+ * The bound constant arguments of histogram(), shared by all the states of
+ * one aggregate function.
+ */
+typedef struct HistogramArgs
+{
+	double min;
+	double max;
+	int32 nbuckets;
+
+	/* The range is too wide to compute max - min without overflow. */
+	bool wide_range;
+
+	/* The arguments were checked, which is done only when we have some rows. */
+	bool checked;
+} HistogramArgs;
+
+typedef struct HistogramState
+{
+	HistogramArgs *args;
+
+	/*
+	 * The counts for nbuckets + 2 buckets including the out-of-range ones,
+	 * allocated for the first aggregated row. No rows means a null result, like
+	 * for the row-by-row transition function.
+	 */
+	int64 *counts;
+} HistogramState;
+
+/*
+ * The same checks as in the row-by-row transition function and in the
+ * width_bucket_float8() function that it calls, in the same order.
+ */
+static void
+histogram_check_args(HistogramArgs *args)
+{
+	if (likely(args->checked))
+	{
+		return;
+	}
+
+	if (args->min > args->max)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("lower bound cannot exceed upper bound")));
+	}
+
+	if (args->nbuckets <= 0)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("count must be greater than zero")));
+	}
+
+	if (isnan(args->min) || isnan(args->max))
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("operand, lower bound, and upper bound cannot be NaN")));
+	}
+
+	if (isinf(args->min) || isinf(args->max))
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("lower and upper bounds must be finite")));
+	}
+
+	if (args->min == args->max)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+				 errmsg("lower bound cannot equal upper bound")));
+	}
+
+	args->wide_range = isinf(args->max - args->min);
+	args->checked = true;
+}
+
+static pg_noinline void
+histogram_nan_error(void)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_INVALID_ARGUMENT_FOR_WIDTH_BUCKET_FUNCTION),
+			 errmsg("operand, lower bound, and upper bound cannot be NaN")));
+}
+
+/*
+ * The bucket index for the given value, computed the same way as
+ * width_bucket_float8() does. The value must not be NaN, but the result is
+ * still a valid bucket index for NaN, so that this can be computed for the
+ * filtered out rows as well. This is written without branches so that it can
+ * be vectorized.
+ */
+static pg_attribute_always_inline int32
+histogram_bucket(const HistogramArgs *args, double value)
+{
+	const double min = args->min;
+	const double max = args->max;
+	const int32 nbuckets = args->nbuckets;
+
+	double position = args->wide_range ?
+						  nbuckets * ((value / 2 - min / 2) / (max / 2 - min / 2)) :
+						  nbuckets * ((value - min) / (max - min));
+
+	/* The quotient could round to 1.0, so clamp it to the last bucket. */
+	position = position > 0 ? position : 0;
+	position = position < nbuckets - 1 ? position : nbuckets - 1;
+
+	const int32 in_range_bucket = ((int32) position) + 1;
+	return value < min ? 0 : (value >= max ? nbuckets + 1 : in_range_bucket);
+}
+
+static pg_attribute_always_inline int64 *
+histogram_get_counts(HistogramState *state)
+{
+	if (unlikely(state->counts == NULL))
+	{
+		histogram_check_args(state->args);
+		state->counts = palloc0(sizeof(*state->counts) * (state->args->nbuckets + 2));
+	}
+	return state->counts;
+}
+
+static void
+histogram_init(void *restrict agg_states, int n, void *agg_args)
+{
+	HistogramState *states = (HistogramState *) agg_states;
+	for (int i = 0; i < n; i++)
+	{
+		states[i].args = (HistogramArgs *) agg_args;
+		states[i].counts = NULL;
+	}
+}
+
+/*
+ * Emit the serialized state in the format of ts_hist_serializefunc().
+ */
+static void
+histogram_emit(void *agg_state, Datum *out_result, bool *out_isnull)
+{
+	HistogramState *state = (HistogramState *) agg_state;
+
+	if (state->counts == NULL)
+	{
+		*out_result = PointerGetDatum(NULL);
+		*out_isnull = true;
+		return;
+	}
+
+	const int32 nbuckets = state->args->nbuckets + 2;
+
+	StringInfoData buf;
+	pq_begintypsend(&buf);
+	pq_sendint32(&buf, nbuckets);
+	for (int32 i = 0; i < nbuckets; i++)
+	{
+		/* The row-by-row transition function has the same limit. */
+		if (state->counts[i] >= PG_INT32_MAX)
+		{
+			elog(ERROR, "overflow in histogram");
+		}
+		pq_sendint32(&buf, (int32) state->counts[i]);
+	}
+
+	*out_result = PointerGetDatum(pq_endtypsend(&buf));
+	*out_isnull = false;
+}
+
+static void histogram_bind_args(VectorAggFunctions *func, Oid argtype, List *const_args);
+
+#define AGG_NAME histogram
+
+#define PG_TYPE FLOAT8
+#define CTYPE float8
+#define DATUM_TO_CTYPE DatumGetFloat8
+#include "histogram_single.c"
+
+#define PG_TYPE FLOAT4
+#define CTYPE float4
+#define DATUM_TO_CTYPE DatumGetFloat4
+#include "histogram_single.c"
+
+#define PG_TYPE INT2
+#define CTYPE int16
+#define DATUM_TO_CTYPE DatumGetInt16
+#include "histogram_single.c"
+
+#define PG_TYPE INT4
+#define CTYPE int32
+#define DATUM_TO_CTYPE DatumGetInt32
+#include "histogram_single.c"
+
+#define PG_TYPE INT8
+#define CTYPE int64
+#define DATUM_TO_CTYPE DatumGetInt64
+#include "histogram_single.c"
+
+#undef AGG_NAME
+
+/*
+ * Bind the min, max and nbuckets arguments, and choose the implementation for
+ * the type of the aggregated column, which can be under an implicit cast to
+ * float8, see vector_agg_aggregated_argument().
+ */
+static void
+histogram_bind_args(VectorAggFunctions *func, Oid argtype, List *const_args)
+{
+	Ensure(list_length(const_args) == 3,
+		   "wrong number of constant arguments %d for histogram()",
+		   list_length(const_args));
+
+	switch (argtype)
+	{
+		case FLOAT8OID:
+			*func = histogram_FLOAT8_argdef;
+			break;
+		case FLOAT4OID:
+			*func = histogram_FLOAT4_argdef;
+			break;
+		case INT2OID:
+			*func = histogram_INT2_argdef;
+			break;
+		case INT4OID:
+			*func = histogram_INT4_argdef;
+			break;
+		case INT8OID:
+			*func = histogram_INT8_argdef;
+			break;
+		default:
+			Ensure(false, "unexpected argument type %d for vectorized histogram()", argtype);
+			pg_unreachable();
+	}
+
+	const Const *min = linitial_node(Const, const_args);
+	const Const *max = lsecond_node(Const, const_args);
+	const Const *nbuckets = lthird_node(Const, const_args);
+	Assert(!min->constisnull && !max->constisnull && !nbuckets->constisnull);
+
+	HistogramArgs *args = palloc0(sizeof(HistogramArgs));
+	args->min = DatumGetFloat8(min->constvalue);
+	args->max = DatumGetFloat8(max->constvalue);
+	args->nbuckets = DatumGetInt32(nbuckets->constvalue);
+	func->agg_args = args;
+}
+
+/*
+ * The histogram(float8, float8, float8, int4) aggregate function of our
+ * extension, if this is it.
+ */
+VectorAggFunctions *
+get_vector_histogram(Oid aggfnoid)
+{
+#if PG16_LT
+	/*
+	 * The width_bucket_float8() before PG 16 computes the bucket with a
+	 * different rounding, so we don't vectorize it there to get the same
+	 * results.
+	 */
+	return NULL;
+#endif
+
+	if (aggfnoid < FirstNormalObjectId)
+	{
+		return NULL;
+	}
+
+	if (get_func_namespace(aggfnoid) != ts_extension_schema_oid() ||
+		get_func_nargs(aggfnoid) != 4)
+	{
+		return NULL;
+	}
+
+	char *name = get_func_name(aggfnoid);
+	if (name == NULL || strcmp(name, "histogram") != 0)
+	{
+		return NULL;
+	}
+
+	/* The actual implementation is chosen when binding the arguments. */
+	return &histogram_FLOAT8_argdef;
+}
@@ -110,6 +110,16 @@ FUNCTION_NAME(one)(void *restrict agg_state, const CTYPE value)
 #endif
 }
 
+#ifndef NEED_SUMX2
+static void
+FUNCTION_NAME(batch_metadata)(void *restrict agg_state, const BatchSumMetadata *metadata)
+{
+	FUNCTION_NAME(state) *state = (FUNCTION_NAME(state) *) agg_state;
+	state->N += metadata->count;
+	state->sumX += metadata->int_sum;
+}
+#endif
+
 #include "agg_many_vector_helper.c"
 #include "agg_scalar_helper.c"
 #include "agg_vector_validity_helper.c"
@@ -121,6 +131,9 @@ VectorAggFunctions FUNCTION_NAME(argdef) = {
 	.agg_scalar = FUNCTION_NAME(scalar),
 	.agg_vector = FUNCTION_NAME(vector),
 	.agg_many_vector = FUNCTION_NAME(many_vector),
+#ifndef NEED_SUMX2
+	.agg_batch_metadata = FUNCTION_NAME(batch_metadata),
+#endif
 };
 
 #endif
@@ -38,6 +38,14 @@ FUNCTION_NAME(one)(void *restrict agg_state, const CTYPE value)
 	state->sum += value;
 }
 
+static void
+FUNCTION_NAME(batch_metadata)(void *restrict agg_state, const BatchSumMetadata *metadata)
+{
+	FUNCTION_NAME(state) *state = (FUNCTION_NAME(state) *) agg_state;
+	state->count += metadata->count;
+	state->sum += metadata->int_sum;
+}
+
 #include "agg_many_vector_helper.c"
 #include "agg_scalar_helper.c"
 #include "agg_vector_validity_helper.c"
@@ -49,6 +57,7 @@ VectorAggFunctions FUNCTION_NAME(argdef) = {
 	.agg_scalar = FUNCTION_NAME(scalar),
 	.agg_vector = FUNCTION_NAME(vector),
 	.agg_many_vector = FUNCTION_NAME(many_vector),
+	.agg_batch_metadata = FUNCTION_NAME(batch_metadata),
 };
 
 #endif
@@ -61,6 +61,20 @@ FUNCTION_NAME(one)(void *restrict agg_state, const CTYPE value)
 
 typedef Int24SumState FUNCTION_NAME(state);
 
+static void
+FUNCTION_NAME(batch_metadata)(void *restrict agg_state, const BatchSumMetadata *metadata)
+{
+	Int24SumState *state = (Int24SumState *) agg_state;
+
+	if (unlikely(pg_add_s64_overflow(state->result, metadata->int_sum, &state->result)))
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), errmsg("bigint out of range")));
+	}
+
+	state->isvalid = state->isvalid || metadata->count > 0;
+}
+
 #include "agg_many_vector_helper.c"
 #include "agg_scalar_helper.c"
 #include "agg_vector_validity_helper.c"
@@ -72,6 +86,7 @@ VectorAggFunctions FUNCTION_NAME(argdef) = {
 	.agg_scalar = FUNCTION_NAME(scalar),
 	.agg_vector = FUNCTION_NAME(vector),
 	.agg_many_vector = FUNCTION_NAME(many_vector),
+	.agg_batch_metadata = FUNCTION_NAME(batch_metadata),
 };
 #endif
 
@@ -0,0 +1,96 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#ifdef GENERATE_DISPATCH_TABLE
+extern VectorAggFunctions FUNCTION_NAME(argdef);
+case PG_AGG_OID_HELPER(AGG_NAME, PG_TYPE):
+	return &FUNCTION_NAME(argdef);
+#else
+static pg_attribute_always_inline void
+FUNCTION_NAME(one)(NumericMinMaxState *state, const NumericValue *value,
+				   MemoryContext agg_extra_mctx)
+{
+	if (state->result == NULL || PREDICATE(numeric_value_cmp(value, &state->value)))
+	{
+		numeric_minmax_set(state, value, agg_extra_mctx);
+	}
+}
+
+static void
+FUNCTION_NAME(scalar)(void *agg_state, Datum constvalue, bool constisnull, int n,
+					  MemoryContext agg_extra_mctx)
+{
+	if (constisnull)
+	{
+		return;
+	}
+
+	const NumericValue value = numeric_value_from_datum(constvalue);
+	FUNCTION_NAME(one)((NumericMinMaxState *) agg_state, &value, agg_extra_mctx);
+}
+
+/*
+ * Find the result for the batch first, so that we have to copy only one value
+ * to the aggregate function state.
+ */
+static void
+FUNCTION_NAME(vector)(void *agg_state, const ArrowArray *vector, const uint64 *filter,
+					  MemoryContext agg_extra_mctx)
+{
+	const int n = vector->length;
+
+	NumericValue batch_result = { 0 };
+	bool have_batch_result = false;
+	for (int row = 0; row < n; row++)
+	{
+		if (!arrow_row_is_valid(filter, row))
+		{
+			continue;
+		}
+
+		const NumericValue value = numeric_value_from_arrow(vector, row);
+		if (!have_batch_result || PREDICATE(numeric_value_cmp(&value, &batch_result)))
+		{
+			batch_result = value;
+			have_batch_result = true;
+		}
+	}
+
+	if (have_batch_result)
+	{
+		FUNCTION_NAME(one)((NumericMinMaxState *) agg_state, &batch_result, agg_extra_mctx);
+	}
+}
+
+static void
+FUNCTION_NAME(many_vector)(void *restrict agg_states, const uint32 *offsets, const uint64 *filter,
+						   int start_row, int end_row, const ArrowArray *vector,
+						   MemoryContext agg_extra_mctx)
+{
+	NumericMinMaxState *states = (NumericMinMaxState *) agg_states;
+	for (int row = start_row; row < end_row; row++)
+	{
+		if (arrow_row_is_valid(filter, row))
+		{
+			Assert(offsets[row] != 0);
+			const NumericValue value = numeric_value_from_arrow(vector, row);
+			FUNCTION_NAME(one)(&states[offsets[row]], &value, agg_extra_mctx);
+		}
+	}
+}
+
+VectorAggFunctions FUNCTION_NAME(argdef) = {
+	.state_bytes = sizeof(NumericMinMaxState),
+	.agg_init = numeric_minmax_init,
+	.agg_emit = numeric_minmax_emit,
+	.agg_scalar = FUNCTION_NAME(scalar),
+	.agg_vector = FUNCTION_NAME(vector),
+	.agg_many_vector = FUNCTION_NAME(many_vector),
+};
+#endif
+
+#undef PREDICATE
+#undef AGG_NAME
@@ -0,0 +1,584 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Vectorized sum(), avg(), min() and max() for numeric.
+ *
+ * The numeric columns are bulk decompressed into the same arrow representation
+ * as text, with the binary representations of numeric values as the bodies. To
+ * aggregate them, we convert the values to a fixed-point representation with
+ * an int64 mantissa and the display scale of the value. The values of a column
+ * usually share the scale, e.g. when the column has a type modifier, so most
+ * batches are aggregated with integer arithmetic. The values with different
+ * scales are brought to a common scale, and those that don't fit into int64
+ * mantissa at all, like NaN, infinities or very large numbers, are aggregated
+ * with the numeric functions, so the results are always exact.
+ */
+
+#include <postgres.h>
+
+#include <common/int.h>
+#include <nodes/execnodes.h>
+#include <port/pg_bswap.h>
+#include <utils/builtins.h>
+#include <utils/datum.h>
+#include <utils/fmgroids.h>
+#include <utils/fmgrprotos.h>
+#include <utils/numeric.h>
+
+#include "debug_assert.h"
+#include "functions.h"
+#include "template_helper.h"
+#include <compression/algorithms/numeric_utils.h>
+#include <compression/arrow_c_data_interface.h>
+
+#ifdef HAVE_INT128
+#ifndef GENERATE_DISPATCH_TABLE
+#define NUMERIC_INT128_MAX ((int128) (((uint128) 1 << 127) - 1))
+#define NUMERIC_INT128_MIN (-NUMERIC_INT128_MAX - 1)
+
+/*
+ * A numeric value from a batch or an aggregate function state, in the binary
+ * representation without the varlena header, and in the fixed-point
+ * representation if it has one.
+ */
+typedef struct
+{
+	const uint8 *body;
+	uint32 len;
+	bool have_fixed;
+	FixedNumeric fixed;
+} NumericValue;
+
+static pg_attribute_always_inline NumericValue
+numeric_value_from_body(const uint8 *body, uint32 len)
+{
+	NumericValue value = { .body = body, .len = len };
+	value.have_fixed = numeric_body_to_fixed(body, len, &value.fixed);
+	return value;
+}
+
+static pg_attribute_always_inline NumericValue
+numeric_value_from_arrow(const ArrowArray *vector, int row)
+{
+	const uint32 *offsets = (const uint32 *) vector->buffers[1];
+	const uint8 *bodies = (const uint8 *) vector->buffers[2];
+	return numeric_value_from_body(&bodies[offsets[row]], offsets[row + 1] - offsets[row]);
+}
+
+static pg_attribute_always_inline NumericValue
+numeric_value_from_datum(Datum datum)
+{
+	Numeric numeric = DatumGetNumeric(datum);
+	return numeric_value_from_body((const uint8 *) VARDATA(numeric), VARSIZE(numeric) - VARHDRSZ);
+}
+
+/*
+ * Make a numeric Datum with the varlena header from the given value, in the
+ * current memory context.
+ */
+static Datum
+numeric_value_to_datum(const NumericValue *value)
+{
+	struct varlena *result = palloc(VARHDRSZ + value->len);
+	SET_VARSIZE(result, VARHDRSZ + value->len);
+	memcpy(VARDATA(result), value->body, value->len);
+	return PointerGetDatum(result);
+}
+
+/*
+ * Convert the fixed-point representation with the given scale to numeric,
+ * going through the text representation that gives it this display scale.
+ */
+static Datum
+numeric_from_int128(int128 value, int32 scale)
+{
+	/* 39 decimal digits of int128, the sign, the point and the zeros. */
+	char *buffer = palloc(scale + 48);
+	char *p = buffer + scale + 47;
+	*p = '\0';
+
+	uint128 abs = value < 0 ? -(uint128) value : (uint128) value;
+	int ndigits = 0;
+	do
+	{
+		*--p = '0' + (int) (abs % 10);
+		abs /= 10;
+		ndigits++;
+		if (ndigits == scale)
+		{
+			*--p = '.';
+		}
+	} while (abs != 0 || ndigits <= scale);
+
+	if (value < 0)
+	{
+		*--p = '-';
+	}
+
+	Datum result = DirectFunctionCall3(numeric_in,
+									   CStringGetDatum(p),
+									   ObjectIdGetDatum(InvalidOid),
+									   Int32GetDatum(-1));
+	pfree(buffer);
+	return result;
+}
+
+/*
+ * Multiply the value by 10^shift, returning false if it overflows.
+ */
+static bool
+int128_rescale(int128 *value, int shift)
+{
+	Assert(shift >= 0);
+	if (*value == 0)
+	{
+		return true;
+	}
+
+	if (shift > NUMERIC_MAX_POW10)
+	{
+		return false;
+	}
+
+	const int64 factor = numeric_pow10[shift];
+	if (*value > NUMERIC_INT128_MAX / factor || *value < NUMERIC_INT128_MIN / factor)
+	{
+		return false;
+	}
+
+	*value *= factor;
+	return true;
+}
+
+/*
+ * Compare two numeric values like numeric_cmp() does. The values that have the
+ * fixed-point representation are compared without converting them to numeric.
+ */
+static pg_attribute_always_inline int
+numeric_value_cmp(const NumericValue *a, const NumericValue *b)
+{
+	if (a->have_fixed && b->have_fixed)
+	{
+		int128 a_scaled = a->fixed.mantissa;
+		int128 b_scaled = b->fixed.mantissa;
+		const int shift = a->fixed.scale - b->fixed.scale;
+		if (likely(shift == 0) ||
+			(shift > 0 ? int128_rescale(&b_scaled, shift) : int128_rescale(&a_scaled, -shift)))
+		{
+			return (a_scaled > b_scaled) - (a_scaled < b_scaled);
+		}
+	}
+
+	Datum a_datum = numeric_value_to_datum(a);
+	Datum b_datum = numeric_value_to_datum(b);
+	const int result = DatumGetInt32(DirectFunctionCall2(numeric_cmp, a_datum, b_datum));
+	pfree(DatumGetPointer(a_datum));
+	pfree(DatumGetPointer(b_datum));
+	return result;
+}
+
+/*
+ * Common parts for vectorized min() and max().
+ */
+typedef struct
+{
+	/*
+	 * The current result, allocated in the aggregate function memory context,
+	 * or NULL if we had no rows yet.
+	 */
+	Numeric result;
+
+	/* The current result as NumericValue that points into the above. */
+	NumericValue value;
+} NumericMinMaxState;
+
+static void
+numeric_minmax_init(void *restrict agg_states, int n)
+{
+	NumericMinMaxState *states = (NumericMinMaxState *) agg_states;
+	for (int i = 0; i < n; i++)
+	{
+		states[i].result = NULL;
+	}
+}
+
+static void
+numeric_minmax_emit(void *agg_state, Datum *out_result, bool *out_isnull)
+{
+	NumericMinMaxState *state = (NumericMinMaxState *) agg_state;
+	*out_result = PointerGetDatum(state->result);
+	*out_isnull = state->result == NULL;
+}
+
+static void
+numeric_minmax_set(NumericMinMaxState *state, const NumericValue *value,
+				   MemoryContext agg_extra_mctx)
+{
+	MemoryContext old = MemoryContextSwitchTo(agg_extra_mctx);
+	if (state->result != NULL)
+	{
+		pfree(state->result);
+	}
+	state->result = DatumGetNumeric(numeric_value_to_datum(value));
+	MemoryContextSwitchTo(old);
+
+	state->value = *value;
+	state->value.body = (const uint8 *) VARDATA(state->result);
+}
+
+/*
+ * Common parts for vectorized sum() and avg().
+ */
+typedef struct
+{
+	/* Number of the aggregated values, including the special ones. */
+	int64 N;
+
+	bool have_nan;
+	bool have_pinf;
+	bool have_ninf;
+
+	/* The sum of the fixed-point values, fixed_sum * 10^-fixed_scale. */
+	int128 fixed_sum;
+	int32 fixed_scale;
+
+	/*
+	 * The sum of the finite values that don't fit into the fixed-point sum,
+	 * allocated in the aggregate function memory context, or NULL.
+	 */
+	Numeric exact_sum;
+} NumericSumState;
+
+static void
+numeric_sum_init(void *restrict agg_states, int n)
+{
+	NumericSumState *states = (NumericSumState *) agg_states;
+	for (int i = 0; i < n; i++)
+	{
+		states[i] = (NumericSumState){ 0 };
+	}
+}
+
+static void
+numeric_sum_add_exact(NumericSumState *state, Datum value, MemoryContext agg_extra_mctx)
+{
+	MemoryContext old = MemoryContextSwitchTo(agg_extra_mctx);
+	if (state->exact_sum == NULL)
+	{
+		state->exact_sum = DatumGetNumeric(datumCopy(value, false, -1));
+	}
+	else
+	{
+		Numeric old_sum = state->exact_sum;
+		state->exact_sum =
+			DatumGetNumeric(DirectFunctionCall2(numeric_add, NumericGetDatum(old_sum), value));
+		pfree(old_sum);
+	}
+	MemoryContextSwitchTo(old);
+}
+
+/*
+ * Move the fixed-point sum to the exact sum when it would overflow.
+ */
+static void
+numeric_sum_flush_fixed(NumericSumState *state, MemoryContext agg_extra_mctx)
+{
+	numeric_sum_add_exact(state,
+						  numeric_from_int128(state->fixed_sum, state->fixed_scale),
+						  agg_extra_mctx);
+	state->fixed_sum = 0;
+}
+
+static void
+numeric_sum_add_fixed(NumericSumState *state, int128 value, int32 scale,
+					  MemoryContext agg_extra_mctx)
+{
+	if (unlikely(scale > state->fixed_scale))
+	{
+		if (!int128_rescale(&state->fixed_sum, scale - state->fixed_scale))
+		{
+			numeric_sum_flush_fixed(state, agg_extra_mctx);
+		}
+		state->fixed_scale = scale;
+	}
+	else if (unlikely(scale < state->fixed_scale))
+	{
+		if (!int128_rescale(&value, state->fixed_scale - scale))
+		{
+			numeric_sum_add_exact(state, numeric_from_int128(value, scale), agg_extra_mctx);
+			return;
+		}
+	}
+
+	if (unlikely((value > 0 && state->fixed_sum > NUMERIC_INT128_MAX - value) ||
+				 (value < 0 && state->fixed_sum < NUMERIC_INT128_MIN - value)))
+	{
+		numeric_sum_flush_fixed(state, agg_extra_mctx);
+	}
+
+	state->fixed_sum += value;
+}
+
+/*
+ * Add n copies of a value that doesn't have the fixed-point representation.
+ */
+static pg_noinline void
+numeric_sum_add_slow(NumericSumState *state, const NumericValue *value, int n,
+					 MemoryContext agg_extra_mctx)
+{
+	uint16 header;
+	Assert(value->len >= sizeof(header));
+	memcpy(&header, value->body, sizeof(header));
+
+	if ((header & NUMERIC_SIGN_MASK) == NUMERIC_SPECIAL)
+	{
+		switch (header & NUMERIC_EXT_SIGN_MASK)
+		{
+			case NUMERIC_PINF:
+				state->have_pinf = true;
+				break;
+			case NUMERIC_NINF:
+				state->have_ninf = true;
+				break;
+			default:
+				state->have_nan = true;
+				break;
+		}
+		return;
+	}
+
+	Datum datum = numeric_value_to_datum(value);
+	if (n != 1)
+	{
+		datum = DirectFunctionCall2(numeric_mul, datum, NumericGetDatum(int64_to_numeric(n)));
+	}
+	numeric_sum_add_exact(state, datum, agg_extra_mctx);
+}
+
+static pg_attribute_always_inline void
+numeric_sum_one(NumericSumState *state, const NumericValue *value, MemoryContext agg_extra_mctx)
+{
+	state->N++;
+	if (likely(value->have_fixed))
+	{
+		numeric_sum_add_fixed(state, value->fixed.mantissa, value->fixed.scale, agg_extra_mctx);
+	}
+	else
+	{
+		numeric_sum_add_slow(state, value, 1, agg_extra_mctx);
+	}
+}
+
+static void
+numeric_sum_scalar(void *agg_state, Datum constvalue, bool constisnull, int n,
+				   MemoryContext agg_extra_mctx)
+{
+	if (constisnull)
+	{
+		return;
+	}
+
+	NumericSumState *state = (NumericSumState *) agg_state;
+	const NumericValue value = numeric_value_from_datum(constvalue);
+	state->N += n;
+	if (likely(value.have_fixed))
+	{
+		numeric_sum_add_fixed(state,
+							  (int128) value.fixed.mantissa * n,
+							  value.fixed.scale,
+							  agg_extra_mctx);
+	}
+	else
+	{
+		numeric_sum_add_slow(state, &value, n, agg_extra_mctx);
+	}
+}
+
+/*
+ * Sum a batch. The values with the same scale as the first one are summed in a
+ * local int128 variable, which can't overflow for the batch size, and the rest
+ * are added to the state separately.
+ */
+static void
+numeric_sum_vector(void *agg_state, const ArrowArray *vector, const uint64 *filter,
+				   MemoryContext agg_extra_mctx)
+{
+	NumericSumState *state = (NumericSumState *) agg_state;
+	const int n = vector->length;
+
+	int128 batch_sum = 0;
+	int32 batch_scale = -1;
+	for (int row = 0; row < n; row++)
+	{
+		if (!arrow_row_is_valid(filter, row))
+		{
+			continue;
+		}
+
+		const NumericValue value = numeric_value_from_arrow(vector, row);
+		if (likely(value.have_fixed && value.fixed.scale == batch_scale))
+		{
+			state->N++;
+			batch_sum += value.fixed.mantissa;
+		}
+		else if (value.have_fixed && batch_scale < 0)
+		{
+			state->N++;
+			batch_sum = value.fixed.mantissa;
+			batch_scale = value.fixed.scale;
+		}
+		else
+		{
+			numeric_sum_one(state, &value, agg_extra_mctx);
+		}
+	}
+
+	if (batch_scale >= 0)
+	{
+		numeric_sum_add_fixed(state, batch_sum, batch_scale, agg_extra_mctx);
+	}
+}
+
+static void
+numeric_sum_many_vector(void *restrict agg_states, const uint32 *offsets, const uint64 *filter,
+						int start_row, int end_row, const ArrowArray *vector,
+						MemoryContext agg_extra_mctx)
+{
+	NumericSumState *states = (NumericSumState *) agg_states;
+	for (int row = start_row; row < end_row; row++)
+	{
+		if (arrow_row_is_valid(filter, row))
+		{
+			Assert(offsets[row] != 0);
+			const NumericValue value = numeric_value_from_arrow(vector, row);
+			numeric_sum_one(&states[offsets[row]], &value, agg_extra_mctx);
+		}
+	}
+}
+
+static Datum
+numeric_special_value(const char *str)
+{
+	return DirectFunctionCall3(numeric_in,
+							   CStringGetDatum(str),
+							   ObjectIdGetDatum(InvalidOid),
+							   Int32GetDatum(-1));
+}
+
+/*
+ * Emit the partial aggregation result in the format of numeric_avg_serialize().
+ * The internal state of numeric_avg_accum() is private to numeric.c, so we
+ * build it by accumulating the total sum and one of each special value we had,
+ * and then put the actual count of values into the serialized state.
+ */
+static void
+numeric_sum_emit(void *agg_state, Datum *out_result, bool *out_isnull)
+{
+	NumericSumState *state = (NumericSumState *) agg_state;
+
+	if (state->N == 0)
+	{
+		*out_result = PointerGetDatum(NULL);
+		*out_isnull = true;
+		return;
+	}
+
+	Datum sum = numeric_from_int128(state->fixed_sum, state->fixed_scale);
+	if (state->exact_sum != NULL)
+	{
+		sum = DirectFunctionCall2(numeric_add, sum, NumericGetDatum(state->exact_sum));
+	}
+
+	Datum values[4];
+	int nvalues = 0;
+	values[nvalues++] = sum;
+	if (state->have_nan)
+	{
+		values[nvalues++] = numeric_special_value("NaN");
+	}
+	if (state->have_pinf)
+	{
+		values[nvalues++] = numeric_special_value("Infinity");
+	}
+	if (state->have_ninf)
+	{
+		values[nvalues++] = numeric_special_value("-Infinity");
+	}
+
+	/*
+	 * The transition function allocates its state in the aggregate memory
+	 * context, so we point it to the current one.
+	 */
+	ExprContext econtext = { .type = T_ExprContext, .ecxt_per_tuple_memory = CurrentMemoryContext };
+	AggState agg_context = { .ss.ps.type = T_AggState, .curaggcontext = &econtext };
+
+	LOCAL_FCINFO(fcinfo, 2);
+	InitFunctionCallInfoData(*fcinfo, NULL, 2, InvalidOid, (Node *) &agg_context, NULL);
+	fcinfo->args[0].value = PointerGetDatum(NULL);
+	fcinfo->args[0].isnull = true;
+	for (int i = 0; i < nvalues; i++)
+	{
+		fcinfo->args[1].value = values[i];
+		fcinfo->args[1].isnull = false;
+		fcinfo->args[0].value = numeric_avg_accum(fcinfo);
+		fcinfo->args[0].isnull = false;
+	}
+
+	/* The accumulated state is already in the first argument. */
+	InitFunctionCallInfoData(*fcinfo, NULL, 1, InvalidOid, (Node *) &agg_context, NULL);
+	bytea *serialized = DatumGetByteaP(numeric_avg_serialize(fcinfo));
+
+	/* The count of values goes first in the serialized state. */
+	const uint64 count = pg_hton64((uint64) state->N);
+	Ensure(VARSIZE(serialized) >= VARHDRSZ + sizeof(count),
+		   "unexpected size %d of the serialized numeric aggregate state",
+		   (int) VARSIZE(serialized));
+	memcpy(VARDATA(serialized), &count, sizeof(count));
+
+	*out_result = PointerGetDatum(serialized);
+	*out_isnull = false;
+}
+
+VectorAggFunctions numeric_sum_agg = {
+	.state_bytes = sizeof(NumericSumState),
+	.agg_init = numeric_sum_init,
+	.agg_emit = numeric_sum_emit,
+	.agg_scalar = numeric_sum_scalar,
+	.agg_vector = numeric_sum_vector,
+	.agg_many_vector = numeric_sum_many_vector,
+};
+#endif
+
+/*
+ * Vectorized implementation of numeric_avg_accum() function.
+ */
+#ifdef GENERATE_DISPATCH_TABLE
+extern VectorAggFunctions numeric_sum_agg;
+case F_SUM_NUMERIC:
+case F_AVG_NUMERIC:
+	return &numeric_sum_agg;
+#endif
+
+/*
+ * Vectorized min() and max(). The numeric_smaller() and numeric_larger()
+ * transition functions keep the new value when it is equal to the current one,
+ * which matters for the values with different display scales, so we do the
+ * same.
+ */
+#define PG_TYPE NUMERIC
+
+#define AGG_NAME MIN
+#define PREDICATE(CMP) ((CMP) <= 0)
+#include "numeric_minmax_single.c"
+
+#define AGG_NAME MAX
+#define PREDICATE(CMP) ((CMP) >= 0)
+#include "numeric_minmax_single.c"
+
+#undef PG_TYPE
+
+#endif
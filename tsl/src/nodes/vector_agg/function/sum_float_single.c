@@ -91,6 +91,14 @@ FUNCTION_NAME(one)(void *restrict agg_state, const CTYPE value)
 	state->result += value;
 }
 
+static void
+FUNCTION_NAME(batch_metadata)(void *restrict agg_state, const BatchSumMetadata *metadata)
+{
+	FloatSumState *state = (FloatSumState *) agg_state;
+	state->isvalid = state->isvalid || metadata->count > 0;
+	state->result += metadata->float_sum;
+}
+
 #include "agg_many_vector_helper.c"
 #include "agg_scalar_helper.c"
 #include "agg_vector_validity_helper.c"
@@ -102,6 +110,7 @@ VectorAggFunctions FUNCTION_NAME(argdef) = {
 	.agg_scalar = FUNCTION_NAME(scalar),
 	.agg_vector = FUNCTION_NAME(vector),
 	.agg_many_vector = FUNCTION_NAME(many_vector),
+	.agg_batch_metadata = FUNCTION_NAME(batch_metadata),
 };
 
 #endif
@@ -70,6 +70,8 @@ typedef enum
 	VAGT_HashSingleFixed4,
 	VAGT_HashSingleFixed8,
 	VAGT_HashSingleText,
+	VAGT_HashPacked8,
+	VAGT_HashPacked16,
 	VAGT_HashSerialized,
 } VectorAggGroupingType;
 
@@ -100,7 +100,7 @@ gp_batch_reset(GroupingPolicy *obj)
 	{
 		VectorAggDef *agg_def = &policy->agg_defs[i];
 		void *agg_state = policy->agg_states[i];
-		agg_def->func.agg_init(agg_state, 1);
+		vector_agg_init_states(&agg_def->func, agg_state, 1);
 	}
 
 	const int ngrp = policy->num_grouping_columns;
@@ -118,6 +118,16 @@ compute_single_aggregate(GroupingPolicyBatch *policy, DecompressContext *dcontex
 						 TupleTableSlot *vector_slot, VectorAggDef *agg_def, void *agg_state,
 						 MemoryContext agg_extra_mctx)
 {
+	/*
+	 * The batch can be aggregated using its pre-aggregated metadata without
+	 * looking at the argument values.
+	 */
+	if (agg_def->use_batch_metadata)
+	{
+		agg_def->func.agg_batch_metadata(agg_state, &agg_def->batch_metadata);
+		return;
+	}
+
 	/*
 	 * We have functions with one argument, and one function with no arguments
 	 * (count(*)). Collect the arguments.
@@ -140,7 +150,7 @@ compute_single_aggregate(GroupingPolicyBatch *policy, DecompressContext *dcontex
 		if (values.arrow != NULL)
 		{
 			arg_arrow = values.arrow;
-			arg_validity_bitmap = values.buffers[0];
+			arg_validity_bitmap = agg_def->func.agg_accepts_nulls ? NULL : values.buffers[0];
 		}
 		else
 		{
@@ -151,7 +161,8 @@ compute_single_aggregate(GroupingPolicyBatch *policy, DecompressContext *dcontex
 	}
 
 	/*
-	 * Compute the combined validity bitmap that includes the argument validity.
+	 * Compute the combined validity bitmap that includes the argument validity,
+	 * unless the function also aggregates the null arguments.
 	 */
 	DecompressBatchState *batch_state = (DecompressBatchState *) vector_slot;
 	const size_t num_words = (batch_state->total_batch_rows + 63) / 64;
@@ -37,6 +37,8 @@
 extern HashingStrategy single_fixed_2_strategy;
 extern HashingStrategy single_fixed_4_strategy;
 extern HashingStrategy single_fixed_8_strategy;
+extern HashingStrategy packed_8_strategy;
+extern HashingStrategy packed_16_strategy;
 #ifdef TS_USE_UMASH
 extern HashingStrategy single_text_strategy;
 extern HashingStrategy serialized_strategy;
@@ -92,6 +94,12 @@ create_grouping_policy_hash(int num_agg_defs, VectorAggDef *agg_defs, int num_gr
 		case VAGT_HashSingleFixed2:
 			policy->hashing = single_fixed_2_strategy;
 			break;
+		case VAGT_HashPacked8:
+			policy->hashing = packed_8_strategy;
+			break;
+		case VAGT_HashPacked16:
+			policy->hashing = packed_16_strategy;
+			break;
 		default:
 			Ensure(false, "failed to determine the hashing strategy");
 			break;
@@ -150,7 +158,7 @@ compute_single_aggregate(GroupingPolicyHash *policy, DecompressContext *dcontext
 		if (values.arrow != NULL)
 		{
 			arg_arrow = values.arrow;
-			arg_validity_bitmap = values.buffers[0];
+			arg_validity_bitmap = agg_def->func.agg_accepts_nulls ? NULL : values.buffers[0];
 		}
 		else
 		{
@@ -161,7 +169,8 @@ compute_single_aggregate(GroupingPolicyHash *policy, DecompressContext *dcontext
 	}
 
 	/*
-	 * Compute the combined validity bitmap that includes the argument validity.
+	 * Compute the combined validity bitmap that includes the argument validity,
+	 * unless the function also aggregates the null arguments.
 	 */
 	DecompressBatchState *batch_state = (DecompressBatchState *) vector_slot;
 	const size_t num_words = (batch_state->total_batch_rows + 63) / 64;
@@ -335,7 +344,8 @@ gp_hash_add_batch(GroupingPolicy *gp, DecompressContext *dcontext, TupleTableSlo
 			void *first_uninitialized_state =
 				agg_def->func.state_bytes * (last_initialized_key_index + 1) +
 				(char *) policy->per_agg_per_key_states[agg_index];
-			agg_def->func.agg_init(first_uninitialized_state,
+			vector_agg_init_states(&agg_def->func,
+								   first_uninitialized_state,
 								   policy->hashing.last_used_key_index -
 									   last_initialized_key_index);
 		}
@@ -87,6 +87,18 @@ typedef struct GroupingPolicyHash
 	uint32 *restrict key_index_for_row;
 	uint64 num_key_index_for_row;
 
+	/*
+	 * When all grouping columns of the current batch are either scalar or
+	 * dictionary-encoded, the grouping key of a row is determined by the
+	 * dictionary indexes of its grouping columns, combined into a "dictionary
+	 * code". In this case, we hash the key only once for each code that occurs
+	 * in the batch, and store the resulting key index here, indexed by code.
+	 * Zero means the key index for this code is not known yet.
+	 */
+	bool use_key_index_for_dict;
+	uint32 *restrict key_index_for_dict;
+	uint64 num_key_index_for_dict;
+
 	/*
 	 * The temporary filter bitmap we use to combine the results of the
 	 * vectorized filters in WHERE, validity of the aggregate function argument,
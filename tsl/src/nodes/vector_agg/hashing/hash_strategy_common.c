@@ -8,6 +8,7 @@
 
 #include "nodes/vector_agg/exec.h"
 #include "nodes/vector_agg/grouping_policy_hash.h"
+#include "nodes/vector_agg/vector_slot.h"
 
 /*
  * Allocate enough storage for keys, given that each row of the new compressed
@@ -35,6 +36,74 @@ hash_strategy_output_key_alloc(GroupingPolicyHash *policy, uint16 nrows)
 	}
 }
 
+/*
+ * Determine whether we can look up the grouping keys of the current batch by
+ * their dictionary codes, and prepare the storage for the key indexes of the
+ * codes if so. See the comment for GroupingPolicyHash.key_index_for_dict.
+ *
+ * The dictionary code of a row combines the dictionary indexes of all
+ * dictionary-encoded grouping columns. Each column contributes dictionary
+ * length + 1 possible values, the last one meaning null. The scalar columns
+ * are the same for all rows of the batch, so they don't contribute to the
+ * code.
+ *
+ * This only pays off when there are fewer possible codes than the rows we
+ * have to hash. We expect this to be the common case for grouping by
+ * low-cardinality text columns.
+ */
+void
+hash_strategy_dict_prepare_for_batch(GroupingPolicyHash *policy, TupleTableSlot *vector_slot)
+{
+	uint16 nrows = 0;
+	const uint64 *filter = vector_slot_get_qual_result(vector_slot, &nrows);
+	const uint64 num_rows_to_hash = arrow_num_valid(filter, nrows);
+
+	policy->use_key_index_for_dict = false;
+
+	uint64 num_codes = 1;
+	bool have_dict_columns = false;
+	for (int i = 0; i < policy->num_grouping_columns; i++)
+	{
+		const CompressedColumnValues *values = &policy->current_batch_grouping_column_values[i];
+
+		if (values->decompression_type == DT_Scalar)
+		{
+			continue;
+		}
+
+		if (values->decompression_type != DT_ArrowTextDict)
+		{
+			return;
+		}
+
+		have_dict_columns = true;
+		num_codes *= values->arrow->dictionary->length + 1;
+		if (num_codes > num_rows_to_hash)
+		{
+			return;
+		}
+	}
+
+	if (!have_dict_columns)
+	{
+		return;
+	}
+
+	if (num_codes > policy->num_key_index_for_dict)
+	{
+		if (policy->key_index_for_dict != NULL)
+		{
+			pfree(policy->key_index_for_dict);
+		}
+		policy->num_key_index_for_dict = num_codes;
+		policy->key_index_for_dict =
+			palloc(sizeof(policy->key_index_for_dict[0]) * policy->num_key_index_for_dict);
+	}
+	memset(policy->key_index_for_dict, 0, num_codes * sizeof(policy->key_index_for_dict[0]));
+
+	policy->use_key_index_for_dict = true;
+}
+
 /*
  * Emit a single-column grouping key with the given index into the aggregated
  * slot.
@@ -77,9 +77,40 @@ FUNCTION_NAME(hash_strategy_prepare_for_batch)(GroupingPolicyHash *policy,
 	uint16 nrows = 0;
 	vector_slot_get_qual_result(vector_slot, &nrows);
 	hash_strategy_output_key_alloc(policy, nrows);
+	policy->use_key_index_for_dict = false;
 	FUNCTION_NAME(key_hashing_prepare_for_batch)(policy, vector_slot);
 }
 
+/*
+ * Find the given key in the hash table, or add it as a new key, and return
+ * its unique index.
+ */
+static pg_attribute_always_inline uint32
+FUNCTION_NAME(find_or_insert_key)(HashingStrategy *restrict hashing,
+								  HASH_TABLE_KEY_TYPE hash_table_key, OUTPUT_KEY_TYPE output_key)
+{
+	struct FUNCTION_NAME(hash) *restrict table = hashing->table;
+
+	bool found = false;
+	FUNCTION_NAME(entry) *restrict entry = FUNCTION_NAME(insert)(table, hash_table_key, &found);
+	if (!found)
+	{
+		/*
+		 * New key, have to store it persistently.
+		 */
+		const uint32 index = ++hashing->last_used_key_index;
+		entry->key_index = index;
+		FUNCTION_NAME(key_hashing_store_new)(hashing, index, output_key);
+		DEBUG_PRINT("%p: new key index %d\n", hashing, index);
+	}
+	else
+	{
+		DEBUG_PRINT("%p: old key index %d\n", hashing, entry->key_index);
+	}
+
+	return entry->key_index;
+}
+
 /*
  * Fill the unique key indexes for all rows of the batch, using a hash table.
  */
@@ -90,8 +121,6 @@ FUNCTION_NAME(fill_offsets_impl)(BatchHashingParams params, int start_row, int e
 
 	uint32 *restrict indexes = params.result_key_indexes;
 
-	struct FUNCTION_NAME(hash) *restrict table = hashing->table;
-
 	HASH_TABLE_KEY_TYPE prev_hash_table_key = { 0 };
 	uint32 previous_key_index = 0;
 	for (int row = start_row; row < end_row; row++)
@@ -146,28 +175,76 @@ FUNCTION_NAME(fill_offsets_impl)(BatchHashingParams params, int start_row, int e
 		/*
 		 * Find the key using the hash table.
 		 */
-		bool found = false;
-		FUNCTION_NAME(entry) *restrict entry = FUNCTION_NAME(insert)(table, hash_table_key, &found);
-		if (!found)
+		indexes[row] = FUNCTION_NAME(find_or_insert_key)(hashing, hash_table_key, output_key);
+		DEBUG_PRINT("%p: row %d key index %d\n", hashing, row, indexes[row]);
+
+		previous_key_index = indexes[row];
+		prev_hash_table_key = hash_table_key;
+	}
+}
+
+#ifdef USE_DICT_HASHING
+/*
+ * Fill the unique key indexes for all rows of the batch, when the grouping
+ * key is determined by the dictionary code of the row. We compute the key only
+ * for the first row with the given code, and the following rows just gather
+ * the key index by their code.
+ */
+static pg_attribute_always_inline void
+FUNCTION_NAME(fill_offsets_dict_impl)(BatchHashingParams params, int start_row, int end_row)
+{
+	HashingStrategy *restrict hashing = params.hashing;
+
+	uint32 *restrict indexes = params.result_key_indexes;
+
+	uint32 *restrict key_index_for_dict = params.policy->key_index_for_dict;
+
+	for (int row = start_row; row < end_row; row++)
+	{
+		if (!arrow_row_is_valid(params.batch_filter, row))
 		{
-			/*
-			 * New key, have to store it persistently.
-			 */
-			const uint32 index = ++hashing->last_used_key_index;
-			entry->key_index = index;
-			FUNCTION_NAME(key_hashing_store_new)(hashing, index, output_key);
-			DEBUG_PRINT("%p: row %d new key index %d\n", hashing, row, index);
+			/* The row doesn't pass the filter. */
+			continue;
+		}
+
+		const uint32 code = FUNCTION_NAME(key_hashing_get_dict_code)(params, row);
+		Assert(code < params.policy->num_key_index_for_dict);
+
+		if (likely(key_index_for_dict[code] != 0))
+		{
+			indexes[row] = key_index_for_dict[code];
+			continue;
+		}
+
+		bool key_valid = false;
+		OUTPUT_KEY_TYPE output_key = { 0 };
+		HASH_TABLE_KEY_TYPE hash_table_key = { 0 };
+		FUNCTION_NAME(key_hashing_get_key)(params, row, &output_key, &hash_table_key, &key_valid);
+
+		if (unlikely(!key_valid))
+		{
+			/* The key is null. */
+			if (hashing->null_key_index == 0)
+			{
+				hashing->null_key_index = ++hashing->last_used_key_index;
+			}
+			key_index_for_dict[code] = hashing->null_key_index;
 		}
 		else
 		{
-			DEBUG_PRINT("%p: row %d old key index %d\n", hashing, row, entry->key_index);
+			key_index_for_dict[code] =
+				FUNCTION_NAME(find_or_insert_key)(hashing, hash_table_key, output_key);
 		}
-		indexes[row] = entry->key_index;
 
-		previous_key_index = entry->key_index;
-		prev_hash_table_key = entry->hash_table_key;
+		DEBUG_PRINT("%p: row %d dict code %d key index %d\n",
+					hashing,
+					row,
+					code,
+					key_index_for_dict[code]);
+		indexes[row] = key_index_for_dict[code];
 	}
 }
+#endif
 
 static void
 FUNCTION_NAME(fill_offsets)(GroupingPolicyHash *policy, TupleTableSlot *vector_slot, int start_row,
@@ -177,6 +254,14 @@ FUNCTION_NAME(fill_offsets)(GroupingPolicyHash *policy, TupleTableSlot *vector_s
 
 	BatchHashingParams params = build_batch_hashing_params(policy, vector_slot);
 
+#ifdef USE_DICT_HASHING
+	if (policy->use_key_index_for_dict)
+	{
+		FUNCTION_NAME(fill_offsets_dict_impl)(params, start_row, end_row);
+		return;
+	}
+#endif
+
 	FUNCTION_NAME(fill_offsets_impl)(params, start_row, end_row);
 }
 
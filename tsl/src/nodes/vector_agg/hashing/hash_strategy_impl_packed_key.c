@@ -0,0 +1,211 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Key handling functions for several fixed-size grouping columns packed into
+ * a fixed-size hash table key.
+ *
+ * The values of the grouping columns are stored one after another starting
+ * from the first byte of the key, and the unused bytes are zero. For multiple
+ * grouping columns, the last byte of the key is the null bitmap of the
+ * columns, and the values of null columns are zero. For a single grouping
+ * column, the null key is stored outside of the hash table, as for the other
+ * single-column strategies, so the entire key is available for the value.
+ */
+
+#include "batch_hashing_params.h"
+
+#define PACKED_KEY_BYTES sizeof(HASH_TABLE_KEY_TYPE)
+
+static void
+FUNCTION_NAME(key_hashing_init)(HashingStrategy *hashing)
+{
+}
+
+static void
+FUNCTION_NAME(key_hashing_prepare_for_batch)(GroupingPolicyHash *policy,
+											 TupleTableSlot *vector_slot)
+{
+}
+
+/*
+ * Copy a value of the supported fixed size. We switch on the size so that the
+ * compiler can use a single load and store for each case.
+ */
+static pg_attribute_always_inline void
+FUNCTION_NAME(copy_value)(uint8 *restrict dest, const uint8 *restrict src, int value_bytes)
+{
+	switch (value_bytes)
+	{
+		case 1:
+			memcpy(dest, src, 1);
+			break;
+		case 2:
+			memcpy(dest, src, 2);
+			break;
+		case 4:
+			memcpy(dest, src, 4);
+			break;
+		case 8:
+			memcpy(dest, src, 8);
+			break;
+		case 16:
+			memcpy(dest, src, 16);
+			break;
+		default:
+			pg_unreachable();
+			break;
+	}
+}
+
+static pg_attribute_always_inline void
+FUNCTION_NAME(key_hashing_get_key)(BatchHashingParams params, int row,
+								   void *restrict output_key_ptr, void *restrict hash_table_key_ptr,
+								   bool *restrict valid)
+{
+	OUTPUT_KEY_TYPE *restrict output_key = (OUTPUT_KEY_TYPE *) output_key_ptr;
+	HASH_TABLE_KEY_TYPE *restrict hash_table_key = (HASH_TABLE_KEY_TYPE *) hash_table_key_ptr;
+
+	const int num_columns = params.num_grouping_columns;
+	Assert(num_columns <= 8);
+
+	HASH_TABLE_KEY_TYPE key = { 0 };
+	uint8 *restrict key_bytes = (uint8 *) &key;
+	uint8 null_mask = 0;
+	int offset = 0;
+	for (int column_index = 0; column_index < num_columns; column_index++)
+	{
+		const CompressedColumnValues *column_values = &params.grouping_column_values[column_index];
+		const GroupingColumn *def = &params.policy->grouping_columns[column_index];
+
+		bool is_valid;
+		if (column_values->decompression_type == DT_Scalar)
+		{
+			is_valid = !DatumGetBool(PointerGetDatum(column_values->buffers[0]));
+			if (is_valid)
+			{
+				const Datum value = PointerGetDatum(column_values->buffers[1]);
+				FUNCTION_NAME(copy_value)(&key_bytes[offset],
+										  def->by_value ? (const uint8 *) &value :
+														  (const uint8 *) DatumGetPointer(value),
+										  def->value_bytes);
+			}
+		}
+		else
+		{
+			is_valid = arrow_row_is_valid(column_values->buffers[0], row);
+			if (is_valid)
+			{
+				if (column_values->decompression_type == DT_ArrowBits)
+				{
+					key_bytes[offset] = arrow_row_is_valid(column_values->buffers[1], row);
+				}
+				else
+				{
+					Assert(column_values->decompression_type == def->value_bytes);
+					FUNCTION_NAME(copy_value)(&key_bytes[offset],
+											  row * def->value_bytes +
+												  (const uint8 *) column_values->buffers[1],
+											  def->value_bytes);
+				}
+			}
+		}
+
+		null_mask |= ((uint8) !is_valid) << column_index;
+		offset += def->value_bytes;
+	}
+
+	if (num_columns == 1)
+	{
+		Assert((size_t) offset <= PACKED_KEY_BYTES);
+		*valid = null_mask == 0;
+	}
+	else
+	{
+		Assert((size_t) offset < PACKED_KEY_BYTES);
+		key_bytes[PACKED_KEY_BYTES - 1] = null_mask;
+		*valid = true;
+	}
+
+	/*
+	 * The packed key is both the hash table key and the output key.
+	 */
+	*hash_table_key = key;
+	*output_key = key;
+}
+
+static pg_attribute_always_inline void
+FUNCTION_NAME(key_hashing_store_new)(HashingStrategy *restrict hashing, uint32 new_key_index,
+									 OUTPUT_KEY_TYPE output_key)
+{
+#ifdef PACKED_KEY_BY_VALUE
+	hashing->output_keys[new_key_index] = Int64GetDatum(output_key);
+#else
+	OUTPUT_KEY_TYPE *stored = MemoryContextAlloc(hashing->key_body_mctx, sizeof(OUTPUT_KEY_TYPE));
+	*stored = output_key;
+	hashing->output_keys[new_key_index] = PointerGetDatum(stored);
+#endif
+}
+
+static void
+FUNCTION_NAME(emit_key)(GroupingPolicyHash *policy, uint32 current_key,
+						TupleTableSlot *aggregated_slot)
+{
+	const HashingStrategy *hashing = &policy->hashing;
+	const int num_columns = policy->num_grouping_columns;
+
+	if (num_columns == 1 && current_key == hashing->null_key_index)
+	{
+		aggregated_slot->tts_isnull[policy->grouping_columns[0].output_offset] = true;
+		return;
+	}
+
+#ifdef PACKED_KEY_BY_VALUE
+	const OUTPUT_KEY_TYPE key = DatumGetInt64(hashing->output_keys[current_key]);
+	const uint8 *key_bytes = (const uint8 *) &key;
+#else
+	const uint8 *key_bytes = (const uint8 *) DatumGetPointer(hashing->output_keys[current_key]);
+#endif
+
+	const uint8 null_mask = num_columns == 1 ? 0 : key_bytes[PACKED_KEY_BYTES - 1];
+	int offset = 0;
+	for (int column_index = 0; column_index < num_columns; column_index++)
+	{
+		const GroupingColumn *col = &policy->grouping_columns[column_index];
+		const bool isnull = null_mask & (((uint8) 1) << column_index);
+
+		aggregated_slot->tts_isnull[col->output_offset] = isnull;
+
+		Datum *output = &aggregated_slot->tts_values[col->output_offset];
+		if (isnull)
+		{
+			*output = 0;
+		}
+		else if (col->by_value)
+		{
+			Assert((size_t) col->value_bytes <= sizeof(Datum));
+			*output = 0;
+			memcpy(output, &key_bytes[offset], col->value_bytes);
+		}
+		else
+		{
+			/*
+			 * The by-reference values point into the stored key, which stays
+			 * valid until the grouping policy is reset.
+			 */
+#ifdef PACKED_KEY_BY_VALUE
+			pg_unreachable();
+#else
+			*output = PointerGetDatum(&key_bytes[offset]);
+#endif
+		}
+
+		offset += col->value_bytes;
+	}
+}
+
+#undef PACKED_KEY_BYTES
+#undef PACKED_KEY_BY_VALUE
@@ -0,0 +1,38 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Implementation of column hashing for several fixed-size columns that fit
+ * into 16 bytes together with their null bitmap, or a single 16-byte column
+ * such as uuid.
+ */
+
+#include <postgres.h>
+
+#include "compression/arrow_c_data_interface.h"
+#include "hash64.h"
+#include "nodes/columnar_scan/compressed_batch.h"
+#include "nodes/vector_agg/exec.h"
+#include "nodes/vector_agg/grouping_policy_hash.h"
+#include "template_helper.h"
+
+typedef struct PackedKey16
+{
+	uint64 lo;
+	uint64 hi;
+} PackedKey16;
+
+#define EXPLAIN_NAME "packed 16-byte"
+#define KEY_VARIANT packed_16
+#define OUTPUT_KEY_TYPE PackedKey16
+#define HASH_TABLE_KEY_TYPE OUTPUT_KEY_TYPE
+
+#include "hash_strategy_impl_packed_key.c"
+
+#define KEY_EQUAL(a, b) (a.lo == b.lo && a.hi == b.hi)
+#define KEY_HASH(X) HASH64(X.lo ^ HASH64(X.hi))
+
+#include "hash_strategy_impl.c"
@@ -0,0 +1,32 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Implementation of column hashing for several fixed-size columns that fit
+ * into 8 bytes together with their null bitmap.
+ */
+
+#include <postgres.h>
+
+#include "compression/arrow_c_data_interface.h"
+#include "hash64.h"
+#include "nodes/columnar_scan/compressed_batch.h"
+#include "nodes/vector_agg/exec.h"
+#include "nodes/vector_agg/grouping_policy_hash.h"
+#include "template_helper.h"
+
+#define EXPLAIN_NAME "packed 8-byte"
+#define KEY_VARIANT packed_8
+#define OUTPUT_KEY_TYPE uint64
+#define HASH_TABLE_KEY_TYPE OUTPUT_KEY_TYPE
+#define PACKED_KEY_BY_VALUE
+
+#include "hash_strategy_impl_packed_key.c"
+
+#define KEY_EQUAL(a, b) a == b
+#define KEY_HASH(X) HASH64(X)
+
+#include "hash_strategy_impl.c"
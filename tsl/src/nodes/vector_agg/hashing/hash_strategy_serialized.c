@@ -35,6 +35,38 @@ serialized_key_hashing_init(HashingStrategy *hashing)
 static void
 serialized_key_hashing_prepare_for_batch(GroupingPolicyHash *policy, TupleTableSlot *vector_slot)
 {
+	hash_strategy_dict_prepare_for_batch(policy, vector_slot);
+}
+
+/*
+ * Combine the dictionary indexes of the dictionary-encoded grouping columns
+ * into a single code, as a mixed-radix number where each column has its
+ * dictionary length + 1 possible values. The scalar columns are the same for
+ * the entire batch, so they don't contribute to the code.
+ */
+static pg_attribute_always_inline uint32
+serialized_key_hashing_get_dict_code(BatchHashingParams params, int row)
+{
+	uint32 code = 0;
+	for (int column_index = 0; column_index < params.num_grouping_columns; column_index++)
+	{
+		const CompressedColumnValues *column_values = &params.grouping_column_values[column_index];
+
+		if (column_values->decompression_type == DT_Scalar)
+		{
+			continue;
+		}
+
+		Assert(column_values->decompression_type == DT_ArrowTextDict);
+
+		const uint32 num_codes = column_values->arrow->dictionary->length + 1;
+		const uint32 column_code = arrow_row_is_valid(column_values->buffers[0], row) ?
+									   ((int16 *) column_values->buffers[3])[row] :
+									   num_codes - 1;
+		code = code * num_codes + column_code;
+	}
+
+	return code;
 }
 
 static pg_attribute_always_inline bool
@@ -476,4 +508,6 @@ serialized_emit_key(GroupingPolicyHash *policy, uint32 current_key, TupleTableSl
 	Assert(ptr == serialized_key + key_data_bytes);
 }
 
+#define USE_DICT_HASHING
+
 #include "hash_strategy_impl.c"
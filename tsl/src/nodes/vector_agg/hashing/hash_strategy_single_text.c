@@ -130,6 +130,27 @@ single_text_emit_key(GroupingPolicyHash *policy, uint32 current_key,
 static void
 single_text_key_hashing_prepare_for_batch(GroupingPolicyHash *policy, TupleTableSlot *vector_slot)
 {
+	hash_strategy_dict_prepare_for_batch(policy, vector_slot);
 }
 
+/*
+ * For a dictionary-encoded column, the dictionary code is the dictionary
+ * index, or the dictionary length for null.
+ */
+static pg_attribute_always_inline uint32
+single_text_key_hashing_get_dict_code(BatchHashingParams params, int row)
+{
+	const CompressedColumnValues *column_values = &params.single_grouping_column;
+	Assert(column_values->decompression_type == DT_ArrowTextDict);
+
+	if (!arrow_row_is_valid(column_values->buffers[0], row))
+	{
+		return column_values->arrow->dictionary->length;
+	}
+
+	return ((int16 *) column_values->buffers[3])[row];
+}
+
+#define USE_DICT_HASHING
+
 #include "hash_strategy_impl.c"
@@ -78,5 +78,6 @@ typedef struct HashingStrategy
 } HashingStrategy;
 
 void hash_strategy_output_key_alloc(GroupingPolicyHash *policy, uint16 nrows);
+void hash_strategy_dict_prepare_for_batch(GroupingPolicyHash *policy, TupleTableSlot *vector_slot);
 void hash_strategy_output_key_single_emit(GroupingPolicyHash *policy, uint32 current_key,
 										  TupleTableSlot *aggregated_slot);
@@ -14,11 +14,14 @@
 #include <nodes/plannodes.h>
 #include <parser/parsetree.h>
 #include <utils/fmgroids.h>
+#include <utils/lsyscache.h>
 
 #include "plan.h"
 
+#include "decompression_stats.h"
 #include "exec.h"
 #include "expression_utils.h"
+#include "func_cache.h"
 #include "import/list.h"
 #include "nodes/columnar_scan/columnar_scan.h"
 #include "nodes/columnar_scan/vector_quals.h"
@@ -104,7 +107,7 @@ resolve_outer_special_vars(List *agg_tlist, Plan *childplan)
  */
 static Plan *
 vector_agg_plan_create(Plan *childplan, Agg *agg, List *resolved_targetlist,
-					   VectorAggGroupingType grouping_type)
+					   VectorAggGroupingType grouping_type, List *batch_metadata)
 {
 	CustomScan *vector_agg = (CustomScan *) makeNode(CustomScan);
 	vector_agg->custom_plans = list_make1(childplan);
@@ -147,6 +150,7 @@ vector_agg_plan_create(Plan *childplan, Agg *agg, List *resolved_targetlist,
 	vector_agg->custom_private = ts_new_list(T_List, VASI_Count);
 	lfirst(list_nth_cell(vector_agg->custom_private, VASI_GroupingType)) =
 		makeInteger(grouping_type);
+	lfirst(list_nth_cell(vector_agg->custom_private, VASI_BatchMetadata)) = batch_metadata;
 
 	return (Plan *) vector_agg;
 }
@@ -166,6 +170,7 @@ is_vector_type(Oid typeoid)
 		case INT4OID:
 		case INT8OID:
 		case TEXTOID:
+		case NUMERICOID:
 		case TIMESTAMPOID:
 		case TIMESTAMPTZOID:
 		case DATEOID:
@@ -177,15 +182,20 @@ is_vector_type(Oid typeoid)
 	}
 }
 
+static bool is_vector_time_bucket(const VectorQualInfo *vqinfo, FuncExpr *func);
+
 /*
  * Whether the expression can be used for vectorized processing: must be a Var
- * that refers to either a bulk-decompressed or a segmentby column.
+ * that refers to either a bulk-decompressed or a segmentby column, or a
+ * time_bucket() call on such a Var.
  */
 static bool
 is_vector_expr(const VectorQualInfo *vqinfo, Expr *expr)
 {
 	switch (((Node *) expr)->type)
 	{
+		case T_FuncExpr:
+			return is_vector_time_bucket(vqinfo, castNode(FuncExpr, expr));
 		case T_Var:
 		{
 			Var *var = castNode(Var, expr);
@@ -215,11 +225,84 @@ is_vector_expr(const VectorQualInfo *vqinfo, Expr *expr)
 }
 
 /*
- * Whether we can vectorize this particular aggregate.
+ * Whether this is a time_bucket() call that we can compute for a vector of
+ * values: the bucketed column must be a vector Var and all the other arguments
+ * must be non-null constants. This is the usual grouping expression of the
+ * time-series queries, including the real-time part of continuous aggregates.
+ */
+static bool
+is_vector_time_bucket(const VectorQualInfo *vqinfo, FuncExpr *func)
+{
+	const FuncInfo *finfo = ts_func_cache_get_bucketing_func(func->funcid);
+	if (finfo == NULL || finfo->origin != ORIGIN_TIMESCALE ||
+		strcmp(finfo->funcname, "time_bucket") != 0)
+	{
+		return false;
+	}
+
+	if (list_length(func->args) < 2 || !func_strict(func->funcid))
+	{
+		return false;
+	}
+
+	/*
+	 * The result is stored as an arrow array of a fixed-size by-value type.
+	 */
+	int16 typlen;
+	bool typbyval;
+	get_typlenbyval(func->funcresulttype, &typlen, &typbyval);
+	if (!typbyval || (typlen != 2 && typlen != 4 && typlen != 8))
+	{
+		return false;
+	}
+
+	ListCell *lc;
+	foreach (lc, func->args)
+	{
+		Node *arg = lfirst(lc);
+		if (foreach_current_index(lc) == 1)
+		{
+			if (!IsA(arg, Var) || !is_vector_expr(vqinfo, (Expr *) arg))
+			{
+				return false;
+			}
+
+			/*
+			 * The vectorized computation handles the by-value arrow arrays of
+			 * the time types. Other types that can be bucketed, like uuid,
+			 * are computed by the usual row-by-row aggregation.
+			 */
+			switch (castNode(Var, arg)->vartype)
+			{
+				case INT2OID:
+				case INT4OID:
+				case INT8OID:
+				case DATEOID:
+				case TIMESTAMPOID:
+				case TIMESTAMPTZOID:
+					break;
+				default:
+					return false;
+			}
+		}
+		else if (!IsA(arg, Const) || castNode(Const, arg)->constisnull)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Whether we can vectorize this particular aggregate. If not, the reason is
+ * returned for the decompression statistics.
  */
 static bool
-can_vectorize_aggref(const VectorQualInfo *vqi, Aggref *aggref)
+can_vectorize_aggref(const VectorQualInfo *vqi, Aggref *aggref, DecompressionStatsCounter *reason)
 {
+	*reason = DSC_FallbackUnsupportedAggregate;
+
 	if (aggref->aggdirectargs != NIL)
 	{
 		/* Can't process ordered-set aggregates with direct arguments. */
@@ -244,12 +327,14 @@ can_vectorize_aggref(const VectorQualInfo *vqi, Aggref *aggref)
 		Node *aggfilter_vectorized = vector_qual_make((Node *) aggref->aggfilter, vqi);
 		if (aggfilter_vectorized == NULL)
 		{
+			*reason = DSC_FallbackFilter;
 			return false;
 		}
 		aggref->aggfilter = (Expr *) aggfilter_vectorized;
 	}
 
-	if (get_vector_aggregate(aggref->aggfnoid) == NULL)
+	const VectorAggFunctions *func = get_vector_aggregate(aggref->aggfnoid);
+	if (func == NULL)
 	{
 		/*
 		 * We don't have a vectorized implementation for this particular
@@ -258,17 +343,72 @@ can_vectorize_aggref(const VectorQualInfo *vqi, Aggref *aggref)
 		return false;
 	}
 
+	*reason = DSC_FallbackAggregateArgument;
+
 	if (aggref->args == NIL)
 	{
 		/* This must be count(*), we can vectorize it. */
 		return true;
 	}
 
-	/* The function must have one argument, check it. */
-	Assert(list_length(aggref->args) == 1);
-	TargetEntry *argument = castNode(TargetEntry, linitial(aggref->args));
+	/*
+	 * The function must have one argument, or the arguments after the first
+	 * one must be non-null constants for the functions that can bind them.
+	 */
+	if (list_length(aggref->args) > 1)
+	{
+		if (func->agg_bind_args == NULL)
+		{
+			return false;
+		}
+
+		ListCell *lc;
+		for_each_from(lc, aggref->args, 1)
+		{
+			Expr *arg = lfirst_node(TargetEntry, lc)->expr;
+			if (!IsA(arg, Const) || castNode(Const, arg)->constisnull)
+			{
+				return false;
+			}
+		}
+	}
 
-	return is_vector_expr(vqi, argument->expr);
+	return is_vector_expr(vqi, vector_agg_aggregated_argument(func, aggref));
+}
+
+/*
+ * Find the pre-aggregated batch metadata that can be used instead of the
+ * decompressed argument of the given aggregate function, see
+ * vectoragg_plan_batch_metadata(). Returns NIL if it can't be used.
+ */
+static List *
+get_aggref_batch_metadata(const VectorQualInfo *vqi, Plan *childplan, List *rtable,
+						  Aggref *aggref)
+{
+	if (aggref->aggfilter != NULL || list_length(aggref->args) != 1)
+	{
+		return NIL;
+	}
+
+	const VectorAggFunctions *func = get_vector_aggregate(aggref->aggfnoid);
+	if (func == NULL || func->agg_batch_metadata == NULL)
+	{
+		return NIL;
+	}
+
+	Expr *argument = castNode(TargetEntry, linitial(aggref->args))->expr;
+	if (!IsA(argument, Var))
+	{
+		return NIL;
+	}
+
+	Var *var = castNode(Var, argument);
+	if (var->varattno <= 0 || var->varattno > vqi->maxattno || vqi->segmentby_attrs[var->varattno])
+	{
+		return NIL;
+	}
+
+	return vectoragg_plan_batch_metadata(childplan, rtable, var->varattno);
 }
 
 /*
@@ -291,6 +431,14 @@ get_vectorized_grouping_type(const VectorQualInfo *vqinfo, Agg *agg, List *resol
 	int16 typlen = 0;
 	bool typbyval = false;
 
+	/*
+	 * The total size of the grouping columns, if all of them are fixed-size
+	 * and can be packed into a fixed-size key.
+	 */
+	bool all_packable = true;
+	int packed_key_bytes = 0;
+	bool have_numeric_grouping = false;
+
 	ListCell *lc;
 	foreach (lc, resolved_targetlist)
 	{
@@ -323,25 +471,45 @@ get_vectorized_grouping_type(const VectorQualInfo *vqinfo, Agg *agg, List *resol
 			all_segmentby = false;
 		}
 
-		/*
-		 * If we have a single grouping column, record it for the additional
-		 * checks later.
-		 */
-		if (num_grouping_columns != 1)
+		TupleDesc tdesc = NULL;
+		Oid type = InvalidOid;
+		TypeFuncClass type_class = get_expr_result_type((Node *) target_entry->expr, &type, &tdesc);
+		if (type_class != TYPEFUNC_SCALAR)
 		{
+			all_packable = false;
 			continue;
 		}
 
-		TupleDesc tdesc = NULL;
-		TypeFuncClass type_class =
-			get_expr_result_type((Node *) target_entry->expr, &single_grouping_var_type, &tdesc);
-		if (type_class != TYPEFUNC_SCALAR)
+		have_numeric_grouping |= type == NUMERICOID;
+
+		int16 column_typlen = 0;
+		bool column_typbyval = false;
+		get_typlenbyval(type, &column_typlen, &column_typbyval);
+		Ensure(column_typlen != 0, "invalid zero typlen for type %d", type);
+
+		/*
+		 * The by-value types and the uuid have a fixed-size columnar
+		 * representation that we can pack into the key.
+		 */
+		if (column_typlen > 0 && (column_typbyval || type == UUIDOID))
 		{
-			continue;
+			packed_key_bytes += column_typlen;
+		}
+		else
+		{
+			all_packable = false;
 		}
 
-		get_typlenbyval(single_grouping_var_type, &typlen, &typbyval);
-		Ensure(typlen != 0, "invalid zero typlen for type %d", single_grouping_var_type);
+		/*
+		 * If we have a single grouping column, record it for the additional
+		 * checks later.
+		 */
+		if (num_grouping_columns == 1)
+		{
+			single_grouping_var_type = type;
+			typlen = column_typlen;
+			typbyval = column_typbyval;
+		}
 	}
 
 	Assert(num_grouping_columns >= agg->numCols);
@@ -362,6 +530,16 @@ get_vectorized_grouping_type(const VectorQualInfo *vqinfo, Agg *agg, List *resol
 		return VAGT_Batch;
 	}
 
+	/*
+	 * The numeric values that are equal can have different binary
+	 * representations, e.g. 1.0 and 1.00, so they can't be grouped by the
+	 * hashing strategies that compare the keys by their bytes.
+	 */
+	if (have_numeric_grouping)
+	{
+		return VAGT_Invalid;
+	}
+
 	/*
 	 * We support hashed vectorized grouping by one fixed-size by-value
 	 * compressed column.
@@ -375,12 +553,8 @@ get_vectorized_grouping_type(const VectorQualInfo *vqinfo, Agg *agg, List *resol
 			switch (typlen)
 			{
 				case 1:
-#ifdef TS_USE_UMASH
 					Assert(single_grouping_var_type == BOOLOID);
-					return VAGT_HashSerialized;
-#else
-					return VAGT_Invalid;
-#endif
+					return VAGT_HashPacked8;
 				case 2:
 					return VAGT_HashSingleFixed2;
 				case 4:
@@ -395,9 +569,8 @@ get_vectorized_grouping_type(const VectorQualInfo *vqinfo, Agg *agg, List *resol
 #ifdef TS_USE_UMASH
 		/*
 		 * We also have the UUID type which is by-reference and has a
-		 * columnar in-memory representation, but no specialized single-column
-		 * vectorized grouping support. It can use the serialized grouping
-		 * strategy.
+		 * columnar in-memory representation. It uses the packed key grouping
+		 * strategy below.
 		 */
 		else if (single_grouping_var_type == TEXTOID)
 		{
@@ -406,6 +579,25 @@ get_vectorized_grouping_type(const VectorQualInfo *vqinfo, Agg *agg, List *resol
 #endif
 	}
 
+	/*
+	 * When all grouping columns are fixed-size, we can pack them into a
+	 * fixed-size key, avoiding the serialization. For multiple columns, the key
+	 * needs one more byte for the null bitmap.
+	 */
+	if (all_packable && num_grouping_columns <= 8)
+	{
+		const int key_bytes = packed_key_bytes + (num_grouping_columns > 1 ? 1 : 0);
+		if (key_bytes <= 8)
+		{
+			return VAGT_HashPacked8;
+		}
+
+		if (key_bytes <= 16)
+		{
+			return VAGT_HashPacked16;
+		}
+	}
+
 #ifdef TS_USE_UMASH
 	/*
 	 * Use hashing of serialized keys when we have many grouping columns.
@@ -525,6 +717,33 @@ vectoragg_plan_possible(Plan *childplan, const List *rtable, VectorQualInfo *vqi
 	return false;
 }
 
+/*
+ * Count the partial aggregation over a compressed chunk in the decompression
+ * statistics, either as vectorized or as fallback with the given reason.
+ * Returns the given plan for convenience.
+ */
+static Plan *
+report_vector_agg_plan(Plan *plan, Oid chunk_relid, DecompressionStatsCounter counter)
+{
+	if (!OidIsValid(chunk_relid) || !ts_decompression_stats_enabled())
+	{
+		return plan;
+	}
+
+	DecompressionStatsCounts counts = { 0 };
+	if (counter != DSC_VectorizedAggregations)
+	{
+		counts.counters[DSC_FallbackAggregations] = 1;
+	}
+	if (counter != DSC_FallbackAggregations)
+	{
+		counts.counters[counter] = 1;
+	}
+	ts_decompression_stats_add(chunk_relid, InvalidAttrNumber, &counts);
+
+	return plan;
+}
+
 /*
  * Where possible, replace the partial aggregation plan nodes with our own
  * vectorized aggregation node. The replacement is done in-place.
@@ -588,10 +807,31 @@ try_insert_vector_agg_node(Plan *plan, List *rtable)
 		return plan;
 	}
 
+	if (agg->plan.lefttree == NULL)
+	{
+		/*
+		 * Not sure what this would mean, but check for it just to be on the
+		 * safe side because we can effectively see any possible plan here.
+		 */
+		return plan;
+	}
+
+	Plan *childplan = agg->plan.lefttree;
+
+	/*
+	 * The chunk for the decompression statistics, when we're aggregating a
+	 * compressed chunk.
+	 */
+	Oid chunk_relid = InvalidOid;
+	if (ts_is_columnar_scan_plan(childplan))
+	{
+		chunk_relid = rt_fetch(((Scan *) childplan)->scanrelid, rtable)->relid;
+	}
+
 	if (agg->groupingSets != NIL)
 	{
 		/* No GROUPING SETS support. */
-		return plan;
+		return report_vector_agg_plan(plan, chunk_relid, DSC_FallbackGrouping);
 	}
 
 	if (agg->plan.qual != NIL)
@@ -601,19 +841,9 @@ try_insert_vector_agg_node(Plan *plan, List *rtable)
 		 * because we only replace the partial aggregation nodes which can't
 		 * check the HAVING clause.
 		 */
-		return plan;
+		return report_vector_agg_plan(plan, chunk_relid, DSC_FallbackAggregations);
 	}
 
-	if (agg->plan.lefttree == NULL)
-	{
-		/*
-		 * Not sure what this would mean, but check for it just to be on the
-		 * safe side because we can effectively see any possible plan here.
-		 */
-		return plan;
-	}
-
-	Plan *childplan = agg->plan.lefttree;
 	VectorQualInfo vqi;
 	MemSet(&vqi, 0, sizeof(VectorQualInfo));
 
@@ -623,8 +853,11 @@ try_insert_vector_agg_node(Plan *plan, List *rtable)
 	 */
 	if (!vectoragg_plan_possible(childplan, rtable, &vqi))
 	{
-		/* Not a compatible vectoragg child node */
-		return plan;
+		/*
+		 * Not a compatible vectoragg child node. For the compressed chunks,
+		 * this means that it has non-vectorized filters.
+		 */
+		return report_vector_agg_plan(plan, chunk_relid, DSC_FallbackFilter);
 	}
 
 	/*
@@ -639,7 +872,7 @@ try_insert_vector_agg_node(Plan *plan, List *rtable)
 	if (grouping_type == VAGT_Invalid)
 	{
 		/* The grouping is not vectorizable. */
-		return plan;
+		return report_vector_agg_plan(plan, chunk_relid, DSC_FallbackGrouping);
 	}
 
 	/*
@@ -651,7 +884,7 @@ try_insert_vector_agg_node(Plan *plan, List *rtable)
 	{
 		if (vqi.reverse)
 		{
-			return plan;
+			return report_vector_agg_plan(plan, chunk_relid, DSC_FallbackReverseOrder);
 		}
 	}
 
@@ -663,34 +896,57 @@ try_insert_vector_agg_node(Plan *plan, List *rtable)
 		if (IsA(target_entry->expr, Aggref))
 		{
 			Aggref *aggref = castNode(Aggref, target_entry->expr);
-			if (!can_vectorize_aggref(&vqi, aggref))
+			DecompressionStatsCounter reason;
+			if (!can_vectorize_aggref(&vqi, aggref, &reason))
 			{
 				/* Aggregate function not vectorizable. */
-				return plan;
+				return report_vector_agg_plan(plan, chunk_relid, reason);
 			}
 		}
-		else if (IsA(target_entry->expr, Var))
-		{
-			if (!is_vector_expr(&vqi, target_entry->expr))
-			{
-				/* Variable not vectorizable. */
-				return plan;
-			}
-		}
-		else
+		else if (!is_vector_expr(&vqi, target_entry->expr))
 		{
 			/*
-			 * Sometimes the plan can require this node to perform a projection,
-			 * e.g. we can see a nested loop param in its output targetlist. We
-			 * can't handle this case currently.
+			 * Either a variable that is not vectorizable, or the plan requires
+			 * this node to perform a projection, e.g. we can see a nested loop
+			 * param in its output targetlist. We can't handle this case
+			 * currently.
 			 */
-			return plan;
+			return report_vector_agg_plan(plan, chunk_relid, DSC_FallbackAggregations);
 		}
 	}
 
+	/*
+	 * When aggregating entire batches, some aggregate functions can use the
+	 * pre-aggregated batch metadata instead of the decompressed values. Find
+	 * the metadata for them, there is one element per aggregate function.
+	 */
+	List *batch_metadata = NIL;
+	foreach (lc, resolved_targetlist)
+	{
+		TargetEntry *target_entry = lfirst_node(TargetEntry, lc);
+		if (!IsA(target_entry->expr, Aggref))
+		{
+			continue;
+		}
+
+		batch_metadata =
+			lappend(batch_metadata,
+					grouping_type == VAGT_Batch ?
+						get_aggref_batch_metadata(&vqi,
+												  childplan,
+												  rtable,
+												  castNode(Aggref, target_entry->expr)) :
+						NIL);
+	}
+
 	/*
 	 * Finally, all requirements are satisfied and we can vectorize this partial
 	 * aggregation node.
 	 */
-	return vector_agg_plan_create(childplan, agg, resolved_targetlist, grouping_type);
+	report_vector_agg_plan(plan, chunk_relid, DSC_VectorizedAggregations);
+	return vector_agg_plan_create(childplan,
+								  agg,
+								  resolved_targetlist,
+								  grouping_type,
+								  batch_metadata);
 }
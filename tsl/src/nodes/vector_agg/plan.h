@@ -15,10 +15,13 @@
 typedef enum
 {
 	VASI_GroupingType = 0,
+	VASI_BatchMetadata,
 	VASI_Count
 } VectorAggSettingsIndex;
 
 extern void _vector_agg_init(void);
 extern void vectoragg_plan_columnar_scan(Plan *childplan, VectorQualInfo *vqi);
+extern List *vectoragg_plan_batch_metadata(Plan *childplan, List *rtable,
+										   AttrNumber uncompressed_chunk_attno);
 Plan *try_insert_vector_agg_node(Plan *plan, List *rtable);
 bool has_vector_agg_node(Plan *plan, bool *has_some_agg);
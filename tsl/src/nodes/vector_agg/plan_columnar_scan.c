@@ -4,11 +4,16 @@
  * LICENSE-TIMESCALE for a copy of the license.
  */
 #include <postgres.h>
+#include <catalog/pg_type.h>
 #include <nodes/pathnodes.h>
 #include <nodes/plannodes.h>
+#include <parser/parsetree.h>
+#include <utils/lsyscache.h>
 
+#include "compression/create.h"
 #include "nodes/columnar_scan/planner.h"
 #include "plan.h"
+#include "ts_catalog/compression_settings.h"
 
 /*
  * Whether the given compressed column index corresponds to a vector variable.
@@ -136,3 +141,80 @@ vectoragg_plan_columnar_scan(Plan *childplan, VectorQualInfo *vqi)
 	List *settings = linitial(custom->custom_private);
 	vqi->reverse = list_nth_int(settings, DCS_Reverse);
 }
+
+/*
+ * Find the position of the given compressed chunk column in the compressed scan
+ * targetlist, or return InvalidAttrNumber if it is not there.
+ */
+static AttrNumber
+find_compressed_scan_attno(const Scan *compressed_scan, AttrNumber compressed_attno)
+{
+	ListCell *lc;
+	foreach (lc, compressed_scan->plan.targetlist)
+	{
+		TargetEntry *target_entry = lfirst_node(TargetEntry, lc);
+		if (IsA(target_entry->expr, Var) &&
+			castNode(Var, target_entry->expr)->varattno == compressed_attno)
+		{
+			return target_entry->resno;
+		}
+	}
+
+	return InvalidAttrNumber;
+}
+
+/*
+ * Find the pre-aggregated sum, count and sum of squares metadata of the given
+ * uncompressed chunk column. Returns the list of their attribute numbers in the
+ * compressed scan tuple, followed by whether the sum is floating-point, or NIL
+ * if the metadata is not available.
+ */
+List *
+vectoragg_plan_batch_metadata(Plan *childplan, List *rtable, AttrNumber uncompressed_chunk_attno)
+{
+	const CustomScan *custom = castNode(CustomScan, childplan);
+	const Scan *compressed_scan = linitial(custom->custom_plans);
+	const Oid chunk_relid = rt_fetch(custom->scan.scanrelid, rtable)->relid;
+	const Oid compressed_relid = rt_fetch(compressed_scan->scanrelid, rtable)->relid;
+
+	CompressionSettings *settings = ts_compression_settings_get(chunk_relid);
+	if (settings == NULL || settings->fd.index == NULL)
+	{
+		return NIL;
+	}
+
+	static const char *const metadata_types[] = { "sum", "count", "sumsq" };
+	List *result = NIL;
+	bool float_sum = false;
+	for (size_t i = 0; i < sizeof(metadata_types) / sizeof(metadata_types[0]); i++)
+	{
+		const AttrNumber compressed_attno =
+			compressed_column_metadata_attno(settings,
+											 chunk_relid,
+											 uncompressed_chunk_attno,
+											 compressed_relid,
+											 metadata_types[i]);
+		if (compressed_attno == InvalidAttrNumber)
+		{
+			return NIL;
+		}
+
+		const AttrNumber scan_attno = find_compressed_scan_attno(compressed_scan, compressed_attno);
+		if (scan_attno == InvalidAttrNumber)
+		{
+			/* Not in the compressed scan targetlist, e.g. an index-only scan. */
+			return NIL;
+		}
+
+		if (i == 0)
+		{
+			float_sum = get_atttype(compressed_relid, compressed_attno) == FLOAT8OID;
+		}
+
+		result = lappend_int(result, scan_attno);
+	}
+
+	result = lappend_int(result, float_sum);
+
+	return result;
+}
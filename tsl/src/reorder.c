@@ -39,7 +39,9 @@
 #include <miscadmin.h>
 #include <nodes/pg_list.h>
 #include <optimizer/planner.h>
+#include <pgstat.h>
 #include <storage/bufmgr.h>
+#include <storage/latch.h>
 #include <storage/lmgr.h>
 #include <storage/lockdefs.h>
 #include <storage/predicate.h>
@@ -62,6 +64,7 @@
 
 #include "chunk.h"
 #include "chunk_index.h"
+#include "guc.h"
 #include "hypertable_cache.h"
 #include "import/heapswap.h"
 #include "indexing.h"
@@ -470,6 +473,36 @@ reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destinati
 	/* NB: rebuild_relation does table_close() on OldHeap */
 }
 
+/*
+ * Upgrade to an AccessExclusiveLock for the heap swap.
+ *
+ * Waiting for the lock would queue all new readers of the chunk behind the
+ * reorder until the readers that are already running are done. Since
+ * reading the chunk is allowed during the whole rewrite, try to get the lock
+ * in between queries first, and only wait in the queue if that fails.
+ *
+ * The number of attempts and the delay between them are set by
+ * timescaledb.reorder_lock_retries and timescaledb.reorder_lock_retry_delay.
+ */
+static void
+reorder_lock_for_swap(Oid relid)
+{
+	for (int i = 0; i < ts_guc_reorder_lock_retries; i++)
+	{
+		if (ConditionalLockRelationOid(relid, AccessExclusiveLock))
+			return;
+
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 ts_guc_reorder_lock_retry_delay,
+						 PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	LockRelationOid(relid, AccessExclusiveLock);
+}
+
 static void
 reorder_finish_heap_swaps(Oid OIDOldHeap, Oid OIDNewHeap, char relpersistence, List *old_index_oids,
 						  List *new_index_oids, bool swap_toast_by_content, bool is_internal,
@@ -527,7 +560,7 @@ reorder_finish_heap_swaps(Oid OIDOldHeap, Oid OIDNewHeap, char relpersistence, L
 				 errmsg("could not set deadlock_timeout guc.")));
 
 	/* Upgrade to an AccessExclusiveLock for the heap swap */
-	LockRelationOid(OIDOldHeap, AccessExclusiveLock);
+	reorder_lock_for_swap(OIDOldHeap);
 
 	/* Swap the contents of the indexes */
 	Assert(list_length(old_index_oids) == list_length(new_index_oids));
@@ -550,8 +583,10 @@ reorder_finish_heap_swaps(Oid OIDOldHeap, Oid OIDNewHeap, char relpersistence, L
 	CommandCounterIncrement();
 
 	/*
-	 * Swap the physical files of the target and transient tables, then
-	 * rebuild the target's indexes and throw away the transient table.
+	 * Swap the physical files of the target and transient tables and throw
+	 * away the transient table. The indexes were already built on the
+	 * transient table before taking the AccessExclusiveLock and swapped
+	 * above, so they must not be rebuilt here while holding the lock.
 	 */
 	ts_finish_heap_swap(OIDOldHeap,
 						OIDNewHeap,
@@ -559,7 +594,7 @@ reorder_finish_heap_swaps(Oid OIDOldHeap, Oid OIDNewHeap, char relpersistence, L
 						swap_toast_by_content,
 						true,
 						true,
-						true,
+						false,
 						frozenXid,
 						cutoffMulti,
 						relpersistence);
@@ -0,0 +1,41 @@
+# This file and its contents are licensed under the Timescale License.
+# Please see the included NOTICE for copyright information and
+# LICENSE-TIMESCALE for a copy of the license.
+
+# While reorder retries to take the AccessExclusiveLock for the heap swap
+# without waiting in the lock queue, new readers of the chunk are not
+# blocked behind it. When it waits in the lock queue right away, new
+# readers are blocked until the reorder is done.
+setup {
+ CREATE TABLE ts_reorder_test(time int, temp float, location int);
+ SELECT create_hypertable('ts_reorder_test', 'time', chunk_time_interval => 10);
+ INSERT INTO ts_reorder_test VALUES (1, 23.4, 1),
+       (2, 21.3, 2),
+       (3, 19.5, 3);
+}
+
+teardown {
+      DROP TABLE ts_reorder_test;
+}
+
+session "S"
+setup		{ BEGIN; }
+step "S1"	{ SELECT count(*) FROM ts_reorder_test; }
+step "Sc"	{ COMMIT; }
+
+session "R"
+setup		{ SET timescaledb.reorder_lock_retries = 1000; SET timescaledb.reorder_lock_retry_delay = '10ms'; }
+step "R1"	{ SELECT reorder_chunk((SELECT show_chunks('ts_reorder_test') LIMIT 1), 'ts_reorder_test_time_idx'); }
+
+session "Q"
+setup		{ SET timescaledb.reorder_lock_retries = 0; }
+step "Q1"	{ SELECT reorder_chunk((SELECT show_chunks('ts_reorder_test') LIMIT 1), 'ts_reorder_test_time_idx'); }
+
+session "N"
+step "N1"	{ SELECT count(*) FROM ts_reorder_test; }
+
+# R retries the lock until S commits, N reads without waiting
+permutation "S1" "R1"("Sc") "N1" "Sc"
+
+# Q waits in the lock queue, N waits behind it until Q is done
+permutation "S1" "Q1" "N1"("Q1") "Sc"
@@ -0,0 +1,107 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+CREATE FUNCTION ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(INT, INT) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+
+CREATE FUNCTION ts_bgw_params_create() RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+
+CREATE FUNCTION ts_bgw_params_reset_time(set_time BIGINT, wait BOOLEAN) RETURNS VOID
+AS :MODULE_PATHNAME LANGUAGE C VOLATILE;
+
+-- These are needed to set up the test scheduler
+CREATE TABLE public.bgw_dsm_handle_store(handle BIGINT);
+INSERT INTO public.bgw_dsm_handle_store VALUES (0);
+SELECT ts_bgw_params_create();
+
+-- Test scheduler automatically writes to this table by name, so
+-- create it.
+CREATE TABLE public.bgw_log(
+    msg_no INT,
+    mock_time BIGINT,
+    application_name TEXT,
+    msg TEXT
+);
+
+-- The admission decisions of the scheduler
+CREATE VIEW admission_log AS
+    SELECT msg_no, msg
+      FROM bgw_log
+     WHERE application_name = 'DB Scheduler'
+       AND (msg LIKE 'launching job%' OR msg LIKE 'deferring job%')
+     ORDER BY mock_time, msg_no;
+
+-- Remove all default jobs
+DELETE FROM _timescaledb_catalog.bgw_job WHERE TRUE;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+
+--
+-- Each of the tables has three chunks with a single page of data that
+-- is not compressed. The compression policies on adm_old and
+-- adm_old_too compress all of them, the policy on adm_recent none
+-- because the data is newer than compress_after, and the policy on
+-- adm_created none because the chunks were created after
+-- compress_created_before.
+--
+CREATE TABLE adm_old(time timestamptz NOT NULL, device int, value float);
+CREATE TABLE adm_old_too(time timestamptz NOT NULL, device int, value float);
+CREATE TABLE adm_recent(time timestamptz NOT NULL, device int, value float);
+CREATE TABLE adm_created(time timestamptz NOT NULL, device int, value float);
+
+SELECT table_name FROM create_hypertable('adm_old', 'time', chunk_time_interval => INTERVAL '1 day');
+SELECT table_name FROM create_hypertable('adm_old_too', 'time', chunk_time_interval => INTERVAL '1 day');
+SELECT table_name FROM create_hypertable('adm_recent', 'time', chunk_time_interval => INTERVAL '1 day');
+SELECT table_name FROM create_hypertable('adm_created', 'time', chunk_time_interval => INTERVAL '1 day');
+
+ALTER TABLE adm_old SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+ALTER TABLE adm_old_too SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+ALTER TABLE adm_recent SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+ALTER TABLE adm_created SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+
+INSERT INTO adm_old SELECT t, 1, 1.0 FROM generate_series('2020-01-01'::timestamptz, '2020-01-03', INTERVAL '1 day') t;
+INSERT INTO adm_old_too SELECT t, 1, 1.0 FROM generate_series('2020-01-01'::timestamptz, '2020-01-03', INTERVAL '1 day') t;
+INSERT INTO adm_recent SELECT now() - t, 1, 1.0 FROM generate_series(INTERVAL '1 hour', INTERVAL '2 days 1 hour', INTERVAL '1 day') t;
+INSERT INTO adm_created SELECT t, 1, 1.0 FROM generate_series('2020-01-01'::timestamptz, '2020-01-03', INTERVAL '1 day') t;
+
+SELECT add_compression_policy('adm_old', INTERVAL '1 day') AS job_old \gset
+SELECT add_compression_policy('adm_old_too', INTERVAL '1 day') AS job_old_too \gset
+SELECT add_compression_policy('adm_recent', INTERVAL '30 days') AS job_recent \gset
+SELECT add_compression_policy('adm_created', compress_created_before => INTERVAL '1 day') AS job_created \gset
+
+--
+-- The budget is larger than the chunks of one table but smaller than
+-- the chunks of two tables. The first compression job is always
+-- admitted. The second one would exceed the budget, so it is deferred
+-- until the first one has finished. The jobs that have nothing to
+-- compress have no cost, so they are admitted while the first one is
+-- running.
+--
+ALTER SYSTEM SET timescaledb.bgw_maintenance_cost_limit TO '32kB';
+ALTER DATABASE :TEST_DBNAME SET timescaledb.bgw_log_level = 'DEBUG1';
+SELECT pg_reload_conf();
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SHOW timescaledb.bgw_maintenance_cost_limit;
+SELECT ts_bgw_params_reset_time(0, false);
+SELECT ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(5000, 0);
+
+SELECT replace(replace(replace(replace(msg, :'job_old_too', 'old_too'), :'job_old', 'old'),
+               :'job_recent', 'recent'), :'job_created', 'created') AS msg
+  FROM admission_log;
+
+SELECT hypertable_name, total_runs, total_successes
+  FROM timescaledb_information.job_stats
+ ORDER BY hypertable_name;
+
+SELECT hypertable_name, count(*) FILTER (WHERE is_compressed) AS compressed, count(*) AS total
+  FROM timescaledb_information.chunks
+ GROUP BY hypertable_name
+ ORDER BY hypertable_name;
+
+-- clean up
+ALTER SYSTEM RESET timescaledb.bgw_maintenance_cost_limit;
+ALTER DATABASE :TEST_DBNAME RESET timescaledb.bgw_log_level;
+SELECT pg_reload_conf();
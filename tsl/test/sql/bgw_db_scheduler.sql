@@ -700,6 +700,94 @@ SELECT job_id, last_run_success, total_runs, total_successes, total_failures, to
 SELECT * FROM sorted_bgw_log WHERE msg NOT LIKE '[TESTING] Wait until%';
 SELECT last_finish, last_successful_finish, last_run_success FROM _timescaledb_internal.bgw_job_stat;
 
+--
+-- Test the order in which jobs are started and the next wakeup time
+--
+\c :TEST_DBNAME :ROLE_SUPERUSER
+TRUNCATE bgw_log;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+SELECT ts_bgw_params_reset_time();
+SELECT ts_bgw_params_mock_wait_returns_immediately(:WAIT_ON_JOB);
+DELETE FROM _timescaledb_catalog.bgw_job;
+-- The jobs are created in a different order than they are due, and the
+-- second job times out before the third job is due
+SELECT insert_job('wakeup_job_3', 'bgw_test_job_1', INTERVAL '100ms', INTERVAL '100s', INTERVAL '1s') AS wakeup_job_3 \gset
+SELECT insert_job('wakeup_job_1', 'bgw_test_job_1', INTERVAL '100ms', INTERVAL '100s', INTERVAL '1s') AS wakeup_job_1 \gset
+SELECT insert_job('wakeup_job_2', 'bgw_test_job_1', INTERVAL '100ms', INTERVAL '5ms', INTERVAL '1s') AS wakeup_job_2 \gset
+SELECT next_start FROM alter_job(:wakeup_job_1, next_start => '2000-01-01 00:00:00.01+00');
+SELECT next_start FROM alter_job(:wakeup_job_2, next_start => '2000-01-01 00:00:00.02+00');
+SELECT next_start FROM alter_job(:wakeup_job_3, next_start => '2000-01-01 00:00:00.03+00');
+\c :TEST_DBNAME :ROLE_DEFAULT_PERM_USER
+
+SELECT ts_bgw_db_scheduler_test_run_and_wait_for_scheduler_finish(50);
+-- The jobs are started in the order they are due. The scheduler wakes up
+-- for the next job to start, the timeout of a running job or the end of
+-- the run, whichever comes first.
+SELECT mock_time, application_name, msg FROM bgw_log ORDER BY mock_time, application_name COLLATE "C", msg_no;
+-- The mock timer does not advance while the scheduler is working, so the
+-- work time and wakeup lag are zero
+SELECT pid IS NULL AS exited, iterations, jobs_started, scheduled_jobs, running_jobs, next_wakeup,
+  avg_work_time, max_work_time, avg_wakeup_lag, max_wakeup_lag
+FROM timescaledb_information.job_scheduler_stats;
+
+--
+-- Test pooled job workers
+--
+\c :TEST_DBNAME :ROLE_SUPERUSER
+ALTER SYSTEM SET timescaledb.bgw_job_pool_size TO 1;
+ALTER SYSTEM SET timescaledb.bgw_job_pool_idle_timeout TO '2s';
+SELECT pg_reload_conf();
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SHOW timescaledb.bgw_job_pool_size;
+SHOW timescaledb.bgw_job_pool_idle_timeout;
+CREATE FUNCTION wait_for_application_exit(application_name TEXT, spins INTEGER=:TEST_SPINWAIT_ITERS) RETURNS BOOLEAN LANGUAGE PLPGSQL AS
+$BODY$
+BEGIN
+	FOR i in 1..spins
+	LOOP
+	PERFORM pg_stat_clear_snapshot();
+	IF NOT EXISTS (SELECT FROM pg_stat_activity a WHERE a.application_name = wait_for_application_exit.application_name) THEN
+		RETURN true;
+	END IF;
+	PERFORM pg_sleep(0.1);
+	END LOOP;
+	RETURN false;
+END
+$BODY$;
+TRUNCATE bgw_log;
+TRUNCATE _timescaledb_internal.bgw_job_stat;
+SELECT ts_bgw_params_reset_time();
+SELECT ts_bgw_params_mock_wait_returns_immediately(:WAIT_FOR_OTHER_TO_ADVANCE);
+DELETE FROM _timescaledb_catalog.bgw_job;
+SELECT insert_job('test_job_pool', 'bgw_test_job_1', INTERVAL '100ms', INTERVAL '100s', INTERVAL '1s') AS job_id \gset
+\c :TEST_DBNAME :ROLE_DEFAULT_PERM_USER
+
+SELECT ts_bgw_db_scheduler_test_run(200);
+SELECT wait_for_timer_to_run(0);
+SELECT wait_for_job_1_to_run(1);
+-- the pooled worker stays around waiting for the next job
+SELECT coalesce(wait_application_pid('TimescaleDB Job Pool Worker'), 0) AS pool_pid \gset
+SELECT :pool_pid <> 0 AS pool_worker_running;
+
+-- the second run is handed to the same worker instead of a new one
+SELECT ts_bgw_params_reset_time(150000, true);
+SELECT wait_for_timer_to_run(150000);
+SELECT wait_for_job_1_to_run(2);
+SELECT wait_application_pid('TimescaleDB Job Pool Worker') = :pool_pid AS same_pool_worker;
+SELECT count(*) FROM bgw_log WHERE msg = '[TESTING] Registered new background worker';
+SELECT job_id = :job_id AS job, total_runs, total_successes, total_failures, total_crashes FROM _timescaledb_internal.bgw_job_stat;
+
+-- the idle worker exits after bgw_job_pool_idle_timeout
+SELECT wait_for_application_exit('TimescaleDB Job Pool Worker', 100);
+
+SELECT ts_bgw_params_reset_time(200000, true);
+SELECT ts_bgw_db_scheduler_test_wait_for_scheduler_finish();
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+ALTER SYSTEM RESET timescaledb.bgw_job_pool_size;
+ALTER SYSTEM RESET timescaledb.bgw_job_pool_idle_timeout;
+SELECT pg_reload_conf();
+
 -- clean up jobs
 \c :TEST_DBNAME :ROLE_SUPERUSER
 SELECT _timescaledb_functions.stop_background_workers();
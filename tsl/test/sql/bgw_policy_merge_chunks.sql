@@ -0,0 +1,111 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+CREATE FUNCTION merge_policy_chunks(ht regclass) RETURNS TABLE(range_start bigint, range_end bigint, is_compressed bool) LANGUAGE SQL AS $$
+  SELECT range_start_integer, range_end_integer, is_compressed
+  FROM timescaledb_information.chunks
+  WHERE format('%I.%I', hypertable_schema, hypertable_name)::regclass = ht
+  ORDER BY range_start_integer;
+$$;
+
+CREATE FUNCTION merge_policy_batches(ht regclass) RETURNS TABLE(device int, batches bigint, batch_rows bigint) LANGUAGE plpgsql AS $$
+DECLARE
+  q text;
+BEGIN
+  SELECT string_agg(format('SELECT device, _ts_meta_count FROM %I.%I', c2.schema_name, c2.table_name), ' UNION ALL ') INTO q
+  FROM _timescaledb_catalog.chunk c1 JOIN _timescaledb_catalog.chunk c2 ON c2.id = c1.compressed_chunk_id
+  WHERE format('%I.%I', c1.schema_name, c1.table_name)::regclass IN (SELECT show_chunks(ht));
+  RETURN QUERY EXECUTE format('SELECT device, count(*), sum(_ts_meta_count) FROM (%s) b GROUP BY device ORDER BY device', q);
+END
+$$;
+
+-- Six adjacent chunks with one batch of 10 rows per device each
+CREATE TABLE mc_group(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('mc_group', 'time', chunk_time_interval => 10);
+ALTER TABLE mc_group SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+INSERT INTO mc_group SELECT t, d, t * d FROM generate_series(0, 59) t, generate_series(1, 2) d;
+SELECT count(compress_chunk(ch)) FROM show_chunks('mc_group') ch;
+
+-- All chunks have the same size, which is used to set the target size
+SELECT DISTINCT ccs.compressed_heap_size + ccs.compressed_toast_size + ccs.compressed_index_size AS chunk_size
+FROM _timescaledb_catalog.compression_chunk_size ccs
+  JOIN _timescaledb_catalog.chunk ch ON ch.id = ccs.chunk_id
+  JOIN _timescaledb_catalog.hypertable ht ON ht.id = ch.hypertable_id
+WHERE ht.table_name = 'mc_group' \gset
+
+CREATE TABLE mc_plain(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('mc_plain', 'time', chunk_time_interval => 10);
+
+\set ON_ERROR_STOP 0
+-- Only hypertables with columnstore enabled can have the policy
+SELECT add_merge_chunks_policy('mc_plain', 1000000);
+-- Invalid target size and minimum batch rows
+SELECT add_merge_chunks_policy('mc_group', 0);
+SELECT add_merge_chunks_policy('mc_group', -1);
+SELECT add_merge_chunks_policy('mc_group', 1000000, min_batch_rows => -1);
+SELECT add_merge_chunks_policy('mc_group', 1000000, min_batch_rows => 1001);
+SELECT remove_merge_chunks_policy('mc_plain');
+\set ON_ERROR_STOP 1
+SELECT remove_merge_chunks_policy('mc_plain', if_exists => true);
+
+-- At most two chunks fit into the target size
+SELECT add_merge_chunks_policy('mc_group', 2 * :chunk_size + 1, min_batch_rows => 0) AS job_group \gset
+SELECT config->'min_batch_rows' AS min_batch_rows, (config->>'target_size')::bigint = 2 * :chunk_size + 1 AS target_size
+FROM timescaledb_information.jobs WHERE job_id = :job_group;
+
+\set ON_ERROR_STOP 0
+SELECT add_merge_chunks_policy('mc_group', 1000000);
+\set ON_ERROR_STOP 1
+SELECT add_merge_chunks_policy('mc_group', 2 * :chunk_size + 1, min_batch_rows => 0, if_not_exists => true);
+SELECT add_merge_chunks_policy('mc_group', 2 * :chunk_size + 1, min_batch_rows => 100, if_not_exists => true);
+
+-- The configuration is validated when altering the job
+\set ON_ERROR_STOP 0
+SELECT job_id FROM alter_job(:job_group, config => (SELECT config - 'min_batch_rows' FROM timescaledb_information.jobs WHERE job_id = :job_group));
+SELECT job_id FROM alter_job(:job_group, config => (SELECT config || '{"min_batch_rows": 2000}' FROM timescaledb_information.jobs WHERE job_id = :job_group));
+SELECT job_id FROM alter_job(:job_group, config => (SELECT config || '{"target_size": 0}' FROM timescaledb_information.jobs WHERE job_id = :job_group));
+SELECT job_id FROM alter_job(:job_group, config => (SELECT config || '{"max_merges_per_job": -1}' FROM timescaledb_information.jobs WHERE job_id = :job_group));
+CALL _timescaledb_functions.policy_merge_chunks(0, '{"hypertable_id": 0, "target_size": 1}');
+\set ON_ERROR_STOP 1
+
+SELECT count(*), sum(value) FROM mc_group;
+SELECT * FROM merge_policy_batches('mc_group');
+CALL run_job(:job_group);
+
+-- Adjacent chunks are merged in pairs and the batches are combined
+SELECT * FROM merge_policy_chunks('mc_group');
+SELECT * FROM merge_policy_batches('mc_group');
+SELECT count(*), sum(value) FROM mc_group;
+SELECT remove_merge_chunks_policy('mc_group');
+
+-- Chunks separated by a gap or by a chunk that is not in the columnstore
+-- are not merged
+CREATE TABLE mc_gap(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('mc_gap', 'time', chunk_time_interval => 10);
+ALTER TABLE mc_gap SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+INSERT INTO mc_gap SELECT t, d, t * d FROM generate_series(0, 29) t, generate_series(1, 2) d;
+INSERT INTO mc_gap SELECT t, d, t * d FROM generate_series(40, 69) t, generate_series(1, 2) d;
+SELECT count(compress_chunk(format('%I.%I', chunk_schema, chunk_name)::regclass))
+FROM timescaledb_information.chunks WHERE hypertable_name = 'mc_gap' AND range_start_integer <> 20;
+
+-- Three chunks fit into the target size, and the default minimum batch
+-- rows is stored in the configuration
+SELECT add_merge_chunks_policy('mc_gap', 3 * :chunk_size + 1) AS job_gap \gset
+SELECT config->'min_batch_rows' AS min_batch_rows FROM timescaledb_information.jobs WHERE job_id = :job_gap;
+CALL run_job(:job_gap);
+SELECT * FROM merge_policy_chunks('mc_gap');
+SELECT count(*), sum(value) FROM mc_gap;
+
+-- Limit the number of merges per run
+CREATE TABLE mc_limit(time int NOT NULL, device int, value int);
+SELECT table_name FROM create_hypertable('mc_limit', 'time', chunk_time_interval => 10);
+ALTER TABLE mc_limit SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+INSERT INTO mc_limit SELECT t, d, t * d FROM generate_series(0, 59) t, generate_series(1, 2) d;
+SELECT count(compress_chunk(ch)) FROM show_chunks('mc_limit') ch;
+SELECT add_merge_chunks_policy('mc_limit', 2 * :chunk_size + 1, min_batch_rows => 0) AS job_limit \gset
+SELECT config->'max_merges_per_job' AS max_merges_per_job
+FROM alter_job(:job_limit, config => (SELECT config || '{"max_merges_per_job": 1}' FROM timescaledb_information.jobs WHERE job_id = :job_limit));
+CALL run_job(:job_limit);
+SELECT * FROM merge_policy_chunks('mc_limit');
+SELECT count(*), sum(value) FROM mc_limit;
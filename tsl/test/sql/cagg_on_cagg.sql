@@ -322,3 +322,59 @@ SET timezone TO 'UTC';
 \set BUCKET_WIDTH_1ST 'INTERVAL \'146 usec\''
 \set BUCKET_WIDTH_2TH 'INTERVAL \'1160 usec\''
 \ir include/cagg_on_cagg_validations.sql
+
+--
+-- Cascading refresh
+--
+CREATE TABLE cascade_raw(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('cascade_raw', 'time', chunk_time_interval => 10);
+CREATE OR REPLACE FUNCTION cascade_raw_now() RETURNS int LANGUAGE SQL STABLE AS
+$$ SELECT coalesce(max(time), 0) FROM cascade_raw $$;
+SELECT set_integer_now_func('cascade_raw', 'cascade_raw_now');
+INSERT INTO cascade_raw SELECT t, 1 FROM generate_series(0, 29) t;
+
+CREATE MATERIALIZED VIEW cascade_1 WITH (timescaledb.continuous, timescaledb.materialized_only=true) AS
+SELECT time_bucket(1, time) AS bucket, sum(value) AS total FROM cascade_raw GROUP BY 1 WITH NO DATA;
+CREATE MATERIALIZED VIEW cascade_5 WITH (timescaledb.continuous, timescaledb.materialized_only=true) AS
+SELECT time_bucket(5, bucket) AS bucket, sum(total) AS total FROM cascade_1 GROUP BY 1 WITH NO DATA;
+CREATE MATERIALIZED VIEW cascade_10 WITH (timescaledb.continuous, timescaledb.materialized_only=true) AS
+SELECT time_bucket(10, bucket) AS bucket, sum(total) AS total FROM cascade_5 GROUP BY 1 WITH NO DATA;
+
+-- Refreshing the bottom level with cascade refreshes all levels above it
+CALL refresh_continuous_aggregate('cascade_1', 0, 30, options => '{"cascade": true}');
+SELECT 'cascade_1' AS cagg, count(*) AS buckets, sum(total) AS total FROM cascade_1
+UNION ALL
+SELECT 'cascade_5', count(*), sum(total) FROM cascade_5
+UNION ALL
+SELECT 'cascade_10', count(*), sum(total) FROM cascade_10;
+
+-- Only the buckets covering the materialized ranges are refreshed on the
+-- levels above. Bucket 10 was materialized on the bottom level without
+-- cascading, so it stays stale on the levels above when a later cascading
+-- refresh materializes the non-contiguous buckets 2 and 27.
+UPDATE cascade_raw SET value = 11 WHERE time = 2;
+UPDATE cascade_raw SET value = 11 WHERE time = 12;
+UPDATE cascade_raw SET value = 11 WHERE time = 27;
+CALL refresh_continuous_aggregate('cascade_1', 10, 15);
+CALL refresh_continuous_aggregate('cascade_1', 0, 30, options => '{"cascade": true}');
+SELECT * FROM cascade_1 WHERE bucket IN (2, 12, 27) ORDER BY 1;
+SELECT * FROM cascade_5 ORDER BY 1;
+SELECT * FROM cascade_10 ORDER BY 1;
+
+-- Refreshing the middle level picks up the stale bucket and cascades further
+CALL refresh_continuous_aggregate('cascade_5', 0, 30, options => '{"cascade": true}');
+SELECT * FROM cascade_5 ORDER BY 1;
+SELECT * FROM cascade_10 ORDER BY 1;
+
+-- The cascade stops after a maximum number of levels
+CREATE MATERIALIZED VIEW cascade_depth_0 WITH (timescaledb.continuous, timescaledb.materialized_only=true) AS
+SELECT time_bucket(1, time) AS bucket, sum(value) AS total FROM cascade_raw GROUP BY 1 WITH NO DATA;
+SELECT format('CREATE MATERIALIZED VIEW cascade_depth_%s WITH (timescaledb.continuous, timescaledb.materialized_only=true) AS '
+              'SELECT time_bucket(%s, bucket) AS bucket, sum(total) AS total FROM cascade_depth_%s GROUP BY 1 WITH NO DATA',
+              level, 1 << level, level - 1)
+FROM generate_series(1, 9) level
+ORDER BY level \gexec
+CALL refresh_continuous_aggregate('cascade_depth_0', 0, 30, options => '{"cascade": true}');
+SELECT string_agg(format('SELECT %s AS level, count(*) AS buckets, sum(total) AS total FROM cascade_depth_%s', level, level),
+                  ' UNION ALL ' ORDER BY level)
+FROM generate_series(0, 9) level \gexec
@@ -92,3 +92,78 @@ WITH adjacent_slices AS
    INNER JOIN _timescaledb_catalog.chunk_constraint c2 ON c2.dimension_slice_id = adjacent_slices.secondary)
 SELECT _timescaledb_internal.test_merge_chunks_on_dimension(format('_timescaledb_internal._hyper_4_%s_chunk', chunks.primary_chunk), format('_timescaledb_internal._hyper_4_%s_chunk', chunks.secondary_chunk), 4)
 FROM chunks;
+
+-- Merging the compressed batches of columnstore chunks. With a batch size
+-- limit of 10, each chunk has one batch of 5 rows for device 1, batches of 10
+-- and 2 rows for device 2 and one batch of 4 rows for a NULL device.
+SET timescaledb.compression_batch_size_limit = 10;
+CREATE FUNCTION rebatch_setup(tbl text, orderby text) RETURNS void LANGUAGE plpgsql AS $$
+BEGIN
+  EXECUTE format('CREATE TABLE %I(time timestamptz NOT NULL, device int, value float)', tbl);
+  PERFORM create_hypertable(tbl::regclass, 'time', chunk_time_interval => interval '1 day');
+  EXECUTE format('ALTER TABLE %I SET (timescaledb.compress, timescaledb.compress_segmentby = ''device'', timescaledb.compress_orderby = %L)', tbl, orderby);
+  EXECUTE format($q$INSERT INTO %I SELECT '2024-01-01 00:00+00'::timestamptz + day * interval '1 day' + n * interval '1 minute', s.device, day * 100 + n
+                    FROM generate_series(0, 2) day, (VALUES (1, 5), (2, 12), (NULL, 4)) s(device, cnt), generate_series(1, s.cnt) n$q$, tbl);
+  PERFORM compress_chunk(ch) FROM show_chunks(tbl::regclass) ch;
+END
+$$;
+CREATE FUNCTION rebatch_batches(ht regclass) RETURNS TABLE(device int, batches bigint, batch_rows bigint) LANGUAGE plpgsql AS $$
+DECLARE
+  q text;
+BEGIN
+  SELECT string_agg(format('SELECT device, _ts_meta_count FROM %I.%I', c2.schema_name, c2.table_name), ' UNION ALL ') INTO q
+  FROM _timescaledb_catalog.chunk c1 JOIN _timescaledb_catalog.chunk c2 ON c2.id = c1.compressed_chunk_id
+  WHERE format('%I.%I', c1.schema_name, c1.table_name)::regclass IN (SELECT show_chunks(ht));
+  RETURN QUERY EXECUTE format('SELECT device, count(*), sum(_ts_meta_count) FROM (%s) b GROUP BY device ORDER BY device', q);
+END
+$$;
+CREATE FUNCTION rebatch_diff(ht regclass) RETURNS bigint LANGUAGE plpgsql AS $$
+DECLARE
+  diff bigint;
+BEGIN
+  EXECUTE format('SELECT count(*) FROM ((SELECT * FROM %1$s EXCEPT ALL SELECT * FROM rebatch_ref) UNION ALL (SELECT * FROM rebatch_ref EXCEPT ALL SELECT * FROM %1$s)) d', ht) INTO diff;
+  RETURN diff;
+END
+$$;
+
+-- Without rebatching, the compressed relations are copied as-is
+SELECT rebatch_setup('rebatch_off', 'time');
+CREATE TABLE rebatch_ref AS SELECT * FROM rebatch_off;
+SELECT * FROM rebatch_batches('rebatch_off');
+CALL merge_chunks(ARRAY(SELECT show_chunks('rebatch_off')));
+SELECT count(*) AS chunks, rebatch_diff('rebatch_off') AS differences FROM show_chunks('rebatch_off');
+SELECT * FROM rebatch_batches('rebatch_off');
+
+-- With rebatching, the undersized batches of device 1 and the NULL device
+-- are recompressed into full batches. The undersized batches of device 2 are
+-- not neighbors, so they are kept.
+SET timescaledb.enable_merge_chunks_rebatch = on;
+SELECT rebatch_setup('rebatch_on', 'time');
+CALL merge_chunks(ARRAY(SELECT show_chunks('rebatch_on')));
+SELECT count(*) AS chunks, rebatch_diff('rebatch_on') AS differences FROM show_chunks('rebatch_on');
+SELECT * FROM rebatch_batches('rebatch_on');
+
+-- Descending orderby
+SELECT rebatch_setup('rebatch_desc', 'time DESC');
+CALL merge_chunks(ARRAY(SELECT show_chunks('rebatch_desc')));
+SELECT count(*) AS chunks, rebatch_diff('rebatch_desc') AS differences FROM show_chunks('rebatch_desc');
+SELECT * FROM rebatch_batches('rebatch_desc');
+
+-- Chunks compressed with different settings fall back to copying the
+-- compressed relations
+SELECT rebatch_setup('rebatch_mixed', 'time');
+SELECT count(*) FROM (SELECT decompress_chunk(ch) FROM show_chunks('rebatch_mixed') ch ORDER BY ch DESC LIMIT 1) d;
+ALTER TABLE rebatch_mixed SET (timescaledb.compress_orderby = 'time DESC');
+SELECT count(*) FROM (SELECT compress_chunk(ch) FROM show_chunks('rebatch_mixed') ch ORDER BY ch DESC LIMIT 1) c;
+CALL merge_chunks(ARRAY(SELECT show_chunks('rebatch_mixed')));
+SELECT count(*) AS chunks, rebatch_diff('rebatch_mixed') AS differences FROM show_chunks('rebatch_mixed');
+SELECT * FROM rebatch_batches('rebatch_mixed');
+
+-- Concurrent merge
+SELECT rebatch_setup('rebatch_concurrent', 'time');
+CALL merge_chunks_concurrently(ARRAY(SELECT show_chunks('rebatch_concurrent')));
+SELECT count(*) AS chunks, rebatch_diff('rebatch_concurrent') AS differences FROM show_chunks('rebatch_concurrent');
+SELECT * FROM rebatch_batches('rebatch_concurrent');
+
+RESET timescaledb.enable_merge_chunks_rebatch;
+RESET timescaledb.compression_batch_size_limit;
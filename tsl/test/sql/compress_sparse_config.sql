@@ -330,3 +330,62 @@ select * from test.show_columns_ext(:'chunk'::regclass);
 select * from settings;
 reset timescaledb.enable_sparse_index_bloom;
 drop table test_sparse_index;
+
+-- Test the sum sparse index. It is not used for filtering, so it can be
+-- combined with a minmax or bloom sparse index on the same column, and can be
+-- set for the orderby columns.
+create table test_sum_index(x int, v int, i8 bigint, f8 float8, t text);
+select table_name from create_hypertable('test_sum_index', 'x');
+
+\set ON_ERROR_STOP 0
+-- duplicate sum index
+alter table test_sum_index set (timescaledb.compress,
+    timescaledb.compress_segmentby = '',
+    timescaledb.compress_orderby = 'x',
+    timescaledb.compress_index = 'sum("v"), sum("v")');
+
+-- still only one filtering sparse index per column
+alter table test_sum_index set (timescaledb.compress,
+    timescaledb.compress_segmentby = '',
+    timescaledb.compress_orderby = 'x',
+    timescaledb.compress_index = 'minmax("v"), sum("v"), bloom("v")');
+
+-- unsupported type
+alter table test_sum_index set (timescaledb.compress,
+    timescaledb.compress_segmentby = '',
+    timescaledb.compress_orderby = 'x',
+    timescaledb.compress_index = 'sum("t")');
+\set ON_ERROR_STOP 1
+
+alter table test_sum_index set (timescaledb.compress,
+    timescaledb.compress_segmentby = '',
+    timescaledb.compress_orderby = 'x',
+    timescaledb.compress_index = 'sum("x"), minmax("v"), sum("v"), sum("i8"), sum("f8")');
+select index from settings where relid = 'test_sum_index'::regclass;
+
+-- The first batch overflows the bigint sum of i8, and the second one has only
+-- null values of v.
+insert into test_sum_index
+select x,
+    case when x between 1001 and 2000 then null else x % 7 end,
+    case when x <= 1000 then 9223372036854775000 else x end,
+    x / 4.0,
+    x::text
+from generate_series(1, 3000) x;
+
+select count(compress_chunk(x)) from show_chunks('test_sum_index') x;
+
+select schema_name || '.' || table_name chunk from _timescaledb_catalog.chunk
+    where id = (select compressed_chunk_id from _timescaledb_catalog.chunk
+        where hypertable_id = (select id from _timescaledb_catalog.hypertable
+            where table_name = 'test_sum_index') limit 1)
+\gset
+
+select * from test.show_columns_ext(:'chunk'::regclass);
+
+select _ts_meta_min_1, _ts_meta_max_1, _ts_meta_v2_sum_x, _ts_meta_v2_count_x,
+    _ts_meta_v2_min_v, _ts_meta_v2_max_v, _ts_meta_v2_sum_v, _ts_meta_v2_count_v,
+    _ts_meta_v2_sum_i8, _ts_meta_v2_count_i8, _ts_meta_v2_sum_f8, _ts_meta_v2_count_f8
+from :chunk order by _ts_meta_min_1;
+
+drop table test_sum_index;
@@ -32,3 +32,47 @@ select sum(t) from generate_series(1, 30) x, lateral test(x * x * x, false) t;
 
 -- Also test decompression which uses the detoaster as well.
 select sum(t) from generate_series(1, 30) x, lateral test(x * x * x, true) t;
+
+-- The toast pages of all compressed columns of a batch are prefetched before
+-- they are detoasted. Check that the results don't depend on the
+-- prefetching, with several toasted columns, and with the batches where no
+-- rows pass the vectorized filter, so that the other columns are not read.
+create table longcols(ts int, seg int, v int, s1 text, s2 text);
+select table_name from create_hypertable('longcols', 'ts', chunk_time_interval => 10000);
+alter table longcols set (timescaledb.compress, timescaledb.compress_segmentby = 'seg',
+    timescaledb.compress_orderby = 'ts');
+insert into longcols select x, x % 3, x % 100, repeat(md5(x::text), 10), md5((-x)::text)
+from generate_series(1, 3000) x;
+select count(compress_chunk(x, true)) from show_chunks('longcols') x;
+
+set timescaledb.enable_compressed_toast_prefetch = off;
+select count(*), sum(length(s1)), sum(length(s2)) from longcols;
+select count(*), md5(string_agg(s1 || s2, ',' order by ts)) from longcols where v < 5;
+select count(*), md5(string_agg(s1 || s2, ',' order by ts)) from longcols where v > 1000;
+
+reset timescaledb.enable_compressed_toast_prefetch;
+select count(*), sum(length(s1)), sum(length(s2)) from longcols;
+select count(*), md5(string_agg(s1 || s2, ',' order by ts)) from longcols where v < 5;
+select count(*), md5(string_agg(s1 || s2, ',' order by ts)) from longcols where v > 1000;
+
+-- On Postgres 17 and later, the toast pages are read through a read stream
+-- that is reset for every batch. Test more batches per segment, the dead
+-- toast tuples left behind by the recompression, whose index entries are
+-- still found by the prefetching lookups, and the rescans.
+insert into longcols select x, x % 3, x % 100, repeat(md5(x::text), 10), md5((-x)::text)
+from generate_series(3001, 6000) x;
+select count(compress_chunk(x, true)) from show_chunks('longcols') x;
+
+select count(*), sum(length(s1)), sum(length(s2)) from longcols;
+select count(*), md5(string_agg(s1 || s2, ',' order by ts)) from longcols where v < 5;
+
+select s.seg, x.* from (values (0), (1), (2)) s(seg),
+    lateral (select count(*), md5(string_agg(s1 || s2, ',' order by ts)) from longcols
+        where seg = s.seg and v < 5) x
+order by s.seg;
+
+-- The read stream falls back to synchronous reads without I/O concurrency.
+set effective_io_concurrency = 0;
+select count(*), md5(string_agg(s1 || s2, ',' order by ts)) from longcols where v < 5;
+reset effective_io_concurrency;
+drop table longcols;
@@ -495,6 +495,153 @@ DROP TABLE base_uuids;
 RESET timescaledb.enable_uuid_compression;
 DROP table uuid_set;
 
+-------------------------
+-- DECIMAL Compression --
+-------------------------
+
+SET timescaledb.enable_decimal_compression = on;
+
+CREATE TABLE decimal_ht(time int NOT NULL, device int, n numeric, f8 float8, f4 float4);
+SELECT table_name FROM create_hypertable('decimal_ht', 'time', chunk_time_interval => 1000);
+ALTER TABLE decimal_ht SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+
+-- high-scale values with NULLs and a single value beyond the supported scale
+INSERT INTO decimal_ht SELECT i, 1,
+    CASE WHEN i % 10 = 5 THEN NULL WHEN i = 50 THEN 1.00000000000000000001 ELSE round(i * 1.234567890123, 12) END,
+    CASE WHEN i % 10 = 6 THEN NULL ELSE (i / 1000.0)::float8 END,
+    CASE WHEN i % 10 = 7 THEN NULL ELSE (i / 8.0)::float4 END
+FROM generate_series(1, 80) i;
+-- a few NaN, infinite and negative zero values
+INSERT INTO decimal_ht SELECT i, 2,
+    CASE i % 40 WHEN 0 THEN 'NaN' WHEN 13 THEN 'Infinity' WHEN 27 THEN '-Infinity' ELSE round(i / 100.0, 2) END,
+    CASE i % 40 WHEN 0 THEN 'NaN' WHEN 13 THEN 'Infinity' WHEN 27 THEN '-Infinity' WHEN 20 THEN '-0' ELSE (i / 100.0)::float8 END,
+    CASE i % 40 WHEN 0 THEN 'NaN' WHEN 13 THEN 'Infinity' WHEN 27 THEN '-Infinity' WHEN 20 THEN '-0' ELSE (i / 4.0)::float4 END
+FROM generate_series(1, 80) i;
+-- too many special values, so the default algorithms are used
+INSERT INTO decimal_ht SELECT i, 3,
+    CASE WHEN i % 2 = 0 THEN 'NaN' ELSE round(i / 100.0, 2) END,
+    CASE WHEN i % 2 = 0 THEN 'NaN' ELSE (i / 100.0)::float8 END,
+    CASE WHEN i % 2 = 0 THEN 'Infinity' ELSE (i / 4.0)::float4 END
+FROM generate_series(1, 80) i;
+
+CREATE TABLE decimal_ref AS SELECT * FROM decimal_ht;
+SELECT count(compress_chunk(ch)) FROM show_chunks('decimal_ht') ch;
+
+SELECT format('%I.%I', c2.schema_name, c2.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk c1
+  JOIN _timescaledb_catalog.chunk c2 ON c2.id = c1.compressed_chunk_id
+  JOIN _timescaledb_catalog.hypertable ht ON ht.id = c1.hypertable_id
+WHERE ht.table_name = 'decimal_ht' \gset
+
+SELECT device,
+    (SELECT algorithm FROM _timescaledb_functions.compressed_data_info(n)) AS n,
+    (SELECT algorithm FROM _timescaledb_functions.compressed_data_info(f8)) AS f8,
+    (SELECT algorithm FROM _timescaledb_functions.compressed_data_info(f4)) AS f4
+FROM :COMPRESSED_CHUNK ORDER BY device;
+
+-- The values, including the numeric display scale and the float bits,
+-- must round-trip with both bulk and row-by-row decompression
+SELECT
+  $$
+  SELECT time, device, n::text, float8send(f8), float4send(f4) FROM decimal_ht
+  $$ AS "QUERY",
+  $$
+  SELECT time, device, n::text, float8send(f8), float4send(f4) FROM decimal_ref
+  $$ AS "REF_QUERY"
+\gset
+
+SELECT count(*) AS differences FROM ((:QUERY EXCEPT ALL :REF_QUERY) UNION ALL (:REF_QUERY EXCEPT ALL :QUERY)) d;
+SET timescaledb.enable_bulk_decompression = off;
+SELECT count(*) AS differences FROM ((:QUERY EXCEPT ALL :REF_QUERY) UNION ALL (:REF_QUERY EXCEPT ALL :QUERY)) d;
+RESET timescaledb.enable_bulk_decompression;
+
+SELECT device, sum(n), count(n), count(f8), count(f4) FROM decimal_ht GROUP BY device ORDER BY device;
+SELECT device, sum(n), count(n), count(f8), count(f4) FROM decimal_ref GROUP BY device ORDER BY device;
+SELECT
+    (SELECT count(*) FROM decimal_ht WHERE n > 0.5) = (SELECT count(*) FROM decimal_ref WHERE n > 0.5) AS n,
+    (SELECT count(*) FROM decimal_ht WHERE f8 > 0.05) = (SELECT count(*) FROM decimal_ref WHERE f8 > 0.05) AS f8,
+    (SELECT count(*) FROM decimal_ht WHERE f4 < 10) = (SELECT count(*) FROM decimal_ref WHERE f4 < 10) AS f4;
+
+RESET timescaledb.enable_decimal_compression;
+DROP TABLE decimal_ht;
+DROP TABLE decimal_ref;
+
+-----------------------
+-- JSONB Compression --
+-----------------------
+
+SET timescaledb.enable_jsonb_compression = on;
+
+CREATE TABLE jsonb_ht(time int NOT NULL, device int, j jsonb);
+SELECT table_name FROM create_hypertable('jsonb_ht', 'time', chunk_time_interval => 1000);
+ALTER TABLE jsonb_ht SET (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+
+-- documents with common keys, nested values and JSON nulls, mixed with SQL
+-- NULLs, non-object documents and a key with a value of another type
+INSERT INTO jsonb_ht SELECT i, 1,
+    CASE
+        WHEN i % 10 = 0 THEN NULL
+        WHEN i % 17 = 0 THEN jsonb_build_array(i, i + 1)
+        WHEN i % 19 = 0 THEN jsonb_build_object('temp', 'n/a', 'status', 'unknown')
+        ELSE jsonb_build_object(
+            'temp', round(i / 10.0, 1),
+            'status', CASE WHEN i % 3 = 0 THEN 'warn' ELSE 'ok' END,
+            'on', i % 2 = 0,
+            'note', CASE WHEN i % 5 = 0 THEN NULL ELSE 'n' || i END,
+            'nested', jsonb_build_object('a', i, 'arr', jsonb_build_array(i, i + 1, NULL)))
+    END
+FROM generate_series(1, 80) i;
+-- large values
+INSERT INTO jsonb_ht SELECT i, 2,
+    CASE
+        WHEN i % 20 = 0 THEN NULL
+        ELSE jsonb_build_object(
+            'k', i,
+            'big', repeat(md5(i::text), 300),
+            'nested', jsonb_build_object('payload', repeat(chr(65 + i % 26), 5000)))
+    END
+FROM generate_series(1, 80) i;
+-- no frequent keys, so the default algorithm is used
+INSERT INTO jsonb_ht SELECT i, 3, CASE WHEN i % 10 = 0 THEN NULL ELSE jsonb_build_object('k' || i, i) END
+FROM generate_series(1, 80) i;
+
+CREATE TABLE jsonb_ref AS SELECT * FROM jsonb_ht;
+SELECT count(compress_chunk(ch)) FROM show_chunks('jsonb_ht') ch;
+
+SELECT format('%I.%I', c2.schema_name, c2.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk c1
+  JOIN _timescaledb_catalog.chunk c2 ON c2.id = c1.compressed_chunk_id
+  JOIN _timescaledb_catalog.hypertable ht ON ht.id = c1.hypertable_id
+WHERE ht.table_name = 'jsonb_ht' \gset
+
+SELECT device, (SELECT algorithm FROM _timescaledb_functions.compressed_data_info(j)) AS j
+FROM :COMPRESSED_CHUNK ORDER BY device;
+
+SELECT
+  $$
+  SELECT time, device, j::text FROM jsonb_ht
+  $$ AS "QUERY",
+  $$
+  SELECT time, device, j::text FROM jsonb_ref
+  $$ AS "REF_QUERY"
+\gset
+
+SELECT count(*) AS differences FROM ((:QUERY EXCEPT ALL :REF_QUERY) UNION ALL (:REF_QUERY EXCEPT ALL :QUERY)) d;
+SET timescaledb.enable_bulk_decompression = off;
+SELECT count(*) AS differences FROM ((:QUERY EXCEPT ALL :REF_QUERY) UNION ALL (:REF_QUERY EXCEPT ALL :QUERY)) d;
+RESET timescaledb.enable_bulk_decompression;
+
+SELECT device, count(j), sum(length(j::text)) FROM jsonb_ht GROUP BY device ORDER BY device;
+SELECT device, count(j), sum(length(j::text)) FROM jsonb_ref GROUP BY device ORDER BY device;
+SELECT
+    (SELECT count(*) FROM jsonb_ht WHERE j ->> 'status' = 'warn') = (SELECT count(*) FROM jsonb_ref WHERE j ->> 'status' = 'warn') AS status,
+    (SELECT count(*) FROM jsonb_ht WHERE j ->> 'temp' = 'n/a') = (SELECT count(*) FROM jsonb_ref WHERE j ->> 'temp' = 'n/a') AS temp,
+    (SELECT count(*) FROM jsonb_ht WHERE j -> 'nested' ->> 'a' = '7') = (SELECT count(*) FROM jsonb_ref WHERE j -> 'nested' ->> 'a' = '7') AS nested;
+
+RESET timescaledb.enable_jsonb_compression;
+DROP TABLE jsonb_ht;
+DROP TABLE jsonb_ref;
+
 -----------------------------------------------
 -- Interesting corrupt data found by fuzzing --
 -----------------------------------------------
@@ -514,11 +514,30 @@ select count(*), min(ts), max(ts), min(d), max(d) from text_table where a like '
 \set ON_ERROR_STOP 1
 
 
--- We don't vectorize comparison operators with text because they are probably
--- not very useful.
-set timescaledb.debug_require_vector_qual to 'forbid';
+-- The text ordering, ILIKE and the regular expressions are vectorized only
+-- for the C collation, because our implementations compare bytewise and only
+-- fold the case of the ASCII letters.
 select count(*), min(ts), max(ts), min(d), max(d) from text_table where a < 'same' collate "C";
 select count(*), min(ts), max(ts), min(d), max(d) from text_table where a > 'same' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a <= 'same' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a >= 'different5' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a < '異' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a ilike 'SAME%' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a ilike '%Nulls1_' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a not ilike '%DIFFERENT%' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a ~ '^different[0-9]+5$' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a ~ '(10a|99b)$' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a !~ 'e' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a ~* '^SAME' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a !~* 'NULLS' collate "C";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a ^@ 'different-';
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a ^@ '異なる9';
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a ^@ '';
+
+set timescaledb.debug_require_vector_qual to 'forbid';
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a < 'same' collate "ucs_basic";
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a ilike 'SAME%';
+select count(*), min(ts), max(ts), min(d), max(d) from text_table where a ~* '^SAME';
 
 reset timescaledb.debug_require_vector_qual;
 reset timescaledb.enable_bulk_decompression;
@@ -875,3 +894,296 @@ reset timescaledb.enable_columnarscan;
 reset timescaledb.debug_require_vector_qual;
 reset timescaledb.enable_bool_compression;
 
+
+
+-- Test the comparisons between two arithmetic columns. The results are
+-- compared with the same data in a plain table.
+create table vvqual(ts int not null, seg int, i2 int2, i4 int4, i8 int8,
+    f4 float4, f8 float8, t1 timestamptz, t2 timestamptz);
+select table_name from create_hypertable('vvqual', 'ts', chunk_time_interval => 100000);
+alter table vvqual set (timescaledb.compress, timescaledb.compress_segmentby = 'seg',
+    timescaledb.compress_orderby = 'ts');
+insert into vvqual
+select x, x % 3,
+    case when x % 10 = 0 then null else x % 7 end,
+    case when x % 11 = 0 then null else x % 5 end,
+    case when x % 13 = 0 then null else x % 6 end,
+    case when x % 17 = 0 then null when x % 19 = 0 then 'nan' else (x % 9) / 2.0 end,
+    case when x % 14 = 0 then null when x % 23 = 0 then 'nan' else (x % 8) / 2.0 end,
+    case when x % 29 = 0 then null else '2024-01-01 00:00:00+00'::timestamptz + (x % 4) * interval '1 hour' end,
+    '2024-01-01 00:00:00+00'::timestamptz + (x % 3) * interval '1 hour'
+from generate_series(1, 5000) x;
+create table vvqual_ref as select * from vvqual;
+select count(compress_chunk(x, true)) from show_chunks('vvqual') x;
+
+-- The columns added after compression have a single default value for the
+-- compressed batches.
+alter table vvqual add column d4 int4 default 3, add column d8 int8 default 3,
+    add column dn int4;
+alter table vvqual_ref add column d4 int4 default 3, add column d8 int8 default 3,
+    add column dn int4;
+
+create function vector_vector_qual(qual text)
+returns table(vectorized_filter text, total_rows bigint, differences bigint)
+language plpgsql as
+$$
+declare
+    plan_line text;
+begin
+    for plan_line in execute format('explain (costs off) select * from vvqual where %s', qual) loop
+        if plan_line like '%Vectorized Filter:%' then
+            vectorized_filter := trim(split_part(plan_line, 'Vectorized Filter:', 2));
+        end if;
+    end loop;
+    execute format('select count(*) from vvqual where %s', qual) into total_rows;
+    execute format('select count(*) from (
+            (select ts from vvqual where %1$s except all select ts from vvqual_ref where %1$s)
+            union all
+            (select ts from vvqual_ref where %1$s except all select ts from vvqual where %1$s)) d',
+        qual) into differences;
+    return next;
+end
+$$;
+
+-- Nulls on either side don't pass, and NaN follows the Postgres semantics
+-- where it is equal to itself and greater than any other value.
+select qual, vectorized_filter, total_rows, differences
+from (values
+    (1, 'i2 > i4'),
+    (2, 'i4 <= i2'),
+    (3, 'i2 = i8'),
+    (4, 'i8 <> i2'),
+    (5, 'i4 < i8'),
+    (6, 'i8 >= i4'),
+    (7, 'i2 < i2'),
+    (8, 'f4 < f8'),
+    (9, 'f8 = f4'),
+    (10, 'f4 >= f8'),
+    (11, 'f8 <> f8'),
+    (12, 't1 > t2'),
+    (13, 'i4 < d4'),
+    (14, 'd8 = d4'),
+    (15, 'd4 > d8'),
+    (16, 'i4 = dn'),
+    (17, 'i2 > i4 and f4 < f8'),
+    (18, 'i2 > i4 or f8 = f4')) q(n, qual),
+    lateral vector_vector_qual(qual)
+order by n;
+
+-- The comparisons between integer and float columns need a cast, and the
+-- segmentby columns are not vectorized, so these are not vectorized.
+select qual, vectorized_filter, total_rows, differences
+from (values
+    (1, 'i4 > f8'),
+    (2, 'f4 = i2'),
+    (3, 'i4 > seg'),
+    (4, 'i2 > i4 and i4 > f8')) q(n, qual),
+    lateral vector_vector_qual(qual)
+order by n;
+
+set timescaledb.debug_require_vector_qual to 'require';
+select count(*) from vvqual where i2 > i4 and f4 < f8;
+select count(*) from vvqual where i8 <> i2 or t1 > t2;
+set timescaledb.debug_require_vector_qual to 'forbid';
+select count(*) from vvqual where i4 > f8;
+reset timescaledb.debug_require_vector_qual;
+
+drop function vector_vector_qual(text);
+drop table vvqual, vvqual_ref;
+
+-- Test the decompression profile shown by EXPLAIN (ANALYZE, VERBOSE). The
+-- sizes and timings depend on the platform, so only the counters are shown.
+create table dprofile(ts int not null, seg int, v int, t text);
+select table_name from create_hypertable('dprofile', 'ts', chunk_time_interval => 100000);
+alter table dprofile set (timescaledb.compress, timescaledb.compress_segmentby = 'seg',
+    timescaledb.compress_orderby = 'ts');
+insert into dprofile select x, x % 2, x % 100, 'text ' || x % 10 from generate_series(1, 4000) x;
+select count(compress_chunk(x)) from show_chunks('dprofile') x;
+vacuum analyze dprofile;
+
+create function decompression_profile(query text, timing bool = false)
+returns table(batches_read bigint, vectorized_removed bigint, filter_removed bigint,
+    skipped_columns bigint, algorithms text, compressed_columns text, timed bool)
+language plpgsql as
+$$
+declare
+    plan jsonb;
+    node jsonb;
+begin
+    execute format('explain (analyze, verbose, costs off, timing %s, summary off, format json) %s',
+        case when timing then 'on' else 'off' end, query) into plan;
+    node := jsonb_path_query_first(plan, '$.** ? (@."Custom Plan Provider" == "ColumnarScan")');
+    batches_read := (node->>'Batches Read')::bigint;
+    vectorized_removed := (node->>'Rows Removed by Vectorized Filter')::bigint;
+    filter_removed := (node->>'Rows Removed by Row Filter')::bigint;
+    skipped_columns := (node->>'Lazily Skipped Columns')::bigint;
+    select string_agg(format('%s=%s', a->>'Algorithm', a->>'Columns'), ', ' order by a->>'Algorithm')
+    from jsonb_array_elements(node->'Decompression') a into algorithms;
+    select string_agg(c->>'Column', ', ' order by c->>'Column')
+    from jsonb_array_elements(node->'Compressed Columns') c
+    where (c->>'Bytes Read')::bigint > 0 into compressed_columns;
+    timed := node ? 'Detoast Time';
+    return next;
+end
+$$;
+
+set max_parallel_workers_per_gather = 0;
+
+-- The profile is only collected when enabled.
+select * from decompression_profile('select ts, v from dprofile where v < 10');
+
+set timescaledb.explain_decompression_profile = on;
+
+-- The rows are removed by the vectorized filter first, and then by the
+-- non-vectorized filter.
+select * from decompression_profile($$ select ts, v from dprofile where v < 10 and v::text = '5' $$);
+
+-- No rows of any batch pass the filter, so the ts column is never
+-- decompressed.
+select * from decompression_profile('select ts, v from dprofile where v > 1000');
+
+-- No rows of the batches with even seg pass the filter.
+select * from decompression_profile($$ select ts, t from dprofile where t = 'text 1' $$);
+
+-- The timings follow the TIMING option of EXPLAIN.
+select timed from decompression_profile('select ts, v from dprofile where v < 10', timing => true);
+
+reset timescaledb.explain_decompression_profile;
+reset max_parallel_workers_per_gather;
+drop function decompression_profile(text, bool);
+drop table dprofile;
+
+-- Test the cumulative decompression statistics. Only the counters that
+-- don't depend on the platform are shown.
+create table dstats(ts int not null, seg int, v int, t text);
+select table_name from create_hypertable('dstats', 'ts', chunk_time_interval => 2000);
+alter table dstats set (timescaledb.compress, timescaledb.compress_segmentby = 'seg',
+    timescaledb.compress_orderby = 'ts');
+insert into dstats select x, x % 2, x % 100, 'text ' || x % 10 from generate_series(0, 3999) x;
+select count(compress_chunk(x)) from show_chunks('dstats') x;
+vacuum analyze dstats;
+
+create function explain_analyze(query text) returns void language plpgsql as
+$$
+begin
+    execute 'explain (analyze, costs off, timing off, summary off) ' || query;
+end
+$$;
+
+create view dstats_columns as
+select column_name, sum(batches_decompressed) batches, sum(rows_decompressed) as rows,
+    sum(dml_batches_decompressed) dml_batches, sum(dml_rows_decompressed) dml_rows
+from timescaledb_information.decompression_stats
+where hypertable_name = 'dstats'
+group by column_name order by column_name nulls first;
+
+create view dstats_aggregations as
+select sum(vectorized_aggregations) vectorized, sum(fallback_aggregations) fallback,
+    sum(fallback_unsupported_aggregate) unsupported, sum(fallback_aggregate_argument) argument,
+    sum(fallback_filter) filter
+from timescaledb_information.decompression_stats
+where hypertable_name = 'dstats' and column_name is null;
+
+set max_parallel_workers_per_gather = 0;
+
+select _timescaledb_functions.decompression_stats_reset();
+select * from dstats_columns;
+
+-- Some rows of every batch pass the filter, so all the columns are
+-- decompressed.
+select explain_analyze('select ts, v from dstats where v < 10');
+select * from dstats_columns;
+
+-- No rows pass the filter, so the batches are not counted for the chunk,
+-- and the ts column is not decompressed.
+select explain_analyze('select ts, v from dstats where v > 1000');
+select * from dstats_columns;
+
+-- Nothing is collected when the tracking is disabled.
+set timescaledb.track_decompression_stats = off;
+select explain_analyze('select ts, v from dstats where v < 10');
+reset timescaledb.track_decompression_stats;
+select * from dstats_columns;
+
+-- The partial aggregations are counted per chunk when they are planned.
+select _timescaledb_functions.decompression_stats_reset();
+select explain_analyze('select sum(v) from dstats');
+select * from dstats_aggregations;
+select explain_analyze('select sum(v), bit_or(v) from dstats');
+select explain_analyze('select sum(abs(v)) from dstats');
+select explain_analyze($$ select sum(v) from dstats where v::text = '5' $$);
+select * from dstats_aggregations;
+
+-- The DML decompresses the batches with seg = 1 in both chunks.
+select _timescaledb_functions.decompression_stats_reset();
+delete from dstats where seg = 1 and v = 5;
+select column_name, dml_batches, dml_rows from dstats_columns;
+
+reset max_parallel_workers_per_gather;
+drop view dstats_aggregations;
+drop view dstats_columns;
+drop function explain_analyze(text);
+drop table dstats;
+
+-- The columns that are decompressed after the vectorized filters only
+-- materialize the values of the passing rows, if the algorithm supports it.
+-- Test the array-compressed text columns, with and without nulls.
+create table latemat(ts int not null, seg int, v int, name text, note text);
+select table_name from create_hypertable('latemat', 'ts', chunk_time_interval => 100000);
+alter table latemat set (timescaledb.compress, timescaledb.compress_segmentby = 'seg',
+    timescaledb.compress_orderby = 'ts');
+insert into latemat select x, x % 2, x % 100, md5(x::text),
+    case when x % 7 = 0 then null else 'note ' || x end
+from generate_series(1, 4000) x;
+select count(compress_chunk(x)) from show_chunks('latemat') x;
+vacuum analyze latemat;
+
+select format('%I.%I', c2.schema_name, c2.table_name) as "COMPRESSED_CHUNK"
+from _timescaledb_catalog.chunk c1
+    join _timescaledb_catalog.chunk c2 on c2.id = c1.compressed_chunk_id
+    join _timescaledb_catalog.hypertable ht on ht.id = c1.hypertable_id
+where ht.table_name = 'latemat' \gset
+
+select distinct
+    (select algorithm from _timescaledb_functions.compressed_data_info(name)) as name,
+    (select algorithm from _timescaledb_functions.compressed_data_info(note)) as note
+from :COMPRESSED_CHUNK;
+
+set max_parallel_workers_per_gather = 0;
+
+select count(*), md5(string_agg(name || coalesce(note, 'null'), ',' order by ts))
+from latemat where v = 5;
+
+-- The quals on the fixed-width columns are evaluated first, but the result
+-- doesn't depend on the order.
+select count(*), md5(string_agg(name || coalesce(note, 'null'), ',' order by ts))
+from latemat where note <> 'note 5' and v = 5;
+
+-- Batch sorted merge materializes all rows.
+select ts, note from latemat where v = 5 order by ts limit 3;
+
+reset max_parallel_workers_per_gather;
+drop table latemat;
+
+-- The vectorized quals are reordered by their runtime statistics every 64
+-- batches. The first qual passes all rows and the second one none, so after
+-- the reordering the column of the first qual is not decompressed anymore.
+create table adaptive(ts int not null, seg int, a int, b int);
+select table_name from create_hypertable('adaptive', 'ts', chunk_time_interval => 1000000);
+alter table adaptive set (timescaledb.compress, timescaledb.compress_segmentby = 'seg',
+    timescaledb.compress_orderby = 'ts');
+insert into adaptive select x, x % 100, x, x from generate_series(1, 100000) x;
+select count(compress_chunk(x)) from show_chunks('adaptive') x;
+vacuum analyze adaptive;
+
+set max_parallel_workers_per_gather = 0;
+select _timescaledb_functions.decompression_stats_reset();
+select * from adaptive where a >= 0 and b < 0;
+select column_name, batches_decompressed from timescaledb_information.decompression_stats
+where hypertable_name = 'adaptive' and column_name is not null order by column_name;
+
+-- The results don't depend on the order.
+select count(*), sum(a), sum(b) from adaptive where a >= 0 and b < 1000;
+
+reset max_parallel_workers_per_gather;
+drop table adaptive;
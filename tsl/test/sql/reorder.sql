@@ -264,3 +264,33 @@ FROM
 SELECT add_reorder_policy(:'INTERNALTABLE','internal_idx');
 \set ON_ERROR_STOP 1
 
+
+-- Reorder swaps in the indexes built on the new heap without rebuilding
+-- them, so all kinds of chunk indexes must stay valid and usable
+CREATE TABLE reorder_idx(time int NOT NULL, device int, value float, note text);
+SELECT table_name FROM create_hypertable('reorder_idx', 'time', chunk_time_interval => 100);
+CREATE INDEX reorder_idx_device ON reorder_idx(device, time);
+CREATE UNIQUE INDEX reorder_idx_time_device ON reorder_idx(time, device);
+CREATE INDEX reorder_idx_partial ON reorder_idx(value) WHERE device = 1;
+CREATE INDEX reorder_idx_expr ON reorder_idx(lower(note));
+INSERT INTO reorder_idx SELECT t, t % 4, t * 0.5, 'Note ' || t FROM generate_series(99, 0, -1) t;
+-- Wait in the lock queue for the heap swap right away
+SET timescaledb.reorder_lock_retries = 0;
+SELECT reorder_chunk(chunk, 'reorder_idx_device') FROM show_chunks('reorder_idx') chunk;
+RESET timescaledb.reorder_lock_retries;
+SELECT device, time FROM reorder_idx ORDER BY ctid LIMIT 3;
+SELECT count(*) AS indexes, bool_and(indisvalid AND indisready AND indislive) AS valid
+FROM pg_index WHERE indrelid IN (SELECT show_chunks('reorder_idx'));
+
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*) FROM reorder_idx WHERE device = 2 AND time < 50;
+SELECT time, device FROM reorder_idx WHERE time = 42 AND device = 2;
+SELECT count(*) FROM reorder_idx WHERE device = 1 AND value > 40;
+SELECT time FROM reorder_idx WHERE lower(note) = 'note 17';
+-- New rows are added to the swapped indexes
+INSERT INTO reorder_idx VALUES (50, 5, 1, 'Extra');
+SELECT time FROM reorder_idx WHERE device = 5;
+SELECT time FROM reorder_idx WHERE lower(note) = 'extra';
+RESET enable_seqscan;
+RESET enable_bitmapscan;
@@ -750,3 +750,125 @@ ORDER BY schemaname, tablename;
 -- Cleanup
 DROP PUBLICATION test_split_pub CASCADE;
 DROP TABLE pub_split_test CASCADE;
+
+--
+-- Split a compressed chunk with several segments and batches. Only the
+-- batches straddling the split point are recompressed, so compare the
+-- result with splitting the same data before compressing it.
+--
+set timescaledb.compression_batch_size_limit = 10;
+
+create function split_batch_counts(ht regclass) returns table(range_start bigint, device int, batches bigint, batch_rows bigint) as $$
+declare
+    q text;
+begin
+    select string_agg(format('select %s::bigint as range_start, device, _ts_meta_count from %I.%I', ds.range_start, c2.schema_name, c2.table_name), ' union all ') into q
+    from _timescaledb_catalog.chunk c1
+    join _timescaledb_catalog.chunk c2 on (c2.id = c1.compressed_chunk_id)
+    join _timescaledb_catalog.chunk_constraint cc on (cc.chunk_id = c1.id)
+    join _timescaledb_catalog.dimension_slice ds on (ds.id = cc.dimension_slice_id)
+    where format('%I.%I', c1.schema_name, c1.table_name)::regclass in (select show_chunks(ht));
+    return query execute format('select range_start, device, count(*), sum(_ts_meta_count) from (%s) b group by 1, 2 order by 1, 2', q);
+end;
+$$ language plpgsql;
+
+create table split_batches (time int not null, device int, temp float);
+select table_name from create_hypertable('split_batches', 'time', chunk_time_interval => 100);
+alter table split_batches set (timescaledb.compress_orderby='time', timescaledb.compress_segmentby='device');
+create table split_batches_ref (time int not null, device int, temp float);
+select table_name from create_hypertable('split_batches_ref', 'time', chunk_time_interval => 100);
+alter table split_batches_ref set (timescaledb.compress_orderby='time', timescaledb.compress_segmentby='device');
+
+-- Devices 1 and 2 have batches on both sides of the split point, device 3
+-- only before it
+insert into split_batches select t, d, t * d from generate_series(0, 99) t, generate_series(1, 2) d;
+insert into split_batches select t, 3, t * 3 from generate_series(0, 39) t;
+insert into split_batches_ref select * from split_batches;
+
+select count(compress_chunk(ch)) from show_chunks('split_batches') ch;
+select * from split_batch_counts('split_batches');
+
+select ch as batches_chunk from show_chunks('split_batches') ch \gset
+call split_chunk(:'batches_chunk', split_at => 55);
+select ch as batches_ref_chunk from show_chunks('split_batches_ref') ch \gset
+call split_chunk(:'batches_ref_chunk', split_at => 55);
+select count(compress_chunk(ch)) from show_chunks('split_batches_ref') ch;
+
+select * from split_batch_counts('split_batches');
+select count(*) as differences from (
+    (select * from split_batch_counts('split_batches') except all select * from split_batch_counts('split_batches_ref'))
+    union all
+    (select * from split_batch_counts('split_batches_ref') except all select * from split_batch_counts('split_batches'))
+) d;
+
+-- Compare the data in each of the result chunks
+select ch as batches_chunk2 from show_chunks('split_batches') ch order by ch limit 1 offset 1 \gset
+select ch as batches_ref_chunk2 from show_chunks('split_batches_ref') ch order by ch limit 1 offset 1 \gset
+select count(*) as differences from (
+    (select * from :batches_chunk except all select * from :batches_ref_chunk)
+    union all
+    (select * from :batches_ref_chunk except all select * from :batches_chunk)
+    union all
+    (select * from :batches_chunk2 except all select * from :batches_ref_chunk2)
+    union all
+    (select * from :batches_ref_chunk2 except all select * from :batches_chunk2)
+) d;
+select count(*), sum(temp) from :batches_chunk;
+select count(*), sum(temp) from :batches_chunk2;
+
+
+-- Split a compressed chunk where several segment groups, including ones
+-- with NULL segmentby values, straddle the split point. The same
+-- compressors are reused for every straddling segment, so check that each
+-- recompressed batch gets the segmentby values and the rows of its own
+-- segment.
+create function split_segment_batches(ht regclass) returns table(range_start bigint, device text, loc int, batch_rows int, min_time int, max_time int) as $$
+declare
+    q text;
+begin
+    select string_agg(format('select %s::bigint as range_start, device, loc, _ts_meta_count, _ts_meta_min_1, _ts_meta_max_1 from %I.%I', ds.range_start, c2.schema_name, c2.table_name), ' union all ') into q
+    from _timescaledb_catalog.chunk c1
+    join _timescaledb_catalog.chunk c2 on (c2.id = c1.compressed_chunk_id)
+    join _timescaledb_catalog.chunk_constraint cc on (cc.chunk_id = c1.id)
+    join _timescaledb_catalog.dimension_slice ds on (ds.id = cc.dimension_slice_id)
+    where format('%I.%I', c1.schema_name, c1.table_name)::regclass in (select show_chunks(ht));
+    return query execute format('select * from (%s) b order by 1, 2, 3, 5', q);
+end;
+$$ language plpgsql;
+
+create table split_segments (time int not null, device text, loc int, temp float);
+select table_name from create_hypertable('split_segments', 'time', chunk_time_interval => 100);
+alter table split_segments set (timescaledb.compress_orderby='time', timescaledb.compress_segmentby='device, loc');
+
+-- Segments (a, 1), (b, 1), (d, 3) and (NULL, 1) straddle the split point at
+-- different offsets, (a, 2) is only before it and (c, NULL) only after it
+insert into split_segments select t, 'a', 1, t from generate_series(40, 69) t;
+insert into split_segments select t, 'a', 2, t from generate_series(30, 39) t;
+insert into split_segments select t, 'b', 1, t from generate_series(43, 62) t;
+insert into split_segments select t, 'c', null, t from generate_series(60, 69) t;
+insert into split_segments select t, 'd', 3, t from generate_series(46, 55) t;
+insert into split_segments select t, null, 1, t from generate_series(50, 64) t;
+create table split_segments_orig as select * from split_segments;
+
+select count(compress_chunk(ch)) from show_chunks('split_segments') ch;
+select ch as segments_chunk from show_chunks('split_segments') ch \gset
+call split_chunk(:'segments_chunk', split_at => 55);
+
+select * from split_segment_batches('split_segments');
+
+select ch as segments_chunk2 from show_chunks('split_segments') ch order by ch limit 1 offset 1 \gset
+select count(*) as differences from (
+    (select * from :segments_chunk except all select * from split_segments_orig where time < 55)
+    union all
+    (select * from split_segments_orig where time < 55 except all select * from :segments_chunk)
+    union all
+    (select * from :segments_chunk2 except all select * from split_segments_orig where time >= 55)
+    union all
+    (select * from split_segments_orig where time >= 55 except all select * from :segments_chunk2)
+) d;
+
+reset timescaledb.compression_batch_size_limit;
+drop table split_batches;
+drop table split_batches_ref;
+drop table split_segments;
+drop table split_segments_orig;
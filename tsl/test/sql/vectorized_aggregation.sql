@@ -473,3 +473,355 @@ FROM testtable3 TT
 WHERE time >= date_trunc('hour', '2024-01-09'::timestamptz) - interval '1 hour'
 \g :TEST_OUTPUT_DIR/vectorized_aggregation_query_result_distinct.out
 
+
+--
+-- Compare the vectorized aggregation with the row-by-row one
+--
+CREATE FUNCTION compare_vector_agg(query text)
+RETURNS TABLE(vectorized bool, total_rows bigint, differences bigint) LANGUAGE plpgsql AS
+$$
+DECLARE
+    plan_line text;
+BEGIN
+    vectorized := false;
+    FOR plan_line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || query LOOP
+        vectorized := vectorized OR plan_line LIKE '%VectorAgg%';
+    END LOOP;
+    EXECUTE 'CREATE TEMP TABLE vector_agg_result AS ' || query;
+    PERFORM set_config('timescaledb.enable_vectorized_aggregation', 'off', true);
+    EXECUTE 'CREATE TEMP TABLE row_agg_result AS ' || query;
+    PERFORM set_config('timescaledb.enable_vectorized_aggregation', 'on', true);
+    SELECT count(*) FROM vector_agg_result INTO total_rows;
+    SELECT count(*) FROM (
+        (TABLE vector_agg_result EXCEPT ALL TABLE row_agg_result)
+        UNION ALL
+        (TABLE row_agg_result EXCEPT ALL TABLE vector_agg_result)) d
+    INTO differences;
+    DROP TABLE vector_agg_result, row_agg_result;
+    RETURN NEXT;
+END
+$$;
+
+--
+-- Vectorized histogram()
+--
+CREATE TABLE hist(ts int NOT NULL, segment int, i2 int2, i4 int4, i8 int8, f4 float4, f8 float8);
+SELECT FROM create_hypertable('hist', 'ts', chunk_time_interval => 10000);
+ALTER TABLE hist SET (timescaledb.compress, timescaledb.compress_segmentby = 'segment', timescaledb.compress_orderby = 'ts');
+
+-- The segment 4 has only nulls.
+INSERT INTO hist
+SELECT x, x % 5,
+    CASE WHEN x % 5 = 4 OR x % 7 = 0 THEN NULL ELSE x % 100 - 10 END,
+    CASE WHEN x % 5 = 4 OR x % 7 = 0 THEN NULL ELSE x % 100 - 10 END,
+    CASE WHEN x % 5 = 4 OR x % 11 = 0 THEN NULL ELSE x % 100 - 10 END,
+    CASE WHEN x % 5 = 4 OR x % 11 = 0 THEN NULL ELSE (x % 100 - 10) / 3.0 END,
+    CASE WHEN x % 5 = 4 OR x % 11 = 0 THEN NULL ELSE (x % 100 - 10) / 3.0 END
+FROM generate_series(1, 20000) x;
+
+SELECT count(compress_chunk(ch)) FROM show_chunks('hist') ch;
+ALTER TABLE hist ADD COLUMN missing float8;
+VACUUM ANALYZE hist;
+
+-- The null values are counted as zeros, like in the row-by-row transition
+-- function, so a group with only nulls has them in the bucket of zero.
+SELECT segment, histogram(i4, 0, 50, 5) FROM hist WHERE segment = 4 GROUP BY segment;
+SET timescaledb.enable_vectorized_aggregation TO off;
+SELECT segment, histogram(i4, 0, 50, 5) FROM hist WHERE segment = 4 GROUP BY segment;
+RESET timescaledb.enable_vectorized_aggregation;
+
+-- histogram() is vectorized on PG 16 and later.
+SELECT current_setting('server_version_num')::int >= 160000 AS vectorize_histogram \gset
+
+SELECT vectorized = :vectorize_histogram AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT histogram(f8, 0, 20, 4) FROM hist $$);
+
+SELECT vectorized = :vectorize_histogram AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, histogram(i2, 0, 50, 5) FROM hist GROUP BY segment $$);
+
+SELECT vectorized = :vectorize_histogram AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, histogram(i4, -5, 95, 10) FROM hist GROUP BY segment $$);
+
+SELECT vectorized = :vectorize_histogram AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, histogram(i8, 10, 20, 3) FROM hist GROUP BY segment $$);
+
+SELECT vectorized = :vectorize_histogram AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, histogram(f4, -1, 31, 8) FROM hist GROUP BY segment $$);
+
+SELECT vectorized = :vectorize_histogram AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, histogram(f8, 0, 20, 4) FROM hist WHERE ts > 5000 GROUP BY segment $$);
+
+SELECT vectorized = :vectorize_histogram AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, i2, histogram(f8, 0, 20, 4) FROM hist GROUP BY segment, i2 $$);
+
+SELECT vectorized = :vectorize_histogram AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, histogram(missing, 0, 10, 2) FROM hist GROUP BY segment $$);
+
+-- An empty group gives a null histogram.
+SELECT vectorized = :vectorize_histogram AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT histogram(f8, 0, 20, 4) FROM hist WHERE f8 > 1000 $$);
+
+DROP TABLE hist;
+
+--
+-- Vectorized aggregation using the batch sum metadata
+--
+CREATE TABLE summeta(ts int NOT NULL, segment int, v int4, i8 int8, f8 float8);
+SELECT FROM create_hypertable('summeta', 'ts', chunk_time_interval => 10000);
+-- The sum metadata can be combined with a minmax sparse index and set for the
+-- orderby column.
+ALTER TABLE summeta SET (timescaledb.compress,
+    timescaledb.compress_segmentby = 'segment',
+    timescaledb.compress_orderby = 'ts',
+    timescaledb.compress_index = 'sum("ts"), minmax("v"), sum("v"), sum("i8"), sum("f8")');
+
+-- The segment 3 has only null values of v, and the bigint sum of i8 overflows
+-- in the segment 1, so these batches have null sum metadata.
+INSERT INTO summeta
+SELECT x, x % 4,
+    CASE WHEN x % 4 = 3 THEN NULL ELSE x % 100 END,
+    CASE WHEN x % 4 = 1 THEN 9223372036854775000 - x ELSE x END,
+    CASE WHEN x % 13 = 0 THEN NULL ELSE x / 8.0 END
+FROM generate_series(1, 20000) x;
+
+SELECT count(compress_chunk(ch)) FROM show_chunks('summeta') ch;
+VACUUM ANALYZE summeta;
+
+SELECT vectorized AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT sum(ts), sum(v), sum(i8), sum(f8) FROM summeta $$);
+
+SELECT vectorized AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, sum(ts), count(ts), avg(ts) FROM summeta GROUP BY segment $$);
+
+SELECT vectorized AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, sum(v), count(v), avg(v), min(v), max(v) FROM summeta GROUP BY segment $$);
+
+SELECT vectorized AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, sum(i8), count(i8), avg(i8) FROM summeta GROUP BY segment $$);
+
+SELECT vectorized AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, sum(f8), count(f8), avg(f8) FROM summeta GROUP BY segment $$);
+
+-- The batches with only null values give null sums.
+SELECT segment, sum(v), count(v), avg(v) FROM summeta WHERE segment = 3 GROUP BY segment;
+
+-- With a vectorized filter, the batches are decompressed.
+SELECT vectorized AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT segment, sum(v), sum(i8), sum(f8) FROM summeta WHERE ts > 15000 GROUP BY segment $$);
+
+DROP TABLE summeta;
+
+--
+-- Vectorized grouping by several fixed-size columns packed into a single key
+--
+CREATE FUNCTION vector_agg_grouping_policy(query text) RETURNS text LANGUAGE plpgsql AS
+$$
+DECLARE
+    plan_line text;
+BEGIN
+    FOR plan_line IN EXECUTE 'EXPLAIN (VERBOSE, COSTS OFF) ' || query LOOP
+        IF plan_line LIKE '%Grouping Policy:%' THEN
+            RETURN trim(split_part(plan_line, 'Grouping Policy:', 2));
+        END IF;
+    END LOOP;
+    RETURN NULL;
+END
+$$;
+
+CREATE TABLE packed(ts int NOT NULL, segment int, i2 int2, i4 int4, i8 int8, f8 float8, b bool, u uuid);
+SELECT FROM create_hypertable('packed', 'ts', chunk_time_interval => 10000);
+ALTER TABLE packed SET (timescaledb.compress, timescaledb.compress_segmentby = 'segment', timescaledb.compress_orderby = 'ts');
+
+-- Every column has nulls, so the null bitmap of the key is tested with all
+-- the columns. The values of i8 use the high bytes.
+INSERT INTO packed
+SELECT x, x % 3,
+    CASE WHEN x % 7 = 0 THEN NULL ELSE x % 5 END,
+    CASE WHEN x % 11 = 0 THEN NULL ELSE x % 4 - 2 END,
+    CASE WHEN x % 13 = 0 THEN NULL ELSE (x % 6) * 10000000000 END,
+    CASE WHEN x % 17 = 0 THEN NULL ELSE (x % 4) / 2.0 END,
+    CASE WHEN x % 19 = 0 THEN NULL ELSE x % 2 = 0 END,
+    CASE WHEN x % 23 = 0 THEN NULL ELSE format('00000000-0000-7000-8000-%s', lpad((x % 3)::text, 12, '0'))::uuid END
+FROM generate_series(1, 20000) x;
+
+SELECT count(compress_chunk(ch)) FROM show_chunks('packed') ch;
+VACUUM ANALYZE packed;
+
+-- The keys of up to 8 bytes, including the null bitmap byte for several
+-- columns, use the 8-byte packed key, and the keys of up to 16 bytes use the
+-- 16-byte one. The larger keys are serialized. The results are compared with
+-- the row-by-row aggregation.
+SELECT grouping, vector_agg_grouping_policy(query) AS grouping_policy, total_rows, differences
+FROM (VALUES
+    (1, 'i2, i4'),
+    (2, 'segment, b'),
+    (3, 'segment, i4'),
+    (4, 'time_bucket(1000, ts), i2'),
+    (5, 'b, i2, i4'),
+    (6, 'i8, i4'),
+    (7, 'b'),
+    (8, 'u'),
+    (9, 'i8, f8'),
+    (10, 'u, b')) g(n, grouping),
+    LATERAL (SELECT format('SELECT %s, count(*), sum(i4), min(f8), max(ts) FROM packed GROUP BY %s', grouping, grouping) AS query) q,
+    LATERAL compare_vector_agg(query) c
+ORDER BY n;
+
+-- With a vectorized filter.
+SELECT vector_agg_grouping_policy(query) AS grouping_policy, total_rows, differences
+FROM (VALUES ('SELECT i2, b, count(*), sum(i8) FROM packed WHERE i4 > 0 GROUP BY i2, b')) q(query),
+    LATERAL compare_vector_agg(query) c;
+
+DROP TABLE packed;
+
+--
+-- Vectorized grouping by time_bucket()
+--
+CREATE TABLE tbucket(ts timestamptz NOT NULL, t timestamp, d date, i int, segment int, v float8, u uuid);
+SELECT FROM create_hypertable('tbucket', 'ts', chunk_time_interval => interval '1 day');
+ALTER TABLE tbucket SET (timescaledb.compress, timescaledb.compress_segmentby = 'segment', timescaledb.compress_orderby = 'ts');
+
+-- The data starts before the Postgres epoch and the default origin of
+-- time_bucket(), to test the rounding of negative values.
+INSERT INTO tbucket
+SELECT ts,
+    CASE WHEN x % 11 = 0 THEN NULL ELSE ts AT TIME ZONE 'UTC' END,
+    CASE WHEN x % 13 = 0 THEN NULL ELSE (ts AT TIME ZONE 'UTC')::date END,
+    CASE WHEN x % 17 = 0 THEN NULL ELSE x % 1000 - 500 END,
+    x % 3,
+    x / 4.0,
+    to_uuidv7_boundary(ts)
+FROM generate_series(1, 10000) x, LATERAL (SELECT '1999-12-31 00:00:00+00'::timestamptz + x * interval '37 seconds' AS ts) t;
+
+SELECT count(compress_chunk(ch)) FROM show_chunks('tbucket') ch;
+VACUUM ANALYZE tbucket;
+
+-- The fixed-width buckets on timestamps with the default origin are computed
+-- inline, the other variants call the time_bucket() function. The variant
+-- with a time zone is not strict, so it is not vectorized. The uuid values
+-- are not bucketed by the vectorized aggregation either.
+SELECT grouping, vector_agg_grouping_policy(query) AS grouping_policy, total_rows, differences
+FROM (VALUES
+    (1, 'time_bucket(''1 hour'', ts)'),
+    (2, 'time_bucket(''1 week'', ts)'),
+    (3, 'time_bucket(''15 minutes'', t)'),
+    (4, 'time_bucket(''1 day'', t, ''2000-01-01 12:00''::timestamp)'),
+    (5, 'time_bucket(''1 hour'', ts, ''30 minutes''::interval)'),
+    (6, 'time_bucket(''1 month'', ts)'),
+    (7, 'time_bucket(''1 week'', d)'),
+    (8, 'time_bucket(100, i)'),
+    (9, 'segment, time_bucket(''1 hour'', ts)'),
+    (10, 'time_bucket(''1 day'', ts, ''Europe/Berlin'')'),
+    (11, 'time_bucket(''1 hour'', u)')) g(n, grouping),
+    LATERAL (SELECT format('SELECT %s, count(*), sum(i), min(v) FROM tbucket GROUP BY %s', grouping, grouping) AS query) q,
+    LATERAL compare_vector_agg(query) c
+ORDER BY n;
+
+-- The real-time part of a continuous aggregate is vectorized.
+CREATE MATERIALIZED VIEW tbucket_hourly WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+SELECT time_bucket('1 hour', ts) AS bucket, segment, count(*), sum(i), min(v) FROM tbucket GROUP BY 1, 2 WITH NO DATA;
+CALL refresh_continuous_aggregate('tbucket_hourly', NULL, '2000-01-02 00:00:00+00');
+
+SELECT vectorized AS plan_ok, total_rows, differences
+FROM compare_vector_agg($$ SELECT * FROM tbucket_hourly $$);
+
+SET client_min_messages TO error;
+DROP MATERIALIZED VIEW tbucket_hourly;
+RESET client_min_messages;
+DROP TABLE tbucket;
+
+--
+-- Vectorized grouping by dictionary-encoded text columns
+--
+CREATE TABLE dictgroup(ts int NOT NULL, segment text, host text, region text, name text, i int);
+SELECT FROM create_hypertable('dictgroup', 'ts', chunk_time_interval => 10000);
+ALTER TABLE dictgroup SET (timescaledb.compress, timescaledb.compress_segmentby = 'segment', timescaledb.compress_orderby = 'ts');
+
+INSERT INTO dictgroup
+SELECT x, 'segment ' || x % 2,
+    CASE WHEN x % 7 = 0 THEN NULL ELSE 'host ' || x % 5 END,
+    CASE WHEN x % 11 = 0 THEN NULL ELSE 'region ' || x % 3 END,
+    'name ' || x,
+    x % 100
+FROM generate_series(1, 20000) x;
+
+SELECT count(compress_chunk(ch)) FROM show_chunks('dictgroup') ch;
+VACUUM ANALYZE dictgroup;
+
+SELECT format('%I.%I', c2.schema_name, c2.table_name) AS "COMPRESSED_CHUNK"
+FROM _timescaledb_catalog.chunk c1
+  JOIN _timescaledb_catalog.chunk c2 ON c2.id = c1.compressed_chunk_id
+  JOIN _timescaledb_catalog.hypertable ht ON ht.id = c1.hypertable_id
+WHERE ht.table_name = 'dictgroup' ORDER BY c1.id LIMIT 1 \gset
+
+-- The low-cardinality columns use dictionary compression, and the unique
+-- names don't.
+SELECT DISTINCT
+    (SELECT algorithm FROM _timescaledb_functions.compressed_data_info(host)) AS host,
+    (SELECT algorithm FROM _timescaledb_functions.compressed_data_info(region)) AS region,
+    (SELECT algorithm FROM _timescaledb_functions.compressed_data_info(name)) AS name
+FROM :COMPRESSED_CHUNK;
+
+-- The keys are looked up once per dictionary code when all the grouping
+-- columns are either dictionary-encoded or segmentby, and there are not more
+-- codes than rows passing the filter. The other cases hash every row. The
+-- results are compared with the row-by-row aggregation.
+SELECT n, vectorized, total_rows, differences
+FROM (VALUES
+    (1, 'SELECT host, count(*), sum(i), min(ts) FROM dictgroup GROUP BY host'),
+    (2, 'SELECT host, region, count(*), sum(i), min(ts) FROM dictgroup GROUP BY host, region'),
+    (3, 'SELECT segment, host, count(*), sum(i), min(ts) FROM dictgroup GROUP BY segment, host'),
+    (4, 'SELECT host, i, count(*), min(ts) FROM dictgroup GROUP BY host, i'),
+    (5, 'SELECT host, name, count(*), sum(i) FROM dictgroup GROUP BY host, name'),
+    (6, 'SELECT host, region, count(*), min(ts) FROM dictgroup WHERE i = 0 GROUP BY host, region'),
+    (7, 'SELECT host, count(*), sum(i), min(ts) FROM dictgroup WHERE i < 50 GROUP BY host'),
+    (8, 'SELECT segment, host, region, count(*), sum(i) FROM dictgroup WHERE i < 50 GROUP BY segment, host, region')) q(n, query),
+    LATERAL compare_vector_agg(query) c
+ORDER BY n;
+
+DROP TABLE dictgroup;
+
+--
+-- Vectorized aggregation of numeric columns
+--
+CREATE TABLE numagg(ts int NOT NULL, segment int, amount numeric, price numeric(10, 2), special numeric, grp numeric);
+SELECT FROM create_hypertable('numagg', 'ts', chunk_time_interval => 100000);
+ALTER TABLE numagg SET (timescaledb.compress, timescaledb.compress_segmentby = 'segment', timescaledb.compress_orderby = 'ts');
+
+-- The amount has values with different scales and nulls, the price has the
+-- same scale everywhere, and the special values have no int64 fixed-point
+-- representation. The grouping column has equal values with different
+-- scales.
+INSERT INTO numagg
+SELECT x, x % 5,
+    CASE WHEN x % 10 = 0 THEN NULL WHEN x % 3 = 0 THEN x * 0.001 ELSE x * 0.01 END,
+    (x % 500) * 0.25,
+    CASE x % 50
+        WHEN 0 THEN 123456789012345678901.5
+        WHEN 1 THEN 'NaN'
+        WHEN 2 THEN 'Infinity'
+        WHEN 3 THEN '-Infinity'
+        WHEN 4 THEN -1e30
+        ELSE x * 0.5 END,
+    CASE WHEN x % 2 = 0 THEN (x % 3)::numeric ELSE round((x % 3)::numeric, 2) END
+FROM generate_series(1, 10000) x;
+
+SELECT count(compress_chunk(ch)) FROM show_chunks('numagg') ch;
+VACUUM ANALYZE numagg;
+
+-- The results keep the display scale of the values.
+SELECT sum(amount), min(amount), max(amount), sum(price), min(price), max(price) FROM numagg;
+
+SELECT n, vectorized, total_rows, differences
+FROM (VALUES
+    (1, 'SELECT sum(amount), avg(amount), min(amount), max(amount), count(amount) FROM numagg'),
+    (2, 'SELECT segment, sum(amount), avg(amount), min(amount), max(amount), count(amount) FROM numagg GROUP BY segment'),
+    (3, 'SELECT segment, sum(price), avg(price), min(price), max(price) FROM numagg GROUP BY segment'),
+    (4, 'SELECT segment, sum(special), avg(special), min(special), max(special) FROM numagg GROUP BY segment'),
+    (5, 'SELECT segment, sum(amount), avg(price), min(special), max(amount) FROM numagg WHERE ts < 5500 GROUP BY segment'),
+    (6, 'SELECT sum(amount), avg(amount), min(amount), max(amount) FROM numagg WHERE ts > 20000'),
+    (7, 'SELECT grp, count(*), sum(amount) FROM numagg GROUP BY grp')) q(n, query),
+    LATERAL compare_vector_agg(query) c
+ORDER BY n;
+
+DROP TABLE numagg;
@@ -44,6 +44,14 @@ get_compression_algorithm(char *name)
 	{
 		return COMPRESSION_ALGORITHM_UUID;
 	}
+	else if (pg_strcasecmp(name, "decimal") == 0)
+	{
+		return COMPRESSION_ALGORITHM_DECIMAL;
+	}
+	else if (pg_strcasecmp(name, "jsonb") == 0)
+	{
+		return COMPRESSION_ALGORITHM_JSONB;
+	}
 
 	ereport(ERROR, (errmsg("unknown compression algorithm %s", name)));
 	return _INVALID_COMPRESSION_ALGORITHM;